@@ -9,9 +9,11 @@ HEADERS += \
     $$files(src/io_dxf/*.h) \
     $$files(src/io_gmio/*.h) \
     $$files(src/io_image/*.h) \
+    $$files(src/io_obj/*.h) \
     $$files(src/io_occ/*.h) \
     $$files(src/io_off/*.h) \
     $$files(src/io_ply/*.h) \
+    $$files(src/io_stl/*.h) \
     $$files(src/measure/*.h) \
 
 
@@ -26,8 +28,10 @@ SOURCES += \
     $$files(src/io_dxf/*.cpp) \
     $$files(src/io_gmio/*.cpp) \
     $$files(src/io_image/*.cpp) \
+    $$files(src/io_obj/*.cpp) \
     $$files(src/io_occ/*.cpp) \
     $$files(src/io_off/*.cpp) \
+    $$files(src/io_stl/*.cpp) \
     $$files(src/measure/*.cpp) \
     \
     messages.cpp \
@@ -5,9 +5,10 @@ double dummy = 0;
 #include "src/io_gmio/io_gmio_amf_writer.cpp"
 #include "src/io_image/io_image.cpp"
 #include "src/io_occ/io_occ_common.h"
-#include "src/io_occ/io_occ_stl.cpp"
 #include "src/io_occ/io_occ_gltf_writer.cpp"
+#include "src/io_occ/io_occ_stl.cpp"
 #include "src/io_ply/io_ply_writer.cpp"
+#include "src/io_stl/io_stl_writer.cpp"
 #include "src/app/app_module.h"
 #include "src/app/widget_model_tree_builder_xde.h"
 
@@ -50,15 +51,18 @@ static void messages() {
     Mayo::IO::OccCommon::textId("Foot");
     Mayo::IO::OccCommon::textId("Mile");
 
-    Mayo::IO::OccStlWriterI18N::textId("Ascii");
-    Mayo::IO::OccStlWriterI18N::textId("Binary");
-
     Mayo::IO::OccGltfWriter::Properties::textId("Json");
     Mayo::IO::OccGltfWriter::Properties::textId("Binary");
 
+    Mayo::IO::OccStlWriterI18N::textId("Ascii");
+    Mayo::IO::OccStlWriterI18N::textId("Binary");
+
     Mayo::IO::PlyWriterI18N::textId("Ascii");
     Mayo::IO::PlyWriterI18N::textId("Binary");
 
+    Mayo::IO::StlWriterI18N::textId("Ascii");
+    Mayo::IO::StlWriterI18N::textId("Binary");
+
     Mayo::IO::ImageWriterI18N::textId("Perspective");
     Mayo::IO::ImageWriterI18N::textId("Orthographic");
 }
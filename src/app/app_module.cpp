@@ -26,6 +26,7 @@
 #include "gui/gui_application.h"
 #include "gui/gui_document.h"
 #include "qtcommon/filepath_conv.h"
+#include "qtcommon/qstring_conv.h"
 #include "qtcommon/qtcore_utils.h"
 
 namespace Mayo
@@ -440,6 +441,60 @@ void AppModule::computeBRepMesh(const TDF_Label &labelEntity, TaskProgress *prog
         this->computeBRepMesh(XCaf::shape(labelEntity), progress);
 }
 
+bool AppModule::isImportPostProcessRequired(IO::Format format)
+{
+    return IO::formatProvidesBRep(format);
+}
+
+void AppModule::postProcessImportedEntity(const TDF_Label &labelEntity, TaskProgress *progress)
+{
+    if (!XCaf::isShape(labelEntity))
+        return;
+
+    const TopoDS_Shape shape = XCaf::shape(labelEntity);
+    // Faces without surface are mesh-only, there's nothing to mesh
+    bool hasGeometricFace = false;
+    BRepUtils::forEachSubFace(
+        shape, [&](const TopoDS_Face &face) { hasGeometricFace |= BRepUtils::isGeometric(face); });
+    if (hasGeometricFace)
+        this->computeBRepMesh(shape, progress);
+}
+
+uint64_t AppModule::importMemoryBudget() const
+{
+    return uint64_t(m_props.importMemoryBudget.value()) * 1024 * 1024;
+}
+
+void AppModule::restoreMemoryExpansionFactors()
+{
+    // Factors are stored as "<format>:<factor>;..." eg "STEP:11.5;STL:3.2;"
+    const QString strFactors = to_QString(m_props.ioMemoryExpansionFactors.value());
+    for (const QString &strItem : strFactors.split(';'))
+    {
+        const QStringList listItemPart = strItem.split(':');
+        if (listItemPart.size() != 2)
+            continue; // Skip
+
+        bool okFactor = false;
+        const double factor = listItemPart.at(1).toDouble(&okFactor);
+        const std::string strFormat = to_stdString(listItemPart.at(0));
+        for (IO::Format format : m_ioSystem.readerFormats())
+        {
+            if (okFactor && IO::formatIdentifier(format) == strFormat)
+                m_ioSystem.setMemoryExpansionFactor(format, factor);
+        }
+    }
+}
+
+void AppModule::recordMemoryExpansionFactors()
+{
+    std::string strFactors;
+    for (const auto &[format, factor] : m_ioSystem.memoryExpansionFactors())
+        strFactors += fmt::format("{}:{};", IO::formatIdentifier(format), factor);
+
+    m_props.ioMemoryExpansionFactors.setValue(strFactors);
+}
+
 void AppModule::addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr)
 {
     m_vecDocTreeNodePropsProvider.push_back(std::move(ptr));
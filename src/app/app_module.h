@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <locale>
 #include <mutex>
 
@@ -115,6 +116,20 @@ public:
     void computeBRepMesh(const TopoDS_Shape &shape, TaskProgress *progress = nullptr);
     void computeBRepMesh(const TDF_Label &labelEntity, TaskProgress *progress = nullptr);
 
+    // Post-processing of entities imported from a file, meant to be called by the import task
+    // BRep shapes are meshed, so this isn't done by the GUI thread when entities get displayed
+    static bool isImportPostProcessRequired(IO::Format format);
+    void postProcessImportedEntity(const TDF_Label &labelEntity, TaskProgress *progress = nullptr);
+
+    // Memory budget in bytes for reading many files, as defined in settings(0 means no limit)
+    uint64_t importMemoryBudget() const;
+
+    // Memory expansion factors learned by IO::System are persisted in settings, so estimations
+    // of memory needed to read files are accurate from the first import
+    // Restore must be called once reader formats are registered and settings are loaded
+    void restoreMemoryExpansionFactors();
+    void recordMemoryExpansionFactors();
+
     // Providers to query document tree node properties
     void addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr);
     std::unique_ptr<PropertyGroupSignals> properties(const DocumentTreeNode &treeNode) const;
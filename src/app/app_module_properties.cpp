@@ -56,10 +56,16 @@ AppModuleProperties::AppModuleProperties(Settings *settings)
     settings->addSetting(&this->linkWithDocumentSelector, groupId_application);
     settings->addSetting(&this->forceOpenGlFallbackWidget, groupId_application);
     settings->addSetting(&this->appUiState, groupId_application);
+    settings->addSetting(&this->importMemoryBudget, groupId_application);
+    settings->addSetting(&this->ioMemoryExpansionFactors, groupId_application);
     this->recentFiles.setUserVisible(false);
     this->lastOpenDir.setUserVisible(false);
     this->lastSelectedFormatFilter.setUserVisible(false);
     this->appUiState.setUserVisible(false);
+    this->ioMemoryExpansionFactors.setUserVisible(false);
+    this->importMemoryBudget.setRange(0, 1024 * 1024);
+    this->importMemoryBudget.setSingleStep(256);
+    this->importMemoryBudget.setConstraintsEnabled(true);
 
     // Meshing
     this->meshingQuality.mutableEnumeration().changeTrContext(AppModuleProperties::textIdContext());
@@ -101,6 +107,8 @@ AppModuleProperties::AppModuleProperties(Settings *settings)
             this->actionOnDocumentFileChange.setValue(ActionOnDocumentFileChange::None);
             this->linkWithDocumentSelector.setValue(true);
             this->appUiState.setValue({});
+            this->importMemoryBudget.setValue(0);
+            this->ioMemoryExpansionFactors.setValue({});
 #ifndef MAYO_OS_MAC
             this->forceOpenGlFallbackWidget.setValue(false);
 #else
@@ -229,6 +237,11 @@ void AppModuleProperties::retranslate()
                  "proved to be more supported.\n\n"
                  "This option is applicable when OpenCascade ≥ 7.6 version. "
                  "Change will take effect after application restart"));
+    this->importMemoryBudget.setDescription(
+        textIdTr("Memory budget in megabytes when importing many files at once.\n\n"
+                 "Files are read concurrently as long as their estimated peak memory fits in "
+                 "this budget, a file exceeding the budget is read alone.\n\n"
+                 "`0` means no limit"));
 
     // Meshing
     this->meshingQuality.setDescription(
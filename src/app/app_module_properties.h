@@ -71,6 +71,9 @@ public:
     PropertyBool linkWithDocumentSelector{this, textId("linkWithDocumentSelector")};
     PropertyBool forceOpenGlFallbackWidget{this, textId("forceOpenGlFallbackWidget")};
     PropertyAppUiState appUiState{this, textId("appUiState")};
+    PropertyInt importMemoryBudget{this, textId("importMemoryBudget")}; // Megabytes
+    // Memory expansion factors learned by IO::System, see AppModule::recordMemoryExpansionFactors()
+    PropertyString ioMemoryExpansionFactors{this, textId("ioMemoryExpansionFactors")};
     // Meshing
     const Settings::GroupIndex groupId_meshing;
     enum class BRepMeshQuality
@@ -7,6 +7,7 @@
 #include "commands_file.h"
 
 #include <cassert>
+#include <vector>
 
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QMimeData>
@@ -17,10 +18,16 @@
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMenu>
 
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
 #include <fmt/format.h>
 
 #include "base/application.h"
+#include "base/brep_utils.h"
+#include "base/document.h"
 #include "base/task_manager.h"
+#include "base/task_progress.h"
+#include "base/xcaf.h"
 #include "gui/gui_application.h"
 #include "qtcommon/filepath_conv.h"
 #include "qtcommon/qstring_conv.h"
@@ -162,6 +169,92 @@ QString strFilepathQuoted(const QString &filepath)
     return filepath;
 }
 
+// Whether some sub-face of 'shape' has a triangulation whose deferred data isn't loaded yet
+bool hasDeferredTriangulation(const TopoDS_Shape &shape)
+{
+    bool hasDeferred = false;
+    BRepUtils::forEachSubFace(shape,
+                              [&](const TopoDS_Face &face)
+                              {
+                                  TopLoc_Location loc;
+                                  const auto &mesh = BRep_Tool::Triangulation(face, loc);
+                                  hasDeferred |= mesh && mesh->HasDeferredData() &&
+                                                 mesh->NbNodes() == 0;
+                              });
+    return hasDeferred;
+}
+
+// Loads in a background task the meshes of entities 'vecEntityId' read with deferred loading
+// (eg glTF "lateDataLoading"). Entities are already in the model tree and displayed without
+// meshes: loaded meshes are assigned from the GUI thread, then graphics are updated
+// Must be called from the GUI thread
+void runLoadDeferredMeshesTask(IAppContext *context, Document::Identifier docId,
+                               const std::vector<TreeNodeId> &vecEntityId)
+{
+    auto app = context->guiApp()->application();
+    const TaskId taskId = context->taskMgr()->newTask(
+        [=](TaskProgress *progress)
+        {
+            progress->setStep(Command::textIdTr("Load meshes"));
+            DocumentPtr doc = app->findDocumentByIdentifier(docId);
+            if (!doc)
+                return;
+
+            for (TreeNodeId entityId : vecEntityId)
+            {
+                const TDF_Label entityLabel = doc->modelTree().nodeData(entityId);
+                TaskProgress subProgress(progress, 100. / vecEntityId.size());
+                const auto vecMesh = BRepUtils::loadDetachedDeferredTriangulations(
+                    XCaf::shape(entityLabel), &subProgress);
+                if (TaskProgress::isAbortRequested(progress))
+                    return;
+
+                if (vecMesh.empty())
+                    continue;
+
+                QMetaObject::invokeMethod(
+                    qApp,
+                    [=]
+                    {
+                        DocumentPtr docTarget = app->findDocumentByIdentifier(docId);
+                        if (!docTarget)
+                            return;
+
+                        BRep_Builder builder;
+                        for (const BRepUtils::DetachedTriangulation &item : vecMesh)
+                            builder.UpdateFace(item.face, item.mesh);
+
+                        docTarget->signalEntityGeometryChanged.send(entityId);
+                    },
+                    Qt::QueuedConnection);
+            }
+        });
+    context->taskMgr()->setTitle(taskId, Command::textIdTr("Load meshes"));
+    context->taskMgr()->run(taskId);
+}
+
+// To be called by import tasks once entities of 'doc' from index 'firstEntityIndex' are in the
+// model tree. Their deferred meshes are then loaded by a separate task
+void scheduleLoadDeferredMeshes(IAppContext *context, const DocumentPtr &doc,
+                                int firstEntityIndex)
+{
+    std::vector<TreeNodeId> vecEntityId;
+    for (int i = firstEntityIndex; i < doc->entityCount(); ++i)
+    {
+        const TDF_Label entityLabel = doc->entityLabel(i);
+        if (XCaf::isShape(entityLabel) && hasDeferredTriangulation(XCaf::shape(entityLabel)))
+            vecEntityId.push_back(doc->entityTreeNodeId(i));
+    }
+
+    if (vecEntityId.empty())
+        return;
+
+    const Document::Identifier docId = doc->identifier();
+    QMetaObject::invokeMethod(
+        qApp, [=] { runLoadDeferredMeshesTask(context, docId, vecEntityId); },
+        Qt::QueuedConnection);
+}
+
 } // namespace
 
 void FileCommandTools::closeDocument(IAppContext *context, Document::Identifier docId)
@@ -195,16 +288,18 @@ void FileCommandTools::openDocumentsFromList(IAppContext *context,
                 {
                     QElapsedTimer chrono;
                     chrono.start();
+                    DocumentPtr doc = app->findDocumentByIdentifier(newDocId);
                     const bool okImport =
                         appModule->ioSystem()
                             ->importInDocument()
-                            .targetDocument(app->findDocumentByIdentifier(newDocId))
+                            .targetDocument(doc)
                             .withFilepath(fp)
                             .withParametersProvider(appModule)
                             .withEntityPostProcess(
                                 [=](TDF_Label labelEntity, TaskProgress *progress)
-                                { appModule->computeBRepMesh(labelEntity, progress); })
-                            .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
+                                { appModule->postProcessImportedEntity(labelEntity, progress); })
+                            .withEntityPostProcessRequiredIf(
+                                &AppModule::isImportPostProcessRequired)
                             .withEntityPostProcessInfoProgress(
                                 20, Command::textIdTr("Mesh BRep shapes"))
                             .withMessenger(appModule)
@@ -213,6 +308,8 @@ void FileCommandTools::openDocumentsFromList(IAppContext *context,
                     if (okImport)
                         appModule->emitInfo(
                             fmt::format(Command::textIdTr("Import time: {}ms"), chrono.elapsed()));
+
+                    scheduleLoadDeferredMeshes(context, doc, 0);
                 });
             context->taskMgr()->setTitle(taskId, fp.stem().string());
             context->taskMgr()->run(taskId);
@@ -243,22 +340,28 @@ void FileCommandTools::importInDocument(IAppContext *context, const DocumentPtr
             chrono.start();
 
             auto doc = appModule->application()->findDocumentByIdentifier(targetDocId);
+            const int firstEntityIndex = doc->entityCount();
             const bool okImport =
                 appModule->ioSystem()
                     ->importInDocument()
                     .targetDocument(doc)
                     .withFilepaths(listFilePaths)
                     .withParametersProvider(appModule)
-                    .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress *progress)
-                                           { appModule->computeBRepMesh(labelEntity, progress); })
-                    .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
+                    .withEntityPostProcess(
+                        [=](TDF_Label labelEntity, TaskProgress *progress)
+                        { appModule->postProcessImportedEntity(labelEntity, progress); })
+                    .withEntityPostProcessRequiredIf(&AppModule::isImportPostProcessRequired)
                     .withEntityPostProcessInfoProgress(20, Command::textIdTr("Mesh BRep shapes"))
+                    .withParallelTransfer(true)
+                    .withMemoryBudget(appModule->importMemoryBudget())
                     .withMessenger(appModule)
                     .withTaskProgress(progress)
                     .execute();
             if (okImport)
                 appModule->emitInfo(
                     fmt::format(Command::textIdTr("Import time: {}ms"), chrono.elapsed()));
+
+            scheduleLoadDeferredMeshes(context, doc, firstEntityIndex);
         });
     const QString taskTitle = listFilePaths.size() > 1 ?
                                   Command::tr("Import") :
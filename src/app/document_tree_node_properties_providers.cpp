@@ -12,6 +12,7 @@
 #include <TDataStd_Name.hxx>
 
 #include "base/caf_utils.h"
+#include "base/cpp_utils.h"
 #include "base/document.h"
 #include "base/document_tree_node.h"
 #include "base/label_data.h"
@@ -277,18 +278,23 @@ public:
     {
         auto attrPointCloudData = CafUtils::findAttribute<PointCloudData>(treeNode.label());
 
-        const bool hasAttrData =
-            !attrPointCloudData.IsNull() && !attrPointCloudData->points().IsNull();
-        m_propertyPointCount.setValue(hasAttrData ? attrPointCloudData->points()->VertexNumber() :
-                                                    0);
-        m_propertyHasColors.setValue(hasAttrData ? attrPointCloudData->points()->HasVertexColors() :
-                                                   false);
+        const bool hasAttrData = !attrPointCloudData.IsNull() && !attrPointCloudData->isNull();
+        m_propertyPointCount.setValue(
+            hasAttrData ? CppUtils::safeStaticCast<int>(attrPointCloudData->pointCount()) : 0);
+        m_propertyHasColors.setValue(hasAttrData ? attrPointCloudData->hasColors() : false);
         if (hasAttrData)
         {
             Bnd_Box bndBox;
-            const int pntCount = attrPointCloudData->points()->VertexNumber();
-            for (int i = 1; i <= pntCount; ++i)
-                bndBox.Add(attrPointCloudData->points()->Vertice(i));
+            const OccHandle<Graphic3d_ArrayOfPoints> &points = attrPointCloudData->points();
+            if (attrPointCloudData->octree())
+            {
+                bndBox = attrPointCloudData->octree()->box();
+            }
+            else
+            {
+                for (int i = 1; i <= points->VertexNumber(); ++i)
+                    bndBox.Add(points->Vertice(i));
+            }
 
             m_propertyCornerMin.setValue(bndBox.CornerMin());
             m_propertyCornerMax.setValue(bndBox.CornerMax());
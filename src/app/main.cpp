@@ -34,11 +34,14 @@
 #include "gui/gui_application.h"
 #include "io_assimp/io_assimp.h"
 #include "io_dxf/io_dxf.h"
+#include "io_obj/io_obj_reader.h"
 #include "io_occ/io_occ.h"
 #include "io_off/io_off_reader.h"
 #include "io_off/io_off_writer.h"
 #include "io_ply/io_ply_reader.h"
 #include "io_ply/io_ply_writer.h"
+#include "io_stl/io_stl_reader.h"
+#include "io_stl/io_stl_writer.h"
 #include "qtbackend/qsettings_storage.h"
 #include "qtbackend/qt_app_translator.h"
 #include "qtbackend/qt_signal_thread_helper.h"
@@ -301,10 +304,15 @@ static int runApp(QCoreApplication *qtApp)
     // Register I/O objects
     IO::System *ioSystem = appModule->ioSystem();
     ioSystem->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
+    // Native OBJ and STL readers take precedence over the OpenCascade ones
+    ioSystem->addFactoryReader(std::make_unique<IO::ObjFactoryReader>());
+    ioSystem->addFactoryReader(std::make_unique<IO::StlFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::OffFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::PlyFactoryReader>());
     ioSystem->addFactoryReader(IO::AssimpFactoryReader::create());
+    // Native STL writer takes precedence over the OpenCascade one
+    ioSystem->addFactoryWriter(std::make_unique<IO::StlFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::OffFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::PlyFactoryWriter>());
@@ -349,8 +357,10 @@ static int runApp(QCoreApplication *qtApp)
 
     appModule->settings()->resetAll();
     fnLoadAppSettings(appModule->settings());
+    appModule->restoreMemoryExpansionFactors();
     const int code = qtApp->exec();
     appModule->recordRecentFiles(guiApp);
+    appModule->recordMemoryExpansionFactors();
     appModule->settings()->save();
     return code;
 }
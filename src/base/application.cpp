@@ -147,6 +147,14 @@ void Application::closeDocument(const DocumentPtr &doc)
     // doc->Main().ForgetAllAttributes(true/*clearChildren*/);
 }
 
+DocumentPtr Application::newScratchDocument()
+{
+    DocumentPtr doc = new Document(this);
+    this->InitDocument(doc);
+    doc->initXCaf();
+    return doc;
+}
+
 void Application::defineMayoFormat(const ApplicationPtr &app)
 {
     const char strFougueCopyright[] = "Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>";
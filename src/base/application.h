@@ -53,6 +53,11 @@ public:
 
     void closeDocument(const DocumentPtr &doc);
 
+    // Creates a document which is not added to the session of the application
+    // Such "scratch" document isn't reported by signals nor found by findDocumentXxx()
+    // functions, it's meant to be temporary storage(eg for background import operations)
+    DocumentPtr newScratchDocument();
+
     static void defineMayoFormat(const ApplicationPtr &app);
 
     static Span<const char *> envOpenCascadeOptions();
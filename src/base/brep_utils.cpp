@@ -7,23 +7,50 @@
 #include "brep_utils.h"
 
 #include "global.h"
+#include "task_manager.h"
+#include "task_parallel.h"
 #include "tkernel_utils.h"
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
 #include "occ_progress_indicator.h"
 #endif
 
+#include <algorithm>
 #include <climits>
+#include <cstdint>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
+#include <vector>
 
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepTools.hxx>
 #include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <TopoDS_Compound.hxx>
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+#include <OSD_CachedFileSystem.hxx>
+#endif
 
 namespace Mayo
 {
 
+namespace
+{
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+// Returns the mutex guarding loading of the deferred data of 'mesh'
+// Concurrent callers(eg export tasks) could otherwise load the same triangulation
+std::mutex &deferredTriangulationMutex(const Poly_Triangulation *mesh)
+{
+    constexpr size_t MutexCount = 64;
+    static std::mutex arrayMutex[MutexCount];
+    const auto address = reinterpret_cast<std::uintptr_t>(mesh);
+    return arrayMutex[(address / sizeof(Poly_Triangulation)) % MutexCount];
+}
+#endif
+
+} // namespace
+
 TopoDS_Compound BRepUtils::makeEmptyCompound()
 {
     TopoDS_Builder builder;
@@ -114,4 +141,99 @@ void BRepUtils::computeMesh(const TopoDS_Shape &shape, const OccBRepMeshParamete
     MAYO_UNUSED(mesher);
 }
 
+void BRepUtils::loadDeferredTriangulations(const TopoDS_Shape &shape)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    std::vector<OccHandle<Poly_Triangulation>> vecTriangulation;
+    std::unordered_set<const Poly_Triangulation *> setTriangulation;
+    BRepUtils::forEachSubFace(
+        shape,
+        [&](const TopoDS_Face &face)
+        {
+            TopLoc_Location loc;
+            const OccHandle<Poly_Triangulation> &mesh = BRep_Tool::Triangulation(face, loc);
+            // Note: whether deferred data is already loaded is checked under lock when loading
+            if (mesh.IsNull() || !mesh->HasDeferredData())
+                return;
+
+            if (setTriangulation.insert(mesh.get()).second)
+                vecTriangulation.push_back(mesh);
+        });
+
+    if (vecTriangulation.empty())
+        return;
+
+    TaskManager taskMgr;
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, vecTriangulation.size(), 1);
+    parallelForChunks(
+        taskMgr, range,
+        [&](size_t, size_t begin, size_t end)
+        {
+            // Keeps file streams open between consecutive loadings
+            auto fileSystem = makeOccHandle<OSD_CachedFileSystem>();
+            for (size_t i = begin; i < end; ++i)
+            {
+                const OccHandle<Poly_Triangulation> &mesh = vecTriangulation.at(i);
+                std::lock_guard<std::mutex> lock(deferredTriangulationMutex(mesh.get()));
+                if (mesh->NbNodes() == 0)
+                    mesh->LoadDeferredData(fileSystem);
+            }
+        },
+        &TaskProgress::null(), 0, 100);
+#else
+    MAYO_UNUSED(shape);
+#endif
+}
+
+std::vector<BRepUtils::DetachedTriangulation>
+BRepUtils::loadDetachedDeferredTriangulations(const TopoDS_Shape &shape, TaskProgress *progress)
+{
+    std::vector<DetachedTriangulation> vecDetached;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    std::unordered_set<const TopoDS_TShape *> setFace;
+    BRepUtils::forEachSubFace(
+        shape,
+        [&](const TopoDS_Face &face)
+        {
+            TopLoc_Location loc;
+            const OccHandle<Poly_Triangulation> &mesh = BRep_Tool::Triangulation(face, loc);
+            if (mesh.IsNull() || !mesh->HasDeferredData() || mesh->NbNodes() > 0)
+                return;
+
+            if (setFace.insert(face.TShape().get()).second)
+                vecDetached.push_back({face, mesh});
+        });
+
+    if (vecDetached.empty())
+        return vecDetached;
+
+    TaskManager taskMgr;
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, vecDetached.size(), 1);
+    const bool okLoad = parallelForChunks(
+        taskMgr, range,
+        [&](size_t, size_t begin, size_t end)
+        {
+            // Keeps file streams open between consecutive loadings
+            auto fileSystem = makeOccHandle<OSD_CachedFileSystem>();
+            for (size_t i = begin; i < end; ++i)
+            {
+                OccHandle<Poly_Triangulation> &mesh = vecDetached.at(i).mesh;
+                mesh = mesh->DetachedLoadDeferredData(fileSystem);
+            }
+        },
+        progress, 0, 100);
+    if (!okLoad)
+        return {};
+
+    // Meshes failing to load are left as they are
+    auto itEnd = std::remove_if(vecDetached.begin(), vecDetached.end(),
+                                [](const DetachedTriangulation &item) { return !item.mesh; });
+    vecDetached.erase(itEnd, vecDetached.end());
+#else
+    MAYO_UNUSED(shape);
+    MAYO_UNUSED(progress);
+#endif
+    return vecDetached;
+}
+
 } // namespace Mayo
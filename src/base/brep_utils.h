@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <Poly_Polygon3D.hxx>
 #include <Poly_Triangulation.hxx>
@@ -77,6 +78,27 @@ struct BRepUtils
     // algorithm
     static void computeMesh(const TopoDS_Shape &shape, const OccBRepMeshParameters &params,
                             TaskProgress *progress = nullptr);
+
+    // Loads in parallel the triangulation data of the sub-faces of 'shape' still pending in some
+    // deferred storage(eg glTF file read with late data loading)
+    // Each triangulation is loaded once, even if this function is called concurrently
+    // Requires OpenCascade >= v7.6.0, does nothing otherwise
+    static void loadDeferredTriangulations(const TopoDS_Shape &shape);
+
+    // Triangulation of 'face' loaded from some deferred storage
+    struct DetachedTriangulation
+    {
+        TopoDS_Face face;
+        OccHandle<Poly_Triangulation> mesh;
+    };
+
+    // Same as loadDeferredTriangulations() but data is loaded into new triangulation objects, one
+    // per face(TShape) whose deferred data isn't loaded yet. 'shape' is left unchanged so it can
+    // be read concurrently(eg displayed), loaded meshes are assigned later with
+    // BRep_Builder::UpdateFace()
+    // Requires OpenCascade >= v7.6.0, returns an empty array otherwise
+    static std::vector<DetachedTriangulation>
+    loadDetachedDeferredTriangulations(const TopoDS_Shape &shape, TaskProgress *progress = nullptr);
 };
 
 // --
@@ -9,6 +9,10 @@
 #include <unordered_set>
 
 #include <TDF_ChildIterator.hxx>
+#include <TDF_ClosureTool.hxx>
+#include <TDF_CopyTool.hxx>
+#include <TDF_DataSet.hxx>
+#include <TDF_RelocationTable.hxx>
 #include <TDF_TagSource.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
 
@@ -230,6 +234,57 @@ void Document::destroyEntity(TreeNodeId entityTreeNodeId)
     m_modelTree.removeRoot(entityTreeNodeId);
 }
 
+TDF_LabelSequence Document::relocateEntities(const OccHandle<TDocStd_Document> &other,
+                                             const TDF_LabelSequence &seqOtherEntity)
+{
+    TDF_LabelSequence seqEntity;
+    if (!other || other.get() == this || seqOtherEntity.IsEmpty())
+        return seqEntity;
+
+    auto dataSet = makeOccHandle<TDF_DataSet>();
+    auto relocTable = makeOccHandle<TDF_RelocationTable>();
+    auto fnAddRelocation = [&](const TDF_Label &srcLabel, const TDF_Label &dstLabel)
+    {
+        dataSet->AddLabel(srcLabel);
+        relocTable->SetRelocation(srcLabel, dstLabel);
+    };
+
+    // XCAF data is split into sections below Main()(shapes, colors, layers, ...)
+    // Sections hold the XCAF tool attributes which already exist in this document, so only
+    // their children are copied. Main() and sections are mapped anyway so references to
+    // them are resolved
+    const TDF_Label otherMain = other->Main();
+    const TDF_Label thisMain = this->Main();
+    relocTable->SetRelocation(otherMain, thisMain);
+    for (TDF_ChildIterator itSection(otherMain); itSection.More(); itSection.Next())
+    {
+        const TDF_Label otherSection = itSection.Value();
+        const TDF_Label thisSection = thisMain.FindChild(otherSection.Tag(), true);
+        relocTable->SetRelocation(otherSection, thisSection);
+        for (TDF_ChildIterator itChild(otherSection); itChild.More(); itChild.Next())
+            fnAddRelocation(itChild.Value(), TDF_TagSource::NewChild(thisSection));
+    }
+
+    // Entities not bound to XCAF(eg point clouds) are direct children of the root label
+    for (const TDF_Label &otherEntity : seqOtherEntity)
+    {
+        if (!otherEntity.IsDescendant(otherMain))
+            fnAddRelocation(otherEntity, this->newEntityLabel());
+    }
+
+    TDF_ClosureTool::Closure(dataSet);
+    TDF_CopyTool::Copy(dataSet, relocTable);
+
+    for (const TDF_Label &otherEntity : seqOtherEntity)
+    {
+        TDF_Label entity;
+        if (relocTable->HasRelocation(otherEntity, entity))
+            seqEntity.Append(entity);
+    }
+
+    return seqEntity;
+}
+
 void Document::BeforeClose()
 {
     TDocStd_Document::BeforeClose();
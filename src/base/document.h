@@ -44,6 +44,11 @@ public:
     const FilePath &filePath() const;
     void setFilePath(const FilePath &fp);
 
+    const ApplicationPtr &application() const
+    {
+        return m_app;
+    }
+
     static const char NameFormatBinary[];
     static const char NameFormatXml[];
     static const char *toNameFormat(Format format);
@@ -90,11 +95,21 @@ public:
     void addEntityTreeNodeSequence(const TDF_LabelSequence &seqLabel);
     void destroyEntity(TreeNodeId entityTreeNodeId);
 
+    // Copies entities 'seqOtherEntity' owned by document 'other' into this document
+    // Labels are relocated in a single step along with their attributes and cross
+    // references(eg XCAF colors, layers), 'other' is typically a scratch document filled on
+    // some worker thread. Model tree is not updated, see addEntityTreeNodeSequence()
+    // Returns the labels of the new entities, in the order of 'seqOtherEntity'
+    TDF_LabelSequence relocateEntities(const OccHandle<TDocStd_Document> &other,
+                                       const TDF_LabelSequence &seqOtherEntity);
+
     // Signals
     Signal<const std::string &> signalNameChanged;
     Signal<const FilePath &> signalFilePathChanged;
     Signal<TreeNodeId> signalEntityAdded;
     Signal<TreeNodeId> signalEntityAboutToBeDestroyed;
+    // Sent when the shapes of some entity are modified in place, eg meshes loaded afterwards
+    Signal<TreeNodeId> signalEntityGeometryChanged;
 
 public: // -- from TDocStd_Document
     void BeforeClose() override;
@@ -0,0 +1,173 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_file_view.h"
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+#include "global.h"
+
+#if defined(MAYO_OS_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define MAYO_FILE_VIEW_HAS_MAPPING
+#elif defined(MAYO_OS_UNIX) && !defined(MAYO_OS_WASM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAYO_FILE_VIEW_HAS_MAPPING
+#endif
+
+namespace Mayo::IO
+{
+
+FileView::FileView(const FilePath &filepath)
+{
+    this->open(filepath);
+}
+
+FileView::~FileView()
+{
+    this->close();
+}
+
+FileView::FileView(FileView &&other) noexcept
+{
+    this->swap(other);
+}
+
+FileView &FileView::operator=(FileView &&other) noexcept
+{
+    if (this != &other)
+    {
+        this->close();
+        this->swap(other);
+    }
+
+    return *this;
+}
+
+bool FileView::open(const FilePath &filepath)
+{
+    this->close();
+    m_filepath = filepath;
+    m_isOpen = this->mapFile() || this->readFileInBuffer();
+    return m_isOpen;
+}
+
+void FileView::close()
+{
+#if defined(MAYO_OS_WINDOWS)
+    if (m_mapData)
+        UnmapViewOfFile(m_mapData);
+#elif defined(MAYO_FILE_VIEW_HAS_MAPPING)
+    if (m_mapData)
+        munmap(m_mapData, m_size);
+#endif
+
+    m_filepath.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapData = nullptr;
+    m_buffer = {};
+    m_isOpen = false;
+}
+
+bool FileView::mapFile()
+{
+#if defined(MAYO_OS_WINDOWS)
+    HANDLE hFile = CreateFileW(m_filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    void *mapData = nullptr;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0 &&
+        uint64_t(fileSize.QuadPart) <= std::numeric_limits<size_t>::max())
+    {
+        HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (hMapping)
+        {
+            mapData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(hMapping); // The view keeps the mapping alive
+        }
+    }
+
+    CloseHandle(hFile);
+    if (!mapData)
+        return false;
+
+    m_mapData = mapData;
+    m_size = size_t(fileSize.QuadPart);
+#elif defined(MAYO_FILE_VIEW_HAS_MAPPING)
+    const int fd = ::open(m_filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat = {};
+    void *mapData = MAP_FAILED;
+    // Empty files can't be mapped, they are handled by the buffered fallback
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0 &&
+        uint64_t(fileStat.st_size) <= std::numeric_limits<size_t>::max())
+    {
+        mapData = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    ::close(fd); // The mapping keeps a reference to the file
+    if (mapData == MAP_FAILED)
+        return false;
+
+    m_mapData = mapData;
+    m_size = size_t(fileStat.st_size);
+    madvise(m_mapData, m_size, MADV_SEQUENTIAL);
+#endif
+
+    m_data = static_cast<const char *>(m_mapData);
+    return m_mapData != nullptr;
+}
+
+bool FileView::readFileInBuffer()
+{
+    std::ifstream ifs(m_filepath, std::ios::in | std::ios::binary);
+    if (!ifs.is_open())
+        return false;
+
+    const uintmax_t fileSize = filepathFileSize(m_filepath);
+    if (fileSize > std::numeric_limits<size_t>::max())
+        return false;
+
+    m_buffer.resize(size_t(fileSize));
+    ifs.read(m_buffer.data(), m_buffer.size());
+    if (ifs.bad())
+    {
+        m_buffer = {};
+        return false;
+    }
+
+    m_buffer.resize(size_t(ifs.gcount()));
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+}
+
+void FileView::swap(FileView &other) noexcept
+{
+    std::swap(m_filepath, other.m_filepath);
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_mapData, other.m_mapData);
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_isOpen, other.m_isOpen);
+}
+
+} // namespace Mayo::IO
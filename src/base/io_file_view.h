@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "filepath.h"
+
+namespace Mayo::IO
+{
+
+// Read-only view over the whole contents of a file
+// The file is memory-mapped when possible(with a sequential access hint), otherwise its contents
+// are read into an internal buffer
+// Meant to be shared by format probing and readers, so a file is opened and read only once
+class FileView
+{
+public:
+    FileView() = default;
+    explicit FileView(const FilePath &filepath);
+    ~FileView();
+
+    // Movable, not copyable
+    FileView(FileView &&other) noexcept;
+    FileView &operator=(FileView &&other) noexcept;
+    FileView(const FileView &) = delete;
+    FileView &operator=(const FileView &) = delete;
+
+    // Opens file at 'filepath', closing any previous file
+    // Returns 'false' if the file can't be read, filepath() is set anyway
+    bool open(const FilePath &filepath);
+    void close();
+
+    bool isOpen() const
+    {
+        return m_isOpen;
+    }
+
+    // Whether contents are memory-mapped(ie not copied in some buffer)
+    bool isMapped() const
+    {
+        return m_mapData != nullptr;
+    }
+
+    const FilePath &filepath() const
+    {
+        return m_filepath;
+    }
+
+    const char *data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    std::string_view contents() const
+    {
+        return {m_data, m_size};
+    }
+
+private:
+    bool mapFile();
+    bool readFileInBuffer();
+    void swap(FileView &other) noexcept;
+
+    FilePath m_filepath;
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+    void *m_mapData = nullptr;  // Null if the file isn't memory-mapped
+    std::vector<char> m_buffer; // Contents when the file isn't memory-mapped
+    bool m_isOpen = false;
+};
+
+} // namespace Mayo::IO
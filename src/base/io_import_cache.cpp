@@ -0,0 +1,350 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_import_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <Standard_Failure.hxx>
+#include <TDF_Tool.hxx>
+#include <fmt/format.h>
+
+#include "application.h"
+#include "document.h"
+#include "property.h"
+#include "property_value_conversion.h"
+#include "tkernel_utils.h"
+
+namespace Mayo::IO
+{
+
+namespace
+{
+
+// 64-bit FNV-1a constants
+constexpr uint64_t HashOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t HashPrime = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, std::string_view bytes)
+{
+    for (char c : bytes)
+        hash = (hash ^ uint8_t(c)) * HashPrime;
+
+    return hash;
+}
+
+// Hashes contents by 64-bit words, which is much faster than byte-wise FNV-1a on big files
+uint64_t hashContents(std::string_view contents)
+{
+    uint64_t hash = HashOffsetBasis;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= contents.size(); i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, contents.data() + i, sizeof(uint64_t));
+        hash = (hash ^ word) * HashPrime;
+        hash ^= hash >> 29;
+    }
+
+    return hashBytes(hash, contents.substr(i));
+}
+
+} // namespace
+
+ImportCache::ImportCache(const FilePath &directory, uint64_t maxSize)
+    : m_directory(directory)
+    , m_maxSize(maxSize)
+{
+}
+
+uint64_t ImportCache::maxSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxSize;
+}
+
+void ImportCache::setMaxSize(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxSize = size;
+    this->evictEntries();
+}
+
+uint64_t ImportCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::error_code ec;
+    uint64_t size = 0;
+    for (const auto &dirEntry : std_filesystem::directory_iterator(m_directory, ec))
+    {
+        if (std_filesystem::is_regular_file(dirEntry.path(), ec))
+            size += filepathFileSize(dirEntry.path());
+    }
+
+    return size;
+}
+
+bool ImportCache::isCacheable(Format format)
+{
+    return formatProvidesBRep(format);
+}
+
+std::string ImportCache::computeKey(const FilePath &filepath, Format format,
+                                    const PropertyGroup *parameters)
+{
+    return computeKey(FileView(filepath), format, parameters);
+}
+
+std::string ImportCache::computeKey(const FileView &fileView, Format format,
+                                    const PropertyGroup *parameters)
+{
+    if (!fileView.isOpen())
+        return {};
+
+    const uint64_t contentsHash = hashContents(fileView.contents());
+    std::string strContext = fmt::format("{}|{}|", formatIdentifier(format), fileView.size());
+    if (parameters)
+    {
+        const PropertyValueConversion conv;
+        for (const Property *prop : parameters->properties())
+            strContext += fmt::format("{}={};", prop->name().key, conv.toVariant(*prop).toString());
+    }
+
+    const uint64_t contextHash = hashBytes(HashOffsetBasis, strContext);
+    return fmt::format("{:016x}{:016x}", contentsHash, contextHash);
+}
+
+bool ImportCache::contains(const std::string &key) const
+{
+    return !key.empty() && filepathExists(this->documentFilePath(key));
+}
+
+bool ImportCache::lookup(const std::string &key)
+{
+    if (this->contains(key))
+        return true;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.missCount;
+    return false;
+}
+
+ImportCache::Entry ImportCache::load(const std::string &key, const ApplicationPtr &app)
+{
+    Entry entry;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    // Note: 'm_mutex' only guards statistics and the cache directory, it isn't locked during
+    //       document retrieval
+    const FilePath docFilepath = this->documentFilePath(key);
+    if (key.empty() || !app || !filepathExists(docFilepath))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.missCount;
+        return entry;
+    }
+
+    try
+    {
+        std::ifstream docStream(docFilepath, std::ios::in | std::ios::binary);
+        OccHandle<TDocStd_Document> doc;
+        app->Open(docStream, doc);
+        // Document is added to application session by Open(), only its data is needed
+        if (doc && doc->IsOpened())
+            app->Close(doc);
+
+        std::ifstream entitiesStream(this->entitiesFilePath(key));
+        std::string strEntry;
+        while (doc && std::getline(entitiesStream, strEntry))
+        {
+            TDF_Label label;
+            TDF_Tool::Label(doc->GetData(), strEntry.c_str(), label, false /*create*/);
+            if (!label.IsNull())
+                entry.seqEntity.Append(label);
+        }
+
+        entry.document = doc;
+    }
+    catch (const Standard_Failure &)
+    {
+        entry = {};
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (entry.isNull())
+    {
+        ++m_stats.missCount;
+        return {};
+    }
+
+    // Last write time of document file is the "last access" time used for LRU eviction
+    std::error_code ec;
+    std_filesystem::last_write_time(docFilepath, std_filesystem::file_time_type::clock::now(), ec);
+    ++m_stats.hitCount;
+#else
+    (void)key;
+    (void)app;
+#endif
+    return entry;
+}
+
+bool ImportCache::store(const std::string &key, const DocumentPtr &doc,
+                        const TDF_LabelSequence &seqEntity)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    if (key.empty() || !doc || !doc->application() || seqEntity.IsEmpty())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::error_code ec;
+    std_filesystem::create_directories(m_directory, ec);
+
+    // Document file is written last and renamed once complete, so a concurrent load() never
+    // finds a partial entry
+    const FilePath docFilepath = this->documentFilePath(key);
+    FilePath docTempFilepath = docFilepath;
+    docTempFilepath += ".tmp";
+    {
+        std::ofstream entitiesStream(this->entitiesFilePath(key));
+        for (const TDF_Label &label : seqEntity)
+        {
+            TCollection_AsciiString strEntry;
+            TDF_Tool::Entry(label, strEntry);
+            entitiesStream << strEntry.ToCString() << '\n';
+        }
+
+        if (!entitiesStream)
+            return false;
+    }
+
+    const ApplicationPtr &app = doc->application();
+    PCDM_StoreStatus storeStatus = PCDM_SS_Failure;
+    try
+    {
+        // Storage drivers require the document to be part of the application session
+        const bool wasOpened = doc->IsOpened();
+        if (!wasOpened)
+            app->CDF_Application::Open(doc);
+
+        {
+            std::ofstream docStream(docTempFilepath, std::ios::out | std::ios::binary);
+            storeStatus = app->SaveAs(doc, docStream);
+        }
+
+        if (!wasOpened)
+            app->Close(doc);
+    }
+    catch (const Standard_Failure &)
+    {
+        storeStatus = PCDM_SS_Failure;
+    }
+
+    if (storeStatus == PCDM_SS_OK)
+        std_filesystem::rename(docTempFilepath, docFilepath, ec);
+
+    if (storeStatus != PCDM_SS_OK || ec)
+    {
+        std_filesystem::remove(docTempFilepath, ec);
+        std_filesystem::remove(this->entitiesFilePath(key), ec);
+        return false;
+    }
+
+    ++m_stats.storeCount;
+    this->evictEntries();
+    return true;
+#else
+    (void)key;
+    (void)doc;
+    (void)seqEntity;
+    return false;
+#endif
+}
+
+void ImportCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::error_code ec;
+    std::vector<FilePath> vecFilepath;
+    for (const auto &dirEntry : std_filesystem::directory_iterator(m_directory, ec))
+    {
+        const FilePath ext = dirEntry.path().extension();
+        if (ext == ".myb" || ext == ".entities")
+            vecFilepath.push_back(dirEntry.path());
+    }
+
+    for (const FilePath &filepath : vecFilepath)
+        std_filesystem::remove(filepath, ec);
+}
+
+ImportCache::Statistics ImportCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ImportCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = {};
+}
+
+FilePath ImportCache::documentFilePath(const std::string &key) const
+{
+    return m_directory / (key + ".myb");
+}
+
+FilePath ImportCache::entitiesFilePath(const std::string &key) const
+{
+    return m_directory / (key + ".entities");
+}
+
+void ImportCache::evictEntries()
+{
+    struct CacheFile
+    {
+        std::string key;
+        std_filesystem::file_time_type lastAccessTime;
+        uint64_t size;
+    };
+
+    std::error_code ec;
+    std::vector<CacheFile> vecCacheFile;
+    uint64_t totalSize = 0;
+    for (const auto &dirEntry : std_filesystem::directory_iterator(m_directory, ec))
+    {
+        if (dirEntry.path().extension() != ".myb")
+            continue;
+
+        CacheFile file;
+        file.key = dirEntry.path().stem().string();
+        file.lastAccessTime = std_filesystem::last_write_time(dirEntry.path(), ec);
+        file.size = filepathFileSize(dirEntry.path());
+        file.size += filepathFileSize(this->entitiesFilePath(file.key));
+        totalSize += file.size;
+        vecCacheFile.push_back(std::move(file));
+    }
+
+    if (totalSize <= m_maxSize)
+        return;
+
+    std::sort(vecCacheFile.begin(), vecCacheFile.end(),
+              [](const CacheFile &lhs, const CacheFile &rhs)
+              { return lhs.lastAccessTime < rhs.lastAccessTime; });
+    for (const CacheFile &file : vecCacheFile)
+    {
+        if (totalSize <= m_maxSize)
+            break;
+
+        std_filesystem::remove(this->documentFilePath(file.key), ec);
+        std_filesystem::remove(this->entitiesFilePath(file.key), ec);
+        totalSize -= std::min(totalSize, file.size);
+        ++m_stats.evictionCount;
+    }
+}
+
+} // namespace Mayo::IO
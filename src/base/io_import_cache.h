@@ -0,0 +1,121 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <TDF_LabelSequence.hxx>
+#include <TDocStd_Document.hxx>
+
+#include "application_ptr.h"
+#include "document_ptr.h"
+#include "filepath.h"
+#include "io_file_view.h"
+#include "io_format.h"
+#include "occ_handle.h"
+
+namespace Mayo
+{
+
+class PropertyGroup;
+
+namespace IO
+{
+
+// Persistent cache of imported entities, meant to skip parsing of files already imported
+// Entries are keyed on the contents of the source file and the reader parameters, they are
+// stored in 'directory' as Mayo binary documents(ie the "BinDocMayo" format defined by
+// Application::defineMayoFormat())
+// Total size of the cache directory is bounded, least recently used entries are evicted first
+// load() and store() use the OpenCascade application(Open(), SaveAs(), Close()) which isn't
+// thread-safe, so they must not be called concurrently with any other use of the application
+// Other functions can be called from any thread
+class ImportCache
+{
+public:
+    ImportCache(const FilePath &directory, uint64_t maxSize = 2048 * 1024 * 1024ull);
+
+    const FilePath &directory() const
+    {
+        return m_directory;
+    }
+
+    // Maximum size in bytes of the cache directory
+    uint64_t maxSize() const;
+    void setMaxSize(uint64_t size);
+
+    // Current size in bytes of the cache directory
+    uint64_t size() const;
+
+    // Whether entities imported from files of 'format' can be put in cache
+    // Only BRep formats are supported: mesh and point cloud data are stored in attributes
+    // having no persistence drivers
+    static bool isCacheable(Format format);
+
+    // Returns the key identifying the import of file 'filepath' with reader 'parameters'
+    // The whole file is hashed, returns an empty string on error
+    static std::string computeKey(const FilePath &filepath, Format format,
+                                  const PropertyGroup *parameters);
+    static std::string computeKey(const FileView &fileView, Format format,
+                                  const PropertyGroup *parameters);
+
+    // Entities read from some cache entry
+    struct Entry
+    {
+        OccHandle<TDocStd_Document> document;
+        TDF_LabelSequence seqEntity;
+
+        bool isNull() const
+        {
+            return seqEntity.IsEmpty();
+        }
+    };
+
+    // Whether the cache directory contains the entry identified by 'key'
+    // Contents of the entry aren't checked, load() could still fail
+    bool contains(const std::string &key) const;
+
+    // Same as contains(), but a miss is counted in statistics if there is no such entry
+    // Hits are counted by load()
+    bool lookup(const std::string &key);
+
+    // Reads the entry identified by 'key', returns a null Entry if there is no such entry
+    // Entities have to be copied into some target document, see Document::relocateEntities()
+    Entry load(const std::string &key, const ApplicationPtr &app);
+
+    // Writes entities 'seqEntity' owned by 'doc' as the entry identified by 'key'
+    // 'doc' is expected to contain only the entities to be stored
+    bool store(const std::string &key, const DocumentPtr &doc, const TDF_LabelSequence &seqEntity);
+
+    // Removes all entries from cache directory
+    void clear();
+
+    struct Statistics
+    {
+        int64_t hitCount = 0;
+        int64_t missCount = 0;
+        int64_t storeCount = 0;
+        int64_t evictionCount = 0;
+    };
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    FilePath documentFilePath(const std::string &key) const;
+    FilePath entitiesFilePath(const std::string &key) const;
+    void evictEntries();
+
+    const FilePath m_directory;
+    uint64_t m_maxSize = 0;
+    Statistics m_stats;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace IO
+} // namespace Mayo
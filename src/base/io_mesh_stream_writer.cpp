@@ -0,0 +1,197 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_mesh_stream_writer.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
+
+#include "caf_utils.h"
+#include "io_system.h"
+#include "label_data.h"
+#include "math_utils.h"
+#include "mesh_access.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "task_thread_pool.h"
+
+namespace Mayo::IO
+{
+
+bool MeshStreamWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress *progress)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    m_vecTreeNode.clear();
+    System::traverseUniqueItems(appItems,
+                                [&](const DocumentTreeNode &treeNode)
+                                {
+                                    if (treeNode.isLeaf())
+                                        m_vecTreeNode.push_back(treeNode);
+                                });
+    progress->setValue(100);
+    return true;
+}
+
+void MeshStreamWriter::visitMeshes(
+    const std::function<void(const IMeshAccess &)> &fnCallback) const
+{
+    for (const DocumentTreeNode &treeNode : m_vecTreeNode)
+        IMeshAccess_visitMeshes(treeNode, fnCallback);
+}
+
+void MeshStreamWriter::visitPointClouds(
+    const std::function<void(const PointCloudDataPtr &)> &fnCallback) const
+{
+    for (const DocumentTreeNode &treeNode : m_vecTreeNode)
+    {
+        if (findLabelDataFlags(treeNode.label()) & LabelData_HasPointCloudData)
+        {
+            auto pntCloud = CafUtils::findAttribute<PointCloudData>(treeNode.label());
+            if (pntCloud && !pntCloud->isNull())
+                fnCallback(pntCloud);
+        }
+    }
+}
+
+MeshStreamWriter::Counts MeshStreamWriter::counts() const
+{
+    Counts counts;
+    this->visitMeshes(
+        [&](const IMeshAccess &mesh)
+        {
+            ++counts.meshCount;
+            counts.meshNodeCount += mesh.triangulation()->NbNodes();
+            counts.meshTriangleCount += mesh.triangulation()->NbTriangles();
+        });
+    this->visitPointClouds(
+        [&](const PointCloudDataPtr &pntCloud)
+        {
+            ++counts.pointCloudCount;
+            counts.pointCount += pntCloud->pointCount();
+        });
+    return counts;
+}
+
+std::vector<MeshStreamWriter::MeshItem> MeshStreamWriter::meshItems() const
+{
+    std::vector<MeshItem> vecMeshItem;
+    int64_t nodeCount = 0;
+    int64_t triangleCount = 0;
+    this->visitMeshes(
+        [&](const IMeshAccess &mesh)
+        {
+            MeshItem item;
+            item.triangulation = mesh.triangulation();
+            item.trsf = mesh.location().Transformation();
+            item.firstNodeIndex = nodeCount;
+            item.firstTriangleIndex = triangleCount;
+            const int meshNodeCount = item.triangulation->NbNodes();
+            item.spanNodeColor = mesh.nodeColors();
+            if (item.spanNodeColor.empty() && meshNodeCount > 0)
+                item.color = mesh.nodeColor(0);
+
+            nodeCount += meshNodeCount;
+            triangleCount += item.triangulation->NbTriangles();
+            vecMeshItem.push_back(std::move(item));
+        });
+    return vecMeshItem;
+}
+
+const MeshStreamWriter::MeshItem &
+MeshStreamWriter::findMeshItemOfNode(Span<const MeshItem> spanMeshItem, int64_t i)
+{
+    auto fnLess = [](int64_t index, const MeshItem &item) { return index < item.firstNodeIndex; };
+    return *std::prev(std::upper_bound(spanMeshItem.begin(), spanMeshItem.end(), i, fnLess));
+}
+
+const MeshStreamWriter::MeshItem &
+MeshStreamWriter::findMeshItemOfTriangle(Span<const MeshItem> spanMeshItem, int64_t i)
+{
+    auto fnLess = [](int64_t index, const MeshItem &item)
+    { return index < item.firstTriangleIndex; };
+    return *std::prev(std::upper_bound(spanMeshItem.begin(), spanMeshItem.end(), i, fnLess));
+}
+
+bool MeshStreamWriter::writeChunks(OutputFileBuffer *out, int64_t elementCount,
+                                   const ChunkEncoder &fnEncode, TaskProgress *progress,
+                                   int pctStart, int pctEnd)
+{
+    std::vector<int64_t> vecChunkEnd;
+    vecChunkEnd.reserve(size_t(elementCount / ChunkElementCount + 1));
+    for (int64_t i = 0; i < elementCount; i += ChunkElementCount)
+        vecChunkEnd.push_back(std::min(i + ChunkElementCount, elementCount));
+
+    return writeChunks(out, vecChunkEnd, fnEncode, progress, pctStart, pctEnd);
+}
+
+bool MeshStreamWriter::writeChunks(OutputFileBuffer *out, Span<const int64_t> spanChunkEnd,
+                                   const ChunkEncoder &fnEncode, TaskProgress *progress,
+                                   int pctStart, int pctEnd)
+{
+    struct Chunk
+    {
+        int64_t begin = 0;
+        int64_t end = 0;
+        TaskId taskId = TaskId_null;
+        fmt::memory_buffer buffer;
+    };
+
+    std::vector<Chunk> vecChunk;
+    vecChunk.reserve(spanChunkEnd.size());
+    int64_t chunkBegin = 0;
+    for (int64_t chunkEnd : spanChunkEnd)
+    {
+        Chunk &chunk = vecChunk.emplace_back();
+        chunk.begin = chunkBegin;
+        chunk.end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    const int64_t elementCount = chunkBegin;
+
+    std::atomic<bool> isAbortRequested = false;
+    TaskManager taskMgr;
+    const size_t maxEncodingCount = size_t(2 * std::max(1, taskMgr.threadPool()->workerCount()));
+    size_t runIndex = 0;
+    for (size_t writeIndex = 0; writeIndex < vecChunk.size(); ++writeIndex)
+    {
+        for (; runIndex < vecChunk.size() && runIndex - writeIndex < maxEncodingCount; ++runIndex)
+        {
+            Chunk *chunk = &vecChunk.at(runIndex);
+            chunk->taskId = taskMgr.newTask(
+                [&, chunk](TaskProgress *)
+                {
+                    if (!isAbortRequested)
+                        fnEncode(chunk->begin, chunk->end, &chunk->buffer);
+                });
+            taskMgr.run(chunk->taskId);
+        }
+
+        Chunk &chunk = vecChunk.at(writeIndex);
+        while (!taskMgr.waitForDone(chunk.taskId, 100))
+        {
+            if (TaskProgress::isAbortRequested(progress))
+                isAbortRequested = true;
+        }
+
+        if (isAbortRequested || TaskProgress::isAbortRequested(progress))
+        {
+            isAbortRequested = true;
+            return false; // TaskManager destructor waits for the running chunks
+        }
+
+        out->write(chunk.buffer.data(), chunk.buffer.size());
+        chunk.buffer = fmt::memory_buffer(); // Release memory
+        progress->setValue(MathUtils::mappedValue(chunk.end, 0, elementCount, pctStart, pctEnd));
+    }
+
+    return true;
+}
+
+} // namespace Mayo::IO
@@ -0,0 +1,123 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <Quantity_Color.hxx>
+#include <gp_Trsf.hxx>
+
+#include "document_tree_node.h"
+#include "io_output_file_buffer.h"
+#include "io_writer.h"
+#include "occ_handle.h"
+#include "point_cloud_data.h"
+#include "span.h"
+
+class Poly_Triangulation;
+
+namespace Mayo
+{
+class IMeshAccess;
+}
+
+namespace Mayo::IO
+{
+
+// Base class for writers encoding meshes straight into the target file
+// transfer() only records the document tree nodes to be written, meshes are then pulled
+// with IMeshAccess_visitMeshes() during writeFile(). No copy of mesh data is made so peak
+// memory is independent of model size
+class MeshStreamWriter : public Writer
+{
+public:
+    bool transfer(Span<const ApplicationItem> appItems, TaskProgress *progress) override;
+
+protected:
+    // Leaf tree nodes recorded by transfer()
+    Span<const DocumentTreeNode> treeNodes() const
+    {
+        return m_vecTreeNode;
+    }
+
+    // Calls 'fnCallback' for each mesh found in treeNodes()
+    void visitMeshes(const std::function<void(const IMeshAccess &)> &fnCallback) const;
+
+    // Calls 'fnCallback' for each point cloud found in treeNodes()
+    void visitPointClouds(const std::function<void(const PointCloudDataPtr &)> &fnCallback) const;
+
+    // Counts of the mesh entities found in treeNodes()
+    struct Counts
+    {
+        int64_t meshCount = 0;
+        int64_t meshNodeCount = 0;
+        int64_t meshTriangleCount = 0;
+        int64_t pointCloudCount = 0;
+        int64_t pointCount = 0;
+    };
+    // Doesn't visit mesh data: counts are read from triangulation/point cloud headers, so
+    // header of target file can be written upfront
+    Counts counts() const;
+
+    // Size of the OutputFileBuffer to be used by derived writers
+    static constexpr size_t OutputBufferSize = 1024 * 1024;
+
+    // Count of elements encoded by a single task in writeChunks()
+    static constexpr int64_t ChunkElementCount = 32 * 1024;
+
+    // Mesh found in treeNodes(), captured so its data can be read concurrently when encoding
+    // Node colors aren't copied, they're read from the document data
+    struct MeshItem
+    {
+        OccHandle<Poly_Triangulation> triangulation;
+        gp_Trsf trsf;
+        Span<const Quantity_Color> spanNodeColor; // Empty if nodes share 'color'
+        std::optional<Quantity_Color> color;      // Color of all nodes if 'spanNodeColor' is empty
+        int64_t firstNodeIndex = 0;     // Index of first node in the nodes of all meshes
+        int64_t firstTriangleIndex = 0; // Index of first triangle in the triangles of all meshes
+
+        // Color of node 'i'(0-based index in 'triangulation')
+        std::optional<Quantity_Color> nodeColor(int i) const
+        {
+            if (!spanNodeColor.empty())
+                return spanNodeColor[i];
+            else
+                return color;
+        }
+    };
+    std::vector<MeshItem> meshItems() const;
+
+    // Returns the mesh item containing node(or triangle) of index 'i' in all meshes
+    static const MeshItem &findMeshItemOfNode(Span<const MeshItem> spanMeshItem, int64_t i);
+    static const MeshItem &findMeshItemOfTriangle(Span<const MeshItem> spanMeshItem, int64_t i);
+
+    // Encodes range [begin, end) of some element list into 'buffer'
+    using ChunkEncoder = std::function<void(int64_t begin, int64_t end, fmt::memory_buffer *)>;
+
+    // Splits range [0, elementCount) into chunks encoded concurrently with 'fnEncode', encoded
+    // chunks are written in order to 'out'. Count of chunks held in memory is bounded so memory
+    // usage is independent of 'elementCount'
+    // Progress is reported in range [pctStart, pctEnd]
+    // Returns 'false' if abort was requested
+    static bool writeChunks(OutputFileBuffer *out, int64_t elementCount,
+                            const ChunkEncoder &fnEncode, TaskProgress *progress, int pctStart,
+                            int pctEnd);
+
+    // Same as above, but chunks are explicitly given by the (ascending) ends of their range
+    // First chunk begins at index 0
+    static bool writeChunks(OutputFileBuffer *out, Span<const int64_t> spanChunkEnd,
+                            const ChunkEncoder &fnEncode, TaskProgress *progress, int pctStart,
+                            int pctEnd);
+
+private:
+    std::vector<DocumentTreeNode> m_vecTreeNode;
+};
+
+} // namespace Mayo::IO
@@ -0,0 +1,69 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_output_file_buffer.h"
+
+#include <cstring>
+
+namespace Mayo::IO
+{
+
+OutputFileBuffer::OutputFileBuffer(const FilePath &filepath, size_t bufferSize)
+    : m_fstr(filepath, std::ios_base::out | std::ios_base::binary)
+    , m_buffer(bufferSize > 0 ? bufferSize : 1)
+{
+}
+
+OutputFileBuffer::~OutputFileBuffer()
+{
+    this->flush();
+}
+
+void OutputFileBuffer::write(const void *data, size_t size)
+{
+    if (size > m_buffer.size() - m_bufferPos)
+    {
+        this->flush();
+        if (size > m_buffer.size())
+        { // Bigger than the whole buffer, bypass it
+            m_fstr.write(static_cast<const char *>(data), size);
+            return;
+        }
+    }
+
+    std::memcpy(m_buffer.data() + m_bufferPos, data, size);
+    m_bufferPos += size;
+}
+
+void OutputFileBuffer::vprint(fmt::string_view fmtStr, fmt::format_args args)
+{
+    size_t freeSize = m_buffer.size() - m_bufferPos;
+    auto result = fmt::vformat_to_n(m_buffer.data() + m_bufferPos, freeSize, fmtStr, args);
+    if (result.size > freeSize)
+    {
+        this->flush();
+        freeSize = m_buffer.size();
+        result = fmt::vformat_to_n(m_buffer.data(), freeSize, fmtStr, args);
+        if (result.size > freeSize)
+        { // Bigger than the whole buffer
+            this->write(fmt::vformat(fmtStr, args));
+            return;
+        }
+    }
+
+    m_bufferPos += result.size;
+}
+
+bool OutputFileBuffer::flush()
+{
+    if (m_bufferPos > 0 && m_fstr.is_open())
+        m_fstr.write(m_buffer.data(), m_bufferPos);
+
+    m_bufferPos = 0;
+    return m_fstr.good();
+}
+
+} // namespace Mayo::IO
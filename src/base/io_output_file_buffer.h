@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "filepath.h"
+
+namespace Mayo::IO
+{
+
+// Provides buffered writing to a file
+// Bytes are accumulated into a fixed-size buffer which is written to the file only when full.
+// This avoids the per-item overhead of std::ostream formatted output
+class OutputFileBuffer
+{
+public:
+    OutputFileBuffer(const FilePath &filepath, size_t bufferSize = 64 * 1024);
+    ~OutputFileBuffer();
+
+    // Not copyable
+    OutputFileBuffer(const OutputFileBuffer &) = delete;
+    OutputFileBuffer &operator=(const OutputFileBuffer &) = delete;
+
+    bool isOpen() const
+    {
+        return m_fstr.is_open();
+    }
+
+    // Whether no error occurred so far when writing to the file
+    bool isGood() const
+    {
+        return m_fstr.good();
+    }
+
+    void write(const void *data, size_t size);
+    void write(std::string_view str)
+    {
+        this->write(str.data(), str.size());
+    }
+
+    // Writes bytes of 'value' as is(ie with host endianness)
+    template <typename T>
+    void writeRaw(const T &value)
+    {
+        this->write(&value, sizeof(T));
+    }
+
+    // Formats arguments with {fmt} library straight into the buffer
+    template <typename... Args>
+    void print(fmt::format_string<Args...> fmtStr, Args &&...args)
+    {
+        this->vprint(fmtStr, fmt::make_format_args(args...));
+    }
+
+    void vprint(fmt::string_view fmtStr, fmt::format_args args);
+
+    // Writes buffered bytes to the file, returns 'false' on error
+    bool flush();
+
+private:
+    std::ofstream m_fstr;
+    std::vector<char> m_buffer;
+    size_t m_bufferPos = 0;
+};
+
+} // namespace Mayo::IO
@@ -12,6 +12,7 @@
 
 #include "document_ptr.h"
 #include "filepath.h"
+#include "io_file_view.h"
 #include "io_format.h"
 #include "messenger_client.h"
 #include "span.h"
@@ -38,11 +39,29 @@ public:
     // Returns 'true' on success
     virtual bool readFile(const FilePath &fp, TaskProgress *progress) = 0;
 
+    // Same as readFile(const FilePath&) but file contents are provided by 'fileView'
+    // Readers able to parse contents from memory should override this function, default
+    // implementation reads file at path FileView::filepath()
+    // NOTE 'fileView' is valid only during the call, contents must not be referenced afterwards
+    virtual bool readFile(const FileView &fileView, TaskProgress *progress)
+    {
+        return this->readFile(fileView.filepath(), progress);
+    }
+
     // Converts data read during readFile() step into document 'doc' using
     // indicator to report progress Returns the list of entities added to document
     // 'doc'
     virtual TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) = 0;
 
+    // Whether transfer() can run concurrently with other readers, each one targeting its own
+    // document
+    // Readers relying on some global state(eg OpenCascade STEP/IGES translators) must not
+    // override the default implementation
+    virtual bool isConcurrentTransferSupported() const
+    {
+        return false;
+    }
+
     // Apply properties contain in 'group' to the reader's parameter values(known
     // in reader sub-class)
     virtual void applyProperties(const PropertyGroup *group) = 0;
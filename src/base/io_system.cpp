@@ -8,23 +8,28 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <fstream>
 #include <gsl/util>
 #include <locale>
-#include <regex>
 #include <unordered_set>
 #include <vector>
 
+#include <OSD_MemInfo.hxx>
 #include <fmt/format.h>
 
+#include "application.h"
+#include "brep_utils.h"
 #include "cpp_utils.h"
 #include "document.h"
+#include "io_import_cache.h"
 #include "io_parameters_provider.h"
 #include "io_reader.h"
 #include "io_writer.h"
 #include "messenger.h"
 #include "task_manager.h"
 #include "task_progress.h"
+#include "tkernel_utils.h"
 
 namespace Mayo::IO
 {
@@ -32,6 +37,9 @@ namespace Mayo::IO
 namespace
 {
 
+// Size of the file excerpt passed to format probes
+constexpr size_t ProbeContentsSize = 2048;
+
 bool containsFormat(Span<const Format> spanFormat, Format format)
 {
     auto itFormat = std::find(spanFormat.begin(), spanFormat.end(), format);
@@ -54,35 +62,289 @@ void dispatchWarnings(std::string_view headerMsg, const MessageCollecter &msgCol
         target->warning() << fmt::format("{}\n    {}", headerMsg, strWarnings);
 }
 
+// Returns the default ratio between the peak memory used to read a file of 'format' and its size
+double defaultMemoryExpansionFactor(Format format)
+{
+    switch (format)
+    {
+    // Text formats describing BRep entities
+    case Format_STEP:
+    case Format_IGES: return 10.;
+    case Format_OCCBREP: return 6.;
+    case Format_DXF: return 8.;
+    // Mesh formats
+    case Format_STL:
+    case Format_PLY:
+    case Format_OFF: return 3.;
+    default: return 5.;
+    }
+}
+
+// Returns current heap usage of the process in bytes, or 0 if not available
+uint64_t processHeapUsage()
+{
+    OSD_MemInfo memInfo(false /*immediateUpdate*/);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    memInfo.SetActive(false);
+    memInfo.SetActive(OSD_MemInfo::MemHeapUsage, true);
+#endif
+    memInfo.Update();
+    const Standard_Size heapUsage = memInfo.Value(OSD_MemInfo::MemHeapUsage);
+    return heapUsage != Standard_Size(-1) ? heapUsage : 0;
+}
+
+// Admission control of file reads against a memory budget
+// Candidates are identified by their index in the list of files to be imported
+class ReadAdmission
+{
+public:
+    ReadAdmission(uint64_t budget)
+        : m_budget(budget)
+    {
+    }
+
+    void addCandidate(size_t index, uint64_t memoryEstimate)
+    {
+        m_vecPending.push_back({index, memoryEstimate});
+        m_mapMemoryEstimate.insert({index, memoryEstimate});
+    }
+
+    // Returns the candidates to be started now, by decreasing memory estimate
+    std::vector<size_t> admit()
+    {
+        std::vector<size_t> vecAdmitted;
+        if (m_budget == 0)
+        {
+            for (const Candidate &candidate : m_vecPending)
+                vecAdmitted.push_back(candidate.index);
+
+            m_vecPending.clear();
+            m_runningCount += vecAdmitted.size();
+            return vecAdmitted;
+        }
+
+        std::stable_sort(m_vecPending.begin(), m_vecPending.end(),
+                         [](const Candidate &lhs, const Candidate &rhs)
+                         { return lhs.memoryEstimate > rhs.memoryEstimate; });
+        auto itCandidate = m_vecPending.begin();
+        while (itCandidate != m_vecPending.end())
+        {
+            if (m_usedMemory + itCandidate->memoryEstimate <= m_budget)
+            {
+                m_usedMemory += itCandidate->memoryEstimate;
+                vecAdmitted.push_back(itCandidate->index);
+                itCandidate = m_vecPending.erase(itCandidate);
+            }
+            else
+            {
+                ++itCandidate;
+            }
+        }
+
+        // Always keep some read running, otherwise import can't progress: start the first
+        // pending file(by index) whatever its memory estimate
+        if (vecAdmitted.empty() && m_runningCount == 0 && !m_vecPending.empty())
+        {
+            auto itFirst = std::min_element(m_vecPending.begin(), m_vecPending.end(),
+                                            [](const Candidate &lhs, const Candidate &rhs)
+                                            { return lhs.index < rhs.index; });
+            m_usedMemory += itFirst->memoryEstimate;
+            vecAdmitted.push_back(itFirst->index);
+            m_vecPending.erase(itFirst);
+        }
+
+        m_runningCount += vecAdmitted.size();
+        return vecAdmitted;
+    }
+
+    // Some admitted candidate is no more running, but its memory is still in use
+    void setFinished()
+    {
+        --m_runningCount;
+    }
+
+    // Memory used by candidate 'index' is released
+    void release(size_t index)
+    {
+        if (m_budget > 0)
+            m_usedMemory -= std::min(m_usedMemory, m_mapMemoryEstimate.at(index));
+    }
+
+private:
+    struct Candidate
+    {
+        size_t index;
+        uint64_t memoryEstimate;
+    };
+
+    uint64_t m_budget = 0;
+    uint64_t m_usedMemory = 0;
+    size_t m_runningCount = 0;
+    std::vector<Candidate> m_vecPending;
+    std::unordered_map<size_t, uint64_t> m_mapMemoryEstimate;
+};
+
 } // namespace
 
 void System::addFormatProbe(const FormatProbe &probe)
 {
     m_vecFormatProbe.push_back(probe);
+    this->clearProbeFormatCache();
 }
 
 Format System::probeFormat(const FilePath &filepath) const
 {
+    std::array<char, ProbeContentsSize> buff;
+    return this->probeFormat(filepath, buff);
+}
+
+std::vector<Format> System::probeFormats(Span<const FilePath> filepaths) const
+{
+    std::vector<Format> vecFormat;
+    vecFormat.reserve(filepaths.size());
+    std::array<char, ProbeContentsSize> buff;
+    for (const FilePath &filepath : filepaths)
+        vecFormat.push_back(this->probeFormat(filepath, buff));
+
+    return vecFormat;
+}
+
+void System::clearProbeFormatCache()
+{
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    m_mapProbeFormatCache.clear();
+    m_listProbeFormatCacheLru.clear();
+}
+
+size_t System::probeFormatCacheSize() const
+{
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    return m_mapProbeFormatCache.size();
+}
+
+size_t System::probeFormatCacheMaxSize() const
+{
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    return m_probeFormatCacheMaxSize;
+}
+
+void System::setProbeFormatCacheMaxSize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    m_probeFormatCacheMaxSize = size;
+    this->evictProbeFormatCacheEntries();
+}
+
+Format System::probeFormat(const FileView &fileView) const
+{
+    if (!fileView.isOpen())
+        return this->probeFormat(fileView.filepath());
+
+    const FilePath &filepath = fileView.filepath();
+    const auto fileLastWriteTime = filepathLastWriteTime(filepath);
+    Format format = Format_Unknown;
+    if (this->findProbeFormatCacheEntry(filepath, fileView.size(), fileLastWriteTime, &format))
+        return format;
+
+    FormatProbeInput probeInput = {};
+    probeInput.filepath = filepath;
+    probeInput.contentsBegin = fileView.contents().substr(0, ProbeContentsSize);
+    probeInput.hintFullSize = fileView.size();
+    probeInput.fileView = &fileView;
+    return this->probeFormat(probeInput, fileLastWriteTime);
+}
+
+Format System::probeFormat(const FilePath &filepath, Span<char> buffer) const
+{
+    // Probe result is cached as long as file size and last write time are unchanged
+    const uintmax_t fileSize = filepathFileSize(filepath);
+    const auto fileLastWriteTime = filepathLastWriteTime(filepath);
+    Format format = Format_Unknown;
+    if (this->findProbeFormatCacheEntry(filepath, fileSize, fileLastWriteTime, &format))
+        return format;
+
     std::ifstream file;
-    file.open(filepath);
-    if (file.is_open())
-    {
-        std::array<char, 2048> buff;
-        buff.fill(0);
-        file.read(buff.data(), buff.size());
-        FormatProbeInput probeInput = {};
-        probeInput.filepath = filepath;
-        probeInput.contentsBegin = std::string_view(buff.data(), file.gcount());
-        probeInput.hintFullSize = filepathFileSize(filepath);
-        for (const FormatProbe &fnProbe : m_vecFormatProbe)
+    file.open(filepath, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return this->probeFormatFromSuffix(filepath);
+
+    file.read(buffer.data(), buffer.size());
+    FormatProbeInput probeInput = {};
+    probeInput.filepath = filepath;
+    probeInput.contentsBegin = std::string_view(buffer.data(), file.gcount());
+    probeInput.hintFullSize = fileSize;
+    file.close();
+    return this->probeFormat(probeInput, fileLastWriteTime);
+}
+
+Format System::probeFormat(const FormatProbeInput &input,
+                           std_filesystem::file_time_type fileLastWriteTime) const
+{
+    Format format = Format_Unknown;
+    for (const FormatProbe &fnProbe : m_vecFormatProbe)
+    {
+        format = fnProbe(input);
+        if (format != Format_Unknown)
+            break; // Interrupt
+    }
+
+    if (format == Format_Unknown)
+        format = this->probeFormatFromSuffix(input.filepath);
+
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    const ProbeFormatCacheKey &key = input.filepath.native();
+    auto [itCache, isInserted] = m_mapProbeFormatCache.try_emplace(key);
+    ProbeFormatCacheEntry &cacheEntry = itCache->second;
+    if (isInserted)
+    {
+        m_listProbeFormatCacheLru.push_front(key);
+        cacheEntry.itLru = m_listProbeFormatCacheLru.begin();
+    }
+    else
+    {
+        m_listProbeFormatCacheLru.splice(m_listProbeFormatCacheLru.begin(),
+                                         m_listProbeFormatCacheLru, cacheEntry.itLru);
+    }
+
+    cacheEntry.fileSize = input.hintFullSize;
+    cacheEntry.fileLastWriteTime = fileLastWriteTime;
+    cacheEntry.format = format;
+    this->evictProbeFormatCacheEntries();
+    return format;
+}
+
+void System::evictProbeFormatCacheEntries() const
+{
+    while (m_mapProbeFormatCache.size() > m_probeFormatCacheMaxSize)
+    {
+        m_mapProbeFormatCache.erase(m_listProbeFormatCacheLru.back());
+        m_listProbeFormatCacheLru.pop_back();
+    }
+}
+
+bool System::findProbeFormatCacheEntry(const FilePath &filepath, uintmax_t fileSize,
+                                       std_filesystem::file_time_type fileLastWriteTime,
+                                       Format *ptrFormat) const
+{
+    std::lock_guard<std::mutex> lock(m_probeFormatCacheMutex);
+    auto itCache = m_mapProbeFormatCache.find(filepath.native());
+    if (itCache != m_mapProbeFormatCache.cend())
+    {
+        const ProbeFormatCacheEntry &entry = itCache->second;
+        if (entry.fileSize == fileSize && entry.fileLastWriteTime == fileLastWriteTime)
         {
-            const Format format = fnProbe(probeInput);
-            if (format != Format_Unknown)
-                return format;
+            m_listProbeFormatCacheLru.splice(m_listProbeFormatCacheLru.begin(),
+                                             m_listProbeFormatCacheLru, entry.itLru);
+            *ptrFormat = entry.format;
+            return true;
         }
     }
 
-    // Try to guess from file suffix
+    return false;
+}
+
+Format System::probeFormatFromSuffix(const FilePath &filepath) const
+{
     std::string fileSuffix = filepath.extension().string();
     if (!fileSuffix.empty() && fileSuffix.front() == '.')
         fileSuffix.erase(fileSuffix.begin());
@@ -120,6 +382,47 @@ Format System::probeFormat(const FilePath &filepath) const
     return Format_Unknown;
 }
 
+double System::memoryExpansionFactor(Format format) const
+{
+    std::lock_guard<std::mutex> lock(m_memoryFactorMutex);
+    auto itFactor = m_mapMemoryFactor.find(format);
+    return itFactor != m_mapMemoryFactor.cend() ? itFactor->second
+                                                : defaultMemoryExpansionFactor(format);
+}
+
+void System::setMemoryExpansionFactor(Format format, double factor)
+{
+    std::lock_guard<std::mutex> lock(m_memoryFactorMutex);
+    m_mapMemoryFactor.insert_or_assign(format, std::max(1., factor));
+}
+
+std::vector<std::pair<Format, double>> System::memoryExpansionFactors() const
+{
+    std::lock_guard<std::mutex> lock(m_memoryFactorMutex);
+    std::vector<std::pair<Format, double>> vecFactor(m_mapMemoryFactor.cbegin(),
+                                                     m_mapMemoryFactor.cend());
+    std::sort(vecFactor.begin(), vecFactor.end());
+    return vecFactor;
+}
+
+uint64_t System::estimateReadMemory(const FilePath &filepath, Format format) const
+{
+    const uint64_t fileSize = filepathFileSize(filepath);
+    return static_cast<uint64_t>(fileSize * this->memoryExpansionFactor(format));
+}
+
+void System::learnMemoryExpansionFactor(Format format, uint64_t fileSize, uint64_t memoryUsed)
+{
+    // Small files give too noisy measurements
+    if (fileSize < 1024 * 1024 || memoryUsed == 0)
+        return;
+
+    // Moving average of measured factors, so a single outlier read has limited effect
+    const double measuredFactor = double(memoryUsed) / double(fileSize);
+    const double factor = this->memoryExpansionFactor(format);
+    this->setMemoryExpansionFactor(format, 0.5 * factor + 0.5 * measuredFactor);
+}
+
 void System::addFactoryReader(std::unique_ptr<FactoryReader> ptr)
 {
     if (!ptr)
@@ -137,6 +440,7 @@ void System::addFactoryReader(std::unique_ptr<FactoryReader> ptr)
     }
 
     m_vecFactoryReader.push_back(std::move(ptr));
+    this->clearProbeFormatCache();
 }
 
 void System::addFactoryWriter(std::unique_ptr<FactoryWriter> ptr)
@@ -156,6 +460,7 @@ void System::addFactoryWriter(std::unique_ptr<FactoryWriter> ptr)
     }
 
     m_vecFactoryWriter.push_back(std::move(ptr));
+    this->clearProbeFormatCache();
 }
 
 const FactoryReader *System::findFactoryReader(Format format) const
@@ -205,19 +510,27 @@ bool System::importInDocument(const Args_ImportInDocument &args)
     TaskProgress *rootProgress = args.progress ? args.progress : &TaskProgress::null();
     Messenger *messenger = args.messenger ? args.messenger : &Messenger::null();
 
-    bool ok = true;
+    // Written by worker threads on error
+    std::atomic<bool> ok = true;
 
     using ReaderPtr = std::unique_ptr<Reader>;
     struct TaskData
     {
         ReaderPtr reader;
+        DocumentPtr scratchDocument;
+        std::string cacheKey;
+        bool isCacheHit = false; // Entry found in cache, still to be loaded
+        ImportCache::Entry cacheEntry;
         FilePath filepath;
         Format fileFormat = Format_Unknown;
         TaskProgress *progress = nullptr;
         TaskId taskId = 0;
+        bool taskDone = false;
+        std::chrono::steady_clock::time_point readyTime; // File ready to be transferred
+        bool transferDone = false; // Transferred into scratch document
+        TaskId postProcessTaskId = 0; // Post-processing of entities transferred by merge thread
         TDF_LabelSequence seqTransferredEntity;
         bool readSuccess = false;
-        bool transferred = false;
         MessageCollecter messenger;
     };
 
@@ -239,9 +552,33 @@ bool System::importInDocument(const Args_ImportInDocument &args)
         fnAddError(taskData, errorMsg);
         return false;
     };
+    std::atomic<int> readInProgressCount = 0;
+    std::atomic<int> readStartCount = 0;
+    auto fnParseFile = [&](TaskData &taskData, const FileView &fileView, TaskProgress *progress)
+    {
+        // Heap usage can be attributed to this file only if no other read ran meanwhile
+        const bool isReadAloneAtStart = readInProgressCount.fetch_add(1) == 0;
+        const int readSeq = ++readStartCount;
+        const uint64_t heapUsageStart = processHeapUsage();
+        const bool okRead = taskData.reader->readFile(fileView, progress);
+        const uint64_t heapUsageEnd = processHeapUsage();
+        const bool isReadAlone = readInProgressCount.fetch_sub(1) == 1 && isReadAloneAtStart;
+        if (okRead && isReadAlone && readStartCount == readSeq && heapUsageEnd > heapUsageStart)
+        {
+            this->learnMemoryExpansionFactor(taskData.fileFormat, fileView.size(),
+                                             heapUsageEnd - heapUsageStart);
+        }
+
+        if (!okRead)
+            return fnReadFileError(taskData, textIdTr("File read problem"));
+
+        return true;
+    };
     auto fnReadFile = [&](TaskData &taskData)
     {
-        taskData.fileFormat = this->probeFormat(taskData.filepath);
+        // File is opened once, its contents are shared by format probing and reading
+        const FileView fileView(taskData.filepath);
+        taskData.fileFormat = this->probeFormat(fileView);
         if (taskData.fileFormat == Format_Unknown)
             return fnReadFileError(taskData, textIdTr("Unknown format"));
 
@@ -255,32 +592,59 @@ bool System::importInDocument(const Args_ImportInDocument &args)
             return fnReadFileError(taskData, textIdTr("No supporting reader"));
 
         taskData.reader->setMessenger(&taskData.messenger);
+        const PropertyGroup *readerParams = nullptr;
         if (args.parametersProvider)
         {
-            taskData.reader->applyProperties(
-                args.parametersProvider->findReaderParameters(taskData.fileFormat));
+            readerParams = args.parametersProvider->findReaderParameters(taskData.fileFormat);
+            taskData.reader->applyProperties(readerParams);
         }
 
-        if (!taskData.reader->readFile(taskData.filepath, &progress))
-            return fnReadFileError(taskData, textIdTr("File read problem"));
+        if (args.importCache && ImportCache::isCacheable(taskData.fileFormat) && doc->application())
+        {
+            taskData.cacheKey =
+                ImportCache::computeKey(fileView, taskData.fileFormat, readerParams);
+            // Cache hit, parsing of the file is skipped
+            // Entry is loaded later by fnLoadFromCache(), in the thread merging into target
+            // document(loading needs the application which isn't thread-safe)
+            taskData.isCacheHit = args.importCache->lookup(taskData.cacheKey);
+            if (taskData.isCacheHit)
+                return true;
+        }
 
-        return true;
+        return fnParseFile(taskData, fileView, &progress);
     };
-    auto fnTransfer = [&](TaskData &taskData)
+    auto fnLoadFromCache = [&](TaskData &taskData)
+    {
+        if (!taskData.isCacheHit)
+            return true;
+
+        taskData.cacheEntry = args.importCache->load(taskData.cacheKey, doc->application());
+        if (!taskData.cacheEntry.isNull())
+            return true;
+
+        // Unreadable entry, fallback to parsing of the file
+        return fnParseFile(taskData, FileView(taskData.filepath), &TaskProgress::null());
+    };
+    auto fnTransfer = [&](TaskData &taskData, const DocumentPtr &targetDoc)
     {
         double portionSize = 60;
         if (fnEntityPostProcessRequired(taskData.fileFormat))
             portionSize *= (100 - args.entityPostProcessProgressSize) / 100.;
 
         TaskProgress progress(taskData.progress, portionSize, textIdTr("Transferring file"));
-        if (taskData.reader && !TaskProgress::isAbortRequested(&progress))
+        if (!taskData.cacheEntry.isNull())
+        {
+            taskData.seqTransferredEntity = targetDoc->relocateEntities(
+                taskData.cacheEntry.document, taskData.cacheEntry.seqEntity);
+            taskData.cacheEntry = {};
+            taskData.cacheKey.clear(); // Nothing to store back in cache
+        }
+        else if (taskData.reader && !TaskProgress::isAbortRequested(&progress))
         {
-            taskData.seqTransferredEntity = taskData.reader->transfer(doc, &progress);
+            taskData.seqTransferredEntity = taskData.reader->transfer(targetDoc, &progress);
             if (taskData.seqTransferredEntity.IsEmpty())
                 fnAddError(taskData, textIdTr("File transfer problem"));
         }
-
-        taskData.transferred = true;
     };
     auto fnPostProcess = [&](TaskData &taskData)
     {
@@ -296,6 +660,44 @@ bool System::importInDocument(const Args_ImportInDocument &args)
             args.entityPostProcess(labelEntity, &subProgress);
         }
     };
+    auto fnStoreInCache = [&](const TaskData &taskData)
+    {
+        if (!taskData.cacheKey.empty() && !taskData.seqTransferredEntity.IsEmpty())
+        {
+            args.importCache->store(taskData.cacheKey, taskData.scratchDocument,
+                                    taskData.seqTransferredEntity);
+        }
+    };
+    auto fnTransferPostProcess = [&](TaskData &taskData)
+    {
+        if (taskData.cacheKey.empty() || !taskData.cacheEntry.isNull())
+        {
+            fnTransfer(taskData, doc);
+            fnPostProcess(taskData);
+            return;
+        }
+
+        // Entities to be stored in cache go through a scratch document, so they are stored
+        // apart from the other contents of the target document
+        taskData.scratchDocument = doc->application()->newScratchDocument();
+        fnTransfer(taskData, taskData.scratchDocument);
+        fnPostProcess(taskData);
+        fnStoreInCache(taskData);
+        taskData.seqTransferredEntity =
+            doc->relocateEntities(taskData.scratchDocument, taskData.seqTransferredEntity);
+        taskData.scratchDocument.Nullify();
+    };
+    auto fnRecordTransferIdleTime = [&](const TaskData &taskData)
+    {
+        if (!args.metrics)
+            return;
+
+        const auto idleTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - taskData.readyTime);
+        ++args.metrics->transferCount;
+        args.metrics->transferIdleTime += idleTime;
+        args.metrics->transferIdleTimeMax = std::max(args.metrics->transferIdleTimeMax, idleTime);
+    };
     auto fnAddModelTreeEntities = [&](const TaskData &taskData)
     {
         // Need to call Document::addEntityTreeNodeSequence() instead of
@@ -315,23 +717,42 @@ bool System::importInDocument(const Args_ImportInDocument &args)
         taskData.messenger.clear();
     };
 
+    auto fnCreateReadAdmission = [&](const std::vector<TaskData> &vecTaskData)
+    {
+        ReadAdmission admission(args.memoryBudget);
+        for (const TaskData &taskData : vecTaskData)
+        {
+            uint64_t memoryEstimate = 0;
+            if (args.memoryBudget > 0)
+            {
+                const Format format = this->probeFormat(taskData.filepath);
+                memoryEstimate = this->estimateReadMemory(taskData.filepath, format);
+            }
+
+            admission.addCandidate(&taskData - &vecTaskData.front(), memoryEstimate);
+        }
+
+        return admission;
+    };
+
     if (listFilepath.size() == 1)
     { // Single file case
         TaskData taskData;
         taskData.filepath = listFilepath.front();
         taskData.progress = rootProgress;
-        ok = fnReadFile(taskData);
+        ok = fnReadFile(taskData) && fnLoadFromCache(taskData);
+        taskData.readyTime = std::chrono::steady_clock::now();
         if (ok)
         {
-            fnTransfer(taskData);
-            fnPostProcess(taskData);
+            fnRecordTransferIdleTime(taskData);
+            fnTransferPostProcess(taskData);
             fnAddModelTreeEntities(taskData);
         }
 
         fnDispatchMessages(taskData);
     }
-    else
-    { // Many files case
+    else if (args.parallelTransfer && doc->application())
+    { // Many files case, each file is transferred in a scratch document
         std::vector<TaskData> vecTaskData;
         vecTaskData.resize(listFilepath.size());
 
@@ -339,7 +760,8 @@ bool System::importInDocument(const Args_ImportInDocument &args)
         childTaskManager.signalProgressChanged.connectSlot(
             [&](TaskId, int) { rootProgress->setValue(childTaskManager.globalProgress()); });
 
-        // Read files
+        // Read and transfer files
+        std::unordered_map<TaskId, TaskData *> mapTaskData;
         for (TaskData &taskData : vecTaskData)
         {
             taskData.filepath = listFilepath[&taskData - &vecTaskData.front()];
@@ -348,35 +770,168 @@ bool System::importInDocument(const Args_ImportInDocument &args)
                 {
                     taskData.progress = progressChild;
                     taskData.readSuccess = fnReadFile(taskData);
+                    // Other files are transferred later in the merge step
+                    if (taskData.readSuccess && !taskData.isCacheHit &&
+                        taskData.reader->isConcurrentTransferSupported())
+                    {
+                        fnTransfer(taskData, taskData.scratchDocument);
+                        fnPostProcess(taskData);
+                        taskData.transferDone = true;
+                    }
+
+                    taskData.readyTime = std::chrono::steady_clock::now();
                 });
+            mapTaskData.insert({taskData.taskId, &taskData});
         }
 
-        for (const TaskData &taskData : vecTaskData)
-            childTaskManager.run(taskData.taskId, TaskAutoDestroy::Off);
+        ReadAdmission admission = fnCreateReadAdmission(vecTaskData);
+        auto fnRunAdmittedTasks = [&]
+        {
+            for (size_t index : admission.admit())
+            {
+                // Scratch document is created here as the application isn't thread-safe, and
+                // only when task starts so the count of living scratch documents is bounded
+                TaskData &taskData = vecTaskData.at(index);
+                taskData.scratchDocument = doc->application()->newScratchDocument();
+                childTaskManager.run(taskData.taskId, TaskAutoDestroy::Off);
+            }
+        };
+        fnRunAdmittedTasks();
 
-        // Transfer to document
-        auto taskDataCount = CppUtils::safeStaticCast<int>(vecTaskData.size());
-        while (taskDataCount > 0 && !rootProgress->isAbortRequested())
+        // Merge scratch documents into target document, in the order of input files
+        size_t mergeIndex = 0;
+        while (mergeIndex < vecTaskData.size() && !rootProgress->isAbortRequested())
         {
-            auto it = std::find_if(vecTaskData.begin(), vecTaskData.end(),
-                                   [&](const TaskData &taskData)
-                                   {
-                                       return !taskData.transferred &&
-                                              childTaskManager.waitForDone(taskData.taskId, 25);
-                                   });
-
-            if (it != vecTaskData.end())
+            const TaskId taskId = childTaskManager.waitForNextDone();
+            if (taskId == TaskId_null)
+                break;
+
+            TaskData &taskDataDone = *mapTaskData.at(taskId);
+            if (taskId == taskDataDone.taskId)
+                admission.setFinished();
+
+            // Reader not supporting concurrent transfer(eg STEP/IGES): transfer is serialized
+            // in this thread, but post-processing(eg BRep meshing) still runs in a child task
+            if (taskId == taskDataDone.taskId && taskDataDone.readSuccess &&
+                !taskDataDone.isCacheHit && !taskDataDone.transferDone &&
+                !rootProgress->isAbortRequested())
             {
-                if (it->readSuccess)
+                taskDataDone.progress = nullptr; // Task is finished
+                fnTransfer(taskDataDone, taskDataDone.scratchDocument);
+                taskDataDone.transferDone = true;
+                if (fnEntityPostProcessRequired(taskDataDone.fileFormat))
                 {
-                    fnTransfer(*it);
-                    fnPostProcess(*it);
-                    fnAddModelTreeEntities(*it);
+                    TaskData *ptrTaskData = &taskDataDone;
+                    taskDataDone.postProcessTaskId = childTaskManager.newTask(
+                        [&, ptrTaskData](TaskProgress *progressChild)
+                        {
+                            ptrTaskData->progress = progressChild;
+                            fnPostProcess(*ptrTaskData);
+                        });
+                    mapTaskData.insert({taskDataDone.postProcessTaskId, ptrTaskData});
+                    childTaskManager.run(taskDataDone.postProcessTaskId, TaskAutoDestroy::Off);
                 }
+                else
+                {
+                    taskDataDone.taskDone = true;
+                }
+            }
+            else
+            {
+                taskDataDone.taskDone = true;
+            }
 
-                fnDispatchMessages(*it);
-                --taskDataCount;
+            while (mergeIndex < vecTaskData.size() && vecTaskData.at(mergeIndex).taskDone)
+            {
+                TaskData &taskData = vecTaskData.at(mergeIndex);
+                if (taskData.readSuccess && !rootProgress->isAbortRequested())
+                {
+                    fnRecordTransferIdleTime(taskData);
+                    // Cache hit: entities are loaded here
+                    // Import cache uses the application, so it's accessed only from this thread
+                    if (!taskData.transferDone)
+                    {
+                        taskData.progress = nullptr; // Task is finished
+                        taskData.scratchDocument.Nullify();
+                        if (fnLoadFromCache(taskData))
+                            fnTransferPostProcess(taskData);
+                    }
+                    else
+                    {
+                        fnStoreInCache(taskData);
+                        taskData.seqTransferredEntity = doc->relocateEntities(
+                            taskData.scratchDocument, taskData.seqTransferredEntity);
+                    }
+
+                    fnAddModelTreeEntities(taskData);
+                }
+
+                taskData.scratchDocument.Nullify();
+                taskData.reader.reset();
+                fnDispatchMessages(taskData);
+                admission.release(mergeIndex);
+                ++mergeIndex;
             }
+
+            fnRunAdmittedTasks();
+        }
+    }
+    else
+    { // Many files case
+        std::vector<TaskData> vecTaskData;
+        vecTaskData.resize(listFilepath.size());
+
+        TaskManager childTaskManager;
+        childTaskManager.signalProgressChanged.connectSlot(
+            [&](TaskId, int) { rootProgress->setValue(childTaskManager.globalProgress()); });
+
+        // Read files
+        std::unordered_map<TaskId, TaskData *> mapTaskData;
+        for (TaskData &taskData : vecTaskData)
+        {
+            taskData.filepath = listFilepath[&taskData - &vecTaskData.front()];
+            taskData.taskId = childTaskManager.newTask(
+                [&](TaskProgress *progressChild)
+                {
+                    taskData.progress = progressChild;
+                    taskData.readSuccess = fnReadFile(taskData);
+                    taskData.readyTime = std::chrono::steady_clock::now();
+                });
+            mapTaskData.insert({taskData.taskId, &taskData});
+        }
+
+        ReadAdmission admission = fnCreateReadAdmission(vecTaskData);
+        auto fnRunAdmittedTasks = [&]
+        {
+            for (size_t index : admission.admit())
+                childTaskManager.run(vecTaskData.at(index).taskId, TaskAutoDestroy::Off);
+        };
+        fnRunAdmittedTasks();
+
+        // Transfer to document each file as soon as it's read(ie in completion order)
+        while (!rootProgress->isAbortRequested())
+        {
+            const TaskId taskId = childTaskManager.waitForNextDone();
+            if (taskId == TaskId_null)
+                break; // All files were transferred
+
+            TaskData &taskData = *mapTaskData.at(taskId);
+            admission.setFinished();
+            if (taskData.readSuccess)
+                taskData.readSuccess = fnLoadFromCache(taskData);
+
+            if (taskData.readSuccess)
+            {
+                fnRecordTransferIdleTime(taskData);
+                fnTransferPostProcess(taskData);
+                fnAddModelTreeEntities(taskData);
+            }
+
+            // Reader data is no more needed, release it before starting other reads
+            taskData.reader.reset();
+            fnDispatchMessages(taskData);
+            admission.release(&taskData - &vecTaskData.front());
+            fnRunAdmittedTasks();
         } // endwhile
     }
 
@@ -415,6 +970,21 @@ bool System::exportApplicationItems(const Args_ExportApplicationItems &args)
 
     writer->setMessenger(&msgCollect);
     writer->applyProperties(args.parameters);
+
+    // Meshes read with late data loading might not be loaded yet
+    for (const ApplicationItem &appItem : args.applicationItems)
+    {
+        if (appItem.isDocument())
+        {
+            for (const TDF_Label &label : appItem.document()->xcaf().topLevelFreeShapes())
+                BRepUtils::loadDeferredTriangulations(XCaf::shape(label));
+        }
+        else if (appItem.isDocumentTreeNode())
+        {
+            BRepUtils::loadDeferredTriangulations(XCaf::shape(appItem.documentTreeNode().label()));
+        }
+    }
+
     {
         TaskProgress transferProgress(progress, 40, textIdTr("Transfer"));
         const bool okTransfer = writer->transfer(args.applicationItems, &transferProgress);
@@ -614,6 +1184,34 @@ System::Operation_ImportInDocument::withEntityPostProcessInfoProgress(int progre
     return *this;
 }
 
+System::Operation_ImportInDocument::Operation &
+System::Operation_ImportInDocument::withParallelTransfer(bool on)
+{
+    m_args.parallelTransfer = on;
+    return *this;
+}
+
+System::Operation_ImportInDocument &
+System::Operation_ImportInDocument::withImportCache(ImportCache *cache)
+{
+    m_args.importCache = cache;
+    return *this;
+}
+
+System::Operation_ImportInDocument &
+System::Operation_ImportInDocument::withMemoryBudget(uint64_t budget)
+{
+    m_args.memoryBudget = budget;
+    return *this;
+}
+
+System::Operation_ImportInDocument &
+System::Operation_ImportInDocument::withMetrics(ImportMetrics *metrics)
+{
+    m_args.metrics = metrics;
+    return *this;
+}
+
 bool System::Operation_ImportInDocument::execute()
 {
     return m_system.importInDocument(m_args);
@@ -627,82 +1225,262 @@ System::Operation_ImportInDocument::Operation_ImportInDocument(System &system)
 namespace
 {
 
-bool matchRegExp_atStart(std::string_view str, const std::regex &rx)
+bool isSpaceChar(char c)
 {
-    std::match_results<std::string_view::const_iterator> mres;
-    const bool match = std::regex_search(str.cbegin(), str.cend(), mres, rx);
-    return match ? mres.position() == 0 : false;
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
 }
 
-bool matchRegExp_anyWhere(std::string_view str, const std::regex &rx)
+bool isDigitChar(char c)
 {
-    return std::regex_search(str.cbegin(), str.cend(), rx);
+    return c >= '0' && c <= '9';
 }
 
-} // namespace
+// Removes the whitespace characters at the start of 'str', returns the count of removed chars
+size_t consumeSpaces(std::string_view *str)
+{
+    size_t count = 0;
+    while (count < str->size() && isSpaceChar((*str)[count]))
+        ++count;
 
-Format probeFormat_STEP(const System::FormatProbeInput &input)
+    str->remove_prefix(count);
+    return count;
+}
+
+// Removes 'token' at the start of 'str', returns 'false' if 'str' doesn't start with 'token'
+bool consumeToken(std::string_view *str, std::string_view token)
 {
-    const std::regex rx{R"(^\s*ISO-10303-21\s*;\s*HEADER)"};
-    return matchRegExp_atStart(input.contentsBegin, rx) ? Format_STEP : Format_Unknown;
+    if (str->substr(0, token.size()) != token)
+        return false;
+
+    str->remove_prefix(token.size());
+    return true;
 }
 
-Format probeFormat_IGES(const System::FormatProbeInput &input)
+// Same as consumeToken() but requires at least one whitespace character after 'token'
+bool consumeWord(std::string_view *str, std::string_view word)
 {
-    const std::regex rx{R"(^.{72}S\s*[0-9]+\s*[\n\r\f])"};
-    return matchRegExp_atStart(input.contentsBegin, rx) ? Format_IGES : Format_Unknown;
+    return consumeToken(str, word) && consumeSpaces(str) > 0;
 }
 
-Format probeFormat_OCCBREP(const System::FormatProbeInput &input)
+std::string_view trimLeft(std::string_view str)
 {
-    const std::regex rx{R"(^\s*DBRep_DrawableShape)"};
-    return matchRegExp_atStart(input.contentsBegin, rx) ? Format_OCCBREP : Format_Unknown;
+    consumeSpaces(&str);
+    return str;
 }
 
-Format probeFormat_STL(const System::FormatProbeInput &input)
+// Functions matchSignature_XXX() expect `contents` with leading whitespaces already removed
+// They are shared by probeFormat_XXX() and probeFormat_Predefined() functions
+
+bool matchSignature_STEP(std::string_view contents)
 {
-    std::string_view sample = input.contentsBegin;
-    // Binary STL ?
+    if (!consumeToken(&contents, "ISO-10303-21"))
+        return false;
+
+    consumeSpaces(&contents);
+    if (!consumeToken(&contents, ";"))
+        return false;
+
+    consumeSpaces(&contents);
+    return consumeToken(&contents, "HEADER");
+}
+
+bool matchSignature_OCCBREP(std::string_view contents)
+{
+    return consumeToken(&contents, "DBRep_DrawableShape");
+}
+
+bool matchSignature_STLAscii(std::string_view contents)
+{
+    return consumeWord(&contents, "solid");
+}
+
+bool matchSignature_PLY(std::string_view contents)
+{
+    if (!consumeWord(&contents, "ply") || !consumeWord(&contents, "format"))
+        return false;
+
+    return consumeWord(&contents, "ascii") || consumeWord(&contents, "binary_little_endian") ||
+           consumeWord(&contents, "binary_big_endian");
+}
+
+bool matchSignature_OFF(std::string_view contents)
+{
+    if (!contents.empty() && (contents.front() == 'C' || contents.front() == 'N' ||
+                              contents.front() == '4'))
     {
-        constexpr size_t binaryStlHeaderSize = 80 + sizeof(uint32_t);
-        if (sample.size() >= binaryStlHeaderSize)
-        {
-            constexpr uint32_t offset = 80; // Skip header
-            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(sample.data());
-            const uint32_t facetsCount = bytes[offset] | (bytes[offset + 1] << 8) |
-                                         (bytes[offset + 2] << 16) | (bytes[offset + 3] << 24);
-            constexpr unsigned facetSize = (sizeof(float) * 12) + sizeof(uint16_t);
-            if ((facetSize * facetsCount + binaryStlHeaderSize) == input.hintFullSize)
-                return Format_STL;
-        }
+        contents.remove_prefix(1);
     }
 
-    // ASCII STL ?
+    return consumeWord(&contents, "OFF");
+}
+
+// Contents are not trimmed: IGES start section line is 80-columns fixed format
+bool matchSignature_IGES(std::string_view contents)
+{
+    constexpr size_t sequenceColumn = 72;
+    if (contents.size() <= sequenceColumn)
+        return false;
+
+    const std::string_view strData = contents.substr(0, sequenceColumn);
+    if (strData.find_first_of("\n\r") != std::string_view::npos)
+        return false;
+
+    contents.remove_prefix(sequenceColumn);
+    if (!consumeToken(&contents, "S"))
+        return false;
+
+    consumeSpaces(&contents);
+    if (contents.empty() || !isDigitChar(contents.front()))
+        return false;
+
+    while (!contents.empty() && isDigitChar(contents.front()))
+        contents.remove_prefix(1);
+
+    // Sequence number must be followed by end of line
+    while (!contents.empty() && isSpaceChar(contents.front()))
     {
-        const std::regex rx{R"(^\s*solid\s+)"};
-        if (matchRegExp_atStart(input.contentsBegin, rx))
-            return Format_STL;
+        const char c = contents.front();
+        if (c == '\n' || c == '\r' || c == '\f')
+            return true;
+
+        contents.remove_prefix(1);
     }
 
-    return Format_Unknown;
+    return false;
+}
+
+bool matchSignature_STLBinary(const System::FormatProbeInput &input)
+{
+    constexpr size_t binaryStlHeaderSize = 80 + sizeof(uint32_t);
+    const std::string_view sample = input.contentsBegin;
+    if (sample.size() < binaryStlHeaderSize)
+        return false;
+
+    constexpr uint32_t offset = 80; // Skip header
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(sample.data());
+    const uint32_t facetsCount = bytes[offset] | (bytes[offset + 1] << 8) |
+                                 (bytes[offset + 2] << 16) | (bytes[offset + 3] << 24);
+    constexpr unsigned facetSize = (sizeof(float) * 12) + sizeof(uint16_t);
+    return (uint64_t(facetSize) * facetsCount + binaryStlHeaderSize) == input.hintFullSize;
+}
+
+// Looks for some line starting with a vertex-like OBJ record, eg "v 0.5 ..." or "vn -1 ..."
+bool matchSignature_OBJ(std::string_view contents)
+{
+    while (!contents.empty())
+    {
+        const size_t posEol = contents.find('\n');
+        std::string_view line = contents.substr(0, posEol);
+        contents.remove_prefix(posEol != std::string_view::npos ? posEol + 1 : contents.size());
+        consumeSpaces(&line);
+        const bool isVertexRecord = consumeWord(&line, "v") || consumeWord(&line, "vt") ||
+                                    consumeWord(&line, "vn") || consumeWord(&line, "vp") ||
+                                    consumeWord(&line, "surf");
+        if (!isVertexRecord)
+            continue;
+
+        if (!line.empty() && (line.front() == '-' || line.front() == '+'))
+            line.remove_prefix(1);
+
+        size_t numberLength = 0;
+        while (numberLength < line.size() &&
+               (isDigitChar(line[numberLength]) || line[numberLength] == '.'))
+        {
+            ++numberLength;
+        }
+
+        if (numberLength > 0 && numberLength < line.size() && isSpaceChar(line[numberLength]))
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+Format probeFormat_STEP(const System::FormatProbeInput &input)
+{
+    return matchSignature_STEP(trimLeft(input.contentsBegin)) ? Format_STEP : Format_Unknown;
+}
+
+Format probeFormat_IGES(const System::FormatProbeInput &input)
+{
+    return matchSignature_IGES(input.contentsBegin) ? Format_IGES : Format_Unknown;
+}
+
+Format probeFormat_OCCBREP(const System::FormatProbeInput &input)
+{
+    return matchSignature_OCCBREP(trimLeft(input.contentsBegin)) ? Format_OCCBREP : Format_Unknown;
+}
+
+Format probeFormat_STL(const System::FormatProbeInput &input)
+{
+    if (matchSignature_STLBinary(input))
+        return Format_STL;
+
+    return matchSignature_STLAscii(trimLeft(input.contentsBegin)) ? Format_STL : Format_Unknown;
 }
 
 Format probeFormat_OBJ(const System::FormatProbeInput &input)
 {
-    const std::regex rx{R"([^\n]\s*(v|vt|vn|vp|surf)\s+[-\+]?[0-9\.]+\s)"};
-    return matchRegExp_anyWhere(input.contentsBegin, rx) ? Format_OBJ : Format_Unknown;
+    return matchSignature_OBJ(input.contentsBegin) ? Format_OBJ : Format_Unknown;
 }
 
 Format probeFormat_PLY(const System::FormatProbeInput &input)
 {
-    const std::regex rx{R"(^\s*ply\s+format\s+(ascii|binary_little_endian|binary_big_endian)\s+)"};
-    return matchRegExp_atStart(input.contentsBegin, rx) ? Format_PLY : Format_Unknown;
+    return matchSignature_PLY(trimLeft(input.contentsBegin)) ? Format_PLY : Format_Unknown;
 }
 
 Format probeFormat_OFF(const System::FormatProbeInput &input)
 {
-    const std::regex rx{R"(^\s*[CN4]?OFF\s+)"};
-    return matchRegExp_atStart(input.contentsBegin, rx) ? Format_OFF : Format_Unknown;
+    return matchSignature_OFF(trimLeft(input.contentsBegin)) ? Format_OFF : Format_Unknown;
+}
+
+Format probeFormat_Predefined(const System::FormatProbeInput &input)
+{
+    // Leading whitespaces are skipped once, then the first character selects the single
+    // header signature to be checked
+    const std::string_view contents = trimLeft(input.contentsBegin);
+    if (!contents.empty())
+    {
+        switch (contents.front())
+        {
+        case 'I':
+            if (matchSignature_STEP(contents))
+                return Format_STEP;
+            break;
+        case 'D':
+            if (matchSignature_OCCBREP(contents))
+                return Format_OCCBREP;
+            break;
+        case 's':
+            if (matchSignature_STLAscii(contents))
+                return Format_STL;
+            break;
+        case 'p':
+            if (matchSignature_PLY(contents))
+                return Format_PLY;
+            break;
+        case 'C':
+        case 'N':
+        case '4':
+        case 'O':
+            if (matchSignature_OFF(contents))
+                return Format_OFF;
+            break;
+        }
+    }
+
+    if (matchSignature_STLBinary(input))
+        return Format_STL;
+
+    if (matchSignature_IGES(input.contentsBegin))
+        return Format_IGES;
+
+    if (matchSignature_OBJ(input.contentsBegin))
+        return Format_OBJ;
+
+    return Format_Unknown;
 }
 
 void addPredefinedFormatProbes(System *system)
@@ -710,13 +1488,7 @@ void addPredefinedFormatProbes(System *system)
     if (!system)
         return;
 
-    system->addFormatProbe(probeFormat_STEP);
-    system->addFormatProbe(probeFormat_IGES);
-    system->addFormatProbe(probeFormat_OCCBREP);
-    system->addFormatProbe(probeFormat_STL);
-    system->addFormatProbe(probeFormat_OBJ);
-    system->addFormatProbe(probeFormat_PLY);
-    system->addFormatProbe(probeFormat_OFF);
+    system->addFormatProbe(probeFormat_Predefined);
 }
 
 } // namespace Mayo::IO
@@ -6,13 +6,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "application_item.h"
 #include "filepath.h"
+#include "io_file_view.h"
 #include "io_format.h"
 #include "io_reader.h"
 #include "io_writer.h"
@@ -30,6 +37,7 @@ class TaskProgress;
 namespace IO
 {
 
+class ImportCache;
 class ParametersProvider;
 
 // Main class to centralize access to FactoryReader/FactoryWriter objects
@@ -44,13 +52,42 @@ public:
     struct FormatProbeInput
     {
         FilePath filepath;
-        std::string_view contentsBegin; // Excerpt of the file(from start)
-        uint64_t hintFullSize;          // Full file size in bytes
+        std::string_view contentsBegin;     // Excerpt of the file(from start)
+        uint64_t hintFullSize;              // Full file size in bytes
+        const FileView *fileView = nullptr; // Optional: whole file contents
     };
     using FormatProbe = std::function<Format(const FormatProbeInput &)>;
     void addFormatProbe(const FormatProbe &probe);
+
+    // Finds the format of file at 'filepath' by running format probes over the first bytes
+    // of the file, then by inspecting the file suffix
+    // Results are cached and reused as long as file size and last write time are unchanged
+    // Count of cached results is bounded, least recently used ones are evicted first
     Format probeFormat(const FilePath &filepath) const;
 
+    // Same as probeFormat(const FilePath&) but contents are taken from the file view, so no
+    // additional read of the file is done
+    Format probeFormat(const FileView &fileView) const;
+
+    // Same as probeFormat() for each file in 'filepaths'(results are in the same order)
+    std::vector<Format> probeFormats(Span<const FilePath> filepaths) const;
+
+    void clearProbeFormatCache();
+    size_t probeFormatCacheSize() const;
+    size_t probeFormatCacheMaxSize() const;
+    void setProbeFormatCacheMaxSize(size_t size);
+
+    // Estimated ratio between the peak memory used to read a file of 'format' and the file size
+    // Initialized with default values, then refined by importInDocument() from the heap usage
+    // measured while reading files
+    double memoryExpansionFactor(Format format) const;
+    void setMemoryExpansionFactor(Format format, double factor);
+    // Factors set or learned so far, by increasing format(default factors aren't included)
+    std::vector<std::pair<Format, double>> memoryExpansionFactors() const;
+
+    // Returns the estimated peak memory in bytes used to read file 'filepath' of 'format'
+    uint64_t estimateReadMemory(const FilePath &filepath, Format format) const;
+
     void addFactoryReader(std::unique_ptr<FactoryReader> ptr);
     void addFactoryWriter(std::unique_ptr<FactoryWriter> ptr);
 
@@ -73,6 +110,19 @@ public:
     // Import service
     //
 
+    // Timing metrics of the importInDocument() function
+    struct ImportMetrics
+    {
+        // Count of files whose transfer was started
+        int transferCount = 0;
+        // Idle time between a file being read and the start of its transfer in the target
+        // document, accumulated over all files
+        // With parallel transfer, it's the time a scratch document waits to be merged
+        std::chrono::microseconds transferIdleTime = {};
+        // Maximum idle time measured for a single file
+        std::chrono::microseconds transferIdleTimeMax = {};
+    };
+
     // Contains arguments for the importInDocument() function
     struct Args_ImportInDocument
     {
@@ -105,6 +155,29 @@ public:
         // Optional: title of the whole post-process operation
         std::string entityPostProcessProgressStep;
 
+        // Optional: when importing many files, transfer(and post-process) each file into its
+        // own scratch document on a worker thread. Entities are then relocated into target
+        // document one file after another, so only this merge step is serialized
+        // Files whose reader doesn't support concurrent transfer(see
+        // Reader::isConcurrentTransferSupported()) are transferred one after another by the
+        // merge step, their post-processing still runs on worker threads
+        bool parallelTransfer = false;
+
+        // Optional: cache of imported entities. Files already imported with the same reader
+        // parameters are restored from cache instead of being read again
+        // See ImportCache::isCacheable() for the supported formats
+        ImportCache *importCache = nullptr;
+
+        // Optional: memory budget in bytes for reading many files, 0 means no limit
+        // Files are started only if the sum of their estimated peak memory(see
+        // estimateReadMemory()) fits in the budget, larger files are started first and smaller
+        // files fill the gaps. A file exceeding the budget is read alone
+        // Memory of a file is accounted until its entities are transferred in target document
+        uint64_t memoryBudget = 0;
+
+        // Optional: receives timing metrics of the import operation
+        ImportMetrics *metrics = nullptr;
+
         // Optional: the messenger object used to report any additional infos,
         // warnings and errors
         Messenger *messenger = nullptr;
@@ -162,6 +235,10 @@ public:
         Operation &withEntityPostProcessRequiredIf(std::function<bool(Format)> fn);
         Operation &withEntityPostProcessInfoProgress(int progressSize,
                                                      std::string_view progressStep);
+        Operation &withParallelTransfer(bool on);
+        Operation &withImportCache(ImportCache *cache);
+        Operation &withMemoryBudget(uint64_t budget);
+        Operation &withMetrics(ImportMetrics *metrics);
 
         Operation &withMessenger(Messenger *messenger);
         Operation &withTaskProgress(TaskProgress *progress);
@@ -219,7 +296,34 @@ public:
     // Implementation
 
 private:
+    Format probeFormat(const FilePath &filepath, Span<char> buffer) const;
+    Format probeFormat(const FormatProbeInput &input,
+                       std_filesystem::file_time_type fileLastWriteTime) const;
+    bool findProbeFormatCacheEntry(const FilePath &filepath, uintmax_t fileSize,
+                                   std_filesystem::file_time_type fileLastWriteTime,
+                                   Format *ptrFormat) const;
+    Format probeFormatFromSuffix(const FilePath &filepath) const;
+
+    using ProbeFormatCacheKey = FilePath::string_type;
+    struct ProbeFormatCacheEntry
+    {
+        uintmax_t fileSize;
+        std_filesystem::file_time_type fileLastWriteTime;
+        Format format;
+        std::list<ProbeFormatCacheKey>::iterator itLru;
+    };
+    // Note: caller must lock 'm_probeFormatCacheMutex'
+    void evictProbeFormatCacheEntries() const;
+
+    void learnMemoryExpansionFactor(Format format, uint64_t fileSize, uint64_t memoryUsed);
+
     std::vector<FormatProbe> m_vecFormatProbe;
+    mutable std::mutex m_memoryFactorMutex;
+    std::unordered_map<Format, double> m_mapMemoryFactor;
+    mutable std::mutex m_probeFormatCacheMutex;
+    mutable std::unordered_map<ProbeFormatCacheKey, ProbeFormatCacheEntry> m_mapProbeFormatCache;
+    mutable std::list<ProbeFormatCacheKey> m_listProbeFormatCacheLru; // Most recently used first
+    size_t m_probeFormatCacheMaxSize = 256;
     std::vector<Format> m_vecReaderFormat;
     std::vector<Format> m_vecWriterFormat;
     std::vector<std::unique_ptr<FactoryReader>> m_vecFactoryReader;
@@ -234,6 +338,8 @@ Format probeFormat_STL(const System::FormatProbeInput &input);
 Format probeFormat_OBJ(const System::FormatProbeInput &input);
 Format probeFormat_PLY(const System::FormatProbeInput &input);
 Format probeFormat_OFF(const System::FormatProbeInput &input);
+// Single-pass combination of all the probeFormat_XXX() functions above
+Format probeFormat_Predefined(const System::FormatProbeInput &input);
 void addPredefinedFormatProbes(System *system);
 
 } // namespace IO
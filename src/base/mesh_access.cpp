@@ -66,6 +66,11 @@ public:
             return {};
     }
 
+    Span<const Quantity_Color> nodeColors() const override
+    {
+        return !m_faceColor ? m_nodeColors : Span<const Quantity_Color>{};
+    }
+
     const TopLoc_Location &location() const override
     {
         return m_location;
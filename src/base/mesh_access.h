@@ -13,6 +13,7 @@
 #include <Standard_Handle.hxx>
 
 #include "occ_handle.h"
+#include "span.h"
 
 class DocumentTreeNode;
 class Poly_Triangulation;
@@ -26,6 +27,9 @@ class IMeshAccess
 {
 public:
     virtual std::optional<Quantity_Color> nodeColor(int i) const = 0;
+    // Per-node colors, empty if nodeColor() is the same for all nodes(or there is no color)
+    // Items refer to document data, they're valid as long as the document isn't modified
+    virtual Span<const Quantity_Color> nodeColors() const = 0;
     virtual const TopLoc_Location &location() const = 0;
     virtual const OccHandle<Poly_Triangulation> &triangulation() const = 0;
 };
@@ -6,8 +6,11 @@
 
 #include "mesh_utils.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
 #include <stdexcept>
 
 #include "math_utils.h"
@@ -139,6 +142,55 @@ void allocateNormals(const OccHandle<Poly_Triangulation> &triangulation)
 #endif
 }
 
+double *nodeCoordsData(const OccHandle<Poly_Triangulation> &triangulation)
+{
+    if (triangulation->NbNodes() <= 0)
+        return nullptr;
+
+#if OCC_VERSION_HEX >= 0x070600
+    Poly_ArrayOfNodes &nodes = triangulation->InternalNodes();
+    return nodes.IsDoublePrecision() ? nodes.ChangeValue3d(0).ChangeData() : nullptr;
+#else
+    return triangulation->ChangeNodes().ChangeFirst().ChangeCoord().ChangeData();
+#endif
+}
+
+float *normalCoordsData(const OccHandle<Poly_Triangulation> &triangulation)
+{
+    if (triangulation->NbNodes() <= 0 || !triangulation->HasNormals())
+        return nullptr;
+
+#if OCC_VERSION_HEX >= 0x070600
+    return triangulation->InternalNormals().ChangeFirst().ChangeData();
+#else
+    return &triangulation->ChangeNormals().ChangeFirst();
+#endif
+}
+
+int *triangleIndicesData(const OccHandle<Poly_Triangulation> &triangulation)
+{
+    if (triangulation->NbTriangles() <= 0)
+        return nullptr;
+
+#if OCC_VERSION_HEX >= 0x070600
+    return &triangulation->InternalTriangles().ChangeFirst().ChangeValue(1);
+#else
+    return &triangulation->ChangeTriangles().ChangeFirst().ChangeValue(1);
+#endif
+}
+
+double *uvNodeCoordsData(const OccHandle<Poly_Triangulation> &triangulation)
+{
+    if (triangulation->NbNodes() <= 0 || !triangulation->HasUVNodes())
+        return nullptr;
+
+#if OCC_VERSION_HEX >= 0x070600
+    return &triangulation->InternalUVNodes().ChangeFirst().ChangeCoord().ChangeCoord(1);
+#else
+    return &triangulation->ChangeUVNodes().ChangeFirst().ChangeCoord().ChangeCoord(1);
+#endif
+}
+
 Poly_Triangulation_NormalType normal(const OccHandle<Poly_Triangulation> &triangulation, int index)
 {
     Poly_Triangulation_NormalType nvec;
@@ -158,6 +210,248 @@ const Poly_Array1OfTriangle &triangles(const OccHandle<Poly_Triangulation> &tria
     return triangulation->InternalTriangles();
 }
 
+namespace
+{
+
+// Tuning values of Forsyth's algorithm
+constexpr int ForsythCacheSize = 32;
+constexpr float ForsythCacheDecayPower = 1.5f;
+constexpr float ForsythLastTriangleScore = 0.75f;
+constexpr float ForsythValenceBoostScale = 2.f;
+constexpr float ForsythValenceBoostPower = 0.5f;
+
+float forsythNodeScore(int cachePos, int remainingTriangleCount)
+{
+    if (remainingTriangleCount == 0)
+        return -1.f;
+
+    float score = 0.f;
+    if (cachePos >= 0)
+    {
+        if (cachePos < 3)
+        {
+            // Nodes of the last triangle added
+            score = ForsythLastTriangleScore;
+        }
+        else
+        {
+            const float scaler = 1.f / (ForsythCacheSize - 3);
+            score = std::pow(1.f - (cachePos - 3) * scaler, ForsythCacheDecayPower);
+        }
+    }
+
+    // Boost nodes having few triangles left, so lone triangles don't stay behind
+    const auto valenceBoost = std::pow(float(remainingTriangleCount), -ForsythValenceBoostPower);
+    return score + ForsythValenceBoostScale * valenceBoost;
+}
+
+} // namespace
+
+void optimizeVertexCache(Span<int> indices, int nodeCount)
+{
+    const int triangleCount = int(indices.size() / 3);
+    if (triangleCount == 0 || nodeCount <= 0)
+        return;
+
+    // Triangles adjacent to each node, remaining(not yet added) ones are at the front
+    std::vector<int> vecNodeTriangleOffset(nodeCount + 1, 0);
+    for (int i = 0; i < 3 * triangleCount; ++i)
+        ++vecNodeTriangleOffset.at(indices[i] + 1);
+
+    std::partial_sum(
+        vecNodeTriangleOffset.begin(), vecNodeTriangleOffset.end(), vecNodeTriangleOffset.begin());
+    std::vector<int> vecNodeTriangle(3 * triangleCount);
+    std::vector<int> vecNodeRemainingCount(nodeCount, 0);
+    for (int i = 0; i < 3 * triangleCount; ++i)
+    {
+        const int node = indices[i];
+        vecNodeTriangle[vecNodeTriangleOffset[node] + vecNodeRemainingCount[node]++] = i / 3;
+    }
+
+    std::vector<int> vecNodeCachePos(nodeCount, -1);
+    std::vector<float> vecNodeScore(nodeCount);
+    for (int node = 0; node < nodeCount; ++node)
+        vecNodeScore[node] = forsythNodeScore(-1, vecNodeRemainingCount[node]);
+
+    std::vector<float> vecTriangleScore(triangleCount);
+    std::vector<bool> vecTriangleAdded(triangleCount, false);
+    int bestTriangle = -1;
+    for (int tri = 0; tri < triangleCount; ++tri)
+    {
+        const int *triNodes = &indices[3 * tri];
+        vecTriangleScore[tri] =
+            vecNodeScore[triNodes[0]] + vecNodeScore[triNodes[1]] + vecNodeScore[triNodes[2]];
+        if (bestTriangle < 0 || vecTriangleScore[tri] > vecTriangleScore[bestTriangle])
+            bestTriangle = tri;
+    }
+
+    std::vector<int> cache;
+    std::vector<int> nextCache;
+    cache.reserve(ForsythCacheSize + 3);
+    nextCache.reserve(ForsythCacheSize + 3);
+    std::vector<int> vecOutput;
+    vecOutput.reserve(3 * triangleCount);
+    int scanTriangle = 0; // Fallback when no triangle adjacent to cached nodes is left
+    for (int iOutput = 0; iOutput < triangleCount; ++iOutput)
+    {
+        if (bestTriangle < 0)
+        {
+            while (vecTriangleAdded[scanTriangle])
+                ++scanTriangle;
+
+            bestTriangle = scanTriangle;
+        }
+
+        // Add best triangle and detach it from its nodes
+        vecTriangleAdded[bestTriangle] = true;
+        const int *triNodes = &indices[3 * bestTriangle];
+        vecOutput.insert(vecOutput.end(), triNodes, triNodes + 3);
+        for (int k = 0; k < 3; ++k)
+        {
+            const int node = triNodes[k];
+            int *nodeTriBegin = vecNodeTriangle.data() + vecNodeTriangleOffset[node];
+            int *nodeTriEnd = nodeTriBegin + vecNodeRemainingCount[node];
+            int *itTri = std::find(nodeTriBegin, nodeTriEnd, bestTriangle);
+            if (itTri != nodeTriEnd)
+            {
+                std::swap(*itTri, *(nodeTriEnd - 1));
+                --vecNodeRemainingCount[node];
+            }
+        }
+
+        // Move triangle nodes at the front of the LRU cache
+        nextCache.assign(triNodes, triNodes + 3);
+        for (int node : cache)
+        {
+            if (node != triNodes[0] && node != triNodes[1] && node != triNodes[2])
+                nextCache.push_back(node);
+        }
+
+        for (size_t pos = 0; pos < nextCache.size(); ++pos)
+        {
+            const int node = nextCache[pos];
+            vecNodeCachePos[node] = pos < ForsythCacheSize ? int(pos) : -1;
+            vecNodeScore[node] =
+                forsythNodeScore(vecNodeCachePos[node], vecNodeRemainingCount[node]);
+        }
+
+        // Update scores of the triangles affected, pick the next best one
+        bestTriangle = -1;
+        float bestScore = -1.f;
+        for (int node : nextCache)
+        {
+            const int *nodeTriBegin = vecNodeTriangle.data() + vecNodeTriangleOffset[node];
+            const int *nodeTriEnd = nodeTriBegin + vecNodeRemainingCount[node];
+            for (const int *itTri = nodeTriBegin; itTri != nodeTriEnd; ++itTri)
+            {
+                const int *adjNodes = &indices[3 * (*itTri)];
+                const float score = vecNodeScore[adjNodes[0]] + vecNodeScore[adjNodes[1]]
+                                    + vecNodeScore[adjNodes[2]];
+                vecTriangleScore[*itTri] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = *itTri;
+                }
+            }
+        }
+
+        if (nextCache.size() > size_t(ForsythCacheSize))
+            nextCache.resize(ForsythCacheSize);
+
+        cache.swap(nextCache);
+    }
+
+    std::copy(vecOutput.cbegin(), vecOutput.cend(), indices.begin());
+}
+
+std::vector<int> optimizeVertexFetch(Span<int> indices, int nodeCount)
+{
+    std::vector<int> vecNewIndex(nodeCount, -1);
+    int nextIndex = 0;
+    for (int &index : indices)
+    {
+        int &newIndex = vecNewIndex.at(index);
+        if (newIndex < 0)
+            newIndex = nextIndex++;
+
+        index = newIndex;
+    }
+
+    for (int &newIndex : vecNewIndex)
+    {
+        if (newIndex < 0)
+            newIndex = nextIndex++;
+    }
+
+    return vecNewIndex;
+}
+
+double averageCacheMissRatio(Span<const int> indices, int nodeCount, int cacheSize)
+{
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || nodeCount <= 0 || cacheSize <= 0)
+        return 0.;
+
+    // Timestamp based FIFO: a node is in cache if inserted at most 'cacheSize' misses ago
+    std::vector<int64_t> vecNodeTimestamp(nodeCount, -int64_t(cacheSize) - 1);
+    int64_t missCount = 0;
+    for (int index : indices)
+    {
+        if (missCount - vecNodeTimestamp.at(index) > cacheSize)
+            vecNodeTimestamp.at(index) = missCount++;
+    }
+
+    return missCount / double(triangleCount);
+}
+
+OccHandle<Poly_Triangulation> optimizedTriangulation(
+    const OccHandle<Poly_Triangulation> &triangulation)
+{
+    const int nodeCount = triangulation->NbNodes();
+    const int triangleCount = triangulation->NbTriangles();
+    std::vector<int> vecIndex;
+    vecIndex.reserve(3 * triangleCount);
+    for (int i = 1; i <= triangleCount; ++i)
+    {
+        const Poly_Triangle &tri = triangulation->Triangle(i);
+        for (int k = 1; k <= 3; ++k)
+            vecIndex.push_back(tri.Value(k) - 1);
+    }
+
+    optimizeVertexCache(vecIndex, nodeCount);
+    const std::vector<int> vecNewIndex = optimizeVertexFetch(vecIndex, nodeCount);
+
+    const bool hasUvNodes = triangulation->HasUVNodes();
+    auto newTriangulation = makeOccHandle<Poly_Triangulation>(nodeCount, triangleCount, hasUvNodes);
+    newTriangulation->Deflection(triangulation->Deflection());
+    if (triangulation->HasNormals())
+        allocateNormals(newTriangulation);
+
+    for (int i = 1; i <= nodeCount; ++i)
+    {
+        const int newIndex = vecNewIndex[i - 1] + 1;
+        setNode(newTriangulation, newIndex, triangulation->Node(i));
+        if (hasUvNodes)
+        {
+            const gp_Pnt2d uv = triangulation->UVNode(i);
+            setUvNode(newTriangulation, newIndex, uv.X(), uv.Y());
+        }
+
+        if (triangulation->HasNormals())
+            setNormal(newTriangulation, newIndex, normal(triangulation, i));
+    }
+
+    for (int i = 1; i <= triangleCount; ++i)
+    {
+        const int *triNodes = &vecIndex[3 * (i - 1)];
+        setTriangle(
+            newTriangulation, i, Poly_Triangle(triNodes[0] + 1, triNodes[1] + 1, triNodes[2] + 1));
+    }
+
+    return newTriangulation;
+}
+
 // Adapted from http://cs.smith.edu/~jorourke/Code/polyorient.C
 MeshUtils::Orientation orientation(const AdaptorPolyline2d &polyline)
 {
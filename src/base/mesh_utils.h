@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <vector>
+
 #include <Poly_Polygon3D.hxx>
 #include <Poly_Triangulation.hxx>
 #include <Standard_Version.hxx>
 
 #include "occ_handle.h"
+#include "span.h"
 
 class gp_XYZ;
 
@@ -38,9 +41,41 @@ void setUvNode(const OccHandle<Poly_Triangulation> &triangulation, int index, do
 
 void allocateNormals(const OccHandle<Poly_Triangulation> &triangulation);
 
+// Direct access to the storage of triangulation data, allows bulk filling(eg straight from file
+// contents) instead of element by element
+// Functions return null if the data is empty or not stored in the expected form
+//     nodeCoordsData(): 3 double coordinates per node
+//     normalCoordsData(): 3 float coordinates per node normal
+//     triangleIndicesData(): 3 int node indices(1-based) per triangle
+//     uvNodeCoordsData(): 2 double coordinates per UV node
+double *nodeCoordsData(const OccHandle<Poly_Triangulation> &triangulation);
+float *normalCoordsData(const OccHandle<Poly_Triangulation> &triangulation);
+int *triangleIndicesData(const OccHandle<Poly_Triangulation> &triangulation);
+double *uvNodeCoordsData(const OccHandle<Poly_Triangulation> &triangulation);
+
 Poly_Triangulation_NormalType normal(const OccHandle<Poly_Triangulation> &triangulation, int index);
 const Poly_Array1OfTriangle &triangles(const OccHandle<Poly_Triangulation> &triangulation);
 
+// Functions below work on 'indices' holding 3 node indices(0-based) per triangle
+
+// Reorders triangles to improve the hit rate of the post-transform vertex cache of GPUs
+// Uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm
+void optimizeVertexCache(Span<int> indices, int nodeCount);
+
+// Renumbers nodes in the order they are first referenced by 'indices', improves locality of
+// vertex fetching. Unreferenced nodes are moved at the end
+// Returns the new index of each node
+std::vector<int> optimizeVertexFetch(Span<int> indices, int nodeCount);
+
+// Average count of nodes transformed per triangle with a FIFO vertex cache of size 'cacheSize'
+// Ranges from 0.5(best case) to 3(worst case)
+double averageCacheMissRatio(Span<const int> indices, int nodeCount, int cacheSize = 16);
+
+// Copy of 'triangulation' with triangles and nodes reordered for GPU rendering, see
+// optimizeVertexCache() and optimizeVertexFetch()
+OccHandle<Poly_Triangulation> optimizedTriangulation(
+    const OccHandle<Poly_Triangulation> &triangulation);
+
 enum class Orientation
 {
     Unknown,
@@ -35,9 +35,39 @@ PointCloudDataPtr PointCloudData::Set(const TDF_Label &label,
 {
     PointCloudDataPtr data = PointCloudData::Set(label);
     data->m_points = points;
+    data->m_octree.Nullify();
     return data;
 }
 
+PointCloudDataPtr PointCloudData::Set(const TDF_Label &label, const PointCloudOctreePtr &octree)
+{
+    PointCloudDataPtr data = PointCloudData::Set(label);
+    data->m_points.Nullify();
+    data->m_octree = octree;
+    return data;
+}
+
+bool PointCloudData::isNull() const
+{
+    return m_points.IsNull() && m_octree.IsNull();
+}
+
+int64_t PointCloudData::pointCount() const
+{
+    if (m_octree)
+        return m_octree->pointCount();
+
+    return m_points ? m_points->VertexNumber() : 0;
+}
+
+bool PointCloudData::hasColors() const
+{
+    if (m_octree)
+        return m_octree->hasColors();
+
+    return m_points ? m_points->HasVertexColors() : false;
+}
+
 const Standard_GUID &PointCloudData::ID() const
 {
     return PointCloudData::GetID();
@@ -47,7 +77,10 @@ void PointCloudData::Restore(const OccHandle<TDF_Attribute> &attribute)
 {
     auto data = PointCloudDataPtr::DownCast(attribute);
     if (data)
+    {
         m_points = data->m_points;
+        m_octree = data->m_octree;
+    }
 }
 
 OccHandle<TDF_Attribute> PointCloudData::NewEmpty() const
@@ -60,7 +93,10 @@ void PointCloudData::Paste(const OccHandle<TDF_Attribute> &into,
 {
     auto data = PointCloudDataPtr::DownCast(into);
     if (data)
+    {
         data->m_points = m_points;
+        data->m_octree = m_octree;
+    }
 }
 
 Standard_OStream &PointCloudData::Dump(Standard_OStream &ostr) const
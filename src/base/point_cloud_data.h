@@ -10,6 +10,7 @@
 #include <TDF_Attribute.hxx>
 
 #include "occ_handle.h"
+#include "point_cloud_octree.h"
 
 namespace Mayo
 {
@@ -20,6 +21,8 @@ DEFINE_STANDARD_HANDLE(PointCloudData, TDF_Attribute)
 using PointCloudDataPtr = OccHandle<PointCloudData>;
 
 // Provides a label attribute to store point cloud data
+// Points are either held in memory by a single array or stored in an out-of-core octree(for huge
+// point clouds)
 class PointCloudData : public TDF_Attribute
 {
 public:
@@ -27,12 +30,25 @@ public:
     static PointCloudDataPtr Set(const TDF_Label &label);
     static PointCloudDataPtr Set(const TDF_Label &label,
                                  const OccHandle<Graphic3d_ArrayOfPoints> &points);
+    static PointCloudDataPtr Set(const TDF_Label &label, const PointCloudOctreePtr &octree);
 
+    // Null if points are stored in octree()
     const OccHandle<Graphic3d_ArrayOfPoints> &points() const
     {
         return m_points;
     }
 
+    // Null if points are stored in points()
+    const PointCloudOctreePtr &octree() const
+    {
+        return m_octree;
+    }
+
+    // Helpers whatever the storage of points
+    bool isNull() const;
+    int64_t pointCount() const;
+    bool hasColors() const;
+
     // -- from TDF_Attribute
     const Standard_GUID &ID() const override;
     void Restore(const OccHandle<TDF_Attribute> &attribute) override;
@@ -45,6 +61,7 @@ public:
 
 private:
     OccHandle<Graphic3d_ArrayOfPoints> m_points;
+    PointCloudOctreePtr m_octree;
 };
 
 } // namespace Mayo
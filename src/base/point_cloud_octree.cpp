@@ -0,0 +1,662 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "point_cloud_octree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <string>
+#include <system_error>
+
+#include "cpp_utils.h"
+#include "math_utils.h"
+#include "task_manager.h"
+#include "task_parallel.h"
+#include "task_progress.h"
+#include "tkernel_utils.h"
+
+namespace Mayo
+{
+
+namespace
+{
+
+// Depth of the grid used to compute the keys of the points
+constexpr int MaxLevel = 20;
+// Maximum level of the partition into buckets, so at most 8^3 buckets
+constexpr int MaxPartitionLevel = 3;
+// Count of points read at once from temporary files
+constexpr size_t PointBatchSize = 64 * 1024;
+
+using Point = PointCloudOctree::Point;
+using Node = PointCloudOctree::Node;
+
+// Cubic grid enclosing all the points
+struct Grid
+{
+    double min[3] = {};
+    double size = 1.;
+
+    // Returns the cubic grid enclosing bounds [coordMin, coordMax], so that octree cells are
+    // cubes. Grid is slightly enlarged to contain the max coordinates
+    static Grid fromBounds(const float coordMin[3], const float coordMax[3])
+    {
+        Grid grid;
+        grid.size = 0.;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            grid.min[axis] = coordMin[axis];
+            grid.size = std::max(grid.size, double(coordMax[axis]) - coordMin[axis]);
+        }
+
+        grid.size = grid.size > 0. ? grid.size * 1.001 : 1.;
+        return grid;
+    }
+
+    // Returns the Morton code(Z-order) of the grid cell containing 'point' at MaxLevel
+    // Points sorted by key are grouped by octree cell at any level
+    uint64_t key(const Point &point) const
+    {
+        constexpr uint32_t cellMax = (1u << MaxLevel) - 1;
+        const double scale = (1u << MaxLevel) / this->size;
+        uint64_t key = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const double pos = (point.coords[axis] - this->min[axis]) * scale;
+            const auto cell = uint32_t(std::clamp(pos, 0., double(cellMax)));
+            for (int bit = 0; bit < MaxLevel; ++bit)
+                key |= uint64_t((cell >> bit) & 1) << (3 * bit + axis);
+        }
+
+        return key;
+    }
+
+    // Returns the bounding box of cell at 'level' identified by 'cellKey'(ie the point keys
+    // truncated to 'level')
+    Bnd_Box cellBox(int level, uint64_t cellKey) const
+    {
+        uint32_t cell[3] = {};
+        for (int bit = 0; bit < level; ++bit)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+                cell[axis] |= uint32_t((cellKey >> (3 * bit + axis)) & 1) << bit;
+        }
+
+        const double cellSize = this->size / (1u << level);
+        const double x = this->min[0] + cell[0] * cellSize;
+        const double y = this->min[1] + cell[1] * cellSize;
+        const double z = this->min[2] + cell[2] * cellSize;
+        Bnd_Box box;
+        box.Update(x, y, z, x + cellSize, y + cellSize, z + cellSize);
+        box.Enlarge(cellSize * 1e-6); // Absorbs rounding errors of the point keys
+        return box;
+    }
+};
+
+uint64_t cellKey(uint64_t pointKey, int level)
+{
+    return pointKey >> (3 * (MaxLevel - level));
+}
+
+// Returns an evenly distributed subsample of 'points', 'points' being sorted by key
+template <typename T, typename Fn>
+std::vector<Point> subsample(Span<const T> points, size_t sampleCount, Fn fnPoint)
+{
+    std::vector<Point> vecSample;
+    sampleCount = std::min(sampleCount, points.size());
+    vecSample.reserve(sampleCount);
+    for (size_t i = 0; i < sampleCount; ++i)
+        vecSample.push_back(fnPoint(points[(i * points.size()) / sampleCount]));
+
+    return vecSample;
+}
+
+FilePath makeUniqueFilepath(const FilePath &dirPath, const char *suffix)
+{
+    static std::atomic<unsigned> counter = 0;
+    std::random_device randomDevice;
+    const std::string filename = "pointcloud_" + std::to_string(randomDevice()) + "_"
+                                 + std::to_string(++counter) + suffix;
+    return dirPath / filename;
+}
+
+} // namespace
+
+PointCloudOctree::~PointCloudOctree()
+{
+    std::error_code ec;
+    if (!m_cacheFilepath.empty())
+        std_filesystem::remove(m_cacheFilepath, ec);
+}
+
+std::vector<int> PointCloudOctree::findNodes(int level, const Bnd_Box &region) const
+{
+    std::vector<int> vecNodeIndex;
+    if (m_vecNode.empty())
+        return vecNodeIndex;
+
+    std::vector<int> vecStack = {0};
+    while (!vecStack.empty())
+    {
+        const int nodeIndex = vecStack.back();
+        vecStack.pop_back();
+        const Node &node = m_vecNode.at(nodeIndex);
+        if (!region.IsVoid() && region.IsOut(node.box))
+            continue;
+
+        if (node.isLeaf || node.level >= level)
+        {
+            vecNodeIndex.push_back(nodeIndex);
+        }
+        else
+        {
+            for (auto it = std::rbegin(node.children); it != std::rend(node.children); ++it)
+            {
+                if (*it >= 0)
+                    vecStack.push_back(*it);
+            }
+        }
+    }
+
+    return vecNodeIndex;
+}
+
+int PointCloudOctree::findLevel(int64_t pointBudget) const
+{
+    int level = 0;
+    while (level < this->depth() && m_vecLevelPointCount.at(level + 1) <= pointBudget)
+        ++level;
+
+    return level;
+}
+
+bool PointCloudOctree::loadNodePoints(int nodeIndex, std::vector<Point> *points) const
+{
+    const Node &node = m_vecNode.at(nodeIndex);
+    points->resize(node.pointCount);
+    std::ifstream istr(m_cacheFilepath, std::ios::in | std::ios::binary);
+    return this->readNodePoints(istr, node, points->data());
+}
+
+OccHandle<Graphic3d_ArrayOfPoints> PointCloudOctree::loadPoints(Span<const int> nodes) const
+{
+    int64_t pointCount = 0;
+    for (int nodeIndex : nodes)
+        pointCount += m_vecNode.at(nodeIndex).pointCount;
+
+    OccHandle<Graphic3d_ArrayOfPoints> gfxPoints = new Graphic3d_ArrayOfPoints(
+        CppUtils::safeStaticCast<int>(pointCount), m_hasColors, false /*hasNormals*/);
+    std::ifstream istr(m_cacheFilepath, std::ios::in | std::ios::binary);
+    std::vector<Point> vecPoint;
+    for (int nodeIndex : nodes)
+    {
+        const Node &node = m_vecNode.at(nodeIndex);
+        vecPoint.resize(node.pointCount);
+        if (!this->readNodePoints(istr, node, vecPoint.data()))
+            return {};
+
+        for (const Point &point : vecPoint)
+        {
+            const float *coords = point.coords;
+            const int index = gfxPoints->AddVertex(coords[0], coords[1], coords[2]);
+            if (m_hasColors)
+            {
+                const Quantity_Color color(point.color[0] / 255., point.color[1] / 255.,
+                                           point.color[2] / 255.,
+                                           TKernelUtils::preferredRgbColorType());
+                gfxPoints->SetVertexColor(index, color);
+            }
+        }
+    }
+
+    return gfxPoints;
+}
+
+bool PointCloudOctree::readNodePoints(std::istream &istr, const Node &node, Point *points) const
+{
+    istr.seekg(std::streamoff(node.fileOffset));
+    istr.read(reinterpret_cast<char *>(points), std::streamsize(node.pointCount * sizeof(Point)));
+    return bool(istr);
+}
+
+// Cell of the octree at the partition level, built independently of the other buckets
+struct PointCloudOctree::Builder::Bucket
+{
+    uint64_t cellKey = 0;
+    int level = 0;
+    int64_t firstPointIndex = 0; // Position of bucket points in the partition file
+    int64_t pointCount = 0;
+    std::vector<Node> vecNode;   // Nodes of the bucket subtree, root is first
+};
+
+PointCloudOctree::Builder::Builder(bool hasColors)
+    : m_hasColors(hasColors),
+      m_cacheDirectory(Builder::defaultCacheDirectory())
+{
+}
+
+PointCloudOctree::Builder::~Builder()
+{
+    m_rawStream.close();
+    m_cacheStream.close();
+    std::error_code ec;
+    for (const FilePath &filepath : {m_rawFilepath, m_partitionFilepath, m_cacheFilepath})
+    {
+        if (!filepath.empty())
+            std_filesystem::remove(filepath, ec);
+    }
+}
+
+void PointCloudOctree::Builder::setMaxNodePointCount(uint32_t count)
+{
+    m_maxNodePointCount = std::max(count, 1u);
+}
+
+void PointCloudOctree::Builder::setBucketPointCount(uint32_t count)
+{
+    m_bucketPointCount = std::max(count, 1u);
+}
+
+void PointCloudOctree::Builder::setCacheDirectory(const FilePath &dirPath)
+{
+    m_cacheDirectory = dirPath;
+}
+
+bool PointCloudOctree::Builder::addPoints(const float *coords, const uint8_t *colors,
+                                          size_t count)
+{
+    if (!m_rawStream.is_open())
+    {
+        std::error_code ec;
+        std_filesystem::create_directories(m_cacheDirectory, ec);
+        m_rawFilepath = makeUniqueFilepath(m_cacheDirectory, ".raw");
+        m_rawStream.open(m_rawFilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!m_rawStream.is_open())
+            return false;
+    }
+
+    std::vector<Point> vecPoint(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Point &point = vecPoint.at(i);
+        std::copy(coords + 3 * i, coords + 3 * i + 3, point.coords);
+        if (m_hasColors)
+            std::copy(colors + 3 * i, colors + 3 * i + 3, point.color);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const bool isFirst = m_pointCount == 0 && i == 0;
+            const float coord = point.coords[axis];
+            m_coordMin[axis] = isFirst ? coord : std::min(m_coordMin[axis], coord);
+            m_coordMax[axis] = isFirst ? coord : std::max(m_coordMax[axis], coord);
+        }
+    }
+
+    m_rawStream.write(reinterpret_cast<const char *>(vecPoint.data()),
+                      std::streamsize(count * sizeof(Point)));
+    m_pointCount += int64_t(count);
+    return bool(m_rawStream);
+}
+
+PointCloudOctreePtr PointCloudOctree::Builder::build(TaskProgress *progress, int pctStart,
+                                                     int pctEnd)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    auto fnSetProgress = [=](double pct)
+    { progress->setValue(MathUtils::mappedValue(pct, 0, 100, pctStart, pctEnd)); };
+
+    m_rawStream.close();
+    if (m_pointCount == 0 || m_rawStream.fail())
+        return {};
+
+    const Grid grid = Grid::fromBounds(m_coordMin, m_coordMax);
+
+    // Partition points into buckets small enough to be built in memory
+    int partitionLevel = 0;
+    while (partitionLevel < MaxPartitionLevel
+           && m_pointCount / (int64_t(1) << (3 * partitionLevel)) > m_bucketPointCount)
+    {
+        ++partitionLevel;
+    }
+
+    std::vector<Bucket> vecBucket(size_t(1) << (3 * partitionLevel));
+    {
+        std::ifstream rawStream(m_rawFilepath, std::ios::in | std::ios::binary);
+        std::vector<Point> vecPoint;
+        auto fnReadRawPoints = [&](const std::function<void(const Point &)> &fnPoint)
+        {
+            rawStream.clear();
+            rawStream.seekg(0);
+            for (int64_t i = 0; i < m_pointCount; i += PointBatchSize)
+            {
+                vecPoint.resize(size_t(std::min<int64_t>(PointBatchSize, m_pointCount - i)));
+                rawStream.read(reinterpret_cast<char *>(vecPoint.data()),
+                               std::streamsize(vecPoint.size() * sizeof(Point)));
+                if (!rawStream || TaskProgress::isAbortRequested(progress))
+                    return false;
+
+                for (const Point &point : vecPoint)
+                    fnPoint(point);
+            }
+
+            return true;
+        };
+
+        auto fnBucketIndex = [&](const Point &point)
+        { return size_t(cellKey(grid.key(point), partitionLevel)); };
+
+        // Count points of each bucket
+        if (!fnReadRawPoints([&](const Point &pnt) { ++vecBucket[fnBucketIndex(pnt)].pointCount; }))
+            return {};
+
+        int64_t firstPointIndex = 0;
+        for (size_t i = 0; i < vecBucket.size(); ++i)
+        {
+            Bucket &bucket = vecBucket.at(i);
+            bucket.cellKey = i;
+            bucket.level = partitionLevel;
+            bucket.firstPointIndex = firstPointIndex;
+            firstPointIndex += bucket.pointCount;
+        }
+
+        fnSetProgress(10);
+
+        // Scatter points into the partition file, by bucket
+        // Points are buffered per bucket to avoid many small writes
+        m_partitionFilepath = makeUniqueFilepath(m_cacheDirectory, ".part");
+        std::error_code ec;
+        std::ofstream(m_partitionFilepath, std::ios::out | std::ios::binary);
+        std_filesystem::resize_file(m_partitionFilepath, m_pointCount * sizeof(Point), ec);
+        std::ofstream partitionStream(m_partitionFilepath,
+                                      std::ios::in | std::ios::out | std::ios::binary);
+        if (ec || !partitionStream.is_open())
+            return {};
+
+        constexpr size_t BucketBufferSize = 2048;
+        std::vector<std::vector<Point>> vecBucketBuffer(vecBucket.size());
+        std::vector<int64_t> vecBucketWriteIndex(vecBucket.size());
+        for (size_t i = 0; i < vecBucket.size(); ++i)
+            vecBucketWriteIndex.at(i) = vecBucket.at(i).firstPointIndex;
+
+        auto fnFlushBucketBuffer = [&](size_t bucketIndex)
+        {
+            std::vector<Point> &buffer = vecBucketBuffer.at(bucketIndex);
+            int64_t &writeIndex = vecBucketWriteIndex.at(bucketIndex);
+            partitionStream.seekp(std::streamoff(writeIndex * sizeof(Point)));
+            partitionStream.write(reinterpret_cast<const char *>(buffer.data()),
+                                  std::streamsize(buffer.size() * sizeof(Point)));
+            writeIndex += int64_t(buffer.size());
+            buffer.clear();
+        };
+        const bool okScatter = fnReadRawPoints(
+            [&](const Point &point)
+            {
+                const size_t bucketIndex = fnBucketIndex(point);
+                std::vector<Point> &buffer = vecBucketBuffer.at(bucketIndex);
+                buffer.push_back(point);
+                if (buffer.size() >= BucketBufferSize)
+                    fnFlushBucketBuffer(bucketIndex);
+            });
+        if (!okScatter)
+            return {};
+
+        for (size_t i = 0; i < vecBucket.size(); ++i)
+            fnFlushBucketBuffer(i);
+
+        partitionStream.close();
+        if (partitionStream.fail())
+            return {};
+    }
+
+    // Raw points are no longer needed
+    std::error_code ec;
+    std_filesystem::remove(m_rawFilepath, ec);
+    m_rawFilepath.clear();
+    fnSetProgress(30);
+
+    m_cacheFilepath = makeUniqueFilepath(m_cacheDirectory, ".octree");
+    m_cacheStream.open(m_cacheFilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_cacheStream.is_open())
+        return {};
+
+    // Build bucket subtrees in parallel, a single bucket per chunk
+    {
+        std::vector<Bucket *> vecFilledBucket;
+        for (Bucket &bucket : vecBucket)
+        {
+            if (bucket.pointCount != 0)
+                vecFilledBucket.push_back(&bucket);
+        }
+
+        TaskManager taskMgr;
+        std::atomic<bool> okBuckets = true;
+        const ChunkedRange range(vecFilledBucket.size(), vecFilledBucket.size());
+        auto fnPercent = [=](double pct)
+        { return int(MathUtils::mappedValue(pct, 0, 100, pctStart, pctEnd)); };
+        const bool okBuild = parallelForChunks(
+            taskMgr, range,
+            [&](size_t, size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (!this->buildBucket(vecFilledBucket.at(i)))
+                        okBuckets = false;
+                }
+            },
+            progress, fnPercent(30), fnPercent(90));
+        if (!okBuild || !okBuckets)
+            return {};
+    }
+
+    std_filesystem::remove(m_partitionFilepath, ec);
+    m_partitionFilepath.clear();
+
+    // Assemble the octree, nodes above partition level are built from the bucket subtrees
+    PointCloudOctreePtr octree = new PointCloudOctree;
+    m_cacheStream.flush();
+    std::ifstream cacheStream(m_cacheFilepath, std::ios::in | std::ios::binary);
+    std::function<int(int, uint64_t)> fnBuildNode = [&](int level, uint64_t key) -> int
+    {
+        std::vector<Node> &vecNode = octree->m_vecNode;
+        if (level == partitionLevel)
+        {
+            Bucket &bucket = vecBucket.at(size_t(key));
+            if (bucket.vecNode.empty())
+                return -1;
+
+            const int nodeOffset = int(vecNode.size());
+            for (Node node : bucket.vecNode)
+            {
+                for (int &childIndex : node.children)
+                    childIndex = childIndex >= 0 ? childIndex + nodeOffset : -1;
+
+                vecNode.push_back(node);
+            }
+
+            bucket.vecNode = {};
+            return nodeOffset;
+        }
+
+        const int nodeIndex = int(vecNode.size());
+        vecNode.emplace_back();
+        int childCount = 0;
+        for (int octant = 0; octant < 8; ++octant)
+        {
+            const int childIndex = fnBuildNode(level + 1, (key << 3) | uint64_t(octant));
+            vecNode.at(nodeIndex).children[octant] = childIndex;
+            childCount += childIndex >= 0 ? 1 : 0;
+        }
+
+        if (childCount == 0)
+        {
+            vecNode.pop_back();
+            return -1;
+        }
+
+        // Node points are taken from the child nodes, in proportion to their point counts
+        Node &node = vecNode.at(nodeIndex);
+        node.box = grid.cellBox(level, key);
+        node.level = level;
+        node.isLeaf = false;
+        for (int childIndex : node.children)
+        {
+            if (childIndex >= 0)
+                node.subtreePointCount += vecNode.at(childIndex).subtreePointCount;
+        }
+
+        std::vector<Point> vecNodePoint;
+        for (int childIndex : node.children)
+        {
+            if (childIndex < 0)
+                continue;
+
+            const Node &child = vecNode.at(childIndex);
+            std::vector<Point> vecChildPoint(child.pointCount);
+            octree->readNodePoints(cacheStream, child, vecChildPoint.data());
+            const auto sampleCount = size_t(
+                (double(m_maxNodePointCount) * child.subtreePointCount) / node.subtreePointCount);
+            const std::vector<Point> vecSample = subsample(
+                Span<const Point>(vecChildPoint), std::max<size_t>(sampleCount, 1),
+                [](const Point &point) { return point; });
+            vecNodePoint.insert(vecNodePoint.end(), vecSample.cbegin(), vecSample.cend());
+        }
+
+        node.pointCount = uint32_t(vecNodePoint.size());
+        node.fileOffset = this->appendToCacheFile(vecNodePoint);
+        m_cacheStream.flush();
+        return nodeIndex;
+    };
+    fnBuildNode(0, 0);
+    m_cacheStream.close();
+    if (m_cacheStream.fail() || !cacheStream)
+        return {};
+
+    // Finalize octree
+    octree->m_cacheFilepath = m_cacheFilepath;
+    m_cacheFilepath.clear(); // Cache file is now owned by the octree
+    octree->m_pointCount = m_pointCount;
+    octree->m_hasColors = m_hasColors;
+    octree->m_box.Update(m_coordMin[0], m_coordMin[1], m_coordMin[2], m_coordMax[0],
+                         m_coordMax[1], m_coordMax[2]);
+    int depth = 0;
+    for (int i = 0; CppUtils::cmpLess(i, octree->m_vecNode.size()); ++i)
+    {
+        const Node &node = octree->m_vecNode.at(i);
+        depth = std::max(depth, node.level);
+        if (node.isLeaf)
+            octree->m_vecLeafNode.push_back(i);
+    }
+
+    for (int level = 0; level <= depth; ++level)
+    {
+        int64_t levelPointCount = 0;
+        for (int nodeIndex : octree->findNodes(level))
+            levelPointCount += octree->m_vecNode.at(nodeIndex).pointCount;
+
+        octree->m_vecLevelPointCount.push_back(levelPointCount);
+    }
+
+    fnSetProgress(100);
+    return octree;
+}
+
+FilePath PointCloudOctree::Builder::defaultCacheDirectory()
+{
+    std::error_code ec;
+    return std_filesystem::temp_directory_path(ec) / "mayo_pointcloud_cache";
+}
+
+bool PointCloudOctree::Builder::buildBucket(Bucket *bucket)
+{
+    struct KeyPoint
+    {
+        uint64_t key;
+        Point point;
+    };
+
+    const Grid grid = Grid::fromBounds(m_coordMin, m_coordMax);
+
+    // Load bucket points, then sort them along the Z-order curve
+    std::vector<KeyPoint> vecKeyPoint(size_t(bucket->pointCount));
+    {
+        std::vector<Point> vecPoint(size_t(bucket->pointCount));
+        std::ifstream istr(m_partitionFilepath, std::ios::in | std::ios::binary);
+        istr.seekg(std::streamoff(bucket->firstPointIndex * sizeof(Point)));
+        istr.read(reinterpret_cast<char *>(vecPoint.data()),
+                  std::streamsize(vecPoint.size() * sizeof(Point)));
+        if (!istr)
+            return false;
+
+        for (size_t i = 0; i < vecPoint.size(); ++i)
+            vecKeyPoint.at(i) = {grid.key(vecPoint.at(i)), vecPoint.at(i)};
+
+        std::sort(vecKeyPoint.begin(), vecKeyPoint.end(),
+                  [](const KeyPoint &lhs, const KeyPoint &rhs) { return lhs.key < rhs.key; });
+    }
+
+    // Points of a cell are contiguous, so nodes are built by recursive splitting of point ranges
+    auto fnPoint = [](const KeyPoint &keyPoint) { return keyPoint.point; };
+    std::function<int(Span<const KeyPoint>, int, uint64_t)> fnBuildNode =
+        [&](Span<const KeyPoint> points, int level, uint64_t key) -> int
+    {
+        const int nodeIndex = int(bucket->vecNode.size());
+        bucket->vecNode.emplace_back();
+        bucket->vecNode.back().box = grid.cellBox(level, key);
+        bucket->vecNode.back().level = level;
+        bucket->vecNode.back().subtreePointCount = int64_t(points.size());
+
+        std::vector<Point> vecNodePoint;
+        if (points.size() <= m_maxNodePointCount || level == MaxLevel)
+        {
+            vecNodePoint = subsample(points, points.size(), fnPoint);
+        }
+        else
+        {
+            bucket->vecNode.back().isLeaf = false;
+            const int shift = 3 * (MaxLevel - level - 1);
+            auto itChildBegin = points.begin();
+            for (int octant = 0; octant < 8; ++octant)
+            {
+                auto itChildEnd = std::partition_point(
+                    itChildBegin, points.end(), [=](const KeyPoint &keyPoint)
+                    { return int((keyPoint.key >> shift) & 7) <= octant; });
+                if (itChildEnd != itChildBegin)
+                {
+                    const Span<const KeyPoint> childPoints(&(*itChildBegin),
+                                                           size_t(itChildEnd - itChildBegin));
+                    const int childIndex =
+                        fnBuildNode(childPoints, level + 1, (key << 3) | uint64_t(octant));
+                    bucket->vecNode.at(nodeIndex).children[octant] = childIndex;
+                }
+
+                itChildBegin = itChildEnd;
+            }
+
+            vecNodePoint = subsample(points, m_maxNodePointCount, fnPoint);
+        }
+
+        Node &node = bucket->vecNode.at(nodeIndex);
+        node.pointCount = uint32_t(vecNodePoint.size());
+        node.fileOffset = this->appendToCacheFile(vecNodePoint);
+        return nodeIndex;
+    };
+    fnBuildNode(vecKeyPoint, bucket->level, bucket->cellKey);
+    return true;
+}
+
+uint64_t PointCloudOctree::Builder::appendToCacheFile(Span<const Point> points)
+{
+    std::lock_guard<std::mutex> lock(m_cacheStreamMutex);
+    const uint64_t fileOffset = m_cacheFileSize;
+    m_cacheStream.write(reinterpret_cast<const char *>(points.data()),
+                        std::streamsize(points.size() * sizeof(Point)));
+    m_cacheFileSize += points.size() * sizeof(Point);
+    return fileOffset;
+}
+
+} // namespace Mayo
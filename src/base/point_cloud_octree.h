@@ -0,0 +1,177 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <Bnd_Box.hxx>
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Standard_Transient.hxx>
+
+#include "filepath.h"
+#include "occ_handle.h"
+#include "span.h"
+
+namespace Mayo
+{
+
+class TaskProgress;
+
+// Pre-declarations
+class PointCloudOctree;
+DEFINE_STANDARD_HANDLE(PointCloudOctree, Standard_Transient)
+using PointCloudOctreePtr = OccHandle<PointCloudOctree>;
+
+// Level-of-detail storage of a point cloud, spatially organized as an octree
+// Points of the octree nodes are stored in a cache file on local disk and are loaded on demand,
+// so only the points actually needed(eg for display) are held in memory
+// Each inner node holds an evenly distributed subsample of the points in its cell, leaf nodes
+// hold all their points: the points of the leaf nodes make the whole point cloud
+class PointCloudOctree : public Standard_Transient
+{
+public:
+    // Point as stored in the cache file
+    struct Point
+    {
+        float coords[3];
+        uint8_t color[4]; // RGB components, 4th one is unused
+    };
+
+    struct Node
+    {
+        Bnd_Box box;                // Cell of the node
+        int level = 0;              // Depth of the node in the octree, root is at level 0
+        int children[8] = {-1, -1, -1, -1, -1, -1, -1, -1}; // Index of child nodes, -1 if none
+        bool isLeaf = true;
+        uint32_t pointCount = 0;    // Count of points stored for the node
+        int64_t subtreePointCount = 0; // Count of points in the cell
+        uint64_t fileOffset = 0;    // Position of the node points in the cache file
+    };
+
+    class Builder;
+
+    ~PointCloudOctree();
+
+    // Count of points in the whole point cloud
+    int64_t pointCount() const
+    {
+        return m_pointCount;
+    }
+
+    bool hasColors() const
+    {
+        return m_hasColors;
+    }
+
+    const Bnd_Box &box() const
+    {
+        return m_box;
+    }
+
+    // Maximum level of the octree nodes
+    int depth() const
+    {
+        return int(m_vecLevelPointCount.size()) - 1;
+    }
+
+    // Root node is the first one
+    Span<const Node> nodes() const
+    {
+        return m_vecNode;
+    }
+
+    // Index of the leaf nodes, in the order of their points in the cache file
+    Span<const int> leafNodes() const
+    {
+        return m_vecLeafNode;
+    }
+
+    // Finds the nodes providing the level of detail 'level' in 'region', ie the nodes at 'level'
+    // and the leaf nodes at lower levels. Void 'region' means the whole point cloud
+    std::vector<int> findNodes(int level, const Bnd_Box &region = {}) const;
+
+    // Returns the deepest level of detail whose point count is not greater than 'pointBudget'
+    int findLevel(int64_t pointBudget) const;
+
+    // Loads from the cache file the points of node at 'nodeIndex'
+    // Thread-safe, can be called concurrently
+    bool loadNodePoints(int nodeIndex, std::vector<Point> *points) const;
+
+    // Loads the points of 'nodes' in a single array, null in case of read error
+    OccHandle<Graphic3d_ArrayOfPoints> loadPoints(Span<const int> nodes) const;
+
+    DEFINE_STANDARD_RTTI_INLINE(PointCloudOctree, Standard_Transient)
+
+private:
+    PointCloudOctree() = default;
+    bool readNodePoints(std::istream &istr, const Node &node, Point *points) const;
+
+    FilePath m_cacheFilepath;
+    std::vector<Node> m_vecNode;
+    std::vector<int> m_vecLeafNode;
+    std::vector<int64_t> m_vecLevelPointCount; // Count of points of each level of detail
+    int64_t m_pointCount = 0;
+    bool m_hasColors = false;
+    Bnd_Box m_box;
+};
+
+// Builds a PointCloudOctree from points provided by batches
+// Points are spilled into temporary files as they are added, then they are partitioned into
+// buckets(octree cells) built in parallel. So memory usage depends on the bucket size and not on
+// the count of points
+class PointCloudOctree::Builder
+{
+public:
+    Builder(bool hasColors);
+    ~Builder(); // Deletes temporary files
+
+    // Maximum count of points stored in a node
+    void setMaxNodePointCount(uint32_t count);
+    // Targeted count of points in a bucket built in memory
+    void setBucketPointCount(uint32_t count);
+    // Directory where the cache file of the octree is created
+    void setCacheDirectory(const FilePath &dirPath);
+
+    // Appends points, 'coords' has 3 values per point and 'colors' 3 RGB components per point
+    // 'colors' is ignored if the builder has no colors
+    bool addPoints(const float *coords, const uint8_t *colors, size_t count);
+
+    // Builds the octree from the points added so far, reporting progress in [pctStart, pctEnd]
+    // Returns null on error or abort
+    PointCloudOctreePtr build(TaskProgress *progress, int pctStart = 0, int pctEnd = 100);
+
+    static FilePath defaultCacheDirectory();
+
+    // Disable copy
+    Builder(const Builder &) = delete;
+    Builder &operator=(const Builder &) = delete;
+
+private:
+    struct Bucket;
+    bool buildBucket(Bucket *bucket);
+    uint64_t appendToCacheFile(Span<const Point> points);
+
+    bool m_hasColors = false;
+    uint32_t m_maxNodePointCount = 64 * 1024;
+    uint32_t m_bucketPointCount = 4 * 1024 * 1024;
+    FilePath m_cacheDirectory;
+    FilePath m_rawFilepath;
+    FilePath m_partitionFilepath;
+    FilePath m_cacheFilepath;
+    std::ofstream m_rawStream;
+    std::ofstream m_cacheStream;
+    std::mutex m_cacheStreamMutex;
+    uint64_t m_cacheFileSize = 0;
+    int64_t m_pointCount = 0;
+    float m_coordMin[3] = {};
+    float m_coordMax[3] = {};
+};
+
+} // namespace Mayo
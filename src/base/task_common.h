@@ -24,4 +24,13 @@ enum class TaskAutoDestroy
     Off
 };
 
+// Scheduling priority of a task(see TaskManager::run())
+// Pending tasks of higher priority are started first
+enum class TaskPriority
+{
+    Low,
+    Normal,
+    High
+};
+
 } // namespace Mayo
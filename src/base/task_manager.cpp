@@ -6,19 +6,54 @@
 
 #include "task_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
-#include <future>
+#include <condition_variable>
+#include <deque>
+#include <gsl/util>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "cpp_utils.h"
 #include "math_utils.h"
+#include "task_thread_pool.h"
 
 namespace Mayo
 {
 
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Waits on 'condition' until 'fnPredicate' is satisfied or 'sleepTime' has elapsed
+// Clock::duration::max() means no time limit
+template<typename Predicate>
+void waitCondition(
+    std::condition_variable &condition, std::unique_lock<std::mutex> &lock,
+    Clock::duration sleepTime, Predicate fnPredicate)
+{
+    if (sleepTime == Clock::duration::max())
+        condition.wait(lock, fnPredicate);
+    else
+        condition.wait_for(lock, sleepTime, fnPredicate);
+}
+
+} // namespace
+
+// Execution state of a task run asynchronously
+// It's shared with the job queued in the thread pool, so it can outlive the task entity
+struct TaskManager::ExecState
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<bool> isPending = false; // Queued or running
+};
+
 // Helper struct providing all required data to manage a Task object
 struct TaskManager::Entity
 {
@@ -26,7 +61,7 @@ struct TaskManager::Entity
     TaskJob taskJob;
     TaskProgress taskProgress;
     std::string title;
-    std::future<void> control;
+    std::shared_ptr<ExecState> execState = std::make_shared<ExecState>();
     std::atomic<bool> isFinished = false;
     TaskAutoDestroy autoDestroy = TaskAutoDestroy::On;
 };
@@ -35,8 +70,9 @@ struct TaskManager::Entity
 struct TaskManager::Private
 {
     // Ctor
-    Private(TaskManager *mgr)
+    Private(TaskManager *mgr, TaskThreadPool *pool)
         : taskMgr(mgr)
+        , threadPool(pool)
     {
     }
 
@@ -52,12 +88,24 @@ struct TaskManager::Private
     void cleanGarbage();
 
     TaskManager *taskMgr = nullptr;
+    TaskThreadPool *threadPool = nullptr;
     std::atomic<TaskId> taskIdSeq = {};
     std::unordered_map<TaskId, std::unique_ptr<TaskManager::Entity>> mapEntity;
+
+    // Completion queue of tasks run with TaskAutoDestroy::Off, see waitForNextDone()
+    std::mutex completionMutex;
+    std::condition_variable completionCondition;
+    std::deque<TaskId> completionQueue; // Finished tasks not taken yet
+    int completionPendingCount = 0;     // Tasks queued or running
 };
 
 TaskManager::TaskManager()
-    : d(new Private(this))
+    : TaskManager(TaskThreadPool::current() ? TaskThreadPool::current() : TaskThreadPool::global())
+{
+}
+
+TaskManager::TaskManager(TaskThreadPool *pool)
+    : d(new Private(this, pool))
 {
 }
 
@@ -65,10 +113,11 @@ TaskManager::~TaskManager()
 {
     // Make sure all tasks are really finished
     for (const auto &mapPair : d->mapEntity)
+        this->waitForDone(mapPair.first);
+
     {
-        const std::unique_ptr<Entity> &ptrEntity = mapPair.second;
-        if (ptrEntity->control.valid())
-            ptrEntity->control.wait();
+        // Wait for the completion of any task still holding the completion queue
+        std::lock_guard<std::mutex> lock(d->completionMutex);
     }
 
     // Erase the task from its container before destruction, this will allow
@@ -92,16 +141,59 @@ TaskId TaskManager::newTask(TaskJob fn)
     return taskId;
 }
 
-void TaskManager::run(TaskId id, TaskAutoDestroy policy)
+void TaskManager::run(TaskId id, TaskAutoDestroy policy, TaskPriority priority)
 {
     d->cleanGarbage();
     Entity *entity = d->findEntity(id);
-    if (!entity)
+    if (!entity || entity->execState->isPending)
         return;
 
     entity->isFinished = false;
     entity->autoDestroy = policy;
-    entity->control = std::async([=] { d->execEntity(entity); });
+    std::shared_ptr<ExecState> execState = entity->execState;
+    execState->isPending = true;
+    // Auto-destroyed tasks can be deleted any time after completion, they are not queued
+    const bool isCompletionQueued = policy == TaskAutoDestroy::Off;
+    if (isCompletionQueued)
+    {
+        std::lock_guard<std::mutex> lock(d->completionMutex);
+        ++d->completionPendingCount;
+    }
+
+    d->threadPool->submit(
+        [=]
+        {
+            auto _ = gsl::finally(
+                [=]
+                {
+                    auto fnSetDone = [=]
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(execState->mutex);
+                            execState->isPending = false;
+                        }
+
+                        execState->condition.notify_all();
+                    };
+
+                    if (!isCompletionQueued)
+                    {
+                        fnSetDone();
+                        return;
+                    }
+
+                    // Manager can be destroyed as soon as the task is done, so 'd' is only
+                    // accessed while 'completionMutex' is locked(see ~TaskManager())
+                    std::lock_guard<std::mutex> lock(d->completionMutex);
+                    --d->completionPendingCount;
+                    d->completionQueue.push_back(id);
+                    fnSetDone();
+                    d->completionCondition.notify_all();
+                });
+            d->execEntity(entity);
+        },
+        priority,
+        this);
 }
 
 void TaskManager::exec(TaskId id, TaskAutoDestroy policy)
@@ -122,16 +214,81 @@ bool TaskManager::waitForDone(TaskId id, int msecs)
     if (!entity)
         return true;
 
-    if (!entity->control.valid())
-        return true;
+    const std::shared_ptr<ExecState> execState = entity->execState;
+    const auto timeout = std::chrono::milliseconds(msecs);
+    const auto startTime = Clock::now();
+    auto fnIsDone = [&] { return !execState->isPending; };
+    const bool isPoolWorker = TaskThreadPool::current() == d->threadPool;
+    while (!fnIsDone())
+    {
+        const auto elapsedTime = Clock::now() - startTime;
+        if (msecs >= 0 && elapsedTime >= timeout)
+            return false;
+
+        // Worker thread: run some pending job of this manager instead of sleeping, this can be
+        // the awaited task itself
+        if (isPoolWorker && d->threadPool->runPendingJob(this))
+            continue;
+
+        // Non-worker threads just sleep until task is done or timeout is reached
+        // Worker threads wake up regularly as new jobs might have been queued meanwhile
+        auto sleepTime = Clock::duration::max();
+        if (isPoolWorker)
+            sleepTime = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(5));
+
+        if (msecs >= 0)
+            sleepTime = std::min<Clock::duration>(sleepTime, timeout - elapsedTime);
+
+        std::unique_lock<std::mutex> lock(execState->mutex);
+        waitCondition(execState->condition, lock, sleepTime, fnIsDone);
+    }
 
-    if (msecs < 0)
+    return true;
+}
+
+TaskId TaskManager::waitForNextDone(int msecs)
+{
+    const auto timeout = std::chrono::milliseconds(msecs);
+    const auto startTime = Clock::now();
+    auto fnIsQueueReady = [=] { return !d->completionQueue.empty(); };
+    const bool isPoolWorker = TaskThreadPool::current() == d->threadPool;
+    for (;;)
     {
-        entity->control.wait();
-        return true;
+        {
+            std::unique_lock<std::mutex> lock(d->completionMutex);
+            if (fnIsQueueReady())
+            {
+                const TaskId id = d->completionQueue.front();
+                d->completionQueue.pop_front();
+                return id;
+            }
+
+            if (d->completionPendingCount == 0)
+                return TaskId_null;
+        }
+
+        const auto elapsedTime = Clock::now() - startTime;
+        if (msecs >= 0 && elapsedTime >= timeout)
+            return TaskId_null;
+
+        if (isPoolWorker && d->threadPool->runPendingJob(this))
+            continue;
+
+        auto sleepTime = Clock::duration::max();
+        if (isPoolWorker)
+            sleepTime = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(5));
+
+        if (msecs >= 0)
+            sleepTime = std::min<Clock::duration>(sleepTime, timeout - elapsedTime);
+
+        std::unique_lock<std::mutex> lock(d->completionMutex);
+        waitCondition(d->completionCondition, lock, sleepTime, fnIsQueueReady);
     }
+}
 
-    return entity->control.wait_for(std::chrono::milliseconds(msecs)) == std::future_status::ready;
+TaskThreadPool *TaskManager::threadPool() const
+{
+    return d->threadPool;
 }
 
 void TaskManager::requestAbort(TaskId id)
@@ -218,9 +375,7 @@ void TaskManager::Private::cleanGarbage()
         Entity *entity = it->second.get();
         if (entity->isFinished && entity->autoDestroy == TaskAutoDestroy::On)
         {
-            if (entity->control.valid())
-                entity->control.wait();
-
+            // execEntity() doesn't access the entity after 'isFinished' is set
             it = this->mapEntity.erase(it);
         }
         else
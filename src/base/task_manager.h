@@ -16,6 +16,8 @@
 namespace Mayo
 {
 
+class TaskThreadPool;
+
 // Piece of code to be executed as a task(ie with TaskManager::run/exec())
 using TaskJob = std::function<void(TaskProgress *)>;
 
@@ -24,7 +26,10 @@ class TaskManager
 {
 public:
     // Ctor & dtor
+    // Tasks are executed by the thread pool the calling thread is a worker of(ie nested tasks
+    // don't create more threads), otherwise by TaskThreadPool::global()
     TaskManager();
+    explicit TaskManager(TaskThreadPool *pool);
     ~TaskManager();
 
     // Not copyable
@@ -37,11 +42,12 @@ public:
 
     // Asynchronous execution of job associated with task identifier 'id'
     // By default destroy policy is set to 'On' meaning the task will be deleted
-    // at some point after its completion This function is based on std::async()
-    // so depending on the C++ stdlib implementation this is probably using a
-    // thread pool NOTE The task must have been allocated previously with
-    // newTask()
-    void run(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On);
+    // at some point after its completion
+    // The job is queued in the thread pool of the manager, pending jobs of higher 'priority'
+    // are started first
+    // NOTE The task must have been allocated previously with newTask()
+    void run(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On,
+             TaskPriority priority = TaskPriority::Normal);
 
     // Same as run() but execution of the task job is synchronous(it runs in the
     // current thread just like a regular function call)
@@ -59,8 +65,19 @@ public:
     void setTitle(TaskId id, std::string_view title);
 
     // Blocks the current thread until task of identifier 'id' has finished
+    // If the current thread is a worker of the thread pool then it meanwhile helps executing
+    // pending tasks of this manager, in which case 'msecs' can be overrun by one task duration
+    // Returns 'false' if task isn't finished after 'msecs' milliseconds
     bool waitForDone(TaskId id, int msecs = -1);
 
+    // Blocks the current thread until some task run with TaskAutoDestroy::Off has finished
+    // Returns the identifier of that task, tasks being returned once each in completion order
+    // Worker threads of the thread pool meanwhile help executing pending tasks of this manager
+    // Returns TaskId_null if there is no such task to wait for, or after 'msecs' milliseconds
+    TaskId waitForNextDone(int msecs = -1);
+
+    TaskThreadPool *threadPool() const;
+
     // Instructs the task of identifier 'id' to abort as soon as possible
     // Task interruption relies on the task job for this: it has to check
     // regularly the TaskProgress::isAbortRequested() flag and interrupt
@@ -88,6 +105,7 @@ public:
 
 private:
     struct Entity;
+    struct ExecState;
     struct Private;
     Private *const d = nullptr;
 };
@@ -0,0 +1,97 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "math_utils.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "task_thread_pool.h"
+
+namespace Mayo
+{
+
+// Contiguous ranges(chunks) covering [0, count)
+class ChunkedRange
+{
+public:
+    ChunkedRange(size_t count, size_t chunkCount)
+        : m_count(count)
+        , m_chunkCount(std::max<size_t>(chunkCount, 1))
+    {
+    }
+
+    // Chunks have at least 'grainSize' items, their count is bounded by the count of workers
+    // Null 'grainSize' is handled as 1
+    static ChunkedRange fromGrainSize(const TaskManager &taskMgr, size_t count, size_t grainSize)
+    {
+        const auto workerCount = size_t(std::max(taskMgr.threadPool()->workerCount(), 1));
+        grainSize = std::max<size_t>(grainSize, 1);
+        return ChunkedRange(count, std::clamp<size_t>(count / grainSize, 1, 4 * workerCount));
+    }
+
+    size_t chunkCount() const
+    {
+        return m_chunkCount;
+    }
+
+    size_t chunkBegin(size_t i) const
+    {
+        return (m_count * i) / m_chunkCount;
+    }
+
+    size_t chunkEnd(size_t i) const
+    {
+        return this->chunkBegin(i + 1);
+    }
+
+private:
+    size_t m_count = 0;
+    size_t m_chunkCount = 1;
+};
+
+// Calls 'fn(chunkIndex, begin, end)' for each chunk of 'range', chunks being processed in
+// parallel. Progress is reported in [pctStart, pctEnd], 'progress' can be null
+// Returns false if abort was requested
+template <typename Function>
+bool parallelForChunks(TaskManager &taskMgr, const ChunkedRange &range, Function fn,
+                       TaskProgress *progress, int pctStart, int pctEnd)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    std::atomic<bool> isAbortRequested = false;
+    for (size_t i = 0; i < range.chunkCount(); ++i)
+    {
+        const TaskId taskId = taskMgr.newTask(
+            [&, i](TaskProgress *)
+            {
+                if (!isAbortRequested)
+                    fn(i, range.chunkBegin(i), range.chunkEnd(i));
+            });
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+    }
+
+    size_t doneCount = 0;
+    while (doneCount < range.chunkCount())
+    {
+        if (taskMgr.waitForNextDone(100) != TaskId_null)
+        {
+            ++doneCount;
+            progress->setValue(
+                MathUtils::mappedValue(doneCount, 0, range.chunkCount(), pctStart, pctEnd));
+        }
+
+        if (TaskProgress::isAbortRequested(progress))
+            isAbortRequested = true;
+    }
+
+    return !isAbortRequested;
+}
+
+} // namespace Mayo
@@ -0,0 +1,241 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "task_thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mayo
+{
+
+namespace
+{
+
+// Pool and worker index of the current thread
+struct WorkerThreadInfo
+{
+    TaskThreadPool *pool = nullptr;
+    int workerIndex = -1;
+};
+
+thread_local WorkerThreadInfo currentWorkerThreadInfo;
+
+std::atomic<int> globalPoolWorkerCount = {};
+
+constexpr int PriorityCount = 3;
+
+struct PendingJob
+{
+    TaskThreadPool::Job job;
+    const void *group = nullptr;
+};
+
+// Queues of pending jobs, one per priority level
+struct JobQueue
+{
+    std::mutex mutex;
+    std::array<std::deque<PendingJob>, PriorityCount> arrayDeque;
+
+    std::deque<PendingJob> &deque(int priority)
+    {
+        return this->arrayDeque.at(priority);
+    }
+};
+
+} // namespace
+
+struct TaskThreadPool::Private
+{
+    // Pops the next job to be executed by worker 'workerIndex'
+    // Only jobs of 'group' are considered, unless 'group' is null
+    // Returns 'false' if there is no such pending job
+    bool popJob(int workerIndex, const void *group, Job *ptrJob);
+
+    // Entry function of worker threads
+    void runWorker(TaskThreadPool *pool, int workerIndex);
+
+    std::vector<std::unique_ptr<JobQueue>> vecWorkerQueue;
+    JobQueue sharedQueue;
+    std::vector<std::thread> vecThread;
+    std::atomic<int> pendingJobCount = {};
+    std::atomic<bool> stopRequested = {};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+};
+
+TaskThreadPool::TaskThreadPool(int workerCount)
+    : d(new Private)
+{
+    if (workerCount <= 0)
+        workerCount = std::max(1, int(std::thread::hardware_concurrency()));
+
+    for (int i = 0; i < workerCount; ++i)
+        d->vecWorkerQueue.push_back(std::make_unique<JobQueue>());
+
+    for (int i = 0; i < workerCount; ++i)
+        d->vecThread.emplace_back([=] { d->runWorker(this, i); });
+}
+
+TaskThreadPool::~TaskThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(d->sleepMutex);
+        d->stopRequested = true;
+    }
+
+    d->sleepCondition.notify_all();
+    for (std::thread &thread : d->vecThread)
+        thread.join();
+
+    delete d;
+}
+
+int TaskThreadPool::workerCount() const
+{
+    return int(d->vecThread.size());
+}
+
+void TaskThreadPool::submit(Job job, TaskPriority priority, const void *group)
+{
+    const WorkerThreadInfo &info = currentWorkerThreadInfo;
+    JobQueue &queue = info.pool == this ? *d->vecWorkerQueue.at(info.workerIndex) : d->sharedQueue;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.deque(int(priority)).push_back({std::move(job), group});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(d->sleepMutex);
+        ++d->pendingJobCount;
+    }
+
+    d->sleepCondition.notify_one();
+}
+
+bool TaskThreadPool::runPendingJob(const void *group)
+{
+    const WorkerThreadInfo &info = currentWorkerThreadInfo;
+    Job job;
+    if (info.pool != this || !group || !d->popJob(info.workerIndex, group, &job))
+        return false;
+
+    try
+    {
+        job();
+    }
+    catch (...)
+    { // Exception of some other job must not escape to the calling thread
+    }
+
+    return true;
+}
+
+TaskThreadPool *TaskThreadPool::current()
+{
+    return currentWorkerThreadInfo.pool;
+}
+
+TaskThreadPool *TaskThreadPool::global()
+{
+    static TaskThreadPool pool(globalPoolWorkerCount);
+    return &pool;
+}
+
+void TaskThreadPool::setGlobalWorkerCount(int count)
+{
+    globalPoolWorkerCount = count;
+}
+
+bool TaskThreadPool::Private::popJob(int workerIndex, const void *group, Job *ptrJob)
+{
+    auto fnIsCandidate = [=](const PendingJob &job) { return !group || job.group == group; };
+    auto fnPop = [=](JobQueue &queue, int priority, bool back)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        auto &deque = queue.deque(priority);
+        auto it = deque.end();
+        if (back)
+        {
+            auto itRev = std::find_if(deque.rbegin(), deque.rend(), fnIsCandidate);
+            it = itRev != deque.rend() ? std::prev(itRev.base()) : deque.end();
+        }
+        else
+        {
+            it = std::find_if(deque.begin(), deque.end(), fnIsCandidate);
+        }
+
+        if (it == deque.end())
+            return false;
+
+        *ptrJob = std::move(it->job);
+        deque.erase(it);
+        --this->pendingJobCount;
+        return true;
+    };
+
+    const int workerCount = int(this->vecWorkerQueue.size());
+    for (int priority = PriorityCount - 1; priority >= 0; --priority)
+    {
+        // Own queue first(LIFO, most recent jobs have their data still hot in cache)
+        if (fnPop(*this->vecWorkerQueue.at(workerIndex), priority, true))
+            return true;
+
+        if (fnPop(this->sharedQueue, priority, false))
+            return true;
+
+        // Steal the oldest job of some other worker
+        for (int i = 1; i <= workerCount; ++i)
+        {
+            const int victimIndex = (workerIndex + i) % workerCount;
+            if (victimIndex != workerIndex &&
+                fnPop(*this->vecWorkerQueue.at(victimIndex), priority, false))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TaskThreadPool::Private::runWorker(TaskThreadPool *pool, int workerIndex)
+{
+    currentWorkerThreadInfo.pool = pool;
+    currentWorkerThreadInfo.workerIndex = workerIndex;
+    for (;;)
+    {
+        Job job;
+        if (this->popJob(workerIndex, nullptr, &job))
+        {
+            try
+            {
+                job();
+            }
+            catch (...)
+            { // Exception must not escape worker thread
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->sleepMutex);
+        this->sleepCondition.wait(lock, [=]
+                                  { return this->stopRequested || this->pendingJobCount > 0; });
+        if (this->stopRequested && this->pendingJobCount == 0)
+            break;
+    }
+}
+
+} // namespace Mayo
@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+#include "task_common.h"
+
+namespace Mayo
+{
+
+// Fixed-size pool of worker threads executing jobs, with work stealing
+// Each worker owns a queue of jobs: jobs submitted from a worker thread are pushed into its
+// queue and executed in LIFO order, idle workers steal jobs from the other queues
+// Jobs submitted from non-worker threads go into a shared queue
+// Pending jobs of higher priority are always picked first
+// Jobs can be tagged with a group, so a worker waiting for some jobs only helps executing the
+// jobs of the same group(and not arbitrary jobs that may need locks held by the waiting thread)
+class TaskThreadPool
+{
+public:
+    using Job = std::function<void()>;
+
+    // 'workerCount' <= 0 means count of hardware threads
+    explicit TaskThreadPool(int workerCount = 0);
+    // Runs all pending jobs then joins worker threads
+    ~TaskThreadPool();
+
+    // Not copyable
+    TaskThreadPool(const TaskThreadPool &) = delete;
+    TaskThreadPool &operator=(const TaskThreadPool &) = delete;
+
+    int workerCount() const;
+
+    // Schedules asynchronous execution of 'job', 'group' being an optional tag identifying the
+    // jobs submitted by the same owner
+    void submit(Job job, TaskPriority priority = TaskPriority::Normal,
+                const void *group = nullptr);
+
+    // Runs in the calling thread some pending job of 'group', if any
+    // Meant to be called by worker threads waiting for completion of jobs of 'group'
+    // Returns 'false' if there was no such pending job
+    bool runPendingJob(const void *group);
+
+    // Returns the pool the calling thread is a worker of, or null
+    static TaskThreadPool *current();
+
+    // Returns the pool used by default by TaskManager objects
+    static TaskThreadPool *global();
+
+    // Sets count of worker threads of the global pool
+    // Must be called before first call to global(), no effect otherwise
+    static void setGlobalWorkerCount(int count);
+
+private:
+    struct Private;
+    Private *const d = nullptr;
+};
+
+} // namespace Mayo
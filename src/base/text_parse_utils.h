@@ -0,0 +1,128 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "task_manager.h"
+#include "task_parallel.h"
+
+namespace Mayo
+{
+
+// Provides helper functions to parse text contents, typically memory-mapped files
+namespace TextParseUtils
+{
+
+enum class CaseSensitivity
+{
+    Sensitive,
+    Insensitive
+};
+
+inline bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+inline std::string_view trimmedLeft(std::string_view str)
+{
+    while (!str.empty() && isSpace(str.front()))
+        str.remove_prefix(1);
+
+    return str;
+}
+
+inline std::string_view trimmed(std::string_view str)
+{
+    str = trimmedLeft(str);
+    while (!str.empty() && isSpace(str.back()))
+        str.remove_suffix(1);
+
+    return str;
+}
+
+// Returns pointer to the end of the line starting at 'p', ie the '\n' character or 'end'
+inline const char *findLineEnd(const char *p, const char *end)
+{
+    auto lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    return lineEnd ? lineEnd : end;
+}
+
+// Calls 'fn(line)' for each line in [begin, end), leading spaces are not part of 'line'
+// Iteration stops as soon as 'fn' returns false
+template <typename Function>
+void forEachLine(const char *begin, const char *end, Function fn)
+{
+    const char *pos = begin;
+    while (pos < end)
+    {
+        const char *lineEnd = findLineEnd(pos, end);
+        if (!fn(trimmedLeft(std::string_view(pos, lineEnd - pos))))
+            return;
+
+        pos = lineEnd + 1;
+    }
+}
+
+// Whether 'str' starts with word 'keyword', if so 'keyword' is removed from 'str'
+// With CaseSensitivity::Insensitive then 'keyword' is expected to be lower case
+inline bool consumeKeyword(std::string_view *str, std::string_view keyword,
+                           CaseSensitivity cs = CaseSensitivity::Sensitive)
+{
+    if (str->size() < keyword.size())
+        return false;
+
+    for (size_t i = 0; i < keyword.size(); ++i)
+    {
+        const char ch = cs == CaseSensitivity::Insensitive ? char(str->at(i) | 0x20) : str->at(i);
+        if (ch != keyword.at(i))
+            return false;
+    }
+
+    if (str->size() > keyword.size() && !isSpace(str->at(keyword.size())))
+        return false;
+
+    str->remove_prefix(keyword.size());
+    return true;
+}
+
+// Splits 'contents' into chunks of at least 'grainSize' bytes, each chunk ending at a line
+// boundary. Chunks are contiguous and cover 'contents' entirely
+inline std::vector<std::string_view> splitIntoLineChunks(const TaskManager &taskMgr,
+                                                         std::string_view contents,
+                                                         size_t grainSize)
+{
+    std::vector<std::string_view> vecChunk;
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, contents.size(), grainSize);
+    const char *contentsEnd = contents.data() + contents.size();
+    const char *chunkBegin = contents.data();
+    for (size_t i = 0; i < range.chunkCount(); ++i)
+    {
+        const char *chunkEnd = contentsEnd;
+        if (i + 1 < range.chunkCount())
+        {
+            const char *chunkEndHint = std::max(contents.data() + range.chunkEnd(i), chunkBegin);
+            chunkEnd = std::min(findLineEnd(chunkEndHint, contentsEnd) + 1, contentsEnd);
+        }
+
+        if (chunkEnd > chunkBegin)
+        {
+            vecChunk.emplace_back(chunkBegin, chunkEnd - chunkBegin);
+            chunkBegin = chunkEnd;
+        }
+    }
+
+    return vecChunk;
+}
+
+} // namespace TextParseUtils
+} // namespace Mayo
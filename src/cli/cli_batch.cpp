@@ -0,0 +1,139 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "cli_batch.h"
+
+#include <iterator>
+#include <system_error>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "base/filepath_conv.h"
+
+namespace Mayo
+{
+
+namespace
+{
+
+std::string jsonEscaped(std::string_view str)
+{
+    std::string strEscaped;
+    strEscaped.reserve(str.size());
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"': strEscaped += "\\\""; break;
+        case '\\': strEscaped += "\\\\"; break;
+        case '\n': strEscaped += "\\n"; break;
+        case '\r': strEscaped += "\\r"; break;
+        case '\t': strEscaped += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                fmt::format_to(std::back_inserter(strEscaped), "\\u{:04x}", int(c));
+            else
+                strEscaped += c;
+        }
+    }
+
+    return strEscaped;
+}
+
+} // namespace
+
+FilePath cli_batchOutputFilepath(std::string_view outputTemplate, const FilePath &inputFilepath)
+{
+    const std::string strDir = inputFilepath.parent_path().u8string();
+    const std::string strOutput =
+        fmt::format(fmt::runtime(outputTemplate), fmt::arg("dir", strDir.empty() ? "." : strDir),
+                    fmt::arg("filename", inputFilepath.filename().u8string()),
+                    fmt::arg("stem", inputFilepath.stem().u8string()),
+                    fmt::arg("ext", inputFilepath.extension().u8string()));
+    return filepathFrom(strOutput);
+}
+
+std::vector<std::pair<size_t, size_t>> cli_batchOutputConflicts(
+    Span<const BatchFileReport> reports)
+{
+    std::vector<std::pair<size_t, size_t>> vecConflict;
+    std::unordered_map<FilePath::string_type, size_t> mapOutputIndex;
+    for (const BatchFileReport &report : reports)
+    {
+        std::error_code ec;
+        const FilePath outputFilepath =
+            std_filesystem::absolute(report.outputFilepath, ec).lexically_normal();
+        const auto index = size_t(&report - &reports.front());
+        auto [it, isInserted] = mapOutputIndex.insert({outputFilepath.native(), index});
+        if (!isInserted)
+            vecConflict.push_back({it->second, index});
+    }
+
+    return vecConflict;
+}
+
+BatchSummary cli_batchSummary(Span<const BatchFileReport> reports, double duration)
+{
+    BatchSummary summary;
+    summary.fileCount = int(reports.size());
+    summary.duration = duration;
+    for (const BatchFileReport &report : reports)
+    {
+        summary.successCount += report.success ? 1 : 0;
+        summary.inputSize += report.inputSize;
+        summary.outputSize += report.outputSize;
+        summary.triangleCount += report.triangleCount;
+    }
+
+    if (duration > 0)
+    {
+        summary.filesPerSecond = summary.fileCount / duration;
+        summary.megaBytesPerSecond = (summary.inputSize / (1024. * 1024.)) / duration;
+    }
+
+    return summary;
+}
+
+std::string cli_batchReportToJson(const BatchSummary &summary,
+                                  Span<const BatchFileReport> reports, int workerCount)
+{
+    std::string json;
+    auto out = std::back_inserter(json);
+    fmt::format_to(out, "{{\n");
+    fmt::format_to(out, "  \"workerCount\": {},\n", workerCount);
+    fmt::format_to(out, "  \"fileCount\": {},\n", summary.fileCount);
+    fmt::format_to(out, "  \"successCount\": {},\n", summary.successCount);
+    fmt::format_to(out, "  \"failureCount\": {},\n", summary.fileCount - summary.successCount);
+    fmt::format_to(out, "  \"duration\": {:.3f},\n", summary.duration);
+    fmt::format_to(out, "  \"inputBytes\": {},\n", summary.inputSize);
+    fmt::format_to(out, "  \"outputBytes\": {},\n", summary.outputSize);
+    fmt::format_to(out, "  \"triangleCount\": {},\n", summary.triangleCount);
+    fmt::format_to(out, "  \"filesPerSecond\": {:.3f},\n", summary.filesPerSecond);
+    fmt::format_to(out, "  \"megaBytesPerSecond\": {:.3f},\n", summary.megaBytesPerSecond);
+    fmt::format_to(out, "  \"files\": [");
+    for (const BatchFileReport &report : reports)
+    {
+        fmt::format_to(out, "{}\n    {{", &report != &reports.front() ? "," : "");
+        fmt::format_to(out, "\"input\": \"{}\", ", jsonEscaped(report.inputFilepath.u8string()));
+        fmt::format_to(out, "\"output\": \"{}\", ", jsonEscaped(report.outputFilepath.u8string()));
+        fmt::format_to(out, "\"success\": {}, ", report.success);
+        fmt::format_to(out, "\"inputBytes\": {}, ", report.inputSize);
+        fmt::format_to(out, "\"outputBytes\": {}, ", report.outputSize);
+        fmt::format_to(out, "\"triangleCount\": {}, ", report.triangleCount);
+        fmt::format_to(out, "\"importDuration\": {:.3f}, ", report.importDuration);
+        fmt::format_to(out, "\"exportDuration\": {:.3f}", report.exportDuration);
+        if (!report.success)
+            fmt::format_to(out, ", \"error\": \"{}\"", jsonEscaped(report.errorMessage));
+
+        fmt::format_to(out, "}}");
+    }
+
+    fmt::format_to(out, "\n  ]\n}}\n");
+    return json;
+}
+
+} // namespace Mayo
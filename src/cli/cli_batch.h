@@ -0,0 +1,66 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/filepath.h"
+#include "base/span.h"
+
+namespace Mayo
+{
+
+// Conversion report of an input file in batch mode
+struct BatchFileReport
+{
+    FilePath inputFilepath;
+    FilePath outputFilepath;
+    uintmax_t inputSize = 0;
+    uintmax_t outputSize = 0;
+    int64_t triangleCount = 0;
+    double importDuration = 0; // Seconds
+    double exportDuration = 0; // Seconds
+    bool success = false;
+    std::string errorMessage;
+};
+
+// Totals of a batch conversion
+struct BatchSummary
+{
+    int fileCount = 0;
+    int successCount = 0;
+    uintmax_t inputSize = 0;
+    uintmax_t outputSize = 0;
+    int64_t triangleCount = 0;
+    double duration = 0; // Seconds
+    double filesPerSecond = 0;
+    double megaBytesPerSecond = 0; // Input bytes
+};
+
+// Returns the output path corresponding to 'inputFilepath' by expanding 'outputTemplate'
+// Supported placeholders are {dir} {filename} {stem} {ext}, eg "{dir}/out/{stem}.stl"
+// Throws fmt::format_error on invalid template
+FilePath cli_batchOutputFilepath(std::string_view outputTemplate, const FilePath &inputFilepath);
+
+// Returns the pairs of indices(in 'reports') of input files mapped to the same output file
+// The first index of a pair is the index of the first file mapped to that output
+// Output paths are compared once made absolute and normalized
+std::vector<std::pair<size_t, size_t>> cli_batchOutputConflicts(
+    Span<const BatchFileReport> reports);
+
+// Computes totals of 'reports', 'duration' being the elapsed time(seconds) of the whole batch
+BatchSummary cli_batchSummary(Span<const BatchFileReport> reports, double duration);
+
+// Returns batch conversion report in JSON format
+std::string cli_batchReportToJson(const BatchSummary &summary,
+                                  Span<const BatchFileReport> reports, int workerCount);
+
+} // namespace Mayo
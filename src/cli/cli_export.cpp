@@ -6,20 +6,30 @@
 
 #include "cli_export.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <QtCore/QtDebug>
 
 #include <Message.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Failure.hxx>
 #include <fmt/format.h>
 
 #include "app/app_module.h"
 #include "base/application.h"
+#include "base/filepath_conv.h"
 #include "base/io_system.h"
+#include "base/math_utils.h"
+#include "base/mesh_access.h"
 #include "base/messenger.h"
 #include "base/task_manager.h"
 #include "qtcommon/qstring_conv.h"
@@ -101,6 +111,52 @@ void printTaskProgress(Helper *helper, TaskId taskId)
     std::cout << "\n";
 }
 
+// Shows progress/traces corresponding to events of tasks managed by 'helper'
+void connectTaskReport(Helper *helper, bool progressReport)
+{
+    auto taskMgr = &helper->taskMgr;
+
+    // Helper function to print in console the progress info of all tasks
+    auto fnPrintProgress = [=]
+    {
+        consoleCursorMoveUp(helper->lastPrintProgressLineCount);
+        helper->lastPrintProgressLineCount = 0;
+        std::cout << "\r";
+        taskMgr->foreachTask([=](TaskId taskId) { printTaskProgress(helper, taskId); });
+        std::cout.flush();
+    };
+
+    taskMgr->signalStarted.connectSlot(
+        [=](TaskId taskId)
+        {
+            if (progressReport)
+                fnPrintProgress();
+            else
+                qInfo() << to_QString(taskMgr->title(taskId));
+        });
+    taskMgr->signalEnded.connectSlot(
+        [=](TaskId taskId)
+        {
+            if (progressReport)
+            {
+                fnPrintProgress();
+            }
+            else
+            {
+                if (helper->mapTaskStatus.at(taskId)->success)
+                    qInfo() << to_QString(taskMgr->title(taskId));
+                else
+                    qCritical() << to_QString(taskMgr->title(taskId));
+            }
+        });
+    taskMgr->signalProgressChanged.connectSlot(
+        [=]
+        {
+            if (progressReport)
+                fnPrintProgress();
+        });
+}
+
 bool importInDocument(DocumentPtr doc, const CliExportArgs &args, Helper *helper,
                       TaskProgress *progress)
 {
@@ -129,6 +185,8 @@ bool importInDocument(DocumentPtr doc, const CliExportArgs &args, Helper *helper
                                    { appModule->computeBRepMesh(labelEntity, progress); })
             .withEntityPostProcessRequiredIf([=](IO::Format) { return brepMeshRequired; })
             .withEntityPostProcessInfoProgress(20, CliExport::textIdTr("Mesh BRep shapes"))
+            .withParallelTransfer(true)
+            .withMemoryBudget(args.memoryBudget)
             .withMessenger(&errorCollect)
             .withTaskProgress(progress)
             .execute();
@@ -166,6 +224,110 @@ void exportDocument(const DocumentPtr &doc, const FilePath &filepath, Helper *he
     --(helper->exportTaskCount);
 }
 
+// Provides helper data that exists during execution of
+// cli_asyncBatchExportDocuments() function
+struct BatchHelper : public Helper
+{
+    // Reports of input files, in the order of CliBatchExportArgs::filesToOpen
+    std::vector<BatchFileReport> vecFileReport;
+    // Index of the next file to be processed by some worker task
+    std::atomic<int> nextFileIndex = {};
+    // Count of files processed so far
+    std::atomic<int> doneFileCount = {};
+    // Counter decremented for each finished worker task, when 0 is reached then
+    // quit
+    std::atomic<int> workerTaskCount = {};
+    // Serializes creation of documents, Application isn't thread-safe
+    std::mutex appMutex;
+    std::chrono::steady_clock::time_point startTime;
+    bool exited = false;
+};
+
+int64_t countTriangles(const DocumentPtr &doc)
+{
+    int64_t count = 0;
+    const ApplicationItem appItems[] = {doc};
+    IO::System::traverseUniqueItems(
+        appItems,
+        [&](const DocumentTreeNode &treeNode)
+        {
+            if (treeNode.isLeaf())
+            {
+                IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess &mesh)
+                                        { count += mesh.triangulation()->NbTriangles(); });
+            }
+        });
+    return count;
+}
+
+// Imports then exports file 'report->inputFilepath' within its own document
+void batchConvertFile(const ApplicationPtr &app, BatchHelper *helper, BatchFileReport *report)
+{
+    using Clock = std::chrono::steady_clock;
+    auto appModule = AppModule::get();
+    IO::System *ioSystem = appModule->ioSystem();
+    report->inputSize = filepathFileSize(report->inputFilepath);
+
+    // If export operation targets some mesh format then force meshing of imported
+    // BRep shapes
+    const IO::Format outputFormat = ioSystem->probeFormat(report->outputFilepath);
+    const bool brepMeshRequired = IO::formatProvidesMesh(outputFormat);
+
+    // Document isn't added to the application session, so it's released as soon as the
+    // file is converted
+    DocumentPtr doc;
+    {
+        std::lock_guard<std::mutex> lock(helper->appMutex);
+        doc = app->newScratchDocument();
+    }
+
+    MessageCollecter errorCollect;
+    errorCollect.only(MessageType::Error);
+    auto fnError = [&](std::string_view defaultMsg)
+    {
+        report->errorMessage = errorCollect.asString(" ");
+        if (report->errorMessage.empty())
+            report->errorMessage = defaultMsg;
+    };
+
+    const auto importStartTime = Clock::now();
+    const bool okImport =
+        ioSystem->importInDocument()
+            .targetDocument(doc)
+            .withFilepath(report->inputFilepath)
+            .withParametersProvider(appModule)
+            .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress *progress)
+                                   { appModule->computeBRepMesh(labelEntity, progress); })
+            .withEntityPostProcessRequiredIf([=](IO::Format) { return brepMeshRequired; })
+            .withEntityPostProcessInfoProgress(20, CliExport::textIdTr("Mesh BRep shapes"))
+            .withMessenger(&errorCollect)
+            .execute();
+    report->importDuration = std::chrono::duration<double>(Clock::now() - importStartTime).count();
+    if (!okImport)
+        return fnError(CliExport::textIdTr("Import failed"));
+
+    report->triangleCount = countTriangles(doc);
+    std::error_code ec;
+    if (report->outputFilepath.has_parent_path())
+        std_filesystem::create_directories(report->outputFilepath.parent_path(), ec);
+
+    const auto exportStartTime = Clock::now();
+    const ApplicationItem appItems[] = {doc};
+    const bool okExport = ioSystem->exportApplicationItems()
+                              .targetFile(report->outputFilepath)
+                              .targetFormat(outputFormat)
+                              .withItems(appItems)
+                              .withParameters(appModule->findWriterParameters(outputFormat))
+                              .withMessenger(&errorCollect)
+                              .execute();
+    report->exportDuration = std::chrono::duration<double>(Clock::now() - exportStartTime).count();
+    if (!okExport)
+        return fnError(CliExport::textIdTr("Export failed"));
+
+    report->outputSize = filepathFileSize(report->outputFilepath);
+    report->success = true;
+}
+
 } // namespace
 
 void cli_asyncExportDocuments(const ApplicationPtr &app, const CliExportArgs &args,
@@ -181,47 +343,7 @@ void cli_asyncExportDocuments(const ApplicationPtr &app, const CliExportArgs &ar
         fnContinuation(retCode);
     };
 
-    // Helper function to print in console the progress info of current function
-    auto fnPrintProgress = [=]
-    {
-        consoleCursorMoveUp(helper->lastPrintProgressLineCount);
-        helper->lastPrintProgressLineCount = 0;
-        std::cout << "\r";
-        taskMgr->foreachTask([=](TaskId taskId) { printTaskProgress(helper, taskId); });
-        std::cout.flush();
-    };
-
-    // Show progress/traces corresponding to task events
-    taskMgr->signalStarted.connectSlot(
-        [=](TaskId taskId)
-        {
-            if (args.progressReport)
-                fnPrintProgress();
-            else
-                qInfo() << to_QString(taskMgr->title(taskId));
-        });
-    taskMgr->signalEnded.connectSlot(
-        [=](TaskId taskId)
-        {
-            if (args.progressReport)
-            {
-                fnPrintProgress();
-            }
-            else
-            {
-                if (helper->mapTaskStatus.at(taskId)->success)
-                    qInfo() << to_QString(taskMgr->title(taskId));
-                else
-                    qCritical() << to_QString(taskMgr->title(taskId));
-            }
-        });
-    taskMgr->signalProgressChanged.connectSlot(
-        [=]
-        {
-            if (args.progressReport)
-                fnPrintProgress();
-        });
-
+    connectTaskReport(helper, args.progressReport);
     helper->exportTaskCount = int(args.filesToExport.size());
     taskMgr->signalEnded.connectSlot(
         [=]
@@ -272,4 +394,153 @@ void cli_asyncExportDocuments(const ApplicationPtr &app, const CliExportArgs &ar
         });
 }
 
+void cli_asyncBatchExportDocuments(const ApplicationPtr &app, const CliBatchExportArgs &args,
+                                   std::function<void(int)> fnContinuation)
+{
+    auto helper = new BatchHelper; // Allocated on heap because current function is asynchronous
+    auto taskMgr = &helper->taskMgr;
+    const int fileCount = int(args.filesToOpen.size());
+    const int workerCount = std::max(1, std::min(args.workerCount, fileCount));
+    helper->vecFileReport.resize(args.filesToOpen.size());
+    for (BatchFileReport &report : helper->vecFileReport)
+    {
+        report.inputFilepath = args.filesToOpen[&report - &helper->vecFileReport.front()];
+        report.outputFilepath = cli_batchOutputFilepath(args.outputTemplate, report.inputFilepath);
+    }
+
+    // Helper function to exit current function
+    auto fnExit = [=](int retCode)
+    {
+        helper->exited = true;
+        helper->deleteLater();
+        fnContinuation(retCode);
+    };
+
+    // Input files mapped to the same output file would overwrite each other's output, this is
+    // reported as an error before any conversion starts
+    const auto vecOutputConflict = cli_batchOutputConflicts(helper->vecFileReport);
+    for (const auto &[firstIndex, index] : vecOutputConflict)
+    {
+        const BatchFileReport &firstReport = helper->vecFileReport.at(firstIndex);
+        const BatchFileReport &report = helper->vecFileReport.at(index);
+        qCritical().noquote() << to_QString(fmt::format(
+            fmt::runtime(CliExport::textIdTr("Input files '{}' and '{}' have the same output "
+                                             "file '{}'")),
+            firstReport.inputFilepath.u8string(), report.inputFilepath.u8string(),
+            report.outputFilepath.u8string()));
+    }
+
+    if (!vecOutputConflict.empty())
+        return fnExit(EXIT_FAILURE);
+
+    // Helper function to write the report and exit once all files are processed
+    auto fnFinish = [=]
+    {
+        const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                              helper->startTime)
+                                    .count();
+        const BatchSummary summary = cli_batchSummary(helper->vecFileReport, duration);
+        for (const BatchFileReport &report : helper->vecFileReport)
+        {
+            if (!report.success)
+            {
+                qCritical().noquote() << to_QString(fmt::format("{}: {}",
+                                                                report.inputFilepath.u8string(),
+                                                                report.errorMessage));
+            }
+        }
+
+        const std::string strSummary = fmt::format(
+            fmt::runtime(CliExport::textIdTr("{}/{} file(s) converted in {:.2f}s "
+                                             "({:.2f} files/s, {:.2f} MB/s)")),
+            summary.successCount, summary.fileCount, summary.duration, summary.filesPerSecond,
+            summary.megaBytesPerSecond);
+        qInfo().noquote() << to_QString(strSummary);
+
+        bool okReport = true;
+        if (!args.reportFilepath.empty())
+        {
+            std::ofstream reportStream(args.reportFilepath);
+            reportStream << cli_batchReportToJson(summary, helper->vecFileReport, workerCount);
+            okReport = reportStream.good();
+            if (!okReport)
+            {
+                qCritical().noquote() << to_QString(
+                    fmt::format(fmt::runtime(CliExport::textIdTr("Failed to write report '{}'")),
+                                args.reportFilepath.u8string()));
+            }
+        }
+
+        const bool okBatch = okReport && summary.successCount == summary.fileCount;
+        fnExit(okBatch ? EXIT_SUCCESS : EXIT_FAILURE);
+    };
+
+    connectTaskReport(helper, args.progressReport);
+    helper->workerTaskCount = workerCount;
+    taskMgr->signalEnded.connectSlot(
+        [=]
+        {
+            if (helper->workerTaskCount == 0 && !helper->exited)
+                fnFinish();
+        });
+
+    // Suppress output from OpenCascade
+    Message::DefaultMessenger()->RemovePrinters(Message_Printer::get_type_descriptor());
+
+    if (fileCount == 0)
+        return fnFinish();
+
+    // Bounded pool of worker tasks, each one pulls the next input file until none remains
+    // Failure of some file doesn't interrupt conversion of the others
+    for (int i = 0; i < workerCount; ++i)
+    {
+        const TaskId taskId = taskMgr->newTask(
+            [=](TaskProgress *progress)
+            {
+                bool okWorker = true;
+                int convertedCount = 0;
+                int fileIndex = 0;
+                while (!progress->isAbortRequested() &&
+                       (fileIndex = helper->nextFileIndex++) < fileCount)
+                {
+                    BatchFileReport &report = helper->vecFileReport.at(fileIndex);
+                    const std::string strFilename = report.inputFilepath.filename().u8string();
+                    taskMgr->setTitle(
+                        progress->taskId(),
+                        fmt::format(fmt::runtime(CliExport::textIdTr("Converting {}...")),
+                                    strFilename));
+                    try
+                    {
+                        batchConvertFile(app, helper, &report);
+                    }
+                    catch (const Standard_Failure &err)
+                    {
+                        report.errorMessage = err.GetMessageString();
+                    }
+                    catch (const std::exception &err)
+                    {
+                        report.errorMessage = err.what();
+                    }
+
+                    okWorker = okWorker && report.success;
+                    convertedCount += report.success ? 1 : 0;
+                    progress->setValue(MathUtils::toPercent(++helper->doneFileCount, 0, fileCount));
+                }
+
+                taskMgr->setTitle(
+                    progress->taskId(),
+                    fmt::format(fmt::runtime(CliExport::textIdTr("Converted {} file(s)")),
+                                convertedCount));
+                helper->mapTaskStatus.at(progress->taskId())->success = okWorker;
+                helper->mapTaskStatus.at(progress->taskId())->finished = true;
+                --(helper->workerTaskCount);
+            });
+        helper->mapTaskStatus.insert({taskId, std::make_unique<TaskStatus>()});
+        taskMgr->setTitle(taskId, CliExport::textIdTr("Waiting..."));
+    }
+
+    helper->startTime = std::chrono::steady_clock::now();
+    taskMgr->foreachTask([=](TaskId taskId) { taskMgr->run(taskId, TaskAutoDestroy::Off); });
+}
+
 } // namespace Mayo
@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <string_view>
 
 #include "base/application_ptr.h"
 #include "base/filepath.h"
 #include "base/span.h"
 
+#include "cli_batch.h"
+
 namespace Mayo
 {
 
@@ -21,6 +26,8 @@ struct CliExportArgs
     bool progressReport = true;
     Span<const FilePath> filesToOpen;
     Span<const FilePath> filesToExport;
+    // Memory budget in bytes for reading input files, 0 means no limit
+    uint64_t memoryBudget = 0;
 };
 
 // Asynchronously exports input file(s) listed in 'args'
@@ -28,4 +35,23 @@ struct CliExportArgs
 void cli_asyncExportDocuments(const ApplicationPtr &app, const CliExportArgs &args,
                               std::function<void(int)> fnContinuation);
 
+// Contains arguments for the cli_asyncBatchExportDocuments() function
+struct CliBatchExportArgs
+{
+    bool progressReport = true;
+    // Each input file is imported then exported in its own document
+    Span<const FilePath> filesToOpen;
+    // Path of the output file, expanded for each input file with cli_batchOutputFilepath()
+    std::string outputTemplate;
+    // Maximum count of files processed concurrently
+    int workerCount = 1;
+    // Optional: path of the JSON report file
+    FilePath reportFilepath;
+};
+
+// Asynchronously converts input files listed in 'args', independently of each other
+// Calls 'fnContinuation' at the end of execution
+void cli_asyncBatchExportDocuments(const ApplicationPtr &app, const CliBatchExportArgs &args,
+                                   std::function<void(int)> fnContinuation);
+
 } // namespace Mayo
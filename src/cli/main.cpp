@@ -5,6 +5,7 @@
 ****************************************************************************/
 
 #include <common/mayo_version.h>
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
@@ -12,8 +13,11 @@
 
 #include <QtCore/QCommandLineParser>
 #include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QSettings>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 #include <QtCore/QTranslator>
 #include <QtCore/QtDebug>
@@ -26,6 +30,7 @@
 #include "base/application.h"
 #include "base/io_system.h"
 #include "base/settings.h"
+#include "base/task_thread_pool.h"
 #include "graphics/graphics_object_driver_mesh.h"
 #include "graphics/graphics_object_driver_point_cloud.h"
 #include "graphics/graphics_object_driver_shape.h"
@@ -33,11 +38,14 @@
 #include "gui/gui_application.h"
 #include "io_assimp/io_assimp.h"
 #include "io_dxf/io_dxf.h"
+#include "io_obj/io_obj_reader.h"
 #include "io_occ/io_occ.h"
 #include "io_off/io_off_reader.h"
 #include "io_off/io_off_writer.h"
 #include "io_ply/io_ply_reader.h"
 #include "io_ply/io_ply_writer.h"
+#include "io_stl/io_stl_reader.h"
+#include "io_stl/io_stl_writer.h"
 #include "qtbackend/qsettings_storage.h"
 #include "qtbackend/qt_app_translator.h"
 #include "qtbackend/qt_signal_thread_helper.h"
@@ -70,6 +78,10 @@ struct CommandLineArguments
     FilePath filepathLog;
     std::vector<FilePath> listFilepathToExport;
     std::vector<FilePath> listFilepathToOpen;
+    std::string batchOutputTemplate;
+    FilePath filepathBatchReport;
+    int batchWorkerCount = 0;
+    int importMemoryBudget = -1; // Megabytes, -1 if not set(then settings value is used)
     bool cacheUseSettings = false;
     bool includeDebugLogs = true;
     bool progressReport = true;
@@ -169,6 +181,48 @@ void showSystemInformation(std::ostream &ostr)
     ostr.flush();
 }
 
+// Expands input arguments of batch mode into a list of files
+// Directories are scanned recursively for files of supported formats, wildcards are
+// supported in the last component of path(eg. models/*.step)
+std::vector<FilePath> expandBatchInputFiles(Span<const FilePath> inputs)
+{
+    const IO::System *ioSystem = AppModule::get()->ioSystem();
+    std::vector<FilePath> vecFilepath;
+    for (const FilePath &input : inputs)
+    {
+        const QString strInput = filepathTo<QString>(input);
+        if (QFileInfo(strInput).isDir())
+        {
+            std::vector<FilePath> vecDirFilepath;
+            QDirIterator itDir(strInput, QDir::Files, QDirIterator::Subdirectories);
+            while (itDir.hasNext())
+            {
+                const FilePath filepath = filepathFrom(itDir.next());
+                if (ioSystem->probeFormat(filepath) != IO::Format_Unknown)
+                    vecDirFilepath.push_back(filepath);
+            }
+
+            std::sort(vecDirFilepath.begin(), vecDirFilepath.end());
+            vecFilepath.insert(vecFilepath.end(), vecDirFilepath.begin(), vecDirFilepath.end());
+        }
+        else if (strInput.contains(QChar('*')) || strInput.contains(QChar('?')))
+        {
+            const QFileInfo fileInfo(strInput);
+            const QDir dir = fileInfo.dir();
+            const QStringList listFilename =
+                dir.entryList(QStringList{fileInfo.fileName()}, QDir::Files, QDir::Name);
+            for (const QString &filename : listFilename)
+                vecFilepath.push_back(filepathFrom(dir.filePath(filename)));
+        }
+        else
+        {
+            vecFilepath.push_back(input);
+        }
+    }
+
+    return vecFilepath;
+}
+
 } // namespace
 
 // Parses command line and process Qt builtin options(basically --version and
@@ -215,6 +269,37 @@ static CommandLineArguments processCommandLine()
         Main::tr("filepath"));
     cmdParser.addOption(cmdFileToExport);
 
+    const QCommandLineOption cmdBatchOutput(
+        QStringList{"b", "batch-output"},
+        Main::tr("Batch mode: convert each input file independently into an output file "
+                 "whose path is built from template. Input can be files, directories or "
+                 "wildcard patterns. Template placeholders are {dir} {filename} {stem} {ext}"
+                 "(eg. -b {dir}/out/{stem}.stl)"),
+        Main::tr("template"));
+    cmdParser.addOption(cmdBatchOutput);
+
+    const QCommandLineOption cmdBatchJobs(
+        QStringList{"j", "jobs"},
+        Main::tr("Batch mode: maximum count of files converted concurrently(default: count of "
+                 "CPU cores)"),
+        Main::tr("count"));
+    cmdParser.addOption(cmdBatchJobs);
+
+    const QCommandLineOption cmdBatchReport(
+        QStringList{"batch-report"},
+        Main::tr("Batch mode: write conversion report(timings, sizes, throughput) into an "
+                 "output file(JSON format)"),
+        Main::tr("filepath"));
+    cmdParser.addOption(cmdBatchReport);
+
+    const QCommandLineOption cmdMemoryBudget(
+        QStringList{"memory-budget"},
+        Main::tr("Memory budget in megabytes for reading input files. Files are read "
+                 "concurrently as long as their estimated peak memory fits in the budget(default: "
+                 "value from application settings, 0 means no limit)"),
+        Main::tr("megabytes"));
+    cmdParser.addOption(cmdMemoryBudget);
+
     const QCommandLineOption cmdLogFile(QStringList{"log-file"},
                                         Main::tr("Writes log messages into output file"),
                                         Main::tr("filepath"));
@@ -265,6 +350,19 @@ static CommandLineArguments processCommandLine()
     for (const QString &posArg : cmdParser.positionalArguments())
         args.listFilepathToOpen.push_back(filepathFrom(posArg));
 
+    if (cmdParser.isSet(cmdBatchOutput))
+        args.batchOutputTemplate = to_stdString(cmdParser.value(cmdBatchOutput));
+
+    if (cmdParser.isSet(cmdBatchReport))
+        args.filepathBatchReport = filepathFrom(cmdParser.value(cmdBatchReport));
+
+    args.batchWorkerCount = QThread::idealThreadCount();
+    if (cmdParser.isSet(cmdBatchJobs))
+        args.batchWorkerCount = cmdParser.value(cmdBatchJobs).toInt();
+
+    if (cmdParser.isSet(cmdMemoryBudget))
+        args.importMemoryBudget = std::max(cmdParser.value(cmdMemoryBudget).toInt(), 0);
+
 #ifdef NDEBUG
     // By default this will exclude debug logs in release build
     args.includeDebugLogs = cmdParser.isSet(cmdDebugLogs);
@@ -370,10 +468,15 @@ static int runApp(QCoreApplication *qtApp)
     // Register I/O objects
     IO::System *ioSystem = appModule->ioSystem();
     ioSystem->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
+    // Native OBJ and STL readers take precedence over the OpenCascade ones
+    ioSystem->addFactoryReader(std::make_unique<IO::ObjFactoryReader>());
+    ioSystem->addFactoryReader(std::make_unique<IO::StlFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::OffFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::PlyFactoryReader>());
     ioSystem->addFactoryReader(IO::AssimpFactoryReader::create());
+    // Native STL writer takes precedence over the OpenCascade one
+    ioSystem->addFactoryWriter(std::make_unique<IO::StlFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::OffFactoryWriter>());
     ioSystem->addFactoryWriter(std::make_unique<IO::PlyFactoryWriter>());
@@ -386,6 +489,7 @@ static int runApp(QCoreApplication *qtApp)
     // Application settings
     appModule->settings()->resetAll();
     fnLoadAppSettings(appModule->settings());
+    appModule->restoreMemoryExpansionFactors();
 
     // Write cached settings to ouput file if asked by user
     if (!args.filepathWriteSettings.empty())
@@ -417,6 +521,38 @@ static int runApp(QCoreApplication *qtApp)
             exitCode = EXIT_FAILURE;
         }
     }
+    else if (!args.batchOutputTemplate.empty())
+    {
+        const std::vector<FilePath> listFilepathToOpen =
+            expandBatchInputFiles(args.listFilepathToOpen);
+        try
+        {
+            if (!listFilepathToOpen.empty())
+                cli_batchOutputFilepath(args.batchOutputTemplate, listFilepathToOpen.front());
+        }
+        catch (const fmt::format_error &err)
+        {
+            fnCriticalExit(Main::tr("Invalid batch output template '%1' [error=%2]")
+                               .arg(to_QString(args.batchOutputTemplate), err.what()));
+        }
+
+        // Batch workers are tasks running on the global thread pool, so it must not be smaller
+        TaskThreadPool::setGlobalWorkerCount(
+            std::max(args.batchWorkerCount, QThread::idealThreadCount()));
+        QTimer::singleShot(0, qtApp,
+                           [=, &listFilepathToOpen]
+                           {
+                               CliBatchExportArgs cliArgs;
+                               cliArgs.progressReport = args.progressReport;
+                               cliArgs.filesToOpen = listFilepathToOpen;
+                               cliArgs.outputTemplate = args.batchOutputTemplate;
+                               cliArgs.workerCount = args.batchWorkerCount;
+                               cliArgs.reportFilepath = args.filepathBatchReport;
+                               cli_asyncBatchExportDocuments(
+                                   app, cliArgs, [=](int retcode) { qtApp->exit(retcode); });
+                           });
+        exitCode = qtApp->exec();
+    }
     else
     {
         QTimer::singleShot(0, qtApp,
@@ -426,6 +562,10 @@ static int runApp(QCoreApplication *qtApp)
                                cliArgs.progressReport = args.progressReport;
                                cliArgs.filesToOpen = args.listFilepathToOpen;
                                cliArgs.filesToExport = args.listFilepathToExport;
+                               cliArgs.memoryBudget =
+                                   args.importMemoryBudget >= 0 ?
+                                       uint64_t(args.importMemoryBudget) * 1024 * 1024 :
+                                       appModule->importMemoryBudget();
                                cli_asyncExportDocuments(app, cliArgs,
                                                         [=](int retcode) { qtApp->exit(retcode); });
                            });
@@ -436,6 +576,7 @@ static int runApp(QCoreApplication *qtApp)
     {
         if (!args.filepathUseSettings.empty())
         {
+            appModule->recordMemoryExpansionFactors();
             appModule->settings()->save();
             qInfo().noquote() << Main::tr("Settings '%1' cached")
                                      .arg(filepathTo<QString>(args.filepathUseSettings));
@@ -16,6 +16,14 @@
 namespace Mayo
 {
 
+namespace
+{
+
+// Maximum count of points loaded for display from an octree point cloud
+constexpr int64_t OctreeDisplayPointBudget = 10 * 1000 * 1000;
+
+} // namespace
+
 GraphicsPointCloudObjectDriver::GraphicsPointCloudObjectDriver()
 {
 }
@@ -31,8 +39,20 @@ GraphicsObjectPtr GraphicsPointCloudObjectDriver::createObject(const TDF_Label &
     if (findLabelDataFlags(label) & LabelData_HasPointCloudData)
     {
         auto attrPointCloudData = CafUtils::findAttribute<PointCloudData>(label);
+        OccHandle<Graphic3d_ArrayOfPoints> points = attrPointCloudData->points();
+        const PointCloudOctreePtr &octree = attrPointCloudData->octree();
+        if (octree)
+        {
+            // Load only the octree nodes of the finest level of detail fitting the budget
+            const int level = octree->findLevel(OctreeDisplayPointBudget);
+            points = octree->loadPoints(octree->findNodes(level));
+        }
+
+        if (!points)
+            return {};
+
         auto object = new AIS_PointCloud;
-        object->SetPoints(attrPointCloudData->points());
+        object->SetPoints(points);
         object->SetOwner(this);
         return object;
     }
@@ -93,6 +93,8 @@ GuiDocument::GuiDocument(const DocumentPtr &doc, GuiApplication *guiApp)
     doc->signalEntityAdded.connectSlot(&GuiDocument::onDocumentEntityAdded, this);
     doc->signalEntityAboutToBeDestroyed.connectSlot(
         &GuiDocument::onDocumentEntityAboutToBeDestroyed, this);
+    doc->signalEntityGeometryChanged.connectSlot(&GuiDocument::onDocumentEntityGeometryChanged,
+                                                 this);
     m_gfxScene.signalSelectionChanged.connectSlot(&GuiDocument::onGraphicsSelectionChanged, this);
 }
 
@@ -574,6 +576,33 @@ void GuiDocument::onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId
     this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
 }
 
+void GuiDocument::onDocumentEntityGeometryChanged(TreeNodeId entityTreeNodeId)
+{
+    if (!this->findGraphicsEntity(entityTreeNodeId))
+        return;
+
+    // Graphics objects are created again, hidden nodes are kept hidden
+    std::vector<TreeNodeId> vecHiddenNodeId;
+    traverseTree(entityTreeNodeId, m_document->modelTree(),
+                 [&](TreeNodeId id)
+                 {
+                     if (this->nodeVisibleState(id) == CheckState::Off)
+                         vecHiddenNodeId.push_back(id);
+                 });
+    this->unmapEntity(entityTreeNodeId);
+    this->mapEntity(entityTreeNodeId);
+    for (TreeNodeId id : vecHiddenNodeId)
+        this->setNodeVisible(id, false);
+
+    m_gfxBoundingBox.SetVoid();
+    for (const GraphicsEntity &gfxEntity : m_vecGraphicsEntity)
+        BndUtils::add(&m_gfxBoundingBox, gfxEntity.bndBox);
+
+    GraphicsUtils::V3dView_fitAll(
+        m_v3dView, this->graphicsBoundingBox(OnlySelectedGraphics | OnlyVisibleGraphics));
+    this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
+}
+
 void GuiDocument::onGraphicsSelectionChanged()
 {
     m_guiApp->connectApplicationItemSelectionChanged(false);
@@ -177,6 +177,7 @@ public:
 private:
     void onDocumentEntityAdded(TreeNodeId entityTreeNodeId);
     void onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId);
+    void onDocumentEntityGeometryChanged(TreeNodeId entityTreeNodeId);
     void onGraphicsSelectionChanged();
 
     void mapEntity(TreeNodeId entityTreeNodeId);
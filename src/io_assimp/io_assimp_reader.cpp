@@ -8,6 +8,7 @@
 
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -15,6 +16,7 @@
 #include <Image_Texture.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TDataStd_Name.hxx>
+#include <TopLoc_Location.hxx>
 #include <XCAFDoc_VisMaterial.hxx>
 #include <XCAFDoc_VisMaterialCommon.hxx>
 #include <XCAFDoc_VisMaterialPBR.hxx>
@@ -35,6 +37,8 @@
 #include "base/occ_handle.h"
 #include "base/property.h"
 #include "base/string_conv.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
 #include "base/task_progress.h"
 #include "base/xcaf.h"
 
@@ -234,7 +238,8 @@ OccHandle<Image_Texture> createOccTexture(const aiTexture *texture)
 }
 
 // Create an OpenCascade Poly_Triangulation object from assimp mesh
-// The input 'mesh' is assumed to contain only triangles
+// Faces of 'mesh' which aren't triangles are ignored
+// Triangulation storage is filled directly, avoiding the overhead of per-element setters
 OccHandle<Poly_Triangulation> createOccTriangulation(const aiMesh *mesh)
 {
     assert(mesh != nullptr);
@@ -243,41 +248,51 @@ OccHandle<Poly_Triangulation> createOccTriangulation(const aiMesh *mesh)
     const unsigned textureIndex = 0;
     const bool hasUvNodes =
         mesh->HasTextureCoords(textureIndex) && mesh->mNumUVComponents[textureIndex] == 2;
-    auto triangulation =
-        makeOccHandle<Poly_Triangulation>(mesh->mNumVertices, mesh->mNumFaces, hasUvNodes);
+    const auto itFaceBegin = mesh->mFaces;
+    const auto itFaceEnd = mesh->mFaces + mesh->mNumFaces;
+    const auto triangleCount =
+        std::count_if(itFaceBegin, itFaceEnd, [](const aiFace &f) { return f.mNumIndices == 3; });
+    auto triangulation = makeOccHandle<Poly_Triangulation>(
+        int(mesh->mNumVertices), int(triangleCount), hasUvNodes);
+    if (mesh->HasNormals())
+        MeshUtils::allocateNormals(triangulation);
 
-    for (unsigned i = 0; i < mesh->mNumVertices; ++i)
+    double *nodeCoords = MeshUtils::nodeCoordsData(triangulation);
+    float *normalCoords = MeshUtils::normalCoordsData(triangulation);
+    double *uvNodeCoords = MeshUtils::uvNodeCoordsData(triangulation);
+    int *triIndices = MeshUtils::triangleIndicesData(triangulation);
+    for (unsigned i = 0; nodeCoords && i < mesh->mNumVertices; ++i)
     {
         const aiVector3D &vertex = mesh->mVertices[i];
-        MeshUtils::setNode(triangulation, i + 1, {vertex.x, vertex.y, vertex.z});
+        nodeCoords[3 * size_t(i)] = vertex.x;
+        nodeCoords[3 * size_t(i) + 1] = vertex.y;
+        nodeCoords[3 * size_t(i) + 2] = vertex.z;
     }
 
-    for (unsigned i = 0; i < mesh->mNumFaces; ++i)
+    for (unsigned i = 0; normalCoords && i < mesh->mNumVertices; ++i)
     {
-        const auto indices = mesh->mFaces[i].mIndices;
-        assert(mesh->mFaces[i].mNumIndices == 3);
-        MeshUtils::setTriangle(triangulation, i + 1,
-                               Poly_Triangle(indices[0] + 1, indices[1] + 1, indices[2] + 1));
+        const aiVector3D &normal = mesh->mNormals[i];
+        normalCoords[3 * size_t(i)] = normal.x;
+        normalCoords[3 * size_t(i) + 1] = normal.y;
+        normalCoords[3 * size_t(i) + 2] = normal.z;
     }
 
-    if (mesh->HasNormals())
+    for (unsigned i = 0; uvNodeCoords && i < mesh->mNumVertices; ++i)
     {
-        MeshUtils::allocateNormals(triangulation);
-        for (unsigned i = 0; i < mesh->mNumVertices; ++i)
-        {
-            using OccNormal = MeshUtils::Poly_Triangulation_NormalType;
-            const aiVector3D &normal = mesh->mNormals[i];
-            MeshUtils::setNormal(triangulation, i + 1, OccNormal{normal.x, normal.y, normal.z});
-        }
+        const aiVector3D &t = mesh->mTextureCoords[textureIndex][i];
+        uvNodeCoords[2 * size_t(i)] = t.x;
+        uvNodeCoords[2 * size_t(i) + 1] = t.y;
     }
 
-    if (hasUvNodes)
+    for (auto itFace = itFaceBegin; triIndices && itFace != itFaceEnd; ++itFace)
     {
-        for (unsigned i = 0; i < mesh->mNumVertices; i++)
-        {
-            const aiVector3D &t = mesh->mTextureCoords[textureIndex][i];
-            MeshUtils::setUvNode(triangulation, i + 1, t.x, t.y);
-        }
+        if (itFace->mNumIndices != 3)
+            continue; // Skip
+
+        const unsigned *indices = itFace->mIndices;
+        *triIndices++ = int(indices[0] + 1);
+        *triIndices++ = int(indices[1] + 1);
+        *triIndices++ = int(indices[2] + 1);
     }
 
     return triangulation;
@@ -297,8 +312,9 @@ public:
         if (TaskProgress::isAbortRequested(m_progress))
             return false;
 
+        // Remaining progress is for the conversion of assimp meshes
         if (percent > 0)
-            m_progress->setValue(percent * 100);
+            m_progress->setValue(percent * 80);
 
         return true;
     }
@@ -324,7 +340,9 @@ public:
 
 bool AssimpReader::readFile(const FilePath &filepath, TaskProgress *progress)
 {
+    progress = progress ? progress : &TaskProgress::null();
     m_vecTriangulation.clear();
+    m_vecMeshLabel.clear();
     m_vecMaterial.clear();
     m_mapMaterialLabel.clear();
     m_mapNodeData.clear();
@@ -372,15 +390,16 @@ bool AssimpReader::readFile(const FilePath &filepath, TaskProgress *progress)
     // Create OpenCascade elements from the assimp meshes
     //     mesh of triangles -> Poly_Triangulation
     //     mesh lines -> Poly_Polygon3D
+    // Meshes are independent, they are converted in parallel
     m_vecTriangulation.resize(m_scene->mNumMeshes);
     std::fill(m_vecTriangulation.begin(), m_vecTriangulation.end(), nullptr);
+    std::vector<unsigned> vecTriangleMeshIndex;
     for (unsigned i = 0; i < m_scene->mNumMeshes; ++i)
     {
         const aiMesh *mesh = m_scene->mMeshes[i];
         if (mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)
         {
-            auto triangulation = createOccTriangulation(mesh);
-            m_vecTriangulation.at(i) = triangulation;
+            vecTriangleMeshIndex.push_back(i);
         }
         else if (mesh->mPrimitiveTypes & aiPrimitiveType_LINE)
         {
@@ -395,6 +414,19 @@ bool AssimpReader::readFile(const FilePath &filepath, TaskProgress *progress)
         }
     }
 
+    TaskManager taskMgr;
+    auto fnConvertMeshes = [&](size_t /*iChunk*/, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const unsigned meshIndex = vecTriangleMeshIndex.at(i);
+            m_vecTriangulation.at(meshIndex) = createOccTriangulation(m_scene->mMeshes[meshIndex]);
+        }
+    };
+    const auto meshRange = ChunkedRange::fromGrainSize(taskMgr, vecTriangleMeshIndex.size(), 1);
+    if (!parallelForChunks(taskMgr, meshRange, fnConvertMeshes, progress, 80, 100))
+        return false;
+
     for (unsigned i = 0; i < m_scene->mNumTextures; ++i)
     {
         const aiTexture *texture = m_scene->mTextures[i];
@@ -421,6 +453,7 @@ TDF_LabelSequence AssimpReader::transfer(DocumentPtr doc, TaskProgress *progress
         return {};
 
     m_mapNodeData.clear();
+    m_vecMeshLabel.assign(m_scene->mNumMeshes, TDF_Label());
 
     // Compute data for each aiNode object in the scene
     deep_aiNodeVisit(m_scene->mRootNode,
@@ -757,6 +790,21 @@ void AssimpReader::transferSceneNode(const aiNode *node, DocumentPtr targetDoc,
         if (!triangulation)
             continue; // Skip
 
+        std::string shapeName = nodeName;
+        if (node->mNumMeshes > 1)
+        {
+            shapeName += "_";
+            if (mesh->mName.length > 0)
+                shapeName += mesh->mName.C_Str();
+            else
+                shapeName += "mesh" + std::to_string(imesh);
+        }
+
+        // All nodes referring to a mesh share the same prototype, each node being a located
+        // instance of it
+        auto shapeTool = targetDoc->xcaf().shapeTool();
+        TDF_Label labelFace;
+        bool isNewPrototype = false;
 #ifdef MAYO_ASSIMP_READER_HANDLE_SCALING
         if (hasScaleFactor(nodeScale))
         {
@@ -768,14 +816,31 @@ void AssimpReader::transferSceneNode(const aiNode *node, DocumentPtr targetDoc,
                     triangulation, i,
                     gp_Pnt{pnt.X() * nodeScale.x, pnt.Y() * nodeScale.y, pnt.Z() * nodeScale.z});
             }
+
+            labelFace = shapeTool->AddShape(BRepUtils::makeFace(triangulation), false);
+            isNewPrototype = true;
         }
 #endif
 
-        TopoDS_Face face = BRepUtils::makeFace(triangulation);
-        face.Location(nodeAbsoluteTrsf);
+        if (labelFace.IsNull())
+        {
+            TDF_Label &labelMesh = m_vecMeshLabel.at(sceneMeshIndex);
+            if (labelMesh.IsNull())
+            {
+                labelMesh = shapeTool->AddShape(BRepUtils::makeFace(triangulation), false);
+                isNewPrototype = true;
+            }
+
+            labelFace = labelMesh;
+        }
+
         const TDF_Label labelComponent =
-            targetDoc->xcaf().shapeTool()->AddComponent(labelEntity, face);
-        const TDF_Label labelFace = targetDoc->xcaf().shapeReferred(labelComponent);
+            shapeTool->AddComponent(labelEntity, labelFace, TopLoc_Location(nodeAbsoluteTrsf));
+        if (!isNewPrototype)
+        {
+            TDataStd_Name::Set(labelComponent, to_OccExtString(shapeName));
+            continue; // Prototype already has its material
+        }
 
         if (mesh->mMaterialIndex < m_vecMaterial.size())
         {
@@ -788,16 +853,6 @@ void AssimpReader::transferSceneNode(const aiNode *node, DocumentPtr targetDoc,
                     << "Material not found(umap), index: " << mesh->mMaterialIndex;
         }
 
-        std::string shapeName = nodeName;
-        if (node->mNumMeshes > 1)
-        {
-            shapeName += "_";
-            if (mesh->mName.length > 0)
-                shapeName += mesh->mName.C_Str();
-            else
-                shapeName += "mesh" + std::to_string(imesh);
-        }
-
         TDataStd_Name::Set(labelFace, to_OccExtString(shapeName));
     }
 
@@ -63,6 +63,7 @@ private:
     const aiScene *m_scene = nullptr;
 
     std::vector<OccHandle<Poly_Triangulation>> m_vecTriangulation;
+    std::vector<TDF_Label> m_vecMeshLabel; // Prototype shared by all the nodes using a mesh
     std::vector<OccHandle<XCAFDoc_VisMaterial>> m_vecMaterial;
     std::unordered_map<OccHandle<XCAFDoc_VisMaterial>, TDF_Label> m_mapMaterialLabel;
     std::unordered_map<const aiNode *, aiNodeData> m_mapNodeData;
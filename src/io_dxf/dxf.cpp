@@ -9,14 +9,12 @@
 // required by windows for M_PI definition
 #define _USE_MATH_DEFINES
 #endif
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <charconv>
 #include <clocale>
 #include <cmath>
-#if __cpp_lib_to_chars
-#include <charconv>
-#endif
-
 #include <functional>
 #include <iostream>
 #include <set>
@@ -24,6 +22,8 @@
 #include <stdexcept>
 #include <string_view>
 
+#include <fast_float/fast_float.h>
+
 #include "base/filepath.h"
 
 #include "dxf.h"
@@ -80,39 +80,29 @@ bool isStringToErrorValue(T value)
 }
 
 template <typename T>
-T stringToNumeric(const std::string &line, StringToErrorMode errorMode)
+T stringToNumeric(std::string_view line, StringToErrorMode errorMode)
 {
-#if __cpp_lib_to_chars
+    // MAYO: parse from view, with fast_float for floating point values
+    const char *first = line.data();
+    const char *last = line.data() + line.size();
     T value;
-    auto [ptr, err] = std::from_chars(line.c_str(), line.c_str() + line.size(), value);
-    if (err == std::errc())
-        return value;
-#else
-    try
+    bool ok = false;
+    if constexpr (std::is_floating_point_v<T>)
     {
-        if constexpr (std::is_same_v<T, int>)
-        {
-            return std::stoi(line);
-        }
-        else if constexpr (std::is_same_v<T, unsigned>)
-        {
-            return std::stoul(line);
-        }
-        else if constexpr (std::is_same_v<T, double>)
-        {
-            return std::stod(line);
-        }
-        else
-        {
-            if (errorMode == StringToErrorMode::ReturnErrorValue)
-                return std::numeric_limits<T>::max();
-            else
-                throw std::runtime_error("Failed to fetch numeric value from line:\n" + line);
-        }
+        if (first != last && *first == '+') // Not accepted by fast_float
+            ++first;
+
+        const auto res = fast_float::from_chars(first, last, value);
+        ok = res.ec == std::errc();
     }
-    catch (...)
+    else
     {
-#endif
+        const auto res = std::from_chars(first, last, value);
+        ok = res.ec == std::errc();
+    }
+
+    if (ok)
+        return value;
 
     if (errorMode == StringToErrorMode::ReturnErrorValue)
     {
@@ -128,29 +118,73 @@ T stringToNumeric(const std::string &line, StringToErrorMode errorMode)
         else if constexpr (std::is_same_v<T, double>)
             strTypeName = "double";
 
-        throw std::runtime_error("Failed to fetch " + strTypeName + " value from line:\n" + line);
+        throw std::runtime_error("Failed to fetch " + strTypeName + " value from line:\n"
+                                 + std::string(line));
     }
-
-#ifndef __cpp_lib_to_chars
-}
-#endif
 }
 
-int stringToInt(const std::string &line, StringToErrorMode errorMode)
+int stringToInt(std::string_view line, StringToErrorMode errorMode)
 {
     return stringToNumeric<int>(line, errorMode);
 }
 
-unsigned stringToUnsigned(const std::string &line, StringToErrorMode errorMode)
+unsigned stringToUnsigned(std::string_view line, StringToErrorMode errorMode)
 {
     return stringToNumeric<unsigned>(line, errorMode);
 }
 
-double stringToDouble(const std::string &line, StringToErrorMode errorMode)
+double stringToDouble(std::string_view line, StringToErrorMode errorMode)
 {
     return stringToNumeric<double>(line, errorMode);
 }
 
+DxfTokenizer::DxfTokenizer(std::string_view contents)
+    : m_contents(contents)
+{
+}
+
+std::string_view DxfTokenizer::nextLine()
+{
+    std::string_view line;
+    const size_t lineEnd = m_contents.find('\n', m_pos);
+    if (lineEnd != std::string_view::npos)
+    {
+        line = m_contents.substr(m_pos, lineEnd - m_pos);
+        m_pos = lineEnd + 1;
+    }
+    else
+    {
+        line = m_contents.substr(std::min(m_pos, m_contents.size()));
+        m_pos = m_contents.size();
+        m_atEnd = true;
+    }
+
+    // Files written on Windows end lines with CRLF
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    size_t posNonSpace = 0;
+    while (posNonSpace < line.size() && std::isspace(static_cast<unsigned char>(line[posNonSpace])))
+        ++posNonSpace;
+
+    line.remove_prefix(posNonSpace);
+    return line;
+}
+
+bool DxfTokenizer::nextGroup(int *ptrCode, std::string_view *ptrValue)
+{
+    if (m_atEnd)
+        return false;
+
+    const int code = stringToInt(this->nextLine(), StringToErrorMode::ReturnErrorValue);
+    if (isStringToErrorValue(code) || m_atEnd)
+        return false;
+
+    *ptrCode = code;
+    *ptrValue = this->nextLine();
+    return true;
+}
+
 } // namespace DxfPrivate
 
 using namespace DxfPrivate;
@@ -1913,12 +1947,16 @@ void CDxfWrite::writeObjectsSection()
 #endif
 
 CDxfRead::CDxfRead(const char *filepath)
-    : m_ifs(filepath)
+    : m_fileView(Mayo::FilePath(filepath))
+    , m_tokenizer(m_fileView.contents())
 {
-    if (!m_ifs)
+    if (!m_fileView.isOpen())
         m_fail = true;
-    else
-        m_ifs.imbue(std::locale::classic());
+}
+
+CDxfRead::CDxfRead(std::string_view contents)
+    : m_tokenizer(contents)
+{
 }
 
 CDxfRead::~CDxfRead()
@@ -1979,7 +2017,7 @@ bool CDxfRead::ReadLine()
     DxfCoords e = {};
     bool hidden = false;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2048,7 +2086,7 @@ bool CDxfRead::ReadPoint()
 {
     DxfCoords s = {};
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2111,7 +2149,7 @@ bool CDxfRead::ReadArc()
     double z_extrusion_dir = 1.0;
     bool hidden = false;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2185,7 +2223,7 @@ bool CDxfRead::ReadSpline()
     int controlPointCount = 0;
     int fitPointCount = 0;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2254,7 +2292,7 @@ bool CDxfRead::ReadCircle()
     DxfCoords c = {}; // centre
     bool hidden = false;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2314,7 +2352,7 @@ bool CDxfRead::ReadMText()
     bool withinAcadColumns = false;
     bool withinAcadDefinedHeight = false;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2492,7 +2530,7 @@ bool CDxfRead::ReadText()
 {
     Dxf_TEXT text;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2510,7 +2548,7 @@ bool CDxfRead::ReadText()
         case 20:
         case 30: HandleCoordCode(n, &text.firstAlignmentPoint); break;
         case 40: text.height = mm(stringToDouble(m_str)); break;
-        case 1: text.str = this->toUtf8(m_str); break;
+        case 1: text.str = this->toUtf8(std::string(m_str)); break;
         case 50: text.rotationAngle = stringToDouble(m_str); break;
         case 41: text.relativeXScaleFactorWidth = stringToDouble(m_str); break;
         case 51: text.obliqueAngle = stringToDouble(m_str); break;
@@ -2551,7 +2589,7 @@ bool CDxfRead::ReadEllipse()
     double start = 0; // start of arc
     double end = 0;   // end of arc
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2697,7 +2735,7 @@ bool CDxfRead::ReadLwPolyLine()
     int flags;
     bool next_item_found = false;
 
-    while (!m_ifs.eof() && !next_item_found)
+    while (!m_eof && !next_item_found)
     {
         get_line();
         const int n = stringToInt(m_str);
@@ -2707,8 +2745,6 @@ bool CDxfRead::ReadLwPolyLine()
             return false;
         }
 
-        std::istringstream ss;
-        ss.imbue(std::locale::classic());
         switch (n)
         {
         case 0:
@@ -2735,44 +2771,40 @@ bool CDxfRead::ReadLwPolyLine()
                 x_found = false;
                 y_found = false;
             }
-            ss.str(m_str);
-            ss >> x;
-            x = mm(x);
-            if (ss.fail())
+            x = stringToDouble(m_str, StringToErrorMode::ReturnErrorValue);
+            if (isStringToErrorValue(x))
             {
                 return false;
             }
+            x = mm(x);
             x_found = true;
             break;
         case 20:
             // y
             get_line();
-            ss.str(m_str);
-            ss >> y;
-            y = mm(y);
-            if (ss.fail())
+            y = stringToDouble(m_str, StringToErrorMode::ReturnErrorValue);
+            if (isStringToErrorValue(y))
             {
                 return false;
             }
+            y = mm(y);
             y_found = true;
             break;
         case 38:
             // elevation
             get_line();
-            ss.str(m_str);
-            ss >> z;
-            z = mm(z);
-            if (ss.fail())
+            z = stringToDouble(m_str, StringToErrorMode::ReturnErrorValue);
+            if (isStringToErrorValue(z))
             {
                 return false;
             }
+            z = mm(z);
             break;
         case 42:
             // bulge
             get_line();
-            ss.str(m_str);
-            ss >> bulge;
-            if (ss.fail())
+            bulge = stringToDouble(m_str, StringToErrorMode::ReturnErrorValue);
+            if (isStringToErrorValue(bulge))
             {
                 return false;
             }
@@ -2809,7 +2841,7 @@ bool CDxfRead::ReadVertex(Dxf_VERTEX *vertex)
 {
     bool x_found = false;
     bool y_found = false;
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2862,7 +2894,7 @@ bool CDxfRead::ReadVertex(Dxf_VERTEX *vertex)
 bool CDxfRead::Read3dFace()
 {
     Dxf_3DFACE face;
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2908,7 +2940,7 @@ bool CDxfRead::ReadSolid()
 {
     Dxf_SOLID solid;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -2982,7 +3014,7 @@ bool CDxfRead::ReadEndSec()
 bool CDxfRead::ReadPolyLine()
 {
     Dxf_POLYLINE polyline;
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3095,7 +3127,7 @@ bool CDxfRead::ReadInsert()
 {
     Dxf_INSERT insert;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3144,7 +3176,7 @@ bool CDxfRead::ReadDimension()
     DxfCoords p = {};  // dimpoint
     double rot = -1.0; // rotation
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3202,7 +3234,7 @@ bool CDxfRead::ReadDimension()
 
 bool CDxfRead::ReadBlockInfo()
 {
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3234,33 +3266,24 @@ bool CDxfRead::ReadBlockInfo()
 
 void CDxfRead::get_line()
 {
-    if (!m_unused_line.empty())
+    if (m_has_unused_line)
     {
         m_str = m_unused_line;
-        m_unused_line.clear();
+        m_has_unused_line = false;
         return;
     }
 
-    std::getline(m_ifs, m_str);
-    m_gcount = m_str.size();
+    const size_t posLineStart = m_tokenizer.position();
+    m_str = m_tokenizer.nextLine();
+    m_eof = m_tokenizer.atEnd();
+    m_gcount = m_tokenizer.position() - posLineStart;
     ++m_line_nb;
-
-    // Erase leading whitespace characters
-    auto itNonSpace = m_str.begin();
-    while (itNonSpace != m_str.end())
-    {
-        if (!std::isspace(*itNonSpace))
-            break;
-
-        ++itNonSpace;
-    }
-
-    m_str.erase(m_str.begin(), itNonSpace);
 }
 
-void CDxfRead::put_line(const std::string &value)
+void CDxfRead::put_line(std::string_view value)
 {
     m_unused_line = value;
+    m_has_unused_line = true;
 }
 
 bool CDxfRead::ReadInsUnits()
@@ -3296,7 +3319,7 @@ bool CDxfRead::ReadLayer()
     std::string layername;
     ColorIndex_t colorIndex = -1;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3348,7 +3371,7 @@ bool CDxfRead::ReadStyle()
 {
     Dxf_STYLE style;
 
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         get_line();
         const int n = stringToInt(m_str, StringToErrorMode::ReturnErrorValue);
@@ -3471,13 +3494,13 @@ void CDxfRead::DoRead(bool ignore_errors)
     if (m_fail)
         return;
 
-    std::unordered_map<std::string, std::function<bool()>> mapHeaderVarHandler;
+    std::unordered_map<std::string_view, std::function<bool()>> mapHeaderVarHandler;
     mapHeaderVarHandler.insert({"$INSUNITS", [=] { return ReadInsUnits(); }});
     mapHeaderVarHandler.insert({"$MEASUREMENT", [=] { return ReadMeasurement(); }});
     mapHeaderVarHandler.insert({"$ACADVER", [=] { return ReadAcadVer(); }});
     mapHeaderVarHandler.insert({"$DWGCODEPAGE", [=] { return ReadDwgCodePage(); }});
 
-    std::unordered_map<std::string, std::function<bool()>> mapEntityHandler;
+    std::unordered_map<std::string_view, std::function<bool()>> mapEntityHandler;
     mapEntityHandler.insert({"ARC", [=] { return ReadArc(); }});
     mapEntityHandler.insert({"BLOCK", [=] { return ReadBlockInfo(); }});
     mapEntityHandler.insert({"CIRCLE", [=] { return ReadCircle(); }});
@@ -3502,7 +3525,7 @@ void CDxfRead::DoRead(bool ignore_errors)
     get_line();
 
     ScopedCLocale _(LC_NUMERIC);
-    while (!m_ifs.eof())
+    while (!m_eof)
     {
         m_ColorIndex = ColorBylayer; // Default
 
@@ -3545,7 +3568,7 @@ void CDxfRead::DoRead(bool ignore_errors)
                 }
                 else
                 {
-                    std::string errMsg = "DXF::DoRead() - Failed to read " + m_str;
+                    std::string errMsg = "DXF::DoRead() - Failed to read " + std::string(m_str);
                     if (!exceptionMsg.empty())
                         errMsg += "\nError: " + exceptionMsg;
 
@@ -3592,9 +3615,10 @@ std::streamsize CDxfRead::gcount() const
     return m_gcount;
 }
 
-std::string CDxfRead::LayerName() const
+const std::string &CDxfRead::LayerName() const
 {
-    std::string result;
+    std::string &result = m_layer_name_buffer;
+    result.clear();
 
     if (!m_section_name.empty())
     {
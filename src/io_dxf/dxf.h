@@ -10,9 +10,12 @@
 #include <fstream>
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "base/io_file_view.h"
+
 typedef int ColorIndex_t; // DXF color index
 
 typedef enum
@@ -631,30 +634,69 @@ enum class StringToErrorMode
     ReturnErrorValue = 0x2
 };
 
-double stringToDouble(const std::string &line,
+// MAYO: numeric values are parsed from views, without copy nor locale dependency
+double stringToDouble(std::string_view line,
                       StringToErrorMode errorMode = StringToErrorMode::Throw);
 
-int stringToInt(const std::string &line, StringToErrorMode errorMode = StringToErrorMode::Throw);
+int stringToInt(std::string_view line, StringToErrorMode errorMode = StringToErrorMode::Throw);
 
-unsigned stringToUnsigned(const std::string &line,
+unsigned stringToUnsigned(std::string_view line,
                           StringToErrorMode errorMode = StringToErrorMode::Throw);
 
+// MAYO: splits DXF contents into lines, each group being a pair of lines(code then value)
+//       Returned views point into the contents, which must outlive the tokenizer
+class DxfTokenizer
+{
+public:
+    DxfTokenizer(std::string_view contents = {});
+
+    // Next line without leading whitespaces nor trailing carriage return
+    // Same behavior as std::getline(): end is reached when there is no line terminator left
+    std::string_view nextLine();
+
+    // Next pair of lines as group code and value
+    // Returns false if end is reached or if group code isn't an integer
+    bool nextGroup(int *ptrCode, std::string_view *ptrValue);
+
+    bool atEnd() const
+    {
+        return m_atEnd;
+    }
+
+    // Offset in contents of the next line to be read
+    size_t position() const
+    {
+        return m_pos;
+    }
+
+private:
+    std::string_view m_contents;
+    size_t m_pos = 0;
+    bool m_atEnd = false;
+};
+
 } // namespace DxfPrivate
 
 // derive a class from this and implement it's virtual functions
 class CDxfRead
 {
 private:
-    std::ifstream m_ifs;
+    // MAYO: lines are read from contents in memory instead of std::ifstream
+    Mayo::IO::FileView m_fileView; // Owner of contents if constructed from a file path
+    DxfPrivate::DxfTokenizer m_tokenizer;
+    bool m_eof = false;
 
     bool m_fail = false;
-    std::string m_str;
-    std::string m_unused_line;
+    // MAYO: current and put back lines are views into contents, no string is allocated per line
+    std::string_view m_str;
+    std::string_view m_unused_line;
+    bool m_has_unused_line = false;
     eDxfUnits_t m_eUnits = eMillimeters;
     bool m_measurement_inch = false;
     std::string m_layer_name{"0"}; // Default layer name
     std::string m_section_name;
     std::string m_block_name;
+    mutable std::string m_layer_name_buffer; // MAYO: avoids allocation in LayerName()
     bool m_ignore_errors = true;
 
     std::streamsize m_gcount = 0;
@@ -724,7 +766,7 @@ private:
 
     void HandleCommonGroupCode(int n);
 
-    void put_line(const std::string &value);
+    void put_line(std::string_view value);
     void ResolveColorIndex();
 
     void ReportError_readInteger(const char *context);
@@ -754,7 +796,9 @@ private:
 
 public:
     CDxfRead(const char *filepath); // this opens the file
-    virtual ~CDxfRead();            // this closes the file
+    // MAYO: reads DXF 'contents', which must outlive this object
+    CDxfRead(std::string_view contents);
+    virtual ~CDxfRead(); // this closes the file
 
     bool IgnoreErrors() const
     {
@@ -803,5 +847,6 @@ public:
 
     virtual void AddGraphics() const = 0;
 
-    std::string LayerName() const;
+    // MAYO: returns a reference to an internal buffer, valid until next call
+    const std::string &LayerName() const;
 };
@@ -7,11 +7,14 @@
 #include "io_dxf.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <tuple>
 
 #include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
@@ -30,6 +33,7 @@
 #include <Precision.hxx>
 #include <Resource_Unicode.hxx>
 #include <TDataStd_Name.hxx>
+#include <TopLoc_Location.hxx>
 #include <TopoDS_Edge.hxx>
 #include <XCAFDoc_ShapeTool.hxx>
 #include <fmt/format.h>
@@ -48,6 +52,8 @@
 #include "base/property_builtins.h"
 #include "base/property_enumeration.h"
 #include "base/string_conv.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
 #include "base/task_progress.h"
 
 #include "aci_table.h"
@@ -97,6 +103,35 @@ gp_Vec toOccVec(const DxfCoords &coords)
     return {coords.x, coords.y, coords.z};
 }
 
+// Entity read from file
+// Its shape is built once the whole file is parsed, see DxfReader::Internal::buildShapes()
+struct DxfEntityRecord
+{
+    enum class Type : uint8_t
+    {
+        Point,
+        Line,
+        Arc,
+        Circle,
+        Ellipse,
+        Quad,
+        Polyline,
+        Spline,
+        Text,
+        MText,
+        Insert
+    };
+
+    Type type = Type::Point;
+    bool flag = false;  // Arc, circle and ellipse: direction is counterclockwise
+                        // Quad: fourth corner is defined
+    int layerId = -1;   // Index of the interned layer name
+    int dataIndex = -1; // Polyline, spline, text and insert: index of the entity data
+    ColorIndex_t aci = 0;
+    DxfCoords pnts[4] = {};
+    double values[3] = {}; // Ellipse: major radius, minor radius and rotation
+};
+
 } // namespace
 
 class DxfReader::Internal : public CDxfRead
@@ -110,13 +145,33 @@ private:
     std::uintmax_t m_fileReadSize = 0;
     Resource_FormatType m_srcEncoding = Resource_ANSI;
 
+    // Entities recorded while parsing
+    std::vector<DxfEntityRecord> m_vecRecord;
+    std::vector<Dxf_POLYLINE> m_vecPolyline;
+    std::vector<Dxf_SPLINE> m_vecSpline;
+    std::vector<Dxf_TEXT> m_vecText;
+    std::vector<Dxf_MTEXT> m_vecMText;
+    std::vector<Dxf_INSERT> m_vecInsert;
+
+    // Interned layer names, entity records are indexed by layer identifier
+    std::vector<std::string> m_vecLayerName;
+    std::vector<std::vector<size_t>> m_vecLayerRecordIndex;
+    std::unordered_map<std::string, int> m_mapLayerNameId;
+    int m_lastLayerId = -1;
+
+    // Blocks referenced by inserts, identified by block name, scale factor and count of block
+    // entities preceding the insert(entities defined after an insert aren't part of it)
+    using BlockKey = std::tuple<std::string, double, size_t>;
+    std::vector<DxfReader::Block> m_blocks;
+    std::map<BlockKey, int> m_mapBlockId;
+
 protected:
     void get_line() override;
     bool setSourceEncoding(const std::string &codepage) override;
     std::string toUtf8(const std::string &strSource) override;
 
 public:
-    Internal(const FilePath &filepath, TaskProgress *progress = nullptr);
+    Internal(const FileView &fileView, TaskProgress *progress = nullptr);
 
     void setMessenger(Messenger *messenger)
     {
@@ -126,10 +181,19 @@ public:
     {
         m_params = params;
     }
-    const auto &layers() const
+    auto &layers()
     {
         return m_layers;
     }
+    auto &blocks()
+    {
+        return m_blocks;
+    }
+
+    // Builds in parallel the shapes of the entities recorded by DoRead(), then groups them by
+    // layer(see layers())
+    // Returns false if abort was requested
+    bool buildShapes();
 
     // CDxfRead's virtual functions
     void OnReadLine(const DxfCoords &s, const DxfCoords &e, bool hidden) override;
@@ -156,9 +220,27 @@ public:
     static OccHandle<Geom_BSplineCurve> createInterpolationSpline(const Dxf_SPLINE &spline);
 
     gp_Pnt toPnt(const DxfCoords &coords) const;
-    void addShape(const TopoDS_Shape &shape);
-
+    DxfEntityRecord &addRecord(DxfEntityRecord::Type type);
+    int currentLayerId();
+
+    // Can be called concurrently, messages are added to 'ptrVecWarning'
+    TopoDS_Shape buildShape(const DxfEntityRecord &record,
+                            std::vector<std::string> *ptrVecWarning) const;
+    TopoDS_Shape buildPolyline(const Dxf_POLYLINE &polyline) const;
+    TopoDS_Shape buildSpline(const Dxf_SPLINE &spline,
+                             std::vector<std::string> *ptrVecWarning) const;
     TopoDS_Face makeFace(const Dxf_QuadBase &quad) const;
+
+    // Font management isn't thread-safe, texts are built sequentially
+    TopoDS_Shape buildText(const Dxf_TEXT &text) const;
+    TopoDS_Shape buildMText(const Dxf_MTEXT &text) const;
+
+    // Finds or builds the shape of block 'ins.blockName' scaled as specified by 'ins'
+    // Block contents are the shapes of the records preceding 'recordIndex'
+    // Returns the index of the block in m_blocks, -1 if the block is empty
+    int findOrBuildBlock(const Dxf_INSERT &ins, size_t recordIndex,
+                         const std::vector<TopoDS_Shape> &vecShape);
+    gp_Trsf insertTrsf(const Dxf_INSERT &ins) const;
 };
 
 class DxfReader::Properties : public PropertyGroup
@@ -194,14 +276,27 @@ public:
 };
 
 bool DxfReader::readFile(const FilePath &filepath, TaskProgress *progress)
+{
+    return this->readFile(FileView(filepath), progress);
+}
+
+bool DxfReader::readFile(const FileView &fileView, TaskProgress *progress)
 {
     m_layers.clear();
-    DxfReader::Internal internalReader(filepath, progress);
+    m_blocks.clear();
+    if (!fileView.isOpen())
+        return false;
+
+    DxfReader::Internal internalReader(fileView, progress);
     internalReader.setParameters(m_params);
     internalReader.setMessenger(this->messenger() ? this->messenger() : &Messenger::null());
     internalReader.DoRead();
+    if (internalReader.Failed() || !internalReader.buildShapes())
+        return false;
+
     m_layers = std::move(internalReader.layers());
-    return !internalReader.Failed();
+    m_blocks = std::move(internalReader.blocks());
+    return true;
 }
 
 TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress *progress)
@@ -226,6 +321,33 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress *progress)
         return labelShape;
     };
 
+    auto fnAddRootAssembly = [&](const std::string &shapeName, TDF_Label layer)
+    {
+        const TopoDS_Shape emptyComp = BRepUtils::makeEmptyCompound();
+        const TDF_Label labelAsm = shapeTool->AddShape(emptyComp, true /*makeAssembly*/);
+        TDataStd_Name::Set(labelAsm, to_OccExtString(shapeName));
+        seqLabel.Append(labelAsm);
+        if (!layer.IsNull())
+            layerTool->SetLayer(labelAsm, layer, true /*onlyInOneLayer*/);
+
+        return labelAsm;
+    };
+
+    // Blocks are added once as prototypes, inserts are components referring to them
+    std::vector<TDF_Label> vecBlockLabel(m_blocks.size());
+    auto fnAddInsertComponent = [&](const TDF_Label &labelAsm, const Entity &entity)
+    {
+        TDF_Label &labelBlock = vecBlockLabel.at(entity.blockId);
+        if (labelBlock.IsNull())
+        {
+            const Block &block = m_blocks.at(entity.blockId);
+            labelBlock = shapeTool->AddShape(block.shape, false /*makeAssembly*/);
+            TDataStd_Name::Set(labelBlock, to_OccExtString(block.name));
+        }
+
+        return shapeTool->AddComponent(labelAsm, labelBlock, entity.shape.Location());
+    };
+
     auto fnAddAci = [&](ColorIndex_t aci) -> TDF_Label
     {
         auto it = mapAciColorLabel.find(aci);
@@ -276,7 +398,17 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress *progress)
             for (const DxfReader::Entity &entity : vecEntity)
             {
                 const std::string shapeName = std::string("Shape_") + std::to_string(++iShape);
-                const TDF_Label shapeLabel = fnAddRootShape(entity.shape, shapeName, layerLabel);
+                TDF_Label shapeLabel;
+                if (entity.blockId >= 0)
+                {
+                    shapeLabel = fnAddRootAssembly(shapeName, layerLabel);
+                    fnAddInsertComponent(shapeLabel, entity);
+                }
+                else
+                {
+                    shapeLabel = fnAddRootShape(entity.shape, shapeName, layerLabel);
+                }
+
                 colorTool->SetColor(shapeLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
                 fnUpdateProgressValue();
             }
@@ -289,42 +421,68 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress *progress)
             if (startsWith(layerName, "BLOCKS"))
                 continue; // Skip
 
+            // Block inserts are kept apart, other entities are gathered in a single compound
             TopoDS_Compound comp = BRepUtils::makeEmptyCompound();
+            bool hasInserts = false;
+            bool isCompEmpty = true;
             for (const Entity &entity : vecEntity)
             {
-                if (!entity.shape.IsNull())
+                if (entity.blockId >= 0)
+                {
+                    hasInserts = true;
+                }
+                else if (!entity.shape.IsNull())
+                {
                     BRepUtils::addShape(&comp, entity.shape);
+                    isCompEmpty = false;
+                }
             }
 
-            if (!comp.IsNull())
+            // Inserts require an assembly, the compound is then one of its components
+            const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
+            TDF_Label rootLabel;
+            TDF_Label compLabel;
+            if (hasInserts)
             {
-                const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
-                const TDF_Label compLabel = fnAddRootShape(comp, layerName, layerLabel);
-                // Check if all entities have the same color
-                bool uniqueColor = true;
-                const ColorIndex_t aci = !vecEntity.empty() ? vecEntity.front().aci : -1;
-                for (const Entity &entity : vecEntity)
+                rootLabel = fnAddRootAssembly(layerName, layerLabel);
+                if (!isCompEmpty)
                 {
-                    uniqueColor = entity.aci == aci;
-                    if (!uniqueColor)
-                        break;
+                    compLabel = shapeTool->AddShape(comp, false /*makeAssembly*/);
+                    TDataStd_Name::Set(compLabel, to_OccExtString(layerName));
+                    shapeTool->AddComponent(rootLabel, compLabel, TopLoc_Location());
                 }
+            }
+            else
+            {
+                rootLabel = fnAddRootShape(comp, layerName, layerLabel);
+                compLabel = rootLabel;
+            }
+
+            // Check if all entities have the same color
+            bool uniqueColor = true;
+            const ColorIndex_t aci = !vecEntity.empty() ? vecEntity.front().aci : -1;
+            for (const Entity &entity : vecEntity)
+            {
+                uniqueColor = entity.aci == aci;
+                if (!uniqueColor)
+                    break;
+            }
+
+            if (uniqueColor)
+                fnSetShapeColor(rootLabel, aci);
 
-                if (uniqueColor)
+            for (const Entity &entity : vecEntity)
+            {
+                if (entity.blockId >= 0)
                 {
-                    fnSetShapeColor(compLabel, aci);
+                    const TDF_Label entityLabel = fnAddInsertComponent(rootLabel, entity);
+                    if (!uniqueColor)
+                        fnSetShapeColor(entityLabel, entity.aci);
                 }
-                else
+                else if (!uniqueColor && !entity.shape.IsNull())
                 {
-                    for (const Entity &entity : vecEntity)
-                    {
-                        if (!entity.shape.IsNull())
-                        {
-                            const TDF_Label entityLabel =
-                                shapeTool->AddSubShape(compLabel, entity.shape);
-                            fnSetShapeColor(entityLabel, entity.aci);
-                        }
-                    }
+                    const TDF_Label entityLabel = shapeTool->AddSubShape(compLabel, entity.shape);
+                    fnSetShapeColor(entityLabel, entity.aci);
                 }
             }
 
@@ -333,6 +491,9 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress *progress)
         }
     }
 
+    if (!m_blocks.empty())
+        shapeTool->UpdateAssemblies();
+
     return seqLabel;
 }
 
@@ -358,7 +519,7 @@ void DxfReader::Internal::get_line()
     CDxfRead::get_line();
     m_fileReadSize += this->gcount();
     if (m_progress)
-        m_progress->setValue(MathUtils::toPercent(m_fileReadSize, 0, m_fileSize));
+        m_progress->setValue(MathUtils::mappedValue(m_fileReadSize, 0, m_fileSize, 0, 40));
 }
 
 bool DxfReader::Internal::setSourceEncoding(const std::string &codepage)
@@ -424,26 +585,379 @@ std::string DxfReader::Internal::toUtf8(const std::string &strSource)
     return to_stdString(extStr);
 }
 
-DxfReader::Internal::Internal(const FilePath &filepath, TaskProgress *progress)
-    : CDxfRead(filepath.u8string().c_str())
+DxfReader::Internal::Internal(const FileView &fileView, TaskProgress *progress)
+    : CDxfRead(fileView.contents())
     , m_progress(progress)
+    , m_fileSize(fileView.size())
 {
-    if (!this->Failed())
-        m_fileSize = filepathFileSize(filepath);
 }
 
 void DxfReader::Internal::OnReadLine(const DxfCoords &s, const DxfCoords &e, bool /*hidden*/)
 {
-    const gp_Pnt p0 = this->toPnt(s);
-    const gp_Pnt p1 = this->toPnt(e);
-    if (p0.IsEqual(p1, Precision::Confusion()))
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Line);
+    record.pnts[0] = s;
+    record.pnts[1] = e;
+}
+
+void DxfReader::Internal::OnReadPolyline(const Dxf_POLYLINE &polyline)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Polyline);
+    record.dataIndex = CppUtils::safeStaticCast<int>(m_vecPolyline.size());
+    m_vecPolyline.push_back(polyline);
+}
+
+void DxfReader::Internal::OnReadPoint(const DxfCoords &s)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Point);
+    record.pnts[0] = s;
+}
+
+void DxfReader::Internal::OnReadText(const Dxf_TEXT &text)
+{
+    if (!m_params.importAnnotations)
         return;
 
-    const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(p0, p1);
-    this->addShape(edge);
+    if (startsWith(this->LayerName(), "BLOCKS"))
+        return;
+
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Text);
+    record.dataIndex = CppUtils::safeStaticCast<int>(m_vecText.size());
+    m_vecText.push_back(text);
 }
 
-void DxfReader::Internal::OnReadPolyline(const Dxf_POLYLINE &polyline)
+void DxfReader::Internal::OnReadMText(const Dxf_MTEXT &text)
+{
+    if (!m_params.importAnnotations)
+        return;
+
+    if (startsWith(this->LayerName(), "BLOCKS"))
+        return;
+
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::MText);
+    record.dataIndex = CppUtils::safeStaticCast<int>(m_vecMText.size());
+    m_vecMText.push_back(text);
+}
+
+void DxfReader::Internal::OnReadArc(const DxfCoords &s, const DxfCoords &e, const DxfCoords &c,
+                                    bool dir, bool /*hidden*/)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Arc);
+    record.flag = dir;
+    record.pnts[0] = s;
+    record.pnts[1] = e;
+    record.pnts[2] = c;
+}
+
+void DxfReader::Internal::OnReadCircle(const DxfCoords &s, const DxfCoords &c, bool dir,
+                                       bool /*hidden*/)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Circle);
+    record.flag = dir;
+    record.pnts[0] = s;
+    record.pnts[1] = c;
+}
+
+void DxfReader::Internal::OnReadEllipse(const DxfCoords &c, double major_radius,
+                                        double minor_radius, double rotation,
+                                        double /*start_angle*/, double /*end_angle*/, bool dir)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Ellipse);
+    record.flag = dir;
+    record.pnts[0] = c;
+    record.values[0] = major_radius;
+    record.values[1] = minor_radius;
+    record.values[2] = rotation;
+}
+
+void DxfReader::Internal::OnReadSpline(const Dxf_SPLINE &spline)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Spline);
+    record.dataIndex = CppUtils::safeStaticCast<int>(m_vecSpline.size());
+    m_vecSpline.push_back(spline);
+}
+
+void DxfReader::Internal::OnReadInsert(const Dxf_INSERT &ins)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Insert);
+    record.dataIndex = CppUtils::safeStaticCast<int>(m_vecInsert.size());
+    m_vecInsert.push_back(ins);
+}
+
+void DxfReader::Internal::OnReadDimension(const DxfCoords &s, const DxfCoords &e,
+                                          const DxfCoords &point, double rotation)
+{
+    if (m_params.importAnnotations)
+    {
+        // TODO
+        std::stringstream sstr;
+        sstr << "DxfReader::OnReadDimension() - Not yet implemented" << std::endl
+             << "    s: " << s.x << ", " << s.y << ", " << s.z << std::endl
+             << "    e: " << e.x << ", " << e.y << ", " << e.z << std::endl
+             << "    point: " << point.x << ", " << point.y << ", " << point.z << std::endl
+             << "    rotation: " << rotation << std::endl;
+        m_messenger->emitWarning(sstr.str());
+    }
+}
+
+void DxfReader::Internal::OnReadSolid(const Dxf_SOLID &solid)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Quad);
+    record.flag = solid.hasCorner4;
+    record.pnts[0] = solid.corner1;
+    record.pnts[1] = solid.corner2;
+    record.pnts[2] = solid.corner3;
+    record.pnts[3] = solid.corner4;
+    if (solid.hasCorner4)
+    {
+        // See https://ezdxf.readthedocs.io/en/stable/dxfentities/solid.html
+        std::swap(record.pnts[2], record.pnts[3]);
+    }
+}
+
+void DxfReader::Internal::OnRead3dFace(const Dxf_3DFACE &face)
+{
+    DxfEntityRecord &record = this->addRecord(DxfEntityRecord::Type::Quad);
+    record.flag = face.hasCorner4;
+    record.pnts[0] = face.corner1;
+    record.pnts[1] = face.corner2;
+    record.pnts[2] = face.corner3;
+    record.pnts[3] = face.corner4;
+}
+
+void DxfReader::Internal::ReportError(const std::string &msg)
+{
+    m_messenger->emitError(msg);
+}
+
+void DxfReader::Internal::AddGraphics() const
+{
+    // Nothing
+}
+
+bool DxfReader::Internal::buildShapes()
+{
+    TaskProgress *progress = m_progress ? m_progress : &TaskProgress::null();
+    auto fnIsBuiltSequentially = [](DxfEntityRecord::Type type)
+    {
+        using Type = DxfEntityRecord::Type;
+        return type == Type::Text || type == Type::MText || type == Type::Insert;
+    };
+
+    // Geometric entities are independent, build them in parallel
+    TaskManager taskMgr;
+    std::vector<TopoDS_Shape> vecShape(m_vecRecord.size());
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, m_vecRecord.size(), 1024);
+    std::vector<std::vector<std::string>> vecChunkWarnings(range.chunkCount());
+    auto fnBuildChunk = [&](size_t iChunk, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const DxfEntityRecord &record = m_vecRecord.at(i);
+            if (!fnIsBuiltSequentially(record.type))
+                vecShape.at(i) = this->buildShape(record, &vecChunkWarnings.at(iChunk));
+        }
+    };
+    const bool okBuild = parallelForChunks(taskMgr, range, fnBuildChunk, progress, 40, 90);
+    for (const std::vector<std::string> &vecWarning : vecChunkWarnings)
+    {
+        for (const std::string &warning : vecWarning)
+            m_messenger->emitWarning(warning);
+    }
+
+    if (!okBuild)
+        return false;
+
+    // Texts and inserts(which depend on shapes of previous entities) are built in file order
+    // Inserts share the shape of their block, only the location differs
+    std::vector<int> vecInsertBlockId(m_vecInsert.size(), -1);
+    for (const DxfEntityRecord &record : m_vecRecord)
+    {
+        const auto iRecord = size_t(&record - m_vecRecord.data());
+        if (record.type == DxfEntityRecord::Type::Text)
+        {
+            vecShape.at(iRecord) = this->buildText(m_vecText.at(record.dataIndex));
+        }
+        else if (record.type == DxfEntityRecord::Type::MText)
+        {
+            vecShape.at(iRecord) = this->buildMText(m_vecMText.at(record.dataIndex));
+        }
+        else if (record.type == DxfEntityRecord::Type::Insert)
+        {
+            const Dxf_INSERT &ins = m_vecInsert.at(record.dataIndex);
+            const int blockId = this->findOrBuildBlock(ins, iRecord, vecShape);
+            if (blockId >= 0)
+            {
+                const TopoDS_Shape &blockShape = m_blocks.at(blockId).shape;
+                vecShape.at(iRecord) = blockShape.Located(this->insertTrsf(ins));
+                vecInsertBlockId.at(record.dataIndex) = blockId;
+            }
+        }
+    }
+
+    progress->setValue(95);
+
+    // Group entities by layer
+    m_layers.clear();
+    for (size_t iLayer = 0; iLayer < m_vecLayerName.size(); ++iLayer)
+    {
+        std::vector<DxfReader::Entity> vecEntity;
+        for (size_t iRecord : m_vecLayerRecordIndex.at(iLayer))
+        {
+            const DxfEntityRecord &record = m_vecRecord.at(iRecord);
+            if (vecShape.at(iRecord).IsNull())
+                continue; // Skip
+
+            DxfReader::Entity entity{record.aci, vecShape.at(iRecord)};
+            if (record.type == DxfEntityRecord::Type::Insert)
+                entity.blockId = vecInsertBlockId.at(record.dataIndex);
+
+            vecEntity.push_back(std::move(entity));
+        }
+
+        if (!vecEntity.empty())
+            m_layers.insert({m_vecLayerName.at(iLayer), std::move(vecEntity)});
+    }
+
+    progress->setValue(100);
+    return true;
+}
+
+gp_Pnt DxfReader::Internal::toPnt(const DxfCoords &coords) const
+{
+    double sp1(coords.x);
+    double sp2(coords.y);
+    double sp3(coords.z);
+    if (!MathUtils::fuzzyEqual(m_params.scaling, 1.))
+    {
+        sp1 = sp1 * m_params.scaling;
+        sp2 = sp2 * m_params.scaling;
+        sp3 = sp3 * m_params.scaling;
+    }
+
+    return gp_Pnt(sp1, sp2, sp3);
+}
+
+DxfEntityRecord &DxfReader::Internal::addRecord(DxfEntityRecord::Type type)
+{
+    const int layerId = this->currentLayerId();
+    m_vecLayerRecordIndex.at(layerId).push_back(m_vecRecord.size());
+    DxfEntityRecord &record = m_vecRecord.emplace_back();
+    record.type = type;
+    record.layerId = layerId;
+    record.aci = m_ColorIndex;
+    return record;
+}
+
+int DxfReader::Internal::currentLayerId()
+{
+    // Consecutive entities mostly belong to the same layer
+    const std::string &layerName = this->LayerName();
+    if (m_lastLayerId >= 0 && m_vecLayerName.at(m_lastLayerId) == layerName)
+        return m_lastLayerId;
+
+    auto itFound = m_mapLayerNameId.find(layerName);
+    if (itFound != m_mapLayerNameId.cend())
+    {
+        m_lastLayerId = itFound->second;
+    }
+    else
+    {
+        m_lastLayerId = CppUtils::safeStaticCast<int>(m_vecLayerName.size());
+        m_vecLayerName.push_back(layerName);
+        m_vecLayerRecordIndex.emplace_back();
+        m_mapLayerNameId.insert({layerName, m_lastLayerId});
+    }
+
+    return m_lastLayerId;
+}
+
+TopoDS_Shape DxfReader::Internal::buildShape(const DxfEntityRecord &record,
+                                             std::vector<std::string> *ptrVecWarning) const
+{
+    using Type = DxfEntityRecord::Type;
+    try
+    {
+        switch (record.type)
+        {
+        case Type::Point: {
+            return BRepBuilderAPI_MakeVertex(this->toPnt(record.pnts[0])).Vertex();
+        }
+        case Type::Line: {
+            const gp_Pnt p0 = this->toPnt(record.pnts[0]);
+            const gp_Pnt p1 = this->toPnt(record.pnts[1]);
+            if (p0.IsEqual(p1, Precision::Confusion()))
+                return {};
+
+            return BRepBuilderAPI_MakeEdge(p0, p1).Edge();
+        }
+        // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
+        case Type::Arc: {
+            const gp_Pnt p0 = this->toPnt(record.pnts[0]);
+            const gp_Pnt p1 = this->toPnt(record.pnts[1]);
+            const gp_Dir up = record.flag ? gp::DZ() : -gp::DZ();
+            const gp_Pnt pc = this->toPnt(record.pnts[2]);
+            const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
+            if (circle.Radius() > 0)
+                return BRepBuilderAPI_MakeEdge(circle, p0, p1).Edge();
+
+            ptrVecWarning->push_back("DxfReader - Ignore degenerate arc of circle");
+            return {};
+        }
+        // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
+        case Type::Circle: {
+            const gp_Pnt p0 = this->toPnt(record.pnts[0]);
+            const gp_Dir up = record.flag ? gp::DZ() : -gp::DZ();
+            const gp_Pnt pc = this->toPnt(record.pnts[1]);
+            const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
+            if (circle.Radius() > 0)
+                return BRepBuilderAPI_MakeEdge(circle).Edge();
+
+            ptrVecWarning->push_back("DxfReader - Ignore degenerate circle");
+            return {};
+        }
+        // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
+        case Type::Ellipse: {
+            const gp_Dir up = record.flag ? gp::DZ() : -gp::DZ();
+            const gp_Pnt pc = this->toPnt(record.pnts[0]);
+            gp_Elips ellipse(gp_Ax2(pc, up), record.values[0] * m_params.scaling,
+                             record.values[1] * m_params.scaling);
+            ellipse.Rotate(gp_Ax1(pc, up), record.values[2]);
+            if (ellipse.MinorRadius() > 0)
+                return BRepBuilderAPI_MakeEdge(ellipse).Edge();
+
+            ptrVecWarning->push_back("DxfReader - Ignore degenerate ellipse");
+            return {};
+        }
+        case Type::Quad: {
+            Dxf_QuadBase quad;
+            quad.corner1 = record.pnts[0];
+            quad.corner2 = record.pnts[1];
+            quad.corner3 = record.pnts[2];
+            quad.corner4 = record.pnts[3];
+            quad.hasCorner4 = record.flag;
+            return this->makeFace(quad);
+        }
+        case Type::Polyline: {
+            return this->buildPolyline(m_vecPolyline.at(record.dataIndex));
+        }
+        case Type::Spline: {
+            return this->buildSpline(m_vecSpline.at(record.dataIndex), ptrVecWarning);
+        }
+        case Type::Text:
+        case Type::MText:
+        case Type::Insert: break; // Built sequentially
+        }
+    }
+    catch (const Standard_Failure &err)
+    {
+        ptrVecWarning->push_back(
+            fmt::format("DxfReader - Failed to build entity({})", err.GetMessageString()));
+    }
+
+    return {};
+}
+
+TopoDS_Shape DxfReader::Internal::buildPolyline(const Dxf_POLYLINE &polyline) const
 {
     const auto &vertices = polyline.vertices;
     if (polyline.flags & Dxf_POLYLINE::Flag::PolyfaceMesh)
@@ -472,7 +986,7 @@ void DxfReader::Internal::OnReadPolyline(const Dxf_POLYLINE &polyline)
         for (unsigned i = 0; i < vecTriangle.size(); ++i)
             triangles.ChangeValue(i + 1) = vecTriangle.at(i);
 
-        this->addShape(BRepUtils::makeFace(new Poly_Triangulation(nodes, triangles)));
+        return BRepUtils::makeFace(new Poly_Triangulation(nodes, triangles));
     }
     else
     {
@@ -487,25 +1001,74 @@ void DxfReader::Internal::OnReadPolyline(const Dxf_POLYLINE &polyline)
             polygonBuilder.setNode(nodeCount, this->toPnt(vertices.at(0).point));
 
         polygonBuilder.finalize();
-        this->addShape(BRepUtils::makeEdge(polygonBuilder.get()));
+        return BRepUtils::makeEdge(polygonBuilder.get());
     }
 }
 
-void DxfReader::Internal::OnReadPoint(const DxfCoords &s)
+// Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
+TopoDS_Shape DxfReader::Internal::buildSpline(const Dxf_SPLINE &spline,
+                                              std::vector<std::string> *ptrVecWarning) const
 {
-    const TopoDS_Vertex vertex = BRepBuilderAPI_MakeVertex(this->toPnt(s));
-    this->addShape(vertex);
+    // https://documentation.help/AutoCAD-DXF/WS1a9193826455f5ff18cb41610ec0a2e719-79e1.htm
+    try
+    {
+        OccHandle<Geom_BSplineCurve> geom;
+        if (!spline.controlPoints.empty())
+            geom = createSplineFromPolesAndKnots(spline);
+        else if (!spline.fitPoints.empty())
+            geom = createInterpolationSpline(spline);
+
+        if (geom.IsNull())
+            throw Standard_Failure("Geom_BSplineCurve object is null");
+
+        return BRepBuilderAPI_MakeEdge(geom).Edge();
+    }
+    catch (const Standard_Failure &err)
+    {
+#ifdef MAYO_IO_DXF_DEBUG_TRACE
+        std::cout << "ERROR DxfReader::buildSpline() -- " << err.GetMessageString() << std::endl;
+#endif
+        ptrVecWarning->push_back(
+            fmt::format("DxfReader - Failed to create bspline({})", err.GetMessageString()));
+    }
+
+    return {};
 }
 
-void DxfReader::Internal::OnReadText(const Dxf_TEXT &text)
+TopoDS_Face DxfReader::Internal::makeFace(const Dxf_QuadBase &quad) const
 {
-    if (!m_params.importAnnotations)
-        return;
+    const gp_Pnt p1 = this->toPnt(quad.corner1);
+    const gp_Pnt p2 = this->toPnt(quad.corner2);
+    const gp_Pnt p3 = this->toPnt(quad.corner3);
+    const gp_Pnt p4 = this->toPnt(quad.corner4);
 
-    const std::string layerName = this->LayerName();
-    if (startsWith(layerName, "BLOCKS"))
-        return;
+    const double pntTolerance = Precision::Confusion();
+    if (p1.IsEqual(p2, pntTolerance) || p1.IsEqual(p3, pntTolerance) ||
+        p2.IsEqual(p3, pntTolerance))
+        return {};
 
+    TopoDS_Face face;
+    BRepBuilderAPI_MakeWire makeWire;
+    makeWire.Add(BRepBuilderAPI_MakeEdge(p1, p2));
+    makeWire.Add(BRepBuilderAPI_MakeEdge(p2, p3));
+    if (quad.hasCorner4 && !p3.IsEqual(p4, pntTolerance) && !p1.IsEqual(p4, pntTolerance))
+    {
+        makeWire.Add(BRepBuilderAPI_MakeEdge(p3, p4));
+        makeWire.Add(BRepBuilderAPI_MakeEdge(p4, p1));
+    }
+    else
+    {
+        makeWire.Add(BRepBuilderAPI_MakeEdge(p3, p1));
+    }
+
+    if (makeWire.IsDone())
+        face = BRepBuilderAPI_MakeFace(makeWire.Wire(), true /*onlyPlane*/);
+
+    return face;
+}
+
+TopoDS_Shape DxfReader::Internal::buildText(const Dxf_TEXT &text) const
+{
     const Dxf_STYLE *ptrStyle = this->findStyle(text.styleName);
     std::string fontName = ptrStyle ? ptrStyle->name : m_params.fontNameForTextObjects;
     // "ARIAL_NARROW" -> "ARIAL NARROW"
@@ -519,7 +1082,7 @@ void DxfReader::Internal::OnReadText(const Dxf_TEXT &text)
                        fontHeight /*, Font_StrictLevel_Aliases*/))
     {
         m_messenger->emitWarning(fmt::format("Font_BRepFont is null for '{}'", fontName));
-        return;
+        return {};
     }
 
     using DxfHJustification = Dxf_TEXT::HorizontalJustification;
@@ -581,20 +1144,12 @@ void DxfReader::Internal::OnReadText(const Dxf_TEXT &text)
     const gp_Ax3 locText(pt, extDir, xAxisDir);
     Font_BRepTextBuilder brepTextBuilder;
     const auto occTextStr = string_conv<NCollection_String>(text.str);
-    const TopoDS_Shape shapeText =
-        brepTextBuilder.Perform(brepFont, occTextStr, locText, hAlign, vAlign);
-    this->addShape(shapeText);
+    return brepTextBuilder.Perform(brepFont, occTextStr, locText, hAlign, vAlign);
 }
 
-void DxfReader::Internal::OnReadMText(const Dxf_MTEXT &text)
+TopoDS_Shape DxfReader::Internal::buildMText(const Dxf_MTEXT &text) const
 {
-    if (!m_params.importAnnotations)
-        return;
-
     const gp_Pnt pt = this->toPnt(text.insertionPoint);
-    const std::string layerName = this->LayerName();
-    if (startsWith(layerName, "BLOCKS"))
-        return;
 
     const std::string &fontName = m_params.fontNameForTextObjects;
     const double fontHeight = 1.4 * text.height * m_params.scaling;
@@ -602,7 +1157,7 @@ void DxfReader::Internal::OnReadMText(const Dxf_MTEXT &text)
     if (!brepFont.Init(fontName.c_str(), Font_FA_Regular, fontHeight))
     {
         m_messenger->emitWarning(fmt::format("Font_BRepFont is null for '{}'", fontName));
-        return;
+        return {};
     }
 
     const int ap = static_cast<int>(text.attachmentPoint);
@@ -652,135 +1207,76 @@ void DxfReader::Internal::OnReadMText(const Dxf_MTEXT &text)
     }
     */
     textFormat->Format();
-    const TopoDS_Shape shapeText = brepTextBuilder.Perform(brepFont, textFormat, locText);
-
-    this->addShape(shapeText);
+    return brepTextBuilder.Perform(brepFont, textFormat, locText);
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-void DxfReader::Internal::OnReadArc(const DxfCoords &s, const DxfCoords &e, const DxfCoords &c,
-                                    bool dir, bool /*hidden*/)
+int DxfReader::Internal::findOrBuildBlock(const Dxf_INSERT &ins, size_t recordIndex,
+                                          const std::vector<TopoDS_Shape> &vecShape)
 {
-    const gp_Pnt p0 = this->toPnt(s);
-    const gp_Pnt p1 = this->toPnt(e);
-    const gp_Dir up = dir ? gp::DZ() : -gp::DZ();
-    const gp_Pnt pc = this->toPnt(c);
-    const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
-    if (circle.Radius() > 0)
+    if (!MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y) ||
+        !MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.z))
     {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle, p0, p1);
-        this->addShape(edge);
+        m_messenger->emitWarning(fmt::format("OnReadInsert('{}') - non-uniform scales aren't "
+                                             "supported({}, {}, {})",
+                                             ins.blockName, ins.scaleFactor.x, ins.scaleFactor.y,
+                                             ins.scaleFactor.z));
     }
-    else
-    {
-        m_messenger->emitWarning("DxfReader - Ignore degenerate arc of circle");
-    }
-}
 
-// Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-void DxfReader::Internal::OnReadCircle(const DxfCoords &s, const DxfCoords &c, bool dir,
-                                       bool /*hidden*/)
-{
-    const gp_Pnt p0 = this->toPnt(s);
-    const gp_Dir up = dir ? gp::DZ() : -gp::DZ();
-    const gp_Pnt pc = this->toPnt(c);
-    const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
-    if (circle.Radius() > 0)
-    {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle);
-        this->addShape(edge);
-    }
-    else
-    {
-        m_messenger->emitWarning("DxfReader - Ignore degenerate circle");
-    }
-}
-
-// Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-void DxfReader::Internal::OnReadEllipse(const DxfCoords &c, double major_radius,
-                                        double minor_radius, double rotation,
-                                        double /*start_angle*/, double /*end_angle*/, bool dir)
-{
-    const gp_Dir up = dir ? gp::DZ() : -gp::DZ();
-    const gp_Pnt pc = this->toPnt(c);
-    gp_Elips ellipse(gp_Ax2(pc, up), major_radius * m_params.scaling,
-                     minor_radius * m_params.scaling);
-    ellipse.Rotate(gp_Ax1(pc, up), rotation);
-    if (ellipse.MinorRadius() > 0)
-    {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(ellipse);
-        this->addShape(edge);
-    }
-    else
-    {
-        m_messenger->emitWarning("DxfReader - Ignore degenerate ellipse");
-    }
-}
-
-// Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-void DxfReader::Internal::OnReadSpline(const Dxf_SPLINE &spline)
-{
-    // https://documentation.help/AutoCAD-DXF/WS1a9193826455f5ff18cb41610ec0a2e719-79e1.htm
-    try
-    {
-        OccHandle<Geom_BSplineCurve> geom;
-        if (!spline.controlPoints.empty())
-            geom = createSplineFromPolesAndKnots(spline);
-        else if (!spline.fitPoints.empty())
-            geom = createInterpolationSpline(spline);
-
-        if (geom.IsNull())
-            throw Standard_Failure("Geom_BSplineCurve object is null");
-
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(geom);
-        this->addShape(edge);
-    }
-    catch (const Standard_Failure &err)
-    {
-#ifdef MAYO_IO_DXF_DEBUG_TRACE
-        std::cout << "ERROR DxfReader::OnReadSpline() -- " << err.GetMessageString() << std::endl;
-#endif
-        m_messenger->emitWarning(
-            fmt::format("DxfReader - Failed to create bspline({})", err.GetMessageString()));
-    }
-}
+    auto fnNonNull = [](double v) { return !MathUtils::fuzzyIsNull(v) ? v : 1.; };
+    double avgScale =
+        std::abs(fnNonNull((ins.scaleFactor.x + ins.scaleFactor.y + ins.scaleFactor.z) / 3.));
+    if (MathUtils::fuzzyEqual(avgScale, 1.))
+        avgScale = 1.;
 
-// Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-void DxfReader::Internal::OnReadInsert(const Dxf_INSERT &ins)
-{
+    // Entities defined after the insert are ignored
+    // Record indices of a layer are sorted, so the count of preceding entities identifies them
+    std::vector<Span<const size_t>> vecBlockRecordIndex;
+    size_t blockRecordCount = 0;
     const std::string prefix = "BLOCKS " + ins.blockName + " ";
-    for (const auto &[k, vecEntity] : m_layers)
+    for (size_t iLayer = 0; iLayer < m_vecLayerName.size(); ++iLayer)
     {
-        if (!startsWith(k, prefix))
+        if (!startsWith(m_vecLayerName.at(iLayer), prefix))
             continue; // Skip
 
-        TopoDS_Shape comp = BRepUtils::makeEmptyCompound();
-        for (const DxfReader::Entity &entity : vecEntity)
-        {
-            if (!entity.shape.IsNull())
-                BRepUtils::addShape(&comp, entity.shape);
-        }
+        const std::vector<size_t> &vecRecordIndex = m_vecLayerRecordIndex.at(iLayer);
+        const auto itEnd = std::lower_bound(vecRecordIndex.cbegin(), vecRecordIndex.cend(),
+                                            recordIndex);
+        const auto count = size_t(itEnd - vecRecordIndex.cbegin());
+        vecBlockRecordIndex.push_back(Span<const size_t>(vecRecordIndex.data(), count));
+        blockRecordCount += count;
+    }
 
-        if (comp.IsNull())
-            continue; // Skip
+    const BlockKey blockKey(ins.blockName, avgScale, blockRecordCount);
+    auto itBlock = m_mapBlockId.find(blockKey);
+    if (itBlock != m_mapBlockId.cend())
+        return itBlock->second;
 
-        if (!MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y) ||
-            !MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y))
+    // Gather the shapes of all the block layers
+    TopoDS_Shape comp = BRepUtils::makeEmptyCompound();
+    bool isEmpty = true;
+    for (Span<const size_t> spanRecordIndex : vecBlockRecordIndex)
+    {
+        for (size_t iRecord : spanRecordIndex)
         {
-            m_messenger->emitWarning(fmt::format("OnReadInsert('{}') - non-uniform scales aren't "
-                                                 "supported({}, {}, {})",
-                                                 ins.blockName, ins.scaleFactor.x,
-                                                 ins.scaleFactor.y, ins.scaleFactor.z));
+            if (!vecShape.at(iRecord).IsNull())
+            {
+                BRepUtils::addShape(&comp, vecShape.at(iRecord));
+                isEmpty = false;
+            }
         }
+    }
 
-        auto fnNonNull = [](double v) { return !MathUtils::fuzzyIsNull(v) ? v : 1.; };
-        const double avgScale =
-            std::abs(fnNonNull((ins.scaleFactor.x + ins.scaleFactor.y + ins.scaleFactor.z) / 3.));
+    int blockId = -1;
+    if (!isEmpty)
+    {
+        // Scaling isn't allowed in shape locations, so the block geometry is scaled once for
+        // all the inserts sharing that scale factor
         if (!MathUtils::fuzzyEqual(avgScale, 1.))
         {
             gp_Trsf trsf;
             trsf.SetScaleFactor(avgScale);
-            BRepBuilderAPI_Transform brepTrsf(comp, trsf);
+            BRepBuilderAPI_Transform brepTrsf(comp, trsf, true /*copy*/);
             if (brepTrsf.IsDone())
             {
                 comp = brepTrsf.Shape();
@@ -793,141 +1289,24 @@ void DxfReader::Internal::OnReadInsert(const Dxf_INSERT &ins)
             }
         }
 
-        gp_Trsf trsfRotZ;
-        if (!MathUtils::fuzzyIsNull(ins.rotationAngle))
-            trsfRotZ.SetRotation(gp::OZ(), ins.rotationAngle);
-
-        gp_Trsf trsfMove;
-        trsfMove.SetTranslation(this->toPnt(ins.insertPoint).XYZ());
-
-        comp.Location(trsfRotZ * trsfMove);
-        this->addShape(comp);
-    }
-}
-
-void DxfReader::Internal::OnReadDimension(const DxfCoords &s, const DxfCoords &e,
-                                          const DxfCoords &point, double rotation)
-{
-    if (m_params.importAnnotations)
-    {
-        // TODO
-        std::stringstream sstr;
-        sstr << "DxfReader::OnReadDimension() - Not yet implemented" << std::endl
-             << "    s: " << s.x << ", " << s.y << ", " << s.z << std::endl
-             << "    e: " << e.x << ", " << e.y << ", " << e.z << std::endl
-             << "    point: " << point.x << ", " << point.y << ", " << point.z << std::endl
-             << "    rotation: " << rotation << std::endl;
-        m_messenger->emitWarning(sstr.str());
-    }
-}
-
-void DxfReader::Internal::OnReadSolid(const Dxf_SOLID &solid)
-{
-    Dxf_QuadBase quad = solid;
-    if (solid.hasCorner4)
-    {
-        // See https://ezdxf.readthedocs.io/en/stable/dxfentities/solid.html
-        std::swap(quad.corner3, quad.corner4);
+        blockId = CppUtils::safeStaticCast<int>(m_blocks.size());
+        m_blocks.push_back({ins.blockName, comp});
     }
 
-    try
-    {
-        const TopoDS_Face face = makeFace(quad);
-        if (!face.IsNull())
-            this->addShape(face);
-    }
-    catch (...)
-    {
-        m_messenger->emitError("OnReadSolid() failed");
-    }
+    m_mapBlockId.insert({blockKey, blockId});
+    return blockId;
 }
 
-void DxfReader::Internal::OnRead3dFace(const Dxf_3DFACE &face)
-{
-    try
-    {
-        const TopoDS_Face brepFace = makeFace(face);
-        if (!brepFace.IsNull())
-            this->addShape(brepFace);
-    }
-    catch (...)
-    {
-        m_messenger->emitError("OnReadFace() failed");
-    }
-}
-
-void DxfReader::Internal::ReportError(const std::string &msg)
+gp_Trsf DxfReader::Internal::insertTrsf(const Dxf_INSERT &ins) const
 {
-    m_messenger->emitError(msg);
-}
-
-void DxfReader::Internal::AddGraphics() const
-{
-    // Nothing
-}
-
-gp_Pnt DxfReader::Internal::toPnt(const DxfCoords &coords) const
-{
-    double sp1(coords.x);
-    double sp2(coords.y);
-    double sp3(coords.z);
-    if (!MathUtils::fuzzyEqual(m_params.scaling, 1.))
-    {
-        sp1 = sp1 * m_params.scaling;
-        sp2 = sp2 * m_params.scaling;
-        sp3 = sp3 * m_params.scaling;
-    }
-
-    return gp_Pnt(sp1, sp2, sp3);
-}
-
-void DxfReader::Internal::addShape(const TopoDS_Shape &shape)
-{
-    const Entity newEntity{m_ColorIndex, shape};
-    const std::string layerName = this->LayerName();
-    auto itFound = m_layers.find(layerName);
-    if (itFound != m_layers.end())
-    {
-        std::vector<DxfReader::Entity> &vecEntity = itFound->second;
-        vecEntity.push_back(newEntity);
-    }
-    else
-    {
-        decltype(m_layers)::value_type pair(std::move(layerName), {newEntity});
-        m_layers.insert(std::move(pair));
-    }
-}
-
-TopoDS_Face DxfReader::Internal::makeFace(const Dxf_QuadBase &quad) const
-{
-    const gp_Pnt p1 = this->toPnt(quad.corner1);
-    const gp_Pnt p2 = this->toPnt(quad.corner2);
-    const gp_Pnt p3 = this->toPnt(quad.corner3);
-    const gp_Pnt p4 = this->toPnt(quad.corner4);
-
-    const double pntTolerance = Precision::Confusion();
-    if (p1.IsEqual(p2, pntTolerance) || p1.IsEqual(p3, pntTolerance) ||
-        p2.IsEqual(p3, pntTolerance))
-        return {};
-
-    TopoDS_Face face;
-    BRepBuilderAPI_MakeWire makeWire;
-    makeWire.Add(BRepBuilderAPI_MakeEdge(p1, p2));
-    makeWire.Add(BRepBuilderAPI_MakeEdge(p2, p3));
-    if (quad.hasCorner4 && !p3.IsEqual(p4, pntTolerance) && !p1.IsEqual(p4, pntTolerance))
-    {
-        makeWire.Add(BRepBuilderAPI_MakeEdge(p3, p4));
-        makeWire.Add(BRepBuilderAPI_MakeEdge(p4, p1));
-    }
-    else
-    {
-        makeWire.Add(BRepBuilderAPI_MakeEdge(p3, p1));
-    }
-
-    if (makeWire.IsDone())
-        face = BRepBuilderAPI_MakeFace(makeWire.Wire(), true /*onlyPlane*/);
-
-    return face;
+    // Block is rotated around its base point, then moved to the insertion point
+    gp_Trsf trsfRotZ;
+    if (!MathUtils::fuzzyIsNull(ins.rotationAngle))
+        trsfRotZ.SetRotation(gp::OZ(), ins.rotationAngle);
+
+    gp_Trsf trsfMove;
+    trsfMove.SetTranslation(this->toPnt(ins.insertPoint).XYZ());
+    return trsfMove * trsfRotZ;
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
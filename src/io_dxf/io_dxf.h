@@ -23,6 +23,7 @@ class DxfReader : public Reader
 {
 public:
     bool readFile(const FilePath &filepath, TaskProgress *progress) override;
+    bool readFile(const FileView &fileView, TaskProgress *progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) override;
 
     struct Parameters
@@ -52,8 +53,18 @@ private:
     {
         int aci = 0;
         TopoDS_Shape shape;
+        int blockId = -1; // Insert of block m_blocks[blockId], 'shape' is then the located block
     };
+
+    // Block shape shared by all its inserts, transferred as an XCAF prototype
+    struct Block
+    {
+        std::string name;
+        TopoDS_Shape shape;
+    };
+
     std::unordered_map<std::string, std::vector<Entity>> m_layers;
+    std::vector<Block> m_blocks;
     Parameters m_params;
 };
 
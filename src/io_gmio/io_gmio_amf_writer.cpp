@@ -16,6 +16,7 @@
 #include <fmt/format.h>
 #include <gmio_amf/amf_error.h>
 #include <gmio_amf/amf_io.h>
+#include <gmio_core/stream.h>
 #include <gp_Quaternion.hxx>
 
 #include "base/brep_utils.h"
@@ -61,6 +62,28 @@ gmio_task_iface gmio_createTask(TaskProgress *progress)
     return task;
 }
 
+size_t gmio_stringStreamWrite(void *cookie, const void *ptr, size_t size, size_t count)
+{
+    auto str = static_cast<std::string *>(cookie);
+    str->append(static_cast<const char *>(ptr), size * count);
+    return count;
+}
+
+int gmio_stringStreamError(void * /*cookie*/)
+{
+    return 0;
+}
+
+// Stream appending written bytes to 'str'
+gmio_stream gmio_createStringStream(std::string *str)
+{
+    gmio_stream stream = {};
+    stream.cookie = str;
+    stream.func_error = gmio_stringStreamError;
+    stream.func_write = gmio_stringStreamWrite;
+    return stream;
+}
+
 // #ifdef MAYO_HAVE_GMIO
 #if 0
 Format System::probeFormat(const QString& filepath) const
@@ -153,6 +176,27 @@ public:
         this->useZip64.setDescription(fmt::format(textIdTr("Use the ZIP64 format extensions.\n"
                                                            "Only applicable if option `{}` is on"),
                                                   this->createZipArchive.label()));
+
+        this->zipCompressionLevel.setConstraintsEnabled(true);
+        this->zipCompressionLevel.setRange(0, 9);
+        this->zipCompressionLevel.setDescription(
+            fmt::format(textIdTr("Compression level from 0(no compression) to 9(best size).\n"
+                                 "Only applicable if option `{}` is on"),
+                        this->createZipArchive.label()));
+
+        this->zipCompressionStrategy.mutableEnumeration().changeTrContext(this->textIdContext());
+        this->zipCompressionStrategy.setDescription(
+            textIdTr("Algorithm used to tune the compression(see zlib documentation)"));
+        this->zipCompressionStrategy.setDescriptions(
+            {{ZipDeflateStrategy::Default, textIdTr("Normal data")},
+             {ZipDeflateStrategy::Filtered, textIdTr("Data produced by a filter or predictor")},
+             {ZipDeflateStrategy::HuffmanOnly, textIdTr("Huffman encoding only, no string match")},
+             {ZipDeflateStrategy::Rle, textIdTr("Run-length encoding")},
+             {ZipDeflateStrategy::Fixed, textIdTr("Prevent the use of dynamic Huffman codes")}});
+
+        this->zipParallelDeflate.setDescription(
+            textIdTr("Compress independent blocks of the AMF document on all available cores.\n"
+                     "The AMF document is fully generated in memory before compression"));
     }
 
     void restoreDefaults() override
@@ -163,27 +207,37 @@ public:
         this->createZipArchive.setValue(params.createZipArchive);
         this->zipEntryFilename.setValue(params.zipEntryFilename);
         this->useZip64.setValue(params.useZip64);
-
-        this->zipEntryFilename.setEnabled(this->createZipArchive);
-        this->useZip64.setEnabled(this->createZipArchive);
+        this->zipCompressionLevel.setValue(params.zipCompressionLevel);
+        this->zipCompressionStrategy.setValue(params.zipCompressionStrategy);
+        this->zipParallelDeflate.setValue(params.zipParallelDeflate);
+        this->updateZipPropertiesEnabled();
     }
 
     void onPropertyChanged(Property *prop) override
     {
         if (prop == &this->createZipArchive)
-        {
-            this->zipEntryFilename.setEnabled(this->createZipArchive);
-            this->useZip64.setEnabled(this->createZipArchive);
-        }
+            this->updateZipPropertiesEnabled();
 
         PropertyGroup::onPropertyChanged(prop);
     }
 
+    void updateZipPropertiesEnabled()
+    {
+        this->zipEntryFilename.setEnabled(this->createZipArchive);
+        this->useZip64.setEnabled(this->createZipArchive);
+        this->zipCompressionLevel.setEnabled(this->createZipArchive);
+        this->zipCompressionStrategy.setEnabled(this->createZipArchive);
+        this->zipParallelDeflate.setEnabled(this->createZipArchive);
+    }
+
     PropertyEnum<GmioAmfWriter::FloatTextFormat> float64Format{this, textId("float64Format")};
     PropertyInt float64Precision{this, textId("float64Precision")};
     PropertyBool createZipArchive{this, textId("createZipArchive")};
     PropertyString zipEntryFilename{this, textId("zipEntryFilename")};
     PropertyBool useZip64{this, textId("useZip64")};
+    PropertyInt zipCompressionLevel{this, textId("zipCompressionLevel")};
+    PropertyEnum<ZipDeflateStrategy> zipCompressionStrategy{this, textId("zipCompressionStrategy")};
+    PropertyBool zipParallelDeflate{this, textId("zipParallelDeflate")};
 };
 
 bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress *progress)
@@ -304,9 +358,39 @@ bool GmioAmfWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
     amfOptions.zip_entry_filename = m_params.zipEntryFilename.c_str();
     amfOptions.zip_entry_filename_len =
         CppUtils::safeStaticCast<uint16_t>(m_params.zipEntryFilename.size());
-    // TODO Handle gmio_amf_write_options::z_compress_options
-    const int error = gmio_amf_write_file(filepath.u8string().c_str(), &amfDoc, &amfOptions);
-    return gmio_no_error(error);
+    // gmio follows zlib levels and strategies, except level 0 which means "default"
+    auto &zOptions = amfOptions.z_compress_options;
+    const int zLevel = m_params.zipCompressionLevel != 0 ? m_params.zipCompressionLevel : -1;
+    zOptions.level = static_cast<decltype(zOptions.level)>(zLevel);
+    zOptions.strategy = static_cast<decltype(zOptions.strategy)>(m_params.zipCompressionStrategy);
+    if (!m_params.createZipArchive || !m_params.zipParallelDeflate)
+    {
+        const int error = gmio_amf_write_file(filepath.u8string().c_str(), &amfDoc, &amfOptions);
+        return gmio_no_error(error);
+    }
+
+    // Generate plain AMF document in memory, then build the ZIP archive with parallel deflate
+    std::string amfContents;
+    {
+        TaskProgress amfProgress(progress, 50);
+        amfOptions.task_iface.cookie = &amfProgress;
+        amfOptions.create_zip_archive = false;
+        gmio_stream stream = gmio_createStringStream(&amfContents);
+        const int error = gmio_amf_write(&stream, &amfDoc, &amfOptions);
+        if (!gmio_no_error(error))
+            return false;
+    }
+
+    std::string entryFilename = m_params.zipEntryFilename;
+    if (entryFilename.empty())
+        entryFilename = filepath.stem().replace_extension(".amf").u8string();
+
+    ZipDeflateOptions zipOptions;
+    zipOptions.level = m_params.zipCompressionLevel;
+    zipOptions.strategy = m_params.zipCompressionStrategy;
+    zipOptions.useZip64 = m_params.useZip64;
+    return writeZipArchiveParallel(filepath, entryFilename, amfContents, zipOptions, progress, 50,
+                                   100);
 }
 
 std::unique_ptr<PropertyGroup> GmioAmfWriter::createProperties(PropertyGroup *parentGroup)
@@ -324,6 +408,9 @@ void GmioAmfWriter::applyProperties(const PropertyGroup *group)
         m_params.createZipArchive = ptr->createZipArchive;
         m_params.zipEntryFilename = ptr->zipEntryFilename;
         m_params.useZip64 = ptr->useZip64;
+        m_params.zipCompressionLevel = ptr->zipCompressionLevel;
+        m_params.zipCompressionStrategy = ptr->zipCompressionStrategy;
+        m_params.zipParallelDeflate = ptr->zipParallelDeflate;
     }
 }
 
@@ -16,6 +16,7 @@
 
 #include "base/document_ptr.h"
 #include "base/io_writer.h"
+#include "zip_deflate_parallel.h"
 
 namespace Mayo::IO
 {
@@ -48,6 +49,10 @@ public:
         bool createZipArchive = false;
         bool useZip64 = true;
         std::string zipEntryFilename; // UTF8
+        int zipCompressionLevel = 6; // In [0, 9], 0 means no compression
+        ZipDeflateStrategy zipCompressionStrategy = ZipDeflateStrategy::Default;
+        // AMF document is generated in memory then deflated by blocks on all cores
+        bool zipParallelDeflate = true;
     };
     Parameters &parameters()
     {
@@ -0,0 +1,332 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "zip_deflate_parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "base/io_output_file_buffer.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
+#include "base/task_progress.h"
+
+namespace Mayo::IO
+{
+
+namespace
+{
+
+// Size of the deflate window, that's also the size of the dictionary priming each block
+constexpr size_t DeflateWindowSize = 32 * 1024;
+// Minimum count of input bytes deflated by a task
+constexpr size_t DeflateGrainSize = 128 * 1024;
+
+constexpr uint32_t ZipMaxUInt32 = 0xFFFFFFFF;
+constexpr size_t ZLibMaxUInt = std::numeric_limits<uInt>::max();
+
+struct DeflatedBlock
+{
+    std::string bytes;
+    uLong crc = 0;
+    bool isValid = false;
+};
+
+int toZLibStrategy(ZipDeflateStrategy strategy)
+{
+    switch (strategy)
+    {
+    case ZipDeflateStrategy::Default: return Z_DEFAULT_STRATEGY;
+    case ZipDeflateStrategy::Filtered: return Z_FILTERED;
+    case ZipDeflateStrategy::HuffmanOnly: return Z_HUFFMAN_ONLY;
+    case ZipDeflateStrategy::Rle: return Z_RLE;
+    case ZipDeflateStrategy::Fixed: return Z_FIXED;
+    }
+
+    return Z_DEFAULT_STRATEGY;
+}
+
+uLong crc32Bytes(uLong crc, std::string_view bytes)
+{
+    while (!bytes.empty())
+    {
+        const size_t len = std::min(bytes.size(), ZLibMaxUInt);
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(bytes.data()), uInt(len));
+        bytes.remove_prefix(len);
+    }
+
+    return crc;
+}
+
+// Deflates data[begin, end) as a raw deflate block sequence
+// Non-last blocks are ended with a sync flush(byte aligned, no final bit set)
+DeflatedBlock deflateBlock(std::string_view data, size_t begin, size_t end, bool isLast,
+                           const ZipDeflateOptions &options)
+{
+    DeflatedBlock block;
+    const std::string_view input = data.substr(begin, end - begin);
+    block.crc = crc32Bytes(crc32(0, Z_NULL, 0), input);
+
+    z_stream zs = {};
+    const int level = std::clamp(options.level, 0, 9);
+    const int strategy = toZLibStrategy(options.strategy);
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK)
+        return block;
+
+    if (begin > 0)
+    {
+        const size_t dictBegin = begin > DeflateWindowSize ? begin - DeflateWindowSize : 0;
+        const auto dict = reinterpret_cast<const Bytef *>(data.data() + dictBegin);
+        deflateSetDictionary(&zs, dict, uInt(begin - dictBegin));
+    }
+
+    // Sync flush marker and final empty block are not accounted by deflateBound()
+    std::string &output = block.bytes;
+    output.resize(deflateBound(&zs, uLong(std::min(input.size(), ZLibMaxUInt))) + 16);
+    size_t inputPos = 0;
+    size_t outputPos = 0;
+    bool isDone = false;
+    while (!isDone)
+    {
+        if (zs.avail_in == 0 && inputPos < input.size())
+        {
+            const size_t len = std::min(input.size() - inputPos, ZLibMaxUInt);
+            zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data() + inputPos));
+            zs.avail_in = uInt(len);
+            inputPos += len;
+        }
+
+        if (outputPos == output.size())
+            output.resize(2 * output.size());
+
+        const size_t outputAvail = std::min(output.size() - outputPos, ZLibMaxUInt);
+        zs.next_out = reinterpret_cast<Bytef *>(output.data() + outputPos);
+        zs.avail_out = uInt(outputAvail);
+        const bool isInputFed = inputPos == input.size();
+        const int flush = isInputFed ? (isLast ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH;
+        const int ret = deflate(&zs, flush);
+        outputPos += outputAvail - zs.avail_out;
+        if (ret == Z_STREAM_ERROR)
+            break;
+
+        if (flush == Z_FINISH)
+            isDone = ret == Z_STREAM_END;
+        else if (flush == Z_SYNC_FLUSH)
+            isDone = zs.avail_in == 0 && zs.avail_out != 0;
+    }
+
+    deflateEnd(&zs);
+    output.resize(outputPos);
+    block.isValid = isDone;
+    return block;
+}
+
+// Appends little-endian encoded values
+class ZipRecord
+{
+public:
+    void u16(uint16_t v)
+    {
+        this->append(v, 2);
+    }
+    void u32(uint32_t v)
+    {
+        this->append(v, 4);
+    }
+    void u64(uint64_t v)
+    {
+        this->append(v, 8);
+    }
+    void bytes(std::string_view str)
+    {
+        m_bytes += str;
+    }
+
+    const std::string &data() const
+    {
+        return m_bytes;
+    }
+
+private:
+    void append(uint64_t v, int byteCount)
+    {
+        for (int i = 0; i < byteCount; ++i)
+            m_bytes += char((v >> (8 * i)) & 0xFF);
+    }
+
+    std::string m_bytes;
+};
+
+uint32_t clampedUInt32(uint64_t value)
+{
+    return value < ZipMaxUInt32 ? uint32_t(value) : ZipMaxUInt32;
+}
+
+// Current local time encoded in MS-DOS format, date in high word and time in low word
+uint32_t dosDateTime()
+{
+    const std::time_t now = std::time(nullptr);
+    const std::tm *tm = std::localtime(&now);
+    if (!tm || tm->tm_year < 80)
+        return (1 << 21) | (1 << 16); // 1980-01-01 00:00
+
+    const uint32_t date = ((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday;
+    const uint32_t time = (tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2);
+    return (date << 16) | time;
+}
+
+} // namespace
+
+bool writeZipArchiveParallel(const FilePath &filepath, std::string_view entryFilename,
+                             std::string_view data, const ZipDeflateOptions &options,
+                             TaskProgress *progress, int pctStart, int pctEnd)
+{
+    if (entryFilename.size() > std::numeric_limits<uint16_t>::max())
+        return false;
+
+    progress = progress ? progress : &TaskProgress::null();
+    const int pctDeflateEnd = pctStart + (pctEnd - pctStart) * 9 / 10;
+
+    // Deflate blocks in parallel
+    TaskManager taskMgr;
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, data.size(), DeflateGrainSize);
+    std::vector<DeflatedBlock> vecBlock(range.chunkCount());
+    const bool okDeflate = parallelForChunks(
+        taskMgr, range,
+        [&](size_t iChunk, size_t begin, size_t end)
+        {
+            const bool isLast = iChunk == range.chunkCount() - 1;
+            vecBlock.at(iChunk) = deflateBlock(data, begin, end, isLast, options);
+        },
+        progress, pctStart, pctDeflateEnd);
+    if (!okDeflate)
+        return false;
+
+    // Stitch blocks
+    uLong crc = crc32(0, Z_NULL, 0);
+    uint64_t compressedSize = 0;
+    for (size_t i = 0; i < vecBlock.size(); ++i)
+    {
+        const DeflatedBlock &block = vecBlock.at(i);
+        if (!block.isValid)
+            return false;
+
+        const auto blockSize = range.chunkEnd(i) - range.chunkBegin(i);
+        crc = crc32_combine(crc, block.crc, z_off_t(blockSize));
+        compressedSize += block.bytes.size();
+    }
+
+    const uint64_t uncompressedSize = data.size();
+    const bool isZip64 = options.useZip64 || compressedSize >= ZipMaxUInt32
+                         || uncompressedSize >= ZipMaxUInt32;
+    const uint16_t versionNeeded = isZip64 ? 45 : 20;
+    const uint16_t flags = 1 << 11; // Entry filename is UTF8
+    const uint16_t methodDeflate = 8;
+    const uint32_t dateTime = dosDateTime();
+
+    // Zip64 "extended information" extra field, local header and central directory header
+    // only differ by the local header offset which is always zero here
+    ZipRecord zip64Extra;
+    if (isZip64)
+    {
+        zip64Extra.u16(0x0001);
+        zip64Extra.u16(16);
+        zip64Extra.u64(uncompressedSize);
+        zip64Extra.u64(compressedSize);
+    }
+
+    const auto fnWriteFileHeader = [&](ZipRecord *rec, bool isCentral)
+    {
+        rec->u32(isCentral ? 0x02014b50 : 0x04034b50);
+        if (isCentral)
+            rec->u16(versionNeeded); // Version made by
+        rec->u16(versionNeeded);
+        rec->u16(flags);
+        rec->u16(methodDeflate);
+        rec->u32(dateTime);
+        rec->u32(uint32_t(crc));
+        rec->u32(isZip64 ? ZipMaxUInt32 : uint32_t(compressedSize));
+        rec->u32(isZip64 ? ZipMaxUInt32 : uint32_t(uncompressedSize));
+        rec->u16(uint16_t(entryFilename.size()));
+        rec->u16(uint16_t(zip64Extra.data().size()));
+        if (isCentral)
+        {
+            rec->u16(0); // File comment length
+            rec->u16(0); // Disk number start
+            rec->u16(0); // Internal file attributes
+            rec->u32(0); // External file attributes
+            rec->u32(0); // Offset of local header
+        }
+
+        rec->bytes(entryFilename);
+        rec->bytes(zip64Extra.data());
+    };
+
+    ZipRecord localHeader;
+    fnWriteFileHeader(&localHeader, false);
+
+    ZipRecord centralDir;
+    fnWriteFileHeader(&centralDir, true);
+    const uint64_t centralDirOffset = localHeader.data().size() + compressedSize;
+    const uint64_t centralDirSize = centralDir.data().size();
+
+    ZipRecord endRecords;
+    if (isZip64)
+    {
+        // Zip64 end of central directory record
+        endRecords.u32(0x06064b50);
+        endRecords.u64(44); // Size of remaining record
+        endRecords.u16(versionNeeded); // Version made by
+        endRecords.u16(versionNeeded);
+        endRecords.u32(0); // Number of this disk
+        endRecords.u32(0); // Disk where central directory starts
+        endRecords.u64(1); // Entry count on this disk
+        endRecords.u64(1); // Total entry count
+        endRecords.u64(centralDirSize);
+        endRecords.u64(centralDirOffset);
+        // Zip64 end of central directory locator
+        endRecords.u32(0x07064b50);
+        endRecords.u32(0); // Disk where zip64 end record starts
+        endRecords.u64(centralDirOffset + centralDirSize);
+        endRecords.u32(1); // Total disk count
+    }
+
+    // End of central directory record
+    endRecords.u32(0x06054b50);
+    endRecords.u16(0); // Number of this disk
+    endRecords.u16(0); // Disk where central directory starts
+    endRecords.u16(1); // Entry count on this disk
+    endRecords.u16(1); // Total entry count
+    endRecords.u32(clampedUInt32(centralDirSize));
+    endRecords.u32(clampedUInt32(centralDirOffset));
+    endRecords.u16(0); // Comment length
+
+    // Write archive
+    OutputFileBuffer file(filepath);
+    if (!file.isOpen())
+        return false;
+
+    file.write(localHeader.data());
+    for (DeflatedBlock &block : vecBlock)
+    {
+        file.write(block.bytes);
+        std::string().swap(block.bytes);
+    }
+
+    file.write(centralDir.data());
+    file.write(endRecords.data());
+    const bool ok = file.flush();
+    progress->setValue(pctEnd);
+    return ok;
+}
+
+} // namespace Mayo::IO
@@ -0,0 +1,49 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <string_view>
+
+#include "base/filepath.h"
+
+namespace Mayo
+{
+class TaskProgress;
+}
+
+namespace Mayo::IO
+{
+
+// Mirrors zlib deflate strategies(Z_DEFAULT_STRATEGY, Z_FILTERED, ...)
+enum class ZipDeflateStrategy
+{
+    Default,
+    Filtered,
+    HuffmanOnly,
+    Rle,
+    Fixed
+};
+
+struct ZipDeflateOptions
+{
+    int level = 6; // In [0, 9], 0 means no compression
+    ZipDeflateStrategy strategy = ZipDeflateStrategy::Default;
+    bool useZip64 = true;
+};
+
+// Writes ZIP archive 'filepath' containing a single entry named 'entryFilename'(UTF8) and holding
+// 'data'
+// Input is split into blocks deflated concurrently, each block being primed with the last 32KB
+// of the previous one. Blocks are ended with a sync flush so they can be concatenated into a
+// single valid deflate stream(like pigz does)
+// Progress is reported in [pctStart, pctEnd]
+// Returns false on error or if abort was requested
+bool writeZipArchiveParallel(const FilePath &filepath, std::string_view entryFilename,
+                             std::string_view data, const ZipDeflateOptions &options,
+                             TaskProgress *progress, int pctStart, int pctEnd);
+
+} // namespace Mayo::IO
@@ -0,0 +1,786 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_obj_reader.h"
+
+#include <TDataStd_Name.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <fast_float/fast_float.h>
+
+#include "base/brep_utils.h"
+#include "base/caf_utils.h"
+#include "base/document.h"
+#include "base/filepath_conv.h"
+#include "base/io_file_view.h"
+#include "base/mesh_utils.h"
+#include "base/messenger.h"
+#include "base/property_builtins.h"
+#include "base/string_conv.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
+#include "base/task_progress.h"
+#include "base/text_parse_utils.h"
+#include "base/triangulation_annex_data.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Mayo::IO
+{
+
+struct ObjReaderI18N
+{
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::ObjReaderI18N)
+};
+
+namespace
+{
+
+// Face corner, indices are 0-based and -1 if not specified
+struct ObjCorner
+{
+    int32_t v = -1;
+    int32_t vt = -1;
+    int32_t vn = -1;
+};
+
+enum class ObjEventType
+{
+    Group, // "g" and "o" records
+    Material, // "usemtl" record
+    MaterialLib // "mtllib" record
+};
+
+// Record changing the state applying to the next faces
+struct ObjEvent
+{
+    ObjEventType type = ObjEventType::Group;
+    std::string_view name;
+    size_t triangleIndex = 0; // Index of the next triangle
+};
+
+// Chunk of contents aligned on line boundaries, parsed by a single task
+struct ObjChunk
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    size_t vertexCount = 0;
+    size_t uvCount = 0;
+    size_t normalCount = 0;
+    size_t triangleCount = 0;
+    size_t firstVertexIndex = 0;
+    size_t firstUvIndex = 0;
+    size_t firstNormalIndex = 0;
+    size_t firstTriangleIndex = 0;
+    std::vector<ObjEvent> vecEvent; // Triangle indices are local to the chunk
+    bool hasError = false;
+};
+
+// Records read from file, faces being triangulated as fans
+struct ObjData
+{
+    std::vector<double> vecVertexCoord; // 3 coordinates per "v" record
+    std::vector<double> vecUvCoord; // 2 coordinates per "vt" record, empty if ignored
+    std::vector<float> vecNormalCoord; // 3 coordinates per "vn" record, empty if ignored
+    std::vector<ObjCorner> vecCorner; // 3 corners per triangle
+    std::vector<ObjEvent> vecEvent; // Triangle indices are global
+};
+
+// Triangles of a group/material pair, as ranges of triangle indices
+struct ObjPart
+{
+    std::string_view groupName;
+    std::string_view materialName;
+    std::vector<std::pair<size_t, size_t>> vecTriangleRange;
+};
+
+using namespace TextParseUtils;
+
+// Parses at most 'maxCount' floating point numbers starting 'str', at least 'minCount' numbers
+// are expected. Values not found are set to zero
+template <typename T>
+bool parseReals(std::string_view str, T *values, int minCount, int maxCount)
+{
+    const char *pos = str.data();
+    const char *end = str.data() + str.size();
+    for (int i = 0; i < maxCount; ++i)
+    {
+        while (pos < end && isSpace(*pos))
+            ++pos;
+
+        if (pos < end && *pos == '+')
+            ++pos;
+
+        const auto result = fast_float::from_chars(pos, end, values[i]);
+        if (result.ec != std::errc())
+        {
+            if (i < minCount)
+                return false;
+
+            std::fill(values + i, values + maxCount, T(0));
+            return true;
+        }
+
+        pos = result.ptr;
+    }
+
+    return true;
+}
+
+// Count of space separated words in 'str'
+size_t wordCount(std::string_view str)
+{
+    size_t count = 0;
+    bool isInWord = false;
+    for (char ch : str)
+    {
+        const bool isWordChar = !isSpace(ch);
+        count += isWordChar && !isInWord ? 1 : 0;
+        isInWord = isWordChar;
+    }
+
+    return count;
+}
+
+// Converts OBJ index 'index'(1-based, or relative to the end if negative) into a 0-based index
+// 'currentCount' is the count of elements defined so far, 'totalCount' the count of elements in
+// the file. Returns -1 on error
+int32_t resolveIndex(int64_t index, size_t currentCount, size_t totalCount)
+{
+    if (index > 0 && size_t(index) <= totalCount)
+        return int32_t(index - 1);
+    else if (index < 0 && size_t(-index) <= currentCount)
+        return int32_t(int64_t(currentCount) + index);
+    else
+        return -1;
+}
+
+// Counts of elements defined so far and in the whole file, used to resolve corner indices
+struct ObjIndexContext
+{
+    size_t currentCounts[3] = {}; // "v", "vt" and "vn"
+    size_t totalCounts[3] = {};
+    bool isUsed[3] = {}; // Whether indices are resolved for "v", "vt" and "vn"
+};
+
+// Parses face corner "v", "v/vt", "v//vn" or "v/vt/vn" starting 'str'
+// Returns the count of characters consumed, 0 on error
+size_t parseCorner(std::string_view str, const ObjIndexContext &ctx, ObjCorner *corner)
+{
+    int32_t *indices[] = {&corner->v, &corner->vt, &corner->vn};
+    const char *pos = str.data();
+    const char *end = str.data() + str.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i > 0)
+        {
+            if (pos == end || *pos != '/')
+                break;
+
+            ++pos;
+            if (pos == end || *pos == '/' || isSpace(*pos))
+                continue; // Index not specified
+        }
+
+        int64_t index = 0;
+        const auto result = std::from_chars(pos, end, index);
+        if (result.ec != std::errc())
+            return 0;
+
+        pos = result.ptr;
+        if (ctx.isUsed[i])
+        {
+            *indices[i] = resolveIndex(index, ctx.currentCounts[i], ctx.totalCounts[i]);
+            if (*indices[i] < 0)
+                return 0;
+        }
+    }
+
+    return pos != end && !isSpace(*pos) ? 0 : size_t(pos - str.data());
+}
+
+// Splits contents into chunks aligned on line boundaries
+std::vector<ObjChunk> splitIntoChunks(const TaskManager &taskMgr, std::string_view contents)
+{
+    std::vector<ObjChunk> vecChunk;
+    for (std::string_view chunkContents : splitIntoLineChunks(taskMgr, contents, 4 * 1024 * 1024))
+    {
+        ObjChunk chunk;
+        chunk.begin = chunkContents.data();
+        chunk.end = chunkContents.data() + chunkContents.size();
+        vecChunk.push_back(std::move(chunk));
+    }
+
+    return vecChunk;
+}
+
+// Contents are split into chunks, a first pass counts the records of each chunk so the second
+// pass knows where to store the values parsed
+// Returns false if abort was requested, error is reported in 'ptrError'
+bool readRecords(TaskManager &taskMgr, std::string_view contents,
+                 const ObjReader::Parameters &params, ObjData *data, std::string_view *ptrError,
+                 TaskProgress *progress, int pctStart, int pctEnd)
+{
+    std::vector<ObjChunk> vecChunk = splitIntoChunks(taskMgr, contents);
+    if (vecChunk.empty())
+        return true; // Empty contents, ChunkedRange would still provide one chunk
+
+    const ChunkedRange chunkRange(vecChunk.size(), vecChunk.size());
+    const int pctCountEnd = pctStart + (pctEnd - pctStart) / 4;
+
+    // First pass: count records and find state changes
+    auto fnCountRecords = [&](size_t ichunk, size_t, size_t)
+    {
+        ObjChunk &chunk = vecChunk.at(ichunk);
+        forEachLine(chunk.begin, chunk.end,
+                    [&](std::string_view line)
+                    {
+                        if (line.empty() || line.front() == '#')
+                            return true;
+
+                        if (consumeKeyword(&line, "v"))
+                        {
+                            ++chunk.vertexCount;
+                        }
+                        else if (consumeKeyword(&line, "vt"))
+                        {
+                            ++chunk.uvCount;
+                        }
+                        else if (consumeKeyword(&line, "vn"))
+                        {
+                            ++chunk.normalCount;
+                        }
+                        else if (consumeKeyword(&line, "f"))
+                        {
+                            const size_t cornerCount = wordCount(line);
+                            chunk.triangleCount += cornerCount >= 3 ? cornerCount - 2 : 0;
+                        }
+                        else
+                        {
+                            ObjEvent event;
+                            event.triangleIndex = chunk.triangleCount;
+                            if (consumeKeyword(&line, "g") || consumeKeyword(&line, "o"))
+                                event.type = ObjEventType::Group;
+                            else if (consumeKeyword(&line, "usemtl"))
+                                event.type = ObjEventType::Material;
+                            else if (consumeKeyword(&line, "mtllib"))
+                                event.type = ObjEventType::MaterialLib;
+                            else
+                                return true; // Other records are ignored
+
+                            event.name = trimmed(line);
+                            chunk.vecEvent.push_back(event);
+                        }
+
+                        return true;
+                    });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnCountRecords, progress, pctStart, pctCountEnd))
+        return false;
+
+    ObjIndexContext ctxTotal;
+    size_t triangleCount = 0;
+    for (ObjChunk &chunk : vecChunk)
+    {
+        chunk.firstVertexIndex = ctxTotal.totalCounts[0];
+        chunk.firstUvIndex = ctxTotal.totalCounts[1];
+        chunk.firstNormalIndex = ctxTotal.totalCounts[2];
+        chunk.firstTriangleIndex = triangleCount;
+        ctxTotal.totalCounts[0] += chunk.vertexCount;
+        ctxTotal.totalCounts[1] += chunk.uvCount;
+        ctxTotal.totalCounts[2] += chunk.normalCount;
+        triangleCount += chunk.triangleCount;
+        for (ObjEvent event : chunk.vecEvent)
+        {
+            event.triangleIndex += chunk.firstTriangleIndex;
+            data->vecEvent.push_back(event);
+        }
+    }
+
+    const auto fnIsTooLarge = [](size_t count) { return count > size_t(INT_MAX); };
+    if (std::any_of(ctxTotal.totalCounts, ctxTotal.totalCounts + 3, fnIsTooLarge)
+        || fnIsTooLarge(3 * triangleCount))
+    {
+        *ptrError = ObjReaderI18N::textIdTr("Too many elements");
+        return true;
+    }
+
+    ctxTotal.isUsed[0] = true;
+    ctxTotal.isUsed[1] = params.readTextureCoords;
+    ctxTotal.isUsed[2] = params.readNormals;
+    data->vecVertexCoord.resize(3 * ctxTotal.totalCounts[0]);
+    data->vecUvCoord.resize(params.readTextureCoords ? 2 * ctxTotal.totalCounts[1] : 0);
+    data->vecNormalCoord.resize(params.readNormals ? 3 * ctxTotal.totalCounts[2] : 0);
+    data->vecCorner.resize(3 * triangleCount);
+
+    // Second pass: parse values
+    auto fnParseRecords = [&](size_t ichunk, size_t, size_t)
+    {
+        ObjChunk &chunk = vecChunk.at(ichunk);
+        ObjIndexContext ctx = ctxTotal;
+        ctx.currentCounts[0] = chunk.firstVertexIndex;
+        ctx.currentCounts[1] = chunk.firstUvIndex;
+        ctx.currentCounts[2] = chunk.firstNormalIndex;
+        ObjCorner *corners = data->vecCorner.data() + 3 * chunk.firstTriangleIndex;
+        forEachLine(chunk.begin, chunk.end,
+                    [&](std::string_view line)
+                    {
+                        if (line.empty() || line.front() == '#')
+                            return true;
+
+                        if (consumeKeyword(&line, "v"))
+                        {
+                            double *coords = data->vecVertexCoord.data() + 3 * ctx.currentCounts[0];
+                            chunk.hasError = !parseReals(line, coords, 3, 3);
+                            ++ctx.currentCounts[0];
+                        }
+                        else if (consumeKeyword(&line, "vt"))
+                        {
+                            if (!data->vecUvCoord.empty())
+                            {
+                                double *coords = data->vecUvCoord.data() + 2 * ctx.currentCounts[1];
+                                chunk.hasError = !parseReals(line, coords, 1, 2);
+                            }
+
+                            ++ctx.currentCounts[1];
+                        }
+                        else if (consumeKeyword(&line, "vn"))
+                        {
+                            if (!data->vecNormalCoord.empty())
+                            {
+                                float *coords =
+                                    data->vecNormalCoord.data() + 3 * ctx.currentCounts[2];
+                                chunk.hasError = !parseReals(line, coords, 3, 3);
+                            }
+
+                            ++ctx.currentCounts[2];
+                        }
+                        else if (consumeKeyword(&line, "f"))
+                        {
+                            // Polygon is triangulated as a fan around its first corner
+                            ObjCorner firstCorner;
+                            ObjCorner prevCorner;
+                            int cornerCount = 0;
+                            line = trimmed(line);
+                            while (!line.empty() && !chunk.hasError)
+                            {
+                                ObjCorner corner;
+                                const size_t len = parseCorner(line, ctx, &corner);
+                                chunk.hasError = len == 0;
+                                if (cornerCount >= 2)
+                                {
+                                    *corners++ = firstCorner;
+                                    *corners++ = prevCorner;
+                                    *corners++ = corner;
+                                }
+
+                                firstCorner = cornerCount == 0 ? corner : firstCorner;
+                                prevCorner = corner;
+                                ++cornerCount;
+                                line = trimmed(line.substr(len));
+                            }
+                        }
+
+                        return !chunk.hasError;
+                    });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnParseRecords, progress, pctCountEnd, pctEnd))
+        return false;
+
+    auto fnHasError = [](const ObjChunk &chunk) { return chunk.hasError; };
+    if (std::any_of(vecChunk.cbegin(), vecChunk.cend(), fnHasError))
+        *ptrError = ObjReaderI18N::textIdTr("Invalid vertex, texture coordinates, normal or face");
+
+    return true;
+}
+
+// Groups consecutive triangles sharing the same group and material names
+std::vector<ObjPart> findParts(const std::vector<ObjEvent> &vecEvent, size_t triangleCount)
+{
+    std::vector<ObjPart> vecPart;
+    std::map<std::pair<std::string_view, std::string_view>, size_t> mapNamesPart;
+    std::string_view groupName;
+    std::string_view materialName;
+    size_t firstTriangleIndex = 0;
+    auto fnAddRange = [&](size_t endTriangleIndex)
+    {
+        if (endTriangleIndex <= firstTriangleIndex)
+            return;
+
+        auto [it, isNew] = mapNamesPart.try_emplace({groupName, materialName}, vecPart.size());
+        if (isNew)
+        {
+            ObjPart part;
+            part.groupName = groupName;
+            part.materialName = materialName;
+            vecPart.push_back(std::move(part));
+        }
+
+        vecPart.at(it->second).vecTriangleRange.push_back({firstTriangleIndex, endTriangleIndex});
+        firstTriangleIndex = endTriangleIndex;
+    };
+
+    for (const ObjEvent &event : vecEvent)
+    {
+        if (event.type == ObjEventType::MaterialLib)
+            continue;
+
+        fnAddRange(event.triangleIndex);
+        if (event.type == ObjEventType::Group)
+            groupName = event.name;
+        else
+            materialName = event.name;
+    }
+
+    fnAddRange(triangleCount);
+    return vecPart;
+}
+
+// Builds the mesh of 'part', nodes being the distinct corners of its triangles
+OccHandle<Poly_Triangulation> buildPartMesh(const ObjData &data, const ObjPart &part)
+{
+    // UV nodes and normals are kept only if all corners have them
+    size_t triangleCount = 0;
+    bool hasUvNodes = !data.vecUvCoord.empty();
+    bool hasNormals = !data.vecNormalCoord.empty();
+    int32_t minVertex = INT32_MAX;
+    int32_t maxVertex = 0;
+    for (const auto &[begin, end] : part.vecTriangleRange)
+    {
+        triangleCount += end - begin;
+        for (size_t i = 3 * begin; i < 3 * end; ++i)
+        {
+            const ObjCorner &corner = data.vecCorner[i];
+            minVertex = std::min(minVertex, corner.v);
+            maxVertex = std::max(maxVertex, corner.v);
+            hasUvNodes = hasUvNodes && corner.vt >= 0;
+            hasNormals = hasNormals && corner.vn >= 0;
+        }
+    }
+
+    // Distinct corners are mesh nodes. Nodes sharing the same vertex are chained
+    // Groups usually refer to a narrow range of vertices, which bounds the size of the lookup
+    std::vector<int32_t> vecVertexFirstNode(size_t(maxVertex - minVertex) + 1, -1);
+    std::vector<ObjCorner> vecNode;
+    std::vector<int32_t> vecNodeNext;
+    std::vector<int32_t> vecTriangleNode;
+    vecTriangleNode.reserve(3 * triangleCount);
+    for (const auto &[begin, end] : part.vecTriangleRange)
+    {
+        for (size_t i = 3 * begin; i < 3 * end; ++i)
+        {
+            ObjCorner corner = data.vecCorner[i];
+            corner.vt = hasUvNodes ? corner.vt : -1;
+            corner.vn = hasNormals ? corner.vn : -1;
+            int32_t &firstNode = vecVertexFirstNode[corner.v - minVertex];
+            int32_t inode = firstNode;
+            while (inode >= 0 && (vecNode[inode].vt != corner.vt || vecNode[inode].vn != corner.vn))
+                inode = vecNodeNext[inode];
+
+            if (inode < 0)
+            {
+                inode = int32_t(vecNode.size());
+                vecNode.push_back(corner);
+                vecNodeNext.push_back(firstNode);
+                firstNode = inode;
+            }
+
+            vecTriangleNode.push_back(inode);
+        }
+    }
+
+    vecVertexFirstNode = {};
+    // Triangles collapsed to a segment or a point are skipped
+    auto fnIsDegenerate = [&](size_t itriangle)
+    {
+        const int32_t *nodes = vecTriangleNode.data() + 3 * itriangle;
+        return nodes[0] == nodes[1] || nodes[1] == nodes[2] || nodes[0] == nodes[2];
+    };
+    size_t validTriangleCount = 0;
+    for (size_t i = 0; i < triangleCount; ++i)
+        validTriangleCount += fnIsDegenerate(i) ? 0 : 1;
+
+    // Build mesh, data is written in place
+    const auto nodeCount = int(vecNode.size());
+    auto mesh =
+        makeOccHandle<Poly_Triangulation>(nodeCount, int(validTriangleCount), hasUvNodes);
+    double *nodeCoords = MeshUtils::nodeCoordsData(mesh);
+    double *uvNodeCoords = hasUvNodes ? MeshUtils::uvNodeCoordsData(mesh) : nullptr;
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        const ObjCorner &node = vecNode[i];
+        const double *coords = data.vecVertexCoord.data() + 3 * size_t(node.v);
+        if (nodeCoords)
+            std::copy(coords, coords + 3, nodeCoords + 3 * size_t(i));
+        else
+            MeshUtils::setNode(mesh, i + 1, gp_Pnt(coords[0], coords[1], coords[2]));
+
+        if (hasUvNodes)
+        {
+            const double *uv = data.vecUvCoord.data() + 2 * size_t(node.vt);
+            if (uvNodeCoords)
+                std::copy(uv, uv + 2, uvNodeCoords + 2 * size_t(i));
+            else
+                MeshUtils::setUvNode(mesh, i + 1, uv[0], uv[1]);
+        }
+    }
+
+    if (hasNormals)
+    {
+        MeshUtils::allocateNormals(mesh);
+        float *normalCoords = MeshUtils::normalCoordsData(mesh);
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            const float *n = data.vecNormalCoord.data() + 3 * size_t(vecNode[i].vn);
+            if (normalCoords)
+                std::copy(n, n + 3, normalCoords + 3 * size_t(i));
+            else
+                MeshUtils::setNormal(mesh, i + 1, gp_Vec3f(n[0], n[1], n[2]));
+        }
+    }
+
+    int *triangleIndices = MeshUtils::triangleIndicesData(mesh);
+    size_t itriangle = 0;
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+        if (fnIsDegenerate(i))
+            continue;
+
+        const int32_t *nodes = vecTriangleNode.data() + 3 * i;
+        if (triangleIndices)
+        {
+            for (int j = 0; j < 3; ++j)
+                triangleIndices[3 * itriangle + j] = nodes[j] + 1;
+        }
+        else
+        {
+            const Poly_Triangle triangle(nodes[0] + 1, nodes[1] + 1, nodes[2] + 1);
+            MeshUtils::setTriangle(mesh, int(itriangle) + 1, triangle);
+        }
+
+        ++itriangle;
+    }
+
+    return mesh;
+}
+
+// Reads the diffuse colors("Kd" records) of the materials defined in MTL file 'filepath'
+void readMtlColors(const FilePath &filepath,
+                   std::unordered_map<std::string, Quantity_Color> *mapMaterialColor)
+{
+    const FileView fileView(filepath);
+    if (!fileView.isOpen())
+        return;
+
+    const std::string_view contents = fileView.contents();
+    std::string_view materialName;
+    forEachLine(contents.data(), contents.data() + contents.size(),
+                [&](std::string_view line)
+                {
+                    double rgb[3] = {};
+                    if (consumeKeyword(&line, "newmtl"))
+                        materialName = trimmed(line);
+                    else if (consumeKeyword(&line, "Kd") && parseReals(line, rgb, 3, 3))
+                        mapMaterialColor->insert_or_assign(
+                            std::string(materialName),
+                            Quantity_Color(std::clamp(rgb[0], 0., 1.), std::clamp(rgb[1], 0., 1.),
+                                           std::clamp(rgb[2], 0., 1.), Quantity_TOC_RGB));
+
+                    return true;
+                });
+}
+
+} // namespace
+
+class ObjReader::Properties : public PropertyGroup
+{
+public:
+    Properties(PropertyGroup *parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->readNormals.setDescription(
+            ObjReaderI18N::textIdTr("Read mesh node normals from the \"vn\" records"));
+        this->readTextureCoords.setDescription(
+            ObjReaderI18N::textIdTr("Read mesh UV nodes from the \"vt\" records"));
+    }
+
+    void restoreDefaults() override
+    {
+        const ObjReader::Parameters defaultParams;
+        this->readNormals.setValue(defaultParams.readNormals);
+        this->readTextureCoords.setValue(defaultParams.readTextureCoords);
+    }
+
+    PropertyBool readNormals{this, ObjReaderI18N::textId("readNormals")};
+    PropertyBool readTextureCoords{this, ObjReaderI18N::textId("readTextureCoords")};
+};
+
+bool ObjReader::readFile(const FilePath &filepath, TaskProgress *progress)
+{
+    return this->readFile(FileView(filepath), progress);
+}
+
+bool ObjReader::readFile(const FileView &fileView, TaskProgress *progress)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    auto fnError = [=](std::string_view strMessage)
+    {
+        this->messenger()->emitError(strMessage);
+        return false;
+    };
+
+    // Reset internal data
+    m_baseFilename = fileView.filepath().stem();
+    m_vecMesh.clear();
+
+    if (!fileView.isOpen())
+        return fnError(ObjReaderI18N::textIdTr("Can't open input file"));
+
+    // Read records
+    TaskManager taskMgr;
+    ObjData data;
+    {
+        std::string_view error;
+        if (!readRecords(taskMgr, fileView.contents(), m_params, &data, &error, progress, 0, 60))
+            return false;
+
+        if (!error.empty())
+            return fnError(error);
+    }
+
+    if (data.vecCorner.empty())
+        return fnError(ObjReaderI18N::textIdTr("No face found"));
+
+    // Material colors
+    std::unordered_map<std::string, Quantity_Color> mapMaterialColor;
+    for (const ObjEvent &event : data.vecEvent)
+    {
+        if (event.type != ObjEventType::MaterialLib)
+            continue;
+
+        // "mtllib" may list several files, file names containing spaces are not supported
+        std::string_view names = event.name;
+        while (!names.empty())
+        {
+            const auto itSpace = std::find_if(names.cbegin(), names.cend(), isSpace);
+            const auto len = size_t(itSpace - names.cbegin());
+            const FilePath mtlFilepath = filepathFrom(names.substr(0, len));
+            readMtlColors(fileView.filepath().parent_path() / mtlFilepath, &mapMaterialColor);
+            names = trimmed(names.substr(len));
+        }
+    }
+
+    progress->setValue(62);
+
+    // Build meshes, one per group/material pair
+    const std::vector<ObjPart> vecPart = findParts(data.vecEvent, data.vecCorner.size() / 3);
+    m_vecMesh.resize(vecPart.size());
+    auto fnBuildMeshes = [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            m_vecMesh.at(i).triangulation = buildPartMesh(data, vecPart.at(i));
+    };
+    const auto partRange = ChunkedRange::fromGrainSize(taskMgr, vecPart.size(), 1);
+    if (!parallelForChunks(taskMgr, partRange, fnBuildMeshes, progress, 62, 98))
+        return false;
+
+    // Exception thrown by some task(eg out of memory) leaves its mesh null
+    auto fnIsNull = [](const Mesh &mesh) { return mesh.triangulation.IsNull(); };
+    if (std::any_of(m_vecMesh.cbegin(), m_vecMesh.cend(), fnIsNull))
+    {
+        m_vecMesh.clear();
+        return fnError(ObjReaderI18N::textIdTr("Failed to build meshes"));
+    }
+
+    for (size_t i = 0; i < vecPart.size(); ++i)
+    {
+        const ObjPart &part = vecPart.at(i);
+        Mesh &mesh = m_vecMesh.at(i);
+        if (!part.groupName.empty())
+            mesh.name = part.groupName;
+        else if (!part.materialName.empty())
+            mesh.name = part.materialName;
+        else
+            mesh.name = filepathTo<std::string>(m_baseFilename);
+
+        auto itColor = mapMaterialColor.find(std::string(part.materialName));
+        if (itColor != mapMaterialColor.cend())
+            mesh.color = itColor->second;
+    }
+
+    // Meshes made empty by skipped degenerate triangles
+    auto fnIsEmpty = [](const Mesh &mesh) { return mesh.triangulation->NbTriangles() == 0; };
+    m_vecMesh.erase(std::remove_if(m_vecMesh.begin(), m_vecMesh.end(), fnIsEmpty),
+                    m_vecMesh.end());
+    progress->setValue(100);
+    return true;
+}
+
+TDF_LabelSequence ObjReader::transfer(DocumentPtr doc, TaskProgress * /*progress*/)
+{
+    if (m_vecMesh.empty())
+        return {};
+
+    OccHandle<XCAFDoc_ShapeTool> shapeTool = doc->xcaf().shapeTool();
+    OccHandle<XCAFDoc_ColorTool> colorTool = doc->xcaf().colorTool();
+    auto fnSetMeshData = [&](const TDF_Label &label, const Mesh &mesh)
+    {
+        TriangulationAnnexData::Set(label); // IMPORTANT: pure mesh part marker!
+        if (mesh.color)
+            colorTool->SetColor(label, colorTool->AddColor(*mesh.color), XCAFDoc_ColorGen);
+    };
+
+    // Single mesh is a plain entity
+    if (m_vecMesh.size() == 1)
+    {
+        const TDF_Label entityLabel = doc->newEntityShapeLabel();
+        doc->xcaf().setShape(entityLabel, BRepUtils::makeFace(m_vecMesh.front().triangulation));
+        fnSetMeshData(entityLabel, m_vecMesh.front());
+        TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+        return CafUtils::makeLabelSequence({entityLabel});
+    }
+
+    // Meshes are components of an assembly named after the file
+    const TopoDS_Shape emptyComp = BRepUtils::makeEmptyCompound();
+    const TDF_Label labelAsm = shapeTool->AddShape(emptyComp, true /*makeAssembly*/);
+    TDataStd_Name::Set(labelAsm, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+    for (const Mesh &mesh : m_vecMesh)
+    {
+        const TopoDS_Face face = BRepUtils::makeFace(mesh.triangulation);
+        const TDF_Label labelMesh = shapeTool->AddShape(face, false /*makeAssembly*/);
+        fnSetMeshData(labelMesh, mesh);
+        TDataStd_Name::Set(labelMesh, to_OccExtString(mesh.name));
+        shapeTool->AddComponent(labelAsm, labelMesh, TopLoc_Location());
+    }
+
+    shapeTool->UpdateAssemblies();
+    return CafUtils::makeLabelSequence({labelAsm});
+}
+
+std::unique_ptr<PropertyGroup> ObjReader::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void ObjReader::applyProperties(const PropertyGroup *params)
+{
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
+    {
+        m_params.readNormals = ptr->readNormals;
+        m_params.readTextureCoords = ptr->readTextureCoords;
+    }
+}
+
+} // namespace Mayo::IO
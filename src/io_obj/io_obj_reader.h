@@ -0,0 +1,77 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+
+#include "base/io_reader.h"
+#include "base/io_single_format_factory.h"
+#include "base/occ_handle.h"
+
+namespace Mayo::IO
+{
+
+// Reader for Wavefront OBJ file format
+// Records are parsed in parallel over chunks of the file contents, then one mesh is built per
+// group/material pair. Diffuse colors of materials are read from the referenced MTL files
+class ObjReader : public Reader
+{
+public:
+    bool readFile(const FilePath &filepath, TaskProgress *progress) override;
+    bool readFile(const FileView &fileView, TaskProgress *progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) override;
+    bool isConcurrentTransferSupported() const override
+    {
+        return true;
+    }
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
+    void applyProperties(const PropertyGroup *params) override;
+
+    // Parameters
+    struct Parameters
+    {
+        // Mesh node normals are read from the "vn" records
+        bool readNormals = true;
+        // Mesh UV nodes are read from the "vt" records
+        bool readTextureCoords = true;
+    };
+    Parameters &parameters()
+    {
+        return m_params;
+    }
+    const Parameters &constParameters() const
+    {
+        return m_params;
+    }
+
+private:
+    // Triangles of a group/material pair
+    struct Mesh
+    {
+        std::string name;
+        OccHandle<Poly_Triangulation> triangulation;
+        std::optional<Quantity_Color> color;
+    };
+
+    class Properties;
+    Parameters m_params;
+    FilePath m_baseFilename;
+    std::vector<Mesh> m_vecMesh;
+};
+
+// Provides factory to create ObjReader objects
+class ObjFactoryReader : public SingleFormatFactoryReader<Format_OBJ, ObjReader>
+{
+};
+
+} // namespace Mayo::IO
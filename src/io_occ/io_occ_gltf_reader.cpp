@@ -6,6 +6,9 @@
 
 #include "io_occ_gltf_reader.h"
 
+#include <fmt/format.h>
+
+#include "base/messenger.h"
 #include "base/property_builtins.h"
 
 namespace Mayo::IO
@@ -23,6 +26,12 @@ public:
             textIdTr("Ignore nodes without geometry(`Yes` by default)"));
         this->useMeshNameAsFallback.setDescription(
             textIdTr("Use mesh name in case if node name is empty(`Yes` by default)"));
+        this->parallelLoading.setDescription(
+            textIdTr("Load binary data of meshes using multiple threads(`Yes` by default)"));
+        this->lateDataLoading.setDescription(
+            textIdTr("Read only the structure of the glTF file, binary data of meshes being "
+                     "loaded later when displayed or exported.\n\n"
+                     "Opening of big files is then almost immediate(`No` by default)"));
     }
 
     void restoreDefaults() override
@@ -30,10 +39,14 @@ public:
         OccBaseMeshReaderProperties::restoreDefaults();
         this->skipEmptyNodes.setValue(true);
         this->useMeshNameAsFallback.setValue(true);
+        this->parallelLoading.setValue(true);
+        this->lateDataLoading.setValue(false);
     }
 
     PropertyBool skipEmptyNodes{this, textId("skipEmptyNodes")};
     PropertyBool useMeshNameAsFallback{this, textId("useMeshNameAsFallback")};
+    PropertyBool parallelLoading{this, textId("parallelLoading")};
+    PropertyBool lateDataLoading{this, textId("lateDataLoading")};
 };
 
 OccGltfReader::OccGltfReader()
@@ -54,6 +67,8 @@ void OccGltfReader::applyProperties(const PropertyGroup *params)
     {
         m_params.useMeshNameAsFallback = ptr->useMeshNameAsFallback;
         m_params.skipEmptyNodes = ptr->skipEmptyNodes;
+        m_params.parallelLoading = ptr->parallelLoading;
+        m_params.lateDataLoading = ptr->lateDataLoading;
     }
 }
 
@@ -62,6 +77,20 @@ void OccGltfReader::applyParameters()
     OccBaseMeshReader::applyParameters();
     m_reader.SetSkipEmptyNodes(m_params.skipEmptyNodes);
     m_reader.SetMeshNameAsFallback(m_params.useMeshNameAsFallback);
+    m_reader.SetParallel(m_params.parallelLoading);
+#if OCC_VERSION_HEX >= 0x070600
+    m_reader.SetToSkipLateDataLoading(m_params.lateDataLoading);
+    if (m_params.lateDataLoading)
+        m_reader.SetToKeepLateData(true); // Triangulations can be loaded afterwards
+#else
+    if (m_params.lateDataLoading)
+    {
+        this->messenger()->emitWarning(
+            fmt::format(Properties::textIdTr("Option supported from OpenCascade ≥ v7.6 "
+                                             "[option={}, actual version={}]"),
+                        "lateDataLoading", OCC_VERSION_COMPLETE));
+    }
+#endif
 }
 
 } // namespace Mayo::IO
@@ -29,6 +29,11 @@ public:
     {
         bool skipEmptyNodes = true;
         bool useMeshNameAsFallback = true;
+        // Load binary buffers of meshes on several threads
+        bool parallelLoading = true;
+        // Only build the document tree when reading, binary buffers of meshes are loaded
+        // afterwards(see BRepUtils::loadDeferredTriangulations())
+        bool lateDataLoading = false;
     };
     OccGltfReader::Parameters &parameters() override
     {
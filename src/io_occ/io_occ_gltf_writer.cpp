@@ -6,23 +6,195 @@
 
 #include "io_occ_gltf_writer.h"
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
 #include <RWGltf_CafWriter.hxx>
+#include <Standard_Version.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#if OCC_VERSION_HEX >= 0x070600
+#include <XCAFDoc_Editor.hxx>
+#endif
 #include <fmt/format.h>
 
 #include "base/application_item.h"
+#include "base/brep_utils.h"
+#include "base/document.h"
 #include "base/enumeration_fromenum.h"
 #include "base/io_system.h"
+#include "base/mesh_utils.h"
 #include "base/messenger.h"
 #include "base/occ_progress_indicator.h"
 #include "base/property_builtins.h"
 #include "base/property_enumeration.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
 #include "base/text_id.h"
+#include "base/xcaf.h"
 
 #include "io_occ_common.h"
 
 namespace Mayo::IO
 {
 
+namespace
+{
+
+#if OCC_VERSION_HEX >= 0x070600
+// Maps triangulations to their optimized copy
+using MapOptimizedTriangulation =
+    std::unordered_map<const Poly_Triangulation *, OccHandle<Poly_Triangulation>>;
+
+// Maps TShape of a shape to its rebuilt copy
+using MapRebuiltShape = std::unordered_map<const TopoDS_TShape *, TopoDS_Shape>;
+
+// Unique triangulations of the faces in the shapes of 'seqLabel'
+std::vector<OccHandle<Poly_Triangulation>> uniqueTriangulations(const TDF_LabelSequence &seqLabel)
+{
+    std::vector<OccHandle<Poly_Triangulation>> vecTriangulation;
+    std::unordered_set<const Poly_Triangulation *> setTriangulation;
+    for (const TDF_Label &label : seqLabel)
+    {
+        BRepUtils::forEachSubFace(
+            XCaf::shape(label),
+            [&](const TopoDS_Face &face)
+            {
+                TopLoc_Location loc;
+                const OccHandle<Poly_Triangulation> &mesh = BRep_Tool::Triangulation(face, loc);
+                if (!mesh.IsNull() && mesh->NbTriangles() > 0 &&
+                    setTriangulation.insert(mesh.get()).second)
+                {
+                    vecTriangulation.push_back(mesh);
+                }
+            });
+    }
+
+    return vecTriangulation;
+}
+
+// Computes in parallel optimized copies of the triangulations
+// Returns false if abort was requested
+bool optimizeTriangulations(Span<const OccHandle<Poly_Triangulation>> spanTriangulation,
+                            MapOptimizedTriangulation *ptrMapOptimized, TaskProgress *progress)
+{
+    TaskManager taskMgr;
+    std::vector<OccHandle<Poly_Triangulation>> vecOptimized(spanTriangulation.size());
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, spanTriangulation.size(), 1);
+    const bool ok = parallelForChunks(
+        taskMgr, range,
+        [&](size_t, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                vecOptimized.at(i) = MeshUtils::optimizedTriangulation(spanTriangulation[i]);
+        },
+        progress, 0, 100);
+    if (!ok)
+        return false;
+
+    for (size_t i = 0; i < spanTriangulation.size(); ++i)
+        ptrMapOptimized->insert({spanTriangulation[i].get(), vecOptimized.at(i)});
+
+    return true;
+}
+
+// Returns copy of 'shape' where faces are replaced by new ones using the optimized triangulations
+// Faces of 'shape' are left untouched, sub-shapes of faces(wires, edges, ...) are shared
+TopoDS_Shape rebuiltShape(const TopoDS_Shape &shape, const MapOptimizedTriangulation &mapOptimized,
+                          MapRebuiltShape *ptrMapRebuilt)
+{
+    if (shape.IsNull() || shape.ShapeType() > TopAbs_FACE)
+        return shape;
+
+    auto it = ptrMapRebuilt->find(shape.TShape().get());
+    if (it == ptrMapRebuilt->end())
+    {
+        const TopoDS_Shape shapeFwd = shape.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD);
+        TopoDS_Shape shapeCopy = shapeFwd.EmptyCopied();
+        BRep_Builder builder;
+        for (TopoDS_Iterator itSub(shapeFwd, false, false); itSub.More(); itSub.Next())
+            builder.Add(shapeCopy, rebuiltShape(itSub.Value(), mapOptimized, ptrMapRebuilt));
+
+        shapeCopy.Closed(shapeFwd.Closed());
+        if (shapeCopy.ShapeType() == TopAbs_FACE)
+        {
+            const TopoDS_Face &face = TopoDS::Face(shapeFwd);
+            const TopoDS_Face &faceCopy = TopoDS::Face(shapeCopy);
+            TopLoc_Location loc;
+            OccHandle<Poly_Triangulation> mesh = BRep_Tool::Triangulation(face, loc);
+            auto itOptimized = mapOptimized.find(mesh.get());
+            if (itOptimized != mapOptimized.cend())
+                mesh = itOptimized->second;
+
+            if (!mesh.IsNull())
+                builder.UpdateFace(faceCopy, mesh);
+
+            builder.NaturalRestriction(faceCopy, BRep_Tool::NaturalRestriction(face));
+        }
+
+        it = ptrMapRebuilt->insert({shape.TShape().get(), shapeCopy}).first;
+    }
+
+    return it->second.Located(shape.Location()).Oriented(shape.Orientation());
+}
+
+// Copies shapes of 'seqLabel' into a new document where faces are given optimized triangulations
+// Shapes of the source document are left untouched, so it can be safely used concurrently
+// Returns null document if abort was requested
+OccHandle<TDocStd_Document> optimizedDocumentCopy(const DocumentPtr &doc,
+                                                  const TDF_LabelSequence &seqLabel,
+                                                  TaskProgress *progress)
+{
+    OccHandle<TDocStd_Document> docCopy = new TDocStd_Document("BinXCAF");
+    XCAFDoc_DocumentTool::Set(docCopy->Main());
+    double lengthUnit = 1.;
+    if (XCAFDoc_DocumentTool::GetLengthUnit(doc, lengthUnit))
+        XCAFDoc_DocumentTool::SetLengthUnit(docCopy, lengthUnit);
+
+    if (!XCAFDoc_Editor::Extract(seqLabel, XCAFDoc_DocumentTool::ShapesLabel(docCopy->Main())))
+        return {};
+
+    // Only simple shapes hold faces, assemblies are rebuilt afterwards from their components
+    OccHandle<XCAFDoc_ShapeTool> shapeTool = XCAFDoc_DocumentTool::ShapeTool(docCopy->Main());
+    TDF_LabelSequence seqShapeLabel;
+    shapeTool->GetShapes(seqShapeLabel);
+    TDF_LabelSequence seqSimpleLabel;
+    for (const TDF_Label &label : seqShapeLabel)
+    {
+        if (XCaf::isShapeSimple(label))
+            seqSimpleLabel.Append(label);
+    }
+
+    // Extracted shapes still share their faces with the source document
+    const std::vector<OccHandle<Poly_Triangulation>> vecTriangulation =
+        uniqueTriangulations(seqSimpleLabel);
+    MapOptimizedTriangulation mapOptimized;
+    if (!optimizeTriangulations(vecTriangulation, &mapOptimized, progress))
+        return {};
+
+    MapRebuiltShape mapRebuilt;
+    for (const TDF_Label &label : seqSimpleLabel)
+    {
+        shapeTool->SetShape(label, rebuiltShape(XCaf::shape(label), mapOptimized, &mapRebuilt));
+        for (const TDF_Label &labelSub : XCaf::shapeSubs(label))
+        {
+            const TopoDS_Shape shapeSub = XCaf::shape(labelSub);
+            shapeTool->SetShape(labelSub, rebuiltShape(shapeSub, mapOptimized, &mapRebuilt));
+        }
+    }
+
+    shapeTool->UpdateAssemblies();
+    return docCopy;
+}
+#endif
+
+} // namespace
+
 class OccGltfWriter::Properties : public PropertyGroup
 {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccGltfWriter::Properties)
@@ -69,6 +241,10 @@ public:
                                  "indexes.\n\n"
                                  "Applicable only if option `{}` is on"),
                         this->mergeFaces.label()));
+        this->optimizeMeshes.setDescription(
+            textIdTr("Reorder mesh triangles to improve reuse of vertices by GPU cache, then "
+                     "reorder mesh vertices in the order they are first used by triangles.\n\n"
+                     "Doesn't change the geometry, but reduces rendering cost of exported meshes"));
     }
 
     void restoreDefaults() override
@@ -89,6 +265,7 @@ public:
         this->embedTextures.setValue(defaults.embedTextures);
         this->mergeFaces.setValue(defaults.mergeFaces);
         this->keepIndices16b.setValue(defaults.keepIndices16b);
+        this->optimizeMeshes.setValue(defaults.optimizeMeshes);
 
         this->embedTextures.setEnabled(this->format == OccGltfWriter::Format::Binary);
         this->keepIndices16b.setEnabled(this->mergeFaces);
@@ -117,6 +294,7 @@ public:
     PropertyBool embedTextures{this, textId("embedTextures")};
     PropertyBool mergeFaces{this, textId("mergeFaces")};
     PropertyBool keepIndices16b{this, textId("keepIndices16b")};
+    PropertyBool optimizeMeshes{this, textId("optimizeMeshes")};
 };
 
 bool OccGltfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress *)
@@ -151,7 +329,25 @@ bool OccGltfWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
     if (!m_document)
         return false;
 
-    auto occProgress = makeOccHandle<OccProgressIndicator>(progress);
+    // Optimized meshes are written from a private copy of the shapes, document being untouched
+    OccHandle<TDocStd_Document> docOutput = m_document;
+    TDF_LabelSequence seqOutputLabel = m_seqRootLabel;
+#if OCC_VERSION_HEX >= 0x070600
+    if (m_params.optimizeMeshes)
+    {
+        TaskProgress optimizeProgress(progress, 20);
+        const TDF_LabelSequence seqLabel =
+            !m_seqRootLabel.IsEmpty() ? m_seqRootLabel : m_document->xcaf().topLevelFreeShapes();
+        docOutput = optimizedDocumentCopy(m_document, seqLabel, &optimizeProgress);
+        if (!docOutput)
+            return false;
+
+        seqOutputLabel.Clear();
+    }
+#endif
+
+    TaskProgress writeProgress(progress, m_params.optimizeMeshes ? 80 : 100);
+    auto occProgress = makeOccHandle<OccProgressIndicator>(&writeProgress);
     const bool isBinary = m_params.format == Format::Binary;
     RWGltf_CafWriter writer(filepath.u8string().c_str(), isBinary);
     writer.ChangeCoordinateSystemConverter().SetInputCoordinateSystem(
@@ -201,12 +397,15 @@ bool OccGltfWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
     if (m_params.keepIndices16b != defaultParams.keepIndices16b)
         this->messenger()->emitWarning(fnWarningOptionNA("keepIndices16b"));
 
+    if (m_params.optimizeMeshes != defaultParams.optimizeMeshes)
+        this->messenger()->emitWarning(fnWarningOptionNA("optimizeMeshes"));
+
 #endif
     const TColStd_IndexedDataMapOfStringString fileInfo;
-    if (m_seqRootLabel.IsEmpty())
-        return writer.Perform(m_document, fileInfo, occProgress->Start());
+    if (seqOutputLabel.IsEmpty())
+        return writer.Perform(docOutput, fileInfo, occProgress->Start());
     else
-        return writer.Perform(m_document, m_seqRootLabel, nullptr, fileInfo, occProgress->Start());
+        return writer.Perform(docOutput, seqOutputLabel, nullptr, fileInfo, occProgress->Start());
 }
 
 std::unique_ptr<PropertyGroup> OccGltfWriter::createProperties(PropertyGroup *parentGroup)
@@ -229,6 +428,7 @@ void OccGltfWriter::applyProperties(const PropertyGroup *params)
         m_params.embedTextures = ptr->embedTextures;
         m_params.mergeFaces = ptr->mergeFaces;
         m_params.keepIndices16b = ptr->keepIndices16b;
+        m_params.optimizeMeshes = ptr->optimizeMeshes;
     }
 }
 
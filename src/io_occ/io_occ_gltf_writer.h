@@ -59,6 +59,8 @@ public:
         bool embedTextures = true; // Only applicable if `format` == Format::Binary
         bool mergeFaces = false;
         bool keepIndices16b = false; // Only applicable if 'mergeFaces' == true
+        // Reorder triangles and nodes of meshes for GPU vertex cache and vertex fetch locality
+        bool optimizeMeshes = false;
     };
     Parameters &parameters()
     {
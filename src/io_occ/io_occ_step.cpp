@@ -14,6 +14,7 @@
 #include <STEPCAFControl_Controller.hxx>
 #include <fmt/format.h>
 
+#include "base/io_file_view.h"
 #include "base/meta_enum.h"
 #include "base/occ_static_variables_rollback.h"
 #include "base/property_builtins.h"
@@ -74,6 +75,12 @@ public:
             textIdTr("Indicates whether to read sub-shape names from 'Name' attributes of "
                      "STEP Representation Items"));
 
+        this->structurePreview.setDescription(
+            textIdTr("Read only the product structure(assemblies, parts, names and instances) "
+                     "with a lightweight scan of the file, geometry isn't read.\n"
+                     "This is much faster than a full read and allows to quickly browse the "
+                     "bill of materials of large files"));
+
         this->productContext.setDescriptions(
             {{ProductContext::Design,
               textIdTr("Translate only products that have "
@@ -128,6 +135,7 @@ public:
         this->readShapeAspect.setValue(params.readShapeAspect);
         this->readSubShapesNames.setValue(params.readSubShapesNames);
         this->encoding.setValue(params.encoding);
+        this->structurePreview.setValue(params.structurePreview);
     }
 
     PropertyEnum<ProductContext> productContext{this, textId("productContext")};
@@ -137,6 +145,7 @@ public:
     PropertyBool readShapeAspect{this, textId("readShapeAspect")};
     PropertyBool readSubShapesNames{this, textId("readSubShapesNames")};
     PropertyEnum<Encoding> encoding{this, textId("encoding")};
+    PropertyBool structurePreview{this, textId("structurePreview")};
 };
 
 OccStepReader::OccStepReader()
@@ -160,6 +169,15 @@ OccStepReader::~OccStepReader()
 
 bool OccStepReader::readFile(const FilePath &filepath, TaskProgress *progress)
 {
+    m_isProductStructureRead = m_params.structurePreview;
+    m_productStructure = {};
+    if (m_params.structurePreview)
+    {
+        const FileView fileView(filepath);
+        return fileView.isOpen()
+               && scanStepProductStructure(fileView.contents(), &m_productStructure, progress);
+    }
+
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
@@ -168,6 +186,9 @@ bool OccStepReader::readFile(const FilePath &filepath, TaskProgress *progress)
 
 TDF_LabelSequence OccStepReader::transfer(DocumentPtr doc, TaskProgress *progress)
 {
+    if (m_isProductStructureRead)
+        return transferStepProductStructure(m_productStructure, doc);
+
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
@@ -190,6 +211,7 @@ void OccStepReader::applyProperties(const PropertyGroup *group)
         m_params.readShapeAspect = ptr->readShapeAspect;
         m_params.readSubShapesNames = ptr->readSubShapesNames;
         m_params.encoding = ptr->encoding;
+        m_params.structurePreview = ptr->structurePreview;
     }
 }
 
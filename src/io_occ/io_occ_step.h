@@ -17,6 +17,7 @@
 #include "base/tkernel_utils.h"
 
 #include "io_occ_common.h"
+#include "io_occ_step_structure.h"
 
 namespace Mayo::IO
 {
@@ -104,6 +105,9 @@ public:
         bool readShapeAspect = true;
         bool readSubShapesNames = false;
         Encoding encoding = Encoding::UTF8;
+        // Only the product structure(assemblies, parts and their instances) is read, with a
+        // lightweight scan of the file. Geometry isn't read
+        bool structurePreview = false;
     };
     Parameters &parameters()
     {
@@ -124,6 +128,8 @@ private:
     STEPCAFControl_Reader *m_reader = nullptr;
     std::aligned_storage_t<sizeof(STEPCAFControl_Reader)> m_readerStorage;
     Parameters m_params;
+    bool m_isProductStructureRead = false;
+    StepProductStructure m_productStructure;
 };
 
 // Opencascade-based writer for STEP file format
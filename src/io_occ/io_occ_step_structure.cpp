@@ -0,0 +1,486 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_step_structure.h"
+
+#include <TDataStd_Name.hxx>
+#include <TopLoc_Location.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <fmt/format.h>
+
+#include "base/brep_utils.h"
+#include "base/document.h"
+#include "base/math_utils.h"
+#include "base/string_conv.h"
+#include "base/task_progress.h"
+#include "base/text_parse_utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+namespace Mayo::IO
+{
+
+namespace
+{
+
+constexpr size_t NotFound = std::string_view::npos;
+
+using namespace TextParseUtils;
+
+bool isKeywordChar(char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9')
+           || ch == '_' || ch == '-';
+}
+
+// Returns position of the first character at or after 'pos' which isn't a space nor part of a
+// comment
+size_t skipSpacesAndComments(std::string_view contents, size_t pos)
+{
+    while (pos < contents.size())
+    {
+        if (isSpace(contents[pos]))
+        {
+            ++pos;
+        }
+        else if (contents.compare(pos, 2, "/*") == 0)
+        {
+            const size_t posCommentEnd = contents.find("*/", pos + 2);
+            pos = posCommentEnd != NotFound ? posCommentEnd + 2 : contents.size();
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+// Returns position of the ';' ending the statement starting at 'pos', ';' in strings being
+// ignored
+size_t findStatementEnd(std::string_view contents, size_t pos)
+{
+    const char *data = contents.data();
+    const char *end = data + contents.size();
+    const char *p = data + pos;
+    while (p < end)
+    {
+        auto semicolon = static_cast<const char *>(std::memchr(p, ';', end - p));
+        if (!semicolon)
+            return NotFound;
+
+        // Fast path: most statements have no string
+        auto quote = static_cast<const char *>(std::memchr(p, '\'', semicolon - p));
+        if (!quote)
+            return semicolon - data;
+
+        // Skip string, quotes inside are doubled so an escaped quote is two strings
+        auto quoteEnd = static_cast<const char *>(std::memchr(quote + 1, '\'', end - quote - 1));
+        if (!quoteEnd)
+            return NotFound;
+
+        p = quoteEnd + 1;
+    }
+
+    return NotFound;
+}
+
+// Splits the parameters of an entity(ie what is between the outer parentheses) at top-level
+// commas. Returns the count of parameters stored in 'params'
+int splitParameters(std::string_view str, std::string_view *params, int maxCount)
+{
+    int count = 0;
+    int depth = 0;
+    bool isInString = false;
+    size_t posParamStart = 0;
+    for (size_t i = 0; i <= str.size() && count < maxCount; ++i)
+    {
+        const char ch = i < str.size() ? str[i] : ',';
+        if (ch == '\'')
+        {
+            isInString = !isInString;
+        }
+        else if (!isInString)
+        {
+            if (ch == '(')
+            {
+                ++depth;
+            }
+            else if (ch == ')')
+            {
+                --depth;
+            }
+            else if (ch == ',' && depth == 0)
+            {
+                params[count++] = trimmed(str.substr(posParamStart, i - posParamStart));
+                posParamStart = i + 1;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Parses entity instance name "#123", returns 0 on error
+uint64_t parseReference(std::string_view str)
+{
+    str = trimmed(str);
+    if (str.empty() || str.front() != '#')
+        return 0;
+
+    uint64_t id = 0;
+    const auto result = std::from_chars(str.data() + 1, str.data() + str.size(), id);
+    return result.ec == std::errc() ? id : 0;
+}
+
+void appendUtf8(std::string *str, uint32_t code)
+{
+    if (code < 0x80)
+    {
+        *str += char(code);
+    }
+    else if (code < 0x800)
+    {
+        *str += char(0xC0 | (code >> 6));
+        *str += char(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        *str += char(0xE0 | (code >> 12));
+        *str += char(0x80 | ((code >> 6) & 0x3F));
+        *str += char(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x110000)
+    {
+        *str += char(0xF0 | (code >> 18));
+        *str += char(0x80 | ((code >> 12) & 0x3F));
+        *str += char(0x80 | ((code >> 6) & 0x3F));
+        *str += char(0x80 | (code & 0x3F));
+    }
+}
+
+// Parses 'digitCount' hexadecimal digits at 'pos', returns false on error
+bool parseHex(std::string_view str, size_t pos, int digitCount, uint32_t *value)
+{
+    if (pos + digitCount > str.size())
+        return false;
+
+    const char *begin = str.data() + pos;
+    const auto result = std::from_chars(begin, begin + digitCount, *value, 16);
+    return result.ec == std::errc() && result.ptr == begin + digitCount;
+}
+
+// Decodes STEP string literal 'str'(quotes included) into utf8
+// Handles doubled quotes/backslashes, \S\ and \X\ latin characters, \X2\ and \X4\ unicode
+// sequences. Unset value '$' gives an empty string
+std::string decodeString(std::string_view str)
+{
+    str = trimmed(str);
+    if (str.size() < 2 || str.front() != '\'' || str.back() != '\'')
+        return {};
+
+    str = str.substr(1, str.size() - 2);
+    std::string result;
+    result.reserve(str.size());
+    uint32_t highSurrogate = 0;
+    size_t i = 0;
+    while (i < str.size())
+    {
+        const char ch = str[i];
+        if (ch == '\'' && i + 1 < str.size() && str[i + 1] == '\'')
+        {
+            result += '\'';
+            i += 2;
+        }
+        else if (ch == '\\' && str.compare(i, 2, "\\\\") == 0)
+        {
+            result += '\\';
+            i += 2;
+        }
+        else if (ch == '\\' && str.compare(i, 3, "\\S\\") == 0 && i + 3 < str.size())
+        {
+            appendUtf8(&result, uint8_t(str[i + 3]) + 128);
+            i += 4;
+        }
+        else if (ch == '\\' && str.compare(i, 3, "\\X\\") == 0)
+        {
+            uint32_t code = 0;
+            if (parseHex(str, i + 3, 2, &code))
+                appendUtf8(&result, code);
+
+            i += 5;
+        }
+        else if (ch == '\\'
+                 && (str.compare(i, 4, "\\X2\\") == 0 || str.compare(i, 4, "\\X4\\") == 0))
+        {
+            const int digitCount = str[i + 2] == '2' ? 4 : 8;
+            i += 4;
+            uint32_t code = 0;
+            while (parseHex(str, i, digitCount, &code))
+            {
+                if (code >= 0xD800 && code < 0xDC00)
+                {
+                    highSurrogate = code;
+                }
+                else if (code >= 0xDC00 && code < 0xE000 && highSurrogate != 0)
+                {
+                    const uint32_t highBits = (highSurrogate - 0xD800) << 10;
+                    appendUtf8(&result, 0x10000 + highBits + code - 0xDC00);
+                    highSurrogate = 0;
+                }
+                else
+                {
+                    appendUtf8(&result, code);
+                }
+
+                i += digitCount;
+            }
+
+            if (str.compare(i, 4, "\\X0\\") == 0)
+                i += 4;
+        }
+        else if (ch == '\\' && str.compare(i, 2, "\\P") == 0 && i + 3 < str.size())
+        {
+            i += 4; // Code page directive \PA\ ... \PI\, ignored
+        }
+        else
+        {
+            result += ch;
+            ++i;
+        }
+    }
+
+    return result;
+}
+
+// Entities of interest, their parameters are kept as found in file
+struct StepRawProduct
+{
+    std::string_view id;
+    std::string_view name;
+};
+
+struct StepRawOccurrence
+{
+    std::string_view id;
+    std::string_view name;
+    uint64_t parentDefinitionId = 0;
+    uint64_t childDefinitionId = 0;
+};
+
+} // namespace
+
+bool scanStepProductStructure(std::string_view contents, StepProductStructure *structure,
+                              TaskProgress *progress)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    *structure = {};
+
+    std::unordered_map<uint64_t, StepRawProduct> mapProduct;
+    std::unordered_map<uint64_t, uint64_t> mapFormationProduct;
+    std::vector<std::pair<uint64_t, uint64_t>> vecDefinitionFormation; // (definition, formation)
+    std::vector<StepRawOccurrence> vecOccurrence;
+
+    bool isDataFound = false;
+    bool isInData = false;
+    const size_t progressStep = std::max<size_t>(contents.size() / 100, 1);
+    size_t posNextProgress = progressStep;
+    size_t pos = skipSpacesAndComments(contents, 0);
+    while (pos < contents.size())
+    {
+        const size_t posEnd = findStatementEnd(contents, pos);
+        if (posEnd == NotFound)
+            break;
+
+        const std::string_view statement = contents.substr(pos, posEnd - pos);
+        pos = skipSpacesAndComments(contents, posEnd + 1);
+        if (pos >= posNextProgress)
+        {
+            progress->setValue(MathUtils::toPercent(pos, 0, contents.size()));
+            if (TaskProgress::isAbortRequested(progress))
+                return false;
+
+            posNextProgress = pos + progressStep;
+        }
+
+        if (!isInData)
+        {
+            isInData = statement.compare(0, 4, "DATA") == 0
+                       && (statement.size() == 4 || !isKeywordChar(statement[4]));
+            isDataFound = isDataFound || isInData;
+            continue;
+        }
+
+        if (statement.compare(0, 6, "ENDSEC") == 0)
+        {
+            isInData = false;
+            continue;
+        }
+
+        // Simple entity instance "#id = KEYWORD(parameters)", complex ones are skipped
+        const size_t posEqual = statement.find('=');
+        if (statement.empty() || statement.front() != '#' || posEqual == NotFound)
+            continue;
+
+        const uint64_t id = parseReference(statement.substr(0, posEqual));
+        std::string_view rhs = trimmed(statement.substr(posEqual + 1));
+        const auto itKeywordEnd = std::find_if_not(rhs.cbegin(), rhs.cend(), isKeywordChar);
+        const std::string_view keyword = rhs.substr(0, itKeywordEnd - rhs.cbegin());
+        rhs = trimmed(rhs.substr(keyword.size()));
+        if (id == 0 || keyword.empty() || rhs.size() < 2 || rhs.front() != '('
+            || rhs.back() != ')')
+        {
+            continue;
+        }
+
+        const std::string_view strParams = rhs.substr(1, rhs.size() - 2);
+        std::string_view params[5];
+        if (keyword == "PRODUCT")
+        {
+            if (splitParameters(strParams, params, 2) == 2)
+                mapProduct.insert({id, {params[0], params[1]}});
+        }
+        else if (keyword == "PRODUCT_DEFINITION_FORMATION"
+                 || keyword == "PRODUCT_DEFINITION_FORMATION_WITH_SPECIFIED_SOURCE")
+        {
+            if (splitParameters(strParams, params, 3) == 3)
+                mapFormationProduct.insert({id, parseReference(params[2])});
+        }
+        else if (keyword == "PRODUCT_DEFINITION"
+                 || keyword == "PRODUCT_DEFINITION_WITH_ASSOCIATED_DOCUMENTS")
+        {
+            if (splitParameters(strParams, params, 3) == 3)
+                vecDefinitionFormation.push_back({id, parseReference(params[2])});
+        }
+        else if (keyword == "NEXT_ASSEMBLY_USAGE_OCCURRENCE")
+        {
+            if (splitParameters(strParams, params, 5) == 5)
+            {
+                const uint64_t parentId = parseReference(params[3]);
+                const uint64_t childId = parseReference(params[4]);
+                vecOccurrence.push_back({params[0], params[1], parentId, childId});
+            }
+        }
+    }
+
+    // Resolve references
+    std::unordered_map<uint64_t, int> mapDefinitionProductIndex;
+    for (const auto &[definitionId, formationId] : vecDefinitionFormation)
+    {
+        StepProductStructure::Product product;
+        auto itFormation = mapFormationProduct.find(formationId);
+        if (itFormation != mapFormationProduct.cend())
+        {
+            auto itProduct = mapProduct.find(itFormation->second);
+            if (itProduct != mapProduct.cend())
+            {
+                product.name = decodeString(itProduct->second.name);
+                if (product.name.empty())
+                    product.name = decodeString(itProduct->second.id);
+            }
+        }
+
+        if (product.name.empty())
+            product.name = fmt::format("#{}", definitionId);
+
+        const auto productIndex = int(structure->vecProduct.size());
+        mapDefinitionProductIndex.insert({definitionId, productIndex});
+        structure->vecProduct.push_back(std::move(product));
+    }
+
+    for (const StepRawOccurrence &rawOccurrence : vecOccurrence)
+    {
+        auto itParent = mapDefinitionProductIndex.find(rawOccurrence.parentDefinitionId);
+        auto itChild = mapDefinitionProductIndex.find(rawOccurrence.childDefinitionId);
+        if (itParent == mapDefinitionProductIndex.cend()
+            || itChild == mapDefinitionProductIndex.cend())
+        {
+            continue;
+        }
+
+        StepProductStructure::Occurrence occurrence;
+        occurrence.parentProductIndex = itParent->second;
+        occurrence.childProductIndex = itChild->second;
+        occurrence.name = decodeString(rawOccurrence.name);
+        if (occurrence.name.empty())
+            occurrence.name = decodeString(rawOccurrence.id);
+
+        structure->vecOccurrence.push_back(std::move(occurrence));
+    }
+
+    progress->setValue(100);
+    return isDataFound;
+}
+
+TDF_LabelSequence transferStepProductStructure(const StepProductStructure &structure,
+                                               DocumentPtr doc)
+{
+    const size_t productCount = structure.vecProduct.size();
+    std::vector<std::vector<const StepProductStructure::Occurrence *>> vecProductOccurrences(
+        productCount);
+    std::vector<bool> vecProductIsChild(productCount, false);
+    for (const StepProductStructure::Occurrence &occurrence : structure.vecOccurrence)
+    {
+        vecProductOccurrences.at(occurrence.parentProductIndex).push_back(&occurrence);
+        vecProductIsChild.at(occurrence.childProductIndex) = true;
+    }
+
+    // Products are added once as prototypes, occurrences are components referring to them
+    // Occurrences making a cycle in the product graph are skipped
+    enum class AddState
+    {
+        None,
+        InProgress,
+        Done
+    };
+    std::vector<AddState> vecProductAddState(productCount, AddState::None);
+    std::vector<TDF_Label> vecProductLabel(productCount);
+    OccHandle<XCAFDoc_ShapeTool> shapeTool = doc->xcaf().shapeTool();
+    std::function<TDF_Label(int)> fnAddProduct = [&](int iProduct)
+    {
+        TDF_Label &labelProduct = vecProductLabel.at(iProduct);
+        if (vecProductAddState.at(iProduct) != AddState::None)
+            return labelProduct;
+
+        vecProductAddState.at(iProduct) = AddState::InProgress;
+        const auto &vecOccurrence = vecProductOccurrences.at(iProduct);
+        const TopoDS_Shape emptyComp = BRepUtils::makeEmptyCompound();
+        labelProduct = shapeTool->AddShape(emptyComp, !vecOccurrence.empty() /*makeAssembly*/);
+        TDataStd_Name::Set(labelProduct, to_OccExtString(structure.vecProduct.at(iProduct).name));
+        for (const StepProductStructure::Occurrence *occurrence : vecOccurrence)
+        {
+            if (vecProductAddState.at(occurrence->childProductIndex) == AddState::InProgress)
+                continue;
+
+            const TDF_Label labelChild = fnAddProduct(occurrence->childProductIndex);
+            const TDF_Label labelComponent =
+                shapeTool->AddComponent(labelProduct, labelChild, TopLoc_Location());
+            if (!occurrence->name.empty())
+                TDataStd_Name::Set(labelComponent, to_OccExtString(occurrence->name));
+        }
+
+        vecProductAddState.at(iProduct) = AddState::Done;
+        return labelProduct;
+    };
+
+    TDF_LabelSequence seqLabel;
+    for (size_t i = 0; i < productCount; ++i)
+    {
+        if (!vecProductIsChild.at(i))
+            seqLabel.Append(fnAddProduct(int(i)));
+    }
+
+    shapeTool->UpdateAssemblies();
+    return seqLabel;
+}
+
+} // namespace Mayo::IO
@@ -0,0 +1,60 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <TDF_LabelSequence.hxx>
+
+#include "base/document_ptr.h"
+
+namespace Mayo
+{
+class TaskProgress;
+}
+
+namespace Mayo::IO
+{
+
+// Product structure(bill of materials) of a STEP file, without any geometry
+struct StepProductStructure
+{
+    // PRODUCT_DEFINITION entity, ie a part or an assembly
+    struct Product
+    {
+        std::string name; // Name of the related PRODUCT entity(utf8)
+    };
+
+    // NEXT_ASSEMBLY_USAGE_OCCURRENCE entity, ie an instance of a product within an assembly
+    struct Occurrence
+    {
+        int parentProductIndex = -1; // Index in vecProduct
+        int childProductIndex = -1;  // Index in vecProduct
+        std::string name;            // utf8
+    };
+
+    std::vector<Product> vecProduct; // In file order
+    std::vector<Occurrence> vecOccurrence; // In file order
+};
+
+// Scans the DATA section of STEP file 'contents' and extracts the PRODUCT,
+// PRODUCT_DEFINITION_FORMATION, PRODUCT_DEFINITION and NEXT_ASSEMBLY_USAGE_OCCURRENCE entities
+// Other entities are skipped without being parsed, so this is much faster than reading the
+// whole STEP model
+// Returns false if no DATA section was found or abort was requested
+bool scanStepProductStructure(std::string_view contents, StepProductStructure *structure,
+                              TaskProgress *progress);
+
+// Adds 'structure' into 'doc' as XCAF assemblies, products without occurrences being empty
+// shapes. Occurrences have no placement
+// Returns the labels of the root products
+TDF_LabelSequence transferStepProductStructure(const StepProductStructure &structure,
+                                               DocumentPtr doc);
+
+} // namespace Mayo::IO
@@ -9,6 +9,7 @@
 #include <Poly_Triangulation.hxx>
 #include <Quantity_Color.hxx>
 #include <TDataStd_Name.hxx>
+#include <fast_float/fast_float.h>
 
 #include "base/brep_utils.h"
 #include "base/caf_utils.h"
@@ -20,20 +21,16 @@
 #include "base/messenger.h"
 #include "base/property_builtins.h"
 #include "base/span.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
 #include "base/task_progress.h"
+#include "base/text_parse_utils.h"
 #include "base/tkernel_utils.h"
 #include "base/triangulation_annex_data.h"
 
-#if __cpp_lib_to_chars
-#include <charconv>
-#else
-#include <cstdlib>
-#endif
-#include <array>
-#include <fstream>
-#include <locale>
-#include <string>
-#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
 
 namespace Mayo::IO
 {
@@ -46,73 +43,112 @@ struct OffReaderI18N
 namespace
 {
 
-const char *strEnd(std::string_view str)
+using namespace TextParseUtils;
+
+// Calls 'fn(line)' for each data line in range [begin, end)
+// Data lines are the lines neither blank nor comment(ie starting with '#'), leading spaces are
+// not part of 'line'
+// Iteration stops as soon as 'fn' returns false
+template <typename Function>
+void forEachDataLine(const char *begin, const char *end, Function fn)
 {
-    return str.data() + str.size();
+    forEachLine(begin, end,
+                [&](std::string_view line)
+                { return line.empty() || line.front() == '#' || fn(line); });
 }
 
-std::string_view getWord(const std::string &strLine, std::string::size_type pos = 0)
+// Returns the next data line starting from '*ptrPos', which is moved after that line
+// Returns an empty string if there is no data line left
+std::string_view nextDataLine(const char **ptrPos, const char *end)
 {
-    using IntType = std::string::size_type;
-    auto fnIsSpace = [](char ch) { return std::isspace(ch, std::locale::classic()); };
-
-    IntType wordStart = pos;
-    for (; wordStart < strLine.size() && fnIsSpace(strLine.at(wordStart)); ++wordStart)
-        ;
-
-    IntType wordEnd = wordStart;
-    for (;
-         wordEnd < strLine.size() && !fnIsSpace(strLine.at(wordEnd)) && strLine.at(wordEnd) != '#';
-         ++wordEnd)
-        ;
-
-    return std::string_view{strLine.c_str() + wordStart, wordEnd - wordStart};
+    std::string_view line;
+    const char *pos = end;
+    forEachDataLine(*ptrPos, end,
+                    [&](std::string_view dataLine)
+                    {
+                        line = dataLine;
+                        pos = std::min(dataLine.data() + dataLine.size() + 1, end);
+                        return false;
+                    });
+    *ptrPos = pos;
+    return line;
 }
 
-template <unsigned N>
-std::array<std::string_view, N> getWords(const std::string &strLine, std::string::size_type pos = 0)
+// Provides sequential access to the words of a line, a word ends at a space or '#' character
+class LineTokenizer
 {
-    std::array<std::string_view, N> arrayWord;
-    for (unsigned i = 0; i < N; ++i)
+public:
+    LineTokenizer(const char *begin, const char *end)
+        : m_pos(begin)
+        , m_end(end)
     {
-        const std::string::size_type offset =
-            i > 0 ? strEnd(arrayWord[i - 1]) - strLine.data() : pos;
-        std::string_view word = getWord(strLine, offset);
-        if (!word.empty())
-            arrayWord[i] = word;
-        else
-            return arrayWord;
     }
 
-    return arrayWord;
-}
+    LineTokenizer(std::string_view line)
+        : LineTokenizer(line.data(), line.data() + line.size())
+    {
+    }
 
-void getWords(const std::string &strLine, std::vector<std::string_view> &vecOutWord,
-              std::string::size_type pos = 0)
-{
-    vecOutWord.clear();
-    while (true)
+    // Returns the next word, or an empty string if the end of the line is reached
+    std::string_view nextWord()
     {
-        const std::string::size_type offset =
-            !vecOutWord.empty() ? strEnd(vecOutWord.back()) - strLine.data() : pos;
-        std::string_view word = getWord(strLine, offset);
-        if (!word.empty())
-            vecOutWord.push_back(word);
-        else
-            return;
+        while (m_pos < m_end && isSpace(*m_pos))
+            ++m_pos;
+
+        const char *wordBegin = m_pos;
+        while (m_pos < m_end && !isSpace(*m_pos) && *m_pos != '#')
+            ++m_pos;
+
+        if (m_pos < m_end && *m_pos == '#')
+            m_end = m_pos; // Comment, skip the rest of the line
+
+        return {wordBegin, size_t(m_pos - wordBegin)};
     }
-}
 
-bool hasEmptyString(Span<const std::string_view> spanStr)
-{
-    for (std::string_view str : spanStr)
+    // Parses the next word as a floating point number, value is 0 if the word isn't a number
+    // Returns false if there is no word left
+    bool nextDouble(double *ptrValue)
     {
-        if (str.empty())
-            return true;
+        std::string_view word = this->nextWord();
+        if (word.empty())
+            return false;
+
+        if (word.front() == '+')
+            word.remove_prefix(1);
+
+        const char *wordEnd = word.data() + word.size();
+        const auto result = fast_float::from_chars(word.data(), wordEnd, *ptrValue);
+        if (result.ec != std::errc())
+            *ptrValue = 0.;
+
+        return true;
     }
 
-    return false;
-}
+    // Parses the next word as an integer, value is 0 if the word isn't an integer
+    // Returns false if there is no word left
+    bool nextInt(int *ptrValue)
+    {
+        const std::string_view word = this->nextWord();
+        if (word.empty())
+            return false;
+
+        size_t i = 0;
+        const bool isNegative = word.front() == '-';
+        if (isNegative || word.front() == '+')
+            ++i;
+
+        int64_t value = 0;
+        for (; i < word.size() && word[i] >= '0' && word[i] <= '9' && value <= INT32_MAX; ++i)
+            value = value * 10 + (word[i] - '0');
+
+        *ptrValue = i == word.size() && value <= INT32_MAX ? int(isNegative ? -value : value) : 0;
+        return true;
+    }
+
+private:
+    const char *m_pos = nullptr;
+    const char *m_end = nullptr;
+};
 
 bool isAnyOf(std::string_view str, std::initializer_list<std::string_view> listCandidates)
 {
@@ -125,61 +161,34 @@ bool isAnyOf(std::string_view str, std::initializer_list<std::string_view> listC
     return false;
 }
 
-template <typename T>
-T strToNum(std::string_view str)
+std::uint32_t toColorComponent(double v)
 {
-    static_assert(std::is_arithmetic_v<std::remove_cv_t<T>>,
-                  "Input template type must be arithmetic type");
-    T num = {};
-    if (str.empty())
-        return num;
-
-#if __cpp_lib_to_chars
-    auto result = std::from_chars(str.data(), str.data() + str.size(), num);
-    if (result.ec != std::errc())
-    {
-        // TODO Handle error code
-        // throw std::runtime_error(std::make_error_code(err).message());
-    }
-#else
-    errno = 0;
-    num = std::strtod(str.data(), nullptr);
-    if (errno != 0)
-    {
-        // TODO Handle error code
-        // throw std::runtime_error(std::strerror(errno));
-    }
-#endif
-    return num;
+    return unsigned(v > 1. ? v : v * 255);
 }
 
-void getNonCommentLine(std::istream &istr, std::string &strLine)
+// Chunk of the vertex and face blocks of some OFF file, parsed by a single thread
+struct ParseChunk
 {
-    std::getline(istr >> std::ws, strLine);
-    while (!istr.eof() && !strLine.empty() && strLine.front() == '#')
-        std::getline(istr >> std::ws, strLine);
-}
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    int64_t dataLineCount = 0;
+    int64_t firstDataLineIndex = 0;
 
-std::uint32_t strToColorComponent(std::string_view str)
-{
-    const double v = strToNum<double>(str);
-    return unsigned(v > 1. ? v : v * 255);
-}
+    // Faces found in the chunk, 'startIndexInArray' is relative to 'vecFacetIndex'
+    std::vector<int> vecFacetIndex;
+    std::vector<std::pair<int, int>> vecFacet; // {startIndexInArray, vertexCount}
 
-std::uint32_t toRgbaColor(Span<const std::string_view> spanWord)
-{
-    const unsigned r = spanWord.size() > 0 ? strToColorComponent(spanWord[0]) : 0;
-    const unsigned g = spanWord.size() > 1 ? strToColorComponent(spanWord[1]) : 0;
-    const unsigned b = spanWord.size() > 2 ? strToColorComponent(spanWord[2]) : 0;
-    const unsigned a = spanWord.size() > 3 ? strToColorComponent(spanWord[3]) : 0;
-    const std::uint32_t color = ((r << 24) & 0xFF000000) | ((g << 16) & 0x00FF0000) |
-                                ((b << 8) & 0x0000FF00) | (a & 0x000000FF);
-    return color;
-}
+    std::string_view error; // First error found
+};
 
 } // namespace
 
 bool OffReader::readFile(const FilePath &filepath, TaskProgress *progress)
+{
+    return this->readFile(FileView(filepath), progress);
+}
+
+bool OffReader::readFile(const FileView &fileView, TaskProgress *progress)
 {
     auto fnError = [=](std::string_view strMessage)
     {
@@ -188,24 +197,24 @@ bool OffReader::readFile(const FilePath &filepath, TaskProgress *progress)
     };
 
     // Reset internal data
-    m_baseFilename = filepath.stem();
+    m_baseFilename = fileView.filepath().stem();
     m_vecVertex.clear();
     m_vecAllFacetIndex.clear();
     m_vecFacet.clear();
 
-    std::ifstream ifs(filepath);
-    if (!ifs.is_open())
+    if (!fileView.isOpen())
         return fnError(OffReaderI18N::textIdTr("Can't open input file"));
 
-    std::string strLine;
+    const char *pos = fileView.data();
+    const char *const contentsEnd = fileView.data() + fileView.size();
 
     // Consume header keyword
+    LineTokenizer headerTokenizer(nextDataLine(&pos, contentsEnd));
     {
-        getNonCommentLine(ifs, strLine);
-        if (!ifs.good())
+        const std::string_view headerKeyword = headerTokenizer.nextWord();
+        if (headerKeyword.empty() || pos >= contentsEnd)
             return fnError(OffReaderI18N::textIdTr("Unexpected end of file"));
 
-        std::string_view headerKeyword = getWord(strLine);
         if (!isAnyOf(headerKeyword, {"OFF", "COFF", "NOFF", "4OFF"}))
             return fnError(OffReaderI18N::textIdTr("Wrong header keyword(should be [C][N][4]OFF"));
     }
@@ -217,93 +226,168 @@ bool OffReader::readFile(const FilePath &filepath, TaskProgress *progress)
         // Normally vertex/face/edge counts are specified on a dedicated line coming
         // after OFF But for some files they are wrongly specified on the line
         // containing OFF token, eg "OFF 24 12 0"
-        const auto arrayStrFirstLine = getWords<3>(strLine);
-        if (!arrayStrFirstLine[1].empty() && !arrayStrFirstLine[2].empty())
-        {
-            vertexCount = strToNum<int>(arrayStrFirstLine[1]);
-            facetCount = strToNum<int>(arrayStrFirstLine[2]);
-        }
-        else
+        bool hasCounts = headerTokenizer.nextInt(&vertexCount);
+        hasCounts = hasCounts && headerTokenizer.nextInt(&facetCount);
+        if (!hasCounts)
         {
-            if (!ifs.good())
+            if (pos >= contentsEnd)
                 return fnError(OffReaderI18N::textIdTr("Unexpected end of file"));
 
-            getNonCommentLine(ifs, strLine);
-            const auto arrayStrCount = getWords<2>(strLine);
-            if (hasEmptyString(arrayStrCount))
-                return fnError(OffReaderI18N::textIdTr("No vertex or face count"));
-
-            vertexCount = strToNum<int>(arrayStrCount[0]);
-            facetCount = strToNum<int>(arrayStrCount[1]);
+            LineTokenizer countTokenizer(nextDataLine(&pos, contentsEnd));
+            hasCounts = countTokenizer.nextInt(&vertexCount);
+            hasCounts = hasCounts && countTokenizer.nextInt(&facetCount);
         }
+
+        if (!hasCounts || vertexCount < 0 || facetCount < 0)
+            return fnError(OffReaderI18N::textIdTr("No vertex or face count"));
     }
 
-    // Helper function for progress report
-    auto fnUpdateProgress = [=]
+    // Vertex and face blocks are split into chunks aligned on line boundaries, each chunk is
+    // then parsed by a separate task. A first pass counts the data lines of each chunk so the
+    // index of every line is known by the second pass
+    TaskManager taskMgr;
+    std::vector<ParseChunk> vecChunk;
+    const std::string_view body(pos, contentsEnd - pos);
+    for (std::string_view chunkContents : splitIntoLineChunks(taskMgr, body, 4 * 1024 * 1024))
     {
-        const auto total = vertexCount + facetCount;
-        const auto current = m_vecVertex.size() + m_vecFacet.size();
-        if (current % 100 || CppUtils::cmpGreaterEqual(current, total))
-            progress->setValue(MathUtils::toPercent(current, 0, total));
-    };
+        ParseChunk chunk;
+        chunk.begin = chunkContents.data();
+        chunk.end = chunkContents.data() + chunkContents.size();
+        vecChunk.push_back(std::move(chunk));
+    }
+
+    if (vecChunk.empty())
+        return true; // No vertex and face blocks, ChunkedRange would still provide one chunk
 
-    // Consume vertices
-    m_vecVertex.reserve(vertexCount);
-    while (!ifs.eof() && CppUtils::cmpLess(m_vecVertex.size(), vertexCount))
+    const ChunkedRange chunkRange(vecChunk.size(), vecChunk.size());
+
+    // First pass: count data lines
+    auto fnCountDataLines = [&](size_t ichunk, size_t, size_t)
     {
-        getNonCommentLine(ifs, strLine);
-        const auto arrayStrCoord = getWords<3>(strLine);
-        if (hasEmptyString(arrayStrCoord))
-            return fnError(OffReaderI18N::textIdTr("No vertex coordinates at current line"));
-
-        Vertex vertex = {};
-        vertex.coords.SetX(strToNum<double>(arrayStrCoord[0]));
-        vertex.coords.SetY(strToNum<double>(arrayStrCoord[1]));
-        vertex.coords.SetZ(strToNum<double>(arrayStrCoord[2]));
-
-        const auto arrayStrColor =
-            getWords<4>(strLine, strEnd(arrayStrCoord.back()) - strLine.data());
-        vertex.hasColor = !arrayStrColor.front().empty();
-        if (vertex.hasColor)
-            vertex.color = toRgbaColor(arrayStrColor);
+        ParseChunk &chunk = vecChunk.at(ichunk);
+        forEachDataLine(chunk.begin, chunk.end,
+                        [&](std::string_view)
+                        {
+                            ++chunk.dataLineCount;
+                            return true;
+                        });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnCountDataLines, progress, 0, 10))
+        return false;
 
-        m_vecVertex.push_back(std::move(vertex));
-        fnUpdateProgress();
+    int64_t dataLineCount = 0;
+    for (ParseChunk &chunk : vecChunk)
+    {
+        chunk.firstDataLineIndex = dataLineCount;
+        dataLineCount += chunk.dataLineCount;
     }
 
-    // Consume faces
-    m_vecAllFacetIndex.reserve(facetCount * 3);
-    m_vecFacet.reserve(facetCount);
-    std::vector<std::string_view> vecWord;
-    while (!ifs.eof() && CppUtils::cmpLess(m_vecFacet.size(), facetCount))
-    {
-        getNonCommentLine(ifs, strLine);
-        getWords(strLine, vecWord);
-        const Facet facet = {int(m_vecAllFacetIndex.size()), strToNum<int>(vecWord.front())};
-        if (CppUtils::cmpLess((vecWord.size() + 1), facet.vertexCount))
-            return fnError(OffReaderI18N::textIdTr("Inconsistent vertex count of face"));
+    // Vertices are directly written in their final array, faces are collected by chunk
+    vertexCount = int(std::min<int64_t>(vertexCount, dataLineCount));
+    facetCount = int(std::min<int64_t>(facetCount, dataLineCount - vertexCount));
+    m_vecVertex.resize(vertexCount);
 
-        for (int i = 0; i < facet.vertexCount; ++i)
+    // Second pass: parse vertices and faces
+    auto fnParseDataLines = [&](size_t ichunk, size_t, size_t)
+    {
+        ParseChunk &chunk = vecChunk.at(ichunk);
+        int64_t lineIndex = chunk.firstDataLineIndex;
+        auto fnSetError = [&](std::string_view error)
         {
-            const int facetVertexId = strToNum<int>(vecWord.at(i + 1));
-            m_vecAllFacetIndex.push_back(facetVertexId);
-        }
+            chunk.error = error;
+            return false;
+        };
+        forEachDataLine(
+            chunk.begin, chunk.end,
+            [&](std::string_view line)
+            {
+                LineTokenizer tokenizer(line);
+                if (lineIndex < vertexCount)
+                {
+                    Vertex &vertex = m_vecVertex[lineIndex];
+                    double coords[3] = {};
+                    for (double &coord : coords)
+                    {
+                        if (!tokenizer.nextDouble(&coord))
+                            return fnSetError(
+                                OffReaderI18N::textIdTr("No vertex coordinates at current line"));
+                    }
+
+                    vertex.coords.SetCoord(coords[0], coords[1], coords[2]);
+                    std::uint32_t color = 0;
+                    double colorComponent = 0.;
+                    for (int i = 0; i < 4 && tokenizer.nextDouble(&colorComponent); ++i)
+                    {
+                        color |= (toColorComponent(colorComponent) & 0xFF) << (24 - 8 * i);
+                        vertex.hasColor = true;
+                    }
+
+                    vertex.color = color;
+                }
+                else if (lineIndex < vertexCount + facetCount)
+                {
+                    int facetVertexCount = 0;
+                    tokenizer.nextInt(&facetVertexCount);
+                    const auto startIndexInArray = int(chunk.vecFacetIndex.size());
+                    for (int i = 0; i < facetVertexCount; ++i)
+                    {
+                        int facetVertexId = 0;
+                        if (!tokenizer.nextInt(&facetVertexId))
+                            return fnSetError(
+                                OffReaderI18N::textIdTr("Inconsistent vertex count of face"));
+
+                        if (facetVertexId < 0 || facetVertexId >= vertexCount)
+                            return fnSetError(
+                                OffReaderI18N::textIdTr("Face vertex index out of range"));
+
+                        chunk.vecFacetIndex.push_back(facetVertexId);
+                    }
+
+                    // Faces with less than 3 vertices can't be triangulated
+                    if (facetVertexCount >= 3)
+                        chunk.vecFacet.push_back({startIndexInArray, facetVertexCount});
+                    else
+                        chunk.vecFacetIndex.resize(startIndexInArray);
+                }
+                else
+                {
+                    return false; // Vertex and face blocks are complete
+                }
+
+                ++lineIndex;
+                return true;
+            });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnParseDataLines, progress, 10, 100))
+        return false;
 
-#if 0
-        const bool facetHasColor = (vecWord.size() - 1 - facet.vertexCount) >= 3;
-        std::uint32_t facetColor = 0;
-        if (facetHasColor) {
-            const std::size_t colorComponentCount = vecWord.size() - (facet.vertexCount + 1);
-            facetColor = toRgbaColor({ &vecWord.at(facet.vertexCount + 1), colorComponentCount });
-            for (int i = 0; i < facet.vertexCount; ++i) {
-                const int ivertex = m_vecAllFacetIndex.at(facet.startIndexInArray + i);
-                Vertex& vertex = m_vecVertex.at(ivertex);
-            }
-        }
-#endif
+    // Report the error found first in file
+    auto itChunkError = std::find_if(vecChunk.cbegin(), vecChunk.cend(),
+                                     [](const ParseChunk &chunk) { return !chunk.error.empty(); });
+    if (itChunkError != vecChunk.cend())
+        return fnError(itChunkError->error);
 
-        m_vecFacet.push_back(std::move(facet));
-        fnUpdateProgress();
+    // Gather faces of all chunks
+    size_t facetIndexCount = 0;
+    size_t validFacetCount = 0;
+    for (const ParseChunk &chunk : vecChunk)
+    {
+        facetIndexCount += chunk.vecFacetIndex.size();
+        validFacetCount += chunk.vecFacet.size();
+    }
+
+    m_vecAllFacetIndex.reserve(facetIndexCount);
+    m_vecFacet.reserve(validFacetCount);
+    for (ParseChunk &chunk : vecChunk)
+    {
+        const auto offset = int(m_vecAllFacetIndex.size());
+        for (const auto &[startIndexInArray, facetVertexCount] : chunk.vecFacet)
+            m_vecFacet.push_back({offset + startIndexInArray, facetVertexCount});
+
+        m_vecAllFacetIndex.insert(m_vecAllFacetIndex.end(), chunk.vecFacetIndex.cbegin(),
+                                  chunk.vecFacetIndex.cend());
+        chunk.vecFacetIndex = {};
+        chunk.vecFacet = {};
     }
 
     return true;
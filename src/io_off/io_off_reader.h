@@ -21,7 +21,12 @@ class OffReader : public Reader
 {
 public:
     bool readFile(const FilePath &filepath, TaskProgress *progress) override;
+    bool readFile(const FileView &fileView, TaskProgress *progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) override;
+    bool isConcurrentTransferSupported() const override
+    {
+        return true;
+    }
     void applyProperties(const PropertyGroup *) override
     {
     }
@@ -6,18 +6,21 @@
 
 #include "io_off_writer.h"
 
-#include <fstream>
-#include <locale>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <vector>
 
 #include <Poly_Triangulation.hxx>
+#include <fmt/format.h>
 
-#include "base/io_system.h"
-#include "base/mesh_access.h"
+#include "base/io_output_file_buffer.h"
+#include "base/math_utils.h"
 #include "base/messenger.h"
+#include "base/property_builtins.h"
 #include "base/task_progress.h"
 #include "base/text_id.h"
 
-
 namespace Mayo::IO
 {
 
@@ -26,112 +29,134 @@ struct OffWriterI18N
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OffWriterI18N)
 };
 
-bool OffWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress * /*progress*/)
+class OffWriter::Properties : public PropertyGroup
 {
-    m_vecTreeNode.clear();
-    m_vecTreeNode.reserve(appItems.size());
-    System::traverseUniqueItems(appItems,
-                                [&](const DocumentTreeNode &treeNode)
-                                {
-                                    if (treeNode.isLeaf())
-                                        m_vecTreeNode.push_back(treeNode);
-                                });
-    return true;
-}
+public:
+    Properties(PropertyGroup *parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->coordinatePrecision.setConstraintsEnabled(true);
+        this->coordinatePrecision.setRange(0, 17);
+        this->coordinatePrecision.setDescription(
+            OffWriterI18N::textIdTr("Maximum number of significant digits when writing vertex "
+                                    "coordinates. Lower values give smaller files.\n"
+                                    "0 means shortest representation preserving exact values"));
+    }
+
+    void restoreDefaults() override
+    {
+        const OffWriter::Parameters defaultParams;
+        this->coordinatePrecision.setValue(defaultParams.coordinatePrecision);
+    }
+
+    PropertyInt coordinatePrecision{this, OffWriterI18N::textId("coordinatePrecision")};
+};
 
 bool OffWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
 {
     progress = progress ? progress : &TaskProgress::null();
-    std::ofstream fstr(filepath);
-    if (!fstr.is_open())
+    OutputFileBuffer out(filepath, OutputBufferSize);
+    if (!out.isOpen())
     {
         this->messenger()->emitError(OffWriterI18N::textIdTr("Failed to open file"));
         return false;
     }
 
-    fstr.imbue(std::locale::classic());
-    fstr << "OFF\n";
-
     // Count vertices and facets
-    int vertexCount = 0;
-    int facetCount = 0;
-    for (const DocumentTreeNode &treeNode : m_vecTreeNode)
-    {
-        IMeshAccess_visitMeshes(treeNode,
-                                [&](const IMeshAccess &mesh)
-                                {
-                                    vertexCount += mesh.triangulation()->NbNodes();
-                                    facetCount += mesh.triangulation()->NbTriangles();
-                                });
-    }
+    const std::vector<MeshItem> vecMeshItem = this->meshItems();
+    const MeshStreamWriter::Counts counts = this->counts();
+    const int64_t vertexCount = counts.meshNodeCount;
+    const int64_t facetCount = counts.meshTriangleCount;
 
-    // Helper function for progress report
-    auto fnUpdateProgress = [=](int current)
-    {
-        const auto total = vertexCount + facetCount;
-        if (current % 100 || current >= total)
-            progress->setValue(MathUtils::toPercent(current, 0, total));
-    };
+    out.write("OFF\n");
+    out.print("{} {} {}\n", vertexCount, facetCount, 0 /*edgeCount*/);
 
-    fstr << vertexCount << " " << facetCount << " " << 0 /*edgeCount*/ << "\n";
     // Write vertices
-    int ivertex = 0;
-    for (const DocumentTreeNode &treeNode : m_vecTreeNode)
+    const int coordinatePrecision = m_params.coordinatePrecision;
+    auto fnEncodeVertices = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
     {
-        IMeshAccess_visitMeshes(
-            treeNode,
-            [&](const IMeshAccess &mesh)
+        auto itOut = std::back_inserter(*buffer);
+        for (int64_t i = begin; i < end;)
+        {
+            const MeshItem &mesh = MeshStreamWriter::findMeshItemOfNode(vecMeshItem, i);
+            const int64_t meshEnd = mesh.firstNodeIndex + mesh.triangulation->NbNodes();
+            for (; i < std::min(end, meshEnd); ++i)
             {
-                const gp_Trsf &meshTrsf = mesh.location().Transformation();
-                const OccHandle<Poly_Triangulation> &triangulation = mesh.triangulation();
-                for (int i = 1; i <= triangulation->NbNodes(); ++i)
+                const int inode = int(i - mesh.firstNodeIndex);
+                const gp_Pnt pnt = mesh.triangulation->Node(inode + 1).Transformed(mesh.trsf);
+                if (coordinatePrecision > 0)
+                {
+                    const int p = coordinatePrecision;
+                    fmt::format_to(itOut, "{:.{}g} {:.{}g} {:.{}g}", pnt.X(), p, pnt.Y(), p,
+                                   pnt.Z(), p);
+                }
+                else
                 {
-                    const gp_Pnt pnt = triangulation->Node(i).Transformed(meshTrsf);
-                    const std::optional<Quantity_Color> color = mesh.nodeColor(i - 1);
-                    fstr << pnt.X() << " " << pnt.Y() << " " << pnt.Z();
-                    if (color.has_value())
-                    {
-                        // fstr << " " << int(color->Red()   * 255)
-                        //      << " " << int(color->Green() * 255)
-                        //      << " " << int(color->Blue()  * 255);
-                        fstr << " " << color->Red() << " " << color->Green() << " "
-                             << color->Blue();
-                    }
-
-                    fstr << "\n";
-                    fnUpdateProgress(++ivertex);
+                    fmt::format_to(itOut, "{} {} {}", pnt.X(), pnt.Y(), pnt.Z());
                 }
-            });
+
+                const std::optional<Quantity_Color> color = mesh.nodeColor(inode);
+                if (color)
+                {
+                    // Color components are single precision values
+                    fmt::format_to(itOut, " {} {} {}", float(color->Red()),
+                                   float(color->Green()), float(color->Blue()));
+                }
+
+                buffer->push_back('\n');
+            }
+        }
+    };
+    const int pctVertices = int(MathUtils::toPercent(vertexCount, 0, vertexCount + facetCount));
+    if (!MeshStreamWriter::writeChunks(&out, vertexCount, fnEncodeVertices, progress, 0,
+                                       pctVertices))
+    {
+        return false;
     }
 
     // Write facets(triangles)
-    int offsetVertex = 0;
-    int ifacet = 0;
-    for (const DocumentTreeNode &treeNode : m_vecTreeNode)
+    auto fnEncodeFacets = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
+    {
+        auto itOut = std::back_inserter(*buffer);
+        for (int64_t i = begin; i < end;)
+        {
+            const MeshItem &mesh = MeshStreamWriter::findMeshItemOfTriangle(vecMeshItem, i);
+            const int64_t meshEnd = mesh.firstTriangleIndex + mesh.triangulation->NbTriangles();
+            const int64_t offset = mesh.firstNodeIndex - 1;
+            for (; i < std::min(end, meshEnd); ++i)
+            {
+                const int itri = int(i - mesh.firstTriangleIndex);
+                const Poly_Triangle &tri = mesh.triangulation->Triangle(itri + 1);
+                fmt::format_to(itOut, "3 {} {} {}\n", offset + tri.Value(1), offset + tri.Value(2),
+                               offset + tri.Value(3));
+            }
+        }
+    };
+    if (!MeshStreamWriter::writeChunks(&out, facetCount, fnEncodeFacets, progress, pctVertices,
+                                       100))
     {
-        IMeshAccess_visitMeshes(treeNode,
-                                [&](const IMeshAccess &mesh)
-                                {
-                                    const OccHandle<Poly_Triangulation> &triangulation =
-                                        mesh.triangulation();
-                                    for (int i = 1; i <= triangulation->NbTriangles(); ++i)
-                                    {
-                                        const Poly_Triangle &tri = triangulation->Triangle(i);
-                                        fstr << "3 " << offsetVertex + tri.Value(1) - 1 << " "
-                                             << offsetVertex + tri.Value(2) - 1 << " "
-                                             << offsetVertex + tri.Value(3) - 1 << "\n";
-                                        fnUpdateProgress(vertexCount + (++ifacet));
-                                    }
-
-                                    offsetVertex += triangulation->NbNodes();
-                                });
+        return false;
+    }
+
+    if (!out.flush())
+    {
+        this->messenger()->emitError(OffWriterI18N::textIdTr("Failed to write file"));
+        return false;
     }
 
     return true;
 }
 
-void OffWriter::applyProperties(const PropertyGroup *)
+std::unique_ptr<PropertyGroup> OffWriter::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OffWriter::applyProperties(const PropertyGroup *params)
 {
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
+        m_params.coordinatePrecision = ptr->coordinatePrecision;
 }
 
 } // namespace Mayo::IO
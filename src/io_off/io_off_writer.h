@@ -6,30 +6,40 @@
 
 #pragma once
 
-#include <vector>
-
-#include "base/document_tree_node.h"
+#include "base/io_mesh_stream_writer.h"
 #include "base/io_single_format_factory.h"
-#include "base/io_writer.h"
 
 namespace Mayo::IO
 {
 
 // Writer for OFF file format
-class OffWriter : public Writer
+class OffWriter : public MeshStreamWriter
 {
 public:
-    bool transfer(Span<const ApplicationItem> appItems, TaskProgress *progress) override;
     bool writeFile(const FilePath &filepath, TaskProgress *progress) override;
-    void applyProperties(const PropertyGroup *group) override;
 
-    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *)
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
+    void applyProperties(const PropertyGroup *params) override;
+
+    // Parameters
+    struct Parameters
+    {
+        // Maximum number of significant digits of vertex coordinates
+        // 0 means shortest representation giving back the exact same value when read
+        int coordinatePrecision = 0;
+    };
+    Parameters &parameters()
+    {
+        return m_params;
+    }
+    const Parameters &constParameters() const
     {
-        return {};
+        return m_params;
     }
 
 private:
-    std::vector<DocumentTreeNode> m_vecTreeNode;
+    class Properties;
+    Parameters m_params;
 };
 
 // Provides factory to create OffWriter objects
@@ -11,11 +11,13 @@
 #include "base/cpp_utils.h"
 #include "base/document.h"
 #include "base/filepath_conv.h"
+#include "base/math_utils.h"
 #include "base/mesh_utils.h"
 #include "base/messenger.h"
 #include "base/point_cloud_data.h"
 #include "base/property_builtins.h"
 #include "base/tkernel_utils.h"
+#include "base/task_progress.h"
 #include "base/triangulation_annex_data.h"
 
 #include "miniply.h"
@@ -24,85 +26,333 @@
 #include <Poly_Triangulation.hxx>
 #include <TDataStd_Name.hxx>
 
+#include <algorithm>
+#include <climits>
+#include <functional>
+
 namespace Mayo::IO
 {
 
-bool PlyReader::readFile(const FilePath &filepath, TaskProgress * /*progress*/)
+namespace
+{
+
+// Count of element rows extracted at once, progress is reported and abort requests are checked
+// between chunks
+constexpr uint32_t RowChunkSize = 256 * 1024;
+
+Quantity_Color toColor(const uint8_t rgb[3])
+{
+    return {rgb[0] / 255., rgb[1] / 255., rgb[2] / 255., TKernelUtils::preferredRgbColorType()};
+}
+
+// Changes count of triangles in 'mesh', nodes and normals are kept
+void resizeTriangles(OccHandle<Poly_Triangulation> &mesh, int triangleCount)
+{
+#if OCC_VERSION_HEX >= 0x070600
+    mesh->ResizeTriangles(triangleCount, false /*toCopyOld*/);
+#else
+    auto newMesh = makeOccHandle<Poly_Triangulation>(mesh->NbNodes(), triangleCount, false);
+    newMesh->ChangeNodes() = mesh->Nodes();
+    if (mesh->HasNormals())
+    {
+        MeshUtils::allocateNormals(newMesh);
+        newMesh->ChangeNormals() = mesh->Normals();
+    }
+
+    mesh = newMesh;
+#endif
+}
+
+} // namespace
+
+struct PlyReaderI18N
+{
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::PlyReaderI18N)
+};
+
+class PlyReader::Properties : public PropertyGroup
+{
+public:
+    Properties(PropertyGroup *parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->octreeMinPointCount.setDescription(
+            PlyReaderI18N::textIdTr("Minimum count of points for a point cloud to be stored in "
+                                    "a level-of-detail octree cached on local disk, instead of "
+                                    "being fully loaded in memory.\n"
+                                    "0 means point clouds are always loaded in memory"));
+        this->octreeMinPointCount.setConstraintsEnabled(true);
+        this->octreeMinPointCount.setRange(0, INT_MAX);
+    }
+
+    void restoreDefaults() override
+    {
+        const PlyReader::Parameters defaultParams;
+        this->octreeMinPointCount.setValue(defaultParams.octreeMinPointCount);
+    }
+
+    PropertyInt octreeMinPointCount{this, PlyReaderI18N::textId("octreeMinPointCount")};
+};
+
+bool PlyReader::readFile(const FilePath &filepath, TaskProgress *progress)
+{
+    return this->readFile(FileView(filepath), progress);
+}
+
+bool PlyReader::readFile(const FileView &fileView, TaskProgress *progress)
 {
-    miniply::PLYReader reader(filepath.u8string().c_str());
+    progress = progress ? progress : &TaskProgress::null();
+
+    // Reset internal data
+    m_baseFilename = fileView.filepath().stem();
+    m_mesh.Nullify();
+    m_pointCloud.Nullify();
+    m_pointCloudOctree.Nullify();
+    m_vecNodeColor.clear();
+
+    if (!fileView.isOpen())
+    {
+        this->messenger()->emitError(PlyReaderI18N::textIdTr("Can't open input file"));
+        return false;
+    }
+
+    // Binary little-endian elements are used in place from the file view
+    miniply::PLYReader reader(fileView.data(), fileView.size());
     if (!reader.valid())
         return false;
 
-    // Reset internal data
-    m_baseFilename = filepath.stem();
-    m_nodeCount = 0;
-    m_vecNodeCoord.clear();
-    m_vecColorComponent.clear();
-    m_vecIndex.clear();
-    m_vecNormalCoord.clear();
-    bool assumeTriangles = true;
+    // Element counts are known from header
+    auto fnFindElement = [&](const char *name)
+    { return reader.get_element(reader.find_element(name)); };
+    const miniply::PLYElement *vertexElem = fnFindElement(miniply::kPLYVertexElement);
+    miniply::PLYElement *faceElem = fnFindElement(miniply::kPLYFaceElement);
+    const miniply::PLYElement *triStripElem = fnFindElement("tristrips");
+    const uint32_t nodeCount = vertexElem ? vertexElem->count : 0;
+    const uint32_t faceCount = faceElem ? faceElem->count : 0;
+    const uint32_t triStripCount = triStripElem ? triStripElem->count : 0;
 
     // Guess if PLY faces are triangles
     uint32_t faceIdxs[3] = {};
-    if (assumeTriangles)
+    const bool assumeTriangles =
+        faceElem
+        && faceElem->convert_list_to_fixed_size(faceElem->find_property("vertex_indices"), 3,
+                                                faceIdxs);
+
+    // Target mesh is allocated upfront, so elements are extracted straight into its arrays
+    if (nodeCount > 0 && (faceCount > 0 || triStripCount > 0))
     {
-        miniply::PLYElement *faceElem =
-            reader.get_element(reader.find_element(miniply::kPLYFaceElement));
-        if (faceElem)
-            assumeTriangles = faceElem->convert_list_to_fixed_size(
-                faceElem->find_property("vertex_indices"), 3, faceIdxs);
+        m_mesh = makeOccHandle<Poly_Triangulation>(
+            CppUtils::safeStaticCast<int>(nodeCount),
+            CppUtils::safeStaticCast<int>(assumeTriangles ? faceCount : 0),
+            false /*hasUvNodes*/);
     }
 
-    bool okLoad = true;
+    // Huge point clouds are stored in an out-of-core octree, built once all points are extracted
+    const bool useOctree = !m_mesh && m_params.octreeMinPointCount > 0
+                           && nodeCount >= uint32_t(m_params.octreeMinPointCount);
+    const int pctExtractEnd = useOctree ? 50 : 100;
+
+    // Helper to extract rows of the current element by chunks
+    // 'fnExtract' is called with the first row and row count of each chunk
+    const uint64_t totalRowCount = uint64_t(nodeCount) + faceCount + triStripCount;
+    uint64_t extractedRowCount = 0;
+    auto fnExtractByChunks = [&](const std::function<bool(uint32_t, uint32_t)> &fnExtract)
+    {
+        const uint32_t rowCount = reader.num_rows();
+        for (uint32_t firstRow = 0; firstRow < rowCount; firstRow += RowChunkSize)
+        {
+            const uint32_t chunkRowCount = std::min(RowChunkSize, rowCount - firstRow);
+            if (!fnExtract(firstRow, chunkRowCount))
+                return false;
+
+            extractedRowCount += chunkRowCount;
+            progress->setValue(
+                MathUtils::mappedValue(extractedRowCount, 0, totalRowCount, 0, pctExtractEnd));
+            if (progress->isAbortRequested())
+                return false;
+        }
+
+        return true;
+    };
+
+    // Helper to assign triangles from node indices(0-based, 3 per triangle)
+    auto fnSetTriangles = [&](const std::vector<int> &vecIndex)
+    {
+        resizeTriangles(m_mesh, CppUtils::safeStaticCast<int>(vecIndex.size() / 3));
+        for (int i = 0; i < m_mesh->NbTriangles(); ++i)
+        {
+            const int *tri = &vecIndex.at(3 * i);
+            const Poly_Triangle triangle(1 + tri[0], 1 + tri[1], 1 + tri[2]);
+            MeshUtils::setTriangle(m_mesh, i + 1, triangle);
+        }
+    };
+
     bool gotVerts = false;
     bool gotFaces = false;
     while (reader.has_element() && (!gotVerts || !gotFaces))
     {
         if (reader.element_is(miniply::kPLYVertexElement))
         {
-            uint32_t prop3Idxs[3] = {};
-            if (!reader.load_element() || !reader.find_pos(prop3Idxs))
+            uint32_t posIdxs[3] = {};
+            if (!reader.load_element() || !reader.find_pos(posIdxs))
+                return false;
+
+            uint32_t normalIdxs[3] = {};
+            uint32_t colorIdxs[3] = {};
+            const bool hasNormals = reader.find_normal(normalIdxs);
+            const bool hasColors = reader.find_color(colorIdxs);
+            std::vector<uint8_t> vecColorChunk;
+            auto fnExtractColors = [&](uint32_t firstRow, uint32_t rowCount,
+                                       const std::function<void(uint32_t, const uint8_t *)> &fn)
             {
-                okLoad = false;
-                break;
-            }
+                vecColorChunk.resize(3 * size_t(rowCount));
+                if (!reader.extract_properties(colorIdxs, 3, miniply::PLYPropertyType::UChar,
+                                               vecColorChunk.data(), firstRow, rowCount))
+                {
+                    return false;
+                }
+
+                for (uint32_t i = 0; i < rowCount; ++i)
+                    fn(firstRow + i, &vecColorChunk.at(3 * i));
 
-            m_nodeCount = reader.num_rows();
-            m_vecNodeCoord.resize(m_nodeCount * 3);
-            reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::Float,
-                                      m_vecNodeCoord.data());
-            if (reader.find_normal(prop3Idxs))
+                return true;
+            };
+
+            bool okExtract = true;
+            if (m_mesh)
             {
-                m_vecNormalCoord.resize(m_nodeCount * 3);
-                reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::Float,
-                                          m_vecNormalCoord.data());
+                if (hasNormals)
+                    MeshUtils::allocateNormals(m_mesh);
+
+                if (hasColors)
+                    m_vecNodeColor.resize(nodeCount);
+
+                double *nodeCoords = MeshUtils::nodeCoordsData(m_mesh);
+                float *normalCoords = hasNormals ? MeshUtils::normalCoordsData(m_mesh) : nullptr;
+                if (!nodeCoords)
+                    return false;
+
+                okExtract = fnExtractByChunks(
+                    [&](uint32_t firstRow, uint32_t rowCount)
+                    {
+                        const size_t offset = 3 * size_t(firstRow);
+                        bool ok =
+                            reader.extract_properties(posIdxs, 3, miniply::PLYPropertyType::Double,
+                                                      nodeCoords + offset, firstRow, rowCount);
+                        if (ok && normalCoords)
+                        {
+                            ok = reader.extract_properties(normalIdxs, 3,
+                                                           miniply::PLYPropertyType::Float,
+                                                           normalCoords + offset, firstRow,
+                                                           rowCount);
+                        }
+
+                        if (ok && hasColors)
+                        {
+                            ok = fnExtractColors(firstRow, rowCount,
+                                                 [&](uint32_t row, const uint8_t *rgb)
+                                                 { m_vecNodeColor.at(row) = toColor(rgb); });
+                        }
+
+                        return ok;
+                    });
             }
-
-            if (reader.find_color(prop3Idxs))
+            else if (useOctree)
             {
-                m_vecColorComponent.resize(m_nodeCount * 3);
-                reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::UChar,
-                                          m_vecColorComponent.data());
+                PointCloudOctree::Builder octreeBuilder(hasColors);
+                std::vector<float> vecCoordChunk;
+                okExtract = fnExtractByChunks(
+                    [&](uint32_t firstRow, uint32_t rowCount)
+                    {
+                        vecCoordChunk.resize(3 * size_t(rowCount));
+                        vecColorChunk.resize(3 * size_t(rowCount));
+                        bool ok =
+                            reader.extract_properties(posIdxs, 3, miniply::PLYPropertyType::Float,
+                                                      vecCoordChunk.data(), firstRow, rowCount);
+                        if (ok && hasColors)
+                        {
+                            ok = reader.extract_properties(colorIdxs, 3,
+                                                           miniply::PLYPropertyType::UChar,
+                                                           vecColorChunk.data(), firstRow,
+                                                           rowCount);
+                        }
+
+                        return ok && octreeBuilder.addPoints(vecCoordChunk.data(),
+                                                             vecColorChunk.data(), rowCount);
+                    });
+                if (okExtract)
+                {
+                    m_pointCloudOctree = octreeBuilder.build(progress, pctExtractEnd, 100);
+                    if (!m_pointCloudOctree && !progress->isAbortRequested())
+                    {
+                        this->messenger()->emitError(
+                            PlyReaderI18N::textIdTr("Failed to build point cloud octree"));
+                    }
+
+                    okExtract = !m_pointCloudOctree.IsNull();
+                }
+            }
+            else
+            {
+                m_pointCloud = new Graphic3d_ArrayOfPoints(
+                    CppUtils::safeStaticCast<int>(nodeCount), hasColors, false /*hasNormals*/);
+                std::vector<float> vecCoordChunk;
+                okExtract = fnExtractByChunks(
+                    [&](uint32_t firstRow, uint32_t rowCount)
+                    {
+                        vecCoordChunk.resize(3 * size_t(rowCount));
+                        if (!reader.extract_properties(posIdxs, 3, miniply::PLYPropertyType::Float,
+                                                       vecCoordChunk.data(), firstRow, rowCount))
+                        {
+                            return false;
+                        }
+
+                        for (uint32_t i = 0; i < rowCount; ++i)
+                        {
+                            const float *coords = &vecCoordChunk.at(3 * i);
+                            m_pointCloud->AddVertex(coords[0], coords[1], coords[2]);
+                        }
+
+                        if (!hasColors)
+                            return true;
+
+                        return fnExtractColors(
+                            firstRow, rowCount,
+                            [&](uint32_t row, const uint8_t *rgb)
+                            { m_pointCloud->SetVertexColor(int(row) + 1, toColor(rgb)); });
+                    });
             }
 
-            // if (reader.find_texcoord(propIdxs)) {
-            //     vecUvCoord.resize(nodeCount * 2);
-            //     reader.extract_properties(propIdxs, 2,
-            //     miniply::PLYPropertyType::Float, vecUvCoord.data());
-            // }
+            if (!okExtract)
+                return false;
 
             gotVerts = true;
         }
-        else if (!gotFaces && reader.element_is(miniply::kPLYFaceElement))
+        else if (!gotFaces && m_mesh && reader.element_is(miniply::kPLYFaceElement))
         {
             if (!reader.load_element())
                 break;
 
             if (assumeTriangles)
             {
-                m_vecIndex.resize(reader.num_rows() * 3);
-                reader.extract_properties(faceIdxs, 3, miniply::PLYPropertyType::Int,
-                                          m_vecIndex.data());
+                int *triIndices = MeshUtils::triangleIndicesData(m_mesh);
+                const bool okExtract = fnExtractByChunks(
+                    [&](uint32_t firstRow, uint32_t rowCount)
+                    {
+                        int *chunkIndices = triIndices + 3 * size_t(firstRow);
+                        if (!reader.extract_properties(faceIdxs, 3, miniply::PLYPropertyType::Int,
+                                                       chunkIndices, firstRow, rowCount))
+                        {
+                            return false;
+                        }
+
+                        // PLY indices are 0-based
+                        std::for_each(chunkIndices, chunkIndices + 3 * size_t(rowCount),
+                                      [](int &index) { ++index; });
+                        return true;
+                    });
+                if (!okExtract)
+                    return false;
             }
             else
             {
@@ -118,23 +368,36 @@ bool PlyReader::readFile(const FilePath &filepath, TaskProgress * /*progress*/)
                     break;
                 }
 
+                std::vector<int> vecIndex;
                 if (polys)
                 {
-                    m_vecIndex.resize(reader.num_triangles(propIdx) * 3);
-                    reader.extract_triangles(propIdx, m_vecNodeCoord.data(), m_nodeCount,
-                                             miniply::PLYPropertyType::Int, m_vecIndex.data());
+                    // Triangulation of polygons needs node positions as float values
+                    std::vector<float> vecNodeCoord;
+                    vecNodeCoord.reserve(3 * size_t(nodeCount));
+                    for (int i = 1; i <= m_mesh->NbNodes(); ++i)
+                    {
+                        const gp_Pnt node = m_mesh->Node(i);
+                        vecNodeCoord.insert(vecNodeCoord.end(),
+                                            {float(node.X()), float(node.Y()), float(node.Z())});
+                    }
+
+                    vecIndex.resize(reader.num_triangles(propIdx) * 3);
+                    reader.extract_triangles(propIdx, vecNodeCoord.data(), nodeCount,
+                                             miniply::PLYPropertyType::Int, vecIndex.data());
                 }
                 else
                 {
-                    m_vecIndex.resize(reader.num_rows() * 3);
+                    vecIndex.resize(reader.num_rows() * 3);
                     reader.extract_list_property(propIdx, miniply::PLYPropertyType::Int,
-                                                 m_vecIndex.data());
+                                                 vecIndex.data());
                 }
+
+                fnSetTriangles(vecIndex);
             }
 
             gotFaces = true;
         }
-        else if (!gotFaces && reader.element_is("tristrips"))
+        else if (!gotFaces && m_mesh && reader.element_is("tristrips"))
         {
             if (!reader.load_element())
             {
@@ -150,24 +413,43 @@ bool PlyReader::readFile(const FilePath &filepath, TaskProgress * /*progress*/)
                 break;
             }
 
-            m_vecIndex.resize(reader.sum_of_list_counts(propIdx));
-            reader.extract_list_property(propIdx, miniply::PLYPropertyType::Int, m_vecIndex.data());
+            std::vector<int> vecIndex(reader.sum_of_list_counts(propIdx));
+            reader.extract_list_property(propIdx, miniply::PLYPropertyType::Int, vecIndex.data());
+            fnSetTriangles(vecIndex);
             gotFaces = true;
         }
 
         reader.next_element();
     } // endwhile
 
-    return okLoad;
+    if (m_mesh && !gotVerts)
+        m_mesh.Nullify();
+
+    // No face could be read, fall back to point cloud
+    if (m_mesh && (!gotFaces || m_mesh->NbTriangles() == 0))
+    {
+        const bool hasColors = !m_vecNodeColor.empty();
+        m_pointCloud = new Graphic3d_ArrayOfPoints(m_mesh->NbNodes(), hasColors, false);
+        for (int i = 1; i <= m_mesh->NbNodes(); ++i)
+        {
+            m_pointCloud->AddVertex(m_mesh->Node(i));
+            if (hasColors)
+                m_pointCloud->SetVertexColor(i, m_vecNodeColor.at(i - 1));
+        }
+
+        m_mesh.Nullify();
+        m_vecNodeColor.clear();
+    }
+
+    return true;
 }
 
 TDF_LabelSequence PlyReader::transfer(DocumentPtr doc, TaskProgress *progress)
 {
     TDF_Label entityLabel;
-    if (!m_vecNodeCoord.empty() && !m_vecIndex.empty())
+    if (m_mesh)
         entityLabel = this->transferMesh(doc, progress);
-
-    if (!m_vecNodeCoord.empty() && m_vecIndex.empty())
+    else if (m_pointCloud || m_pointCloudOctree)
         entityLabel = this->transferPointCloud(doc, progress);
 
     if (!entityLabel.IsNull())
@@ -181,93 +463,36 @@ TDF_LabelSequence PlyReader::transfer(DocumentPtr doc, TaskProgress *progress)
 
 TDF_Label PlyReader::transferMesh(DocumentPtr doc, TaskProgress * /*progress*/)
 {
-    // Create target mesh
-    const int triangleCount = CppUtils::safeStaticCast<int>(m_vecIndex.size() / 3);
-    auto mesh = makeOccHandle<Poly_Triangulation>(m_nodeCount, triangleCount, false /*hasUvNodes*/);
-    if (!m_vecNormalCoord.empty())
-        MeshUtils::allocateNormals(mesh);
-
-    // Copy nodes(vertices) into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecNodeCoord.size()); i += 3)
-    {
-        const auto &vec = m_vecNodeCoord;
-        const gp_Pnt node = {vec.at(i), vec.at(i + 1), vec.at(i + 2)};
-        MeshUtils::setNode(mesh, (i / 3) + 1, node);
-    }
-
-    // Copy triangles indices into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecIndex.size()); i += 3)
-    {
-        const auto &vec = m_vecIndex;
-        const Poly_Triangle tri = {1 + vec.at(i), 1 + vec.at(i + 1), 1 + vec.at(i + 2)};
-        MeshUtils::setTriangle(mesh, (i / 3) + 1, tri);
-    }
-
-    // Copy normals(optional) into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecNormalCoord.size()); i += 3)
-    {
-        const auto &vec = m_vecNormalCoord;
-        const MeshUtils::Poly_Triangulation_NormalType n(vec.at(i), vec.at(i + 1), vec.at(i + 2));
-        MeshUtils::setNormal(mesh, (i / 3) + 1, n);
-    }
-
-    // Copy colors(optional) into mesh
-    std::vector<Quantity_Color> vecColor;
-    for (int i = 0; CppUtils::cmpLess(i, m_vecColorComponent.size()); i += 3)
-    {
-        const auto &vec = m_vecColorComponent;
-        const Quantity_Color color = {vec.at(i) / 255., vec.at(i + 1) / 255., vec.at(i + 2) / 255.,
-                                      TKernelUtils::preferredRgbColorType()};
-        vecColor.push_back(color);
-    }
-
     // Insert mesh as a document entity
     const TDF_Label entityLabel = doc->newEntityShapeLabel();
     doc->xcaf().setShape(entityLabel,
-                         BRepUtils::makeFace(mesh)); // IMPORTANT: pure mesh part marker!
-    TriangulationAnnexData::Set(entityLabel, vecColor);
+                         BRepUtils::makeFace(m_mesh)); // IMPORTANT: pure mesh part marker!
+    TriangulationAnnexData::Set(entityLabel, std::move(m_vecNodeColor));
     return entityLabel;
 }
 
 TDF_Label PlyReader::transferPointCloud(DocumentPtr doc, TaskProgress * /*progress*/)
 {
-    const bool hasColors = !m_vecColorComponent.empty();
-    const bool hasNormals = false; //! m_vecNormalCoord.empty();
-    auto gfxPoints = new Graphic3d_ArrayOfPoints(
-        CppUtils::safeStaticCast<int>(m_vecNodeCoord.size()), hasColors, hasNormals);
-
-    // Add nodes(vertices) into point cloud
-    for (int i = 0; CppUtils::cmpLess(i, m_vecNodeCoord.size()); i += 3)
-    {
-        const auto &vec = m_vecNodeCoord;
-        const gp_Pnt node = {vec.at(i), vec.at(i + 1), vec.at(i + 2)};
-        gfxPoints->AddVertex(node);
-    }
-
-    if (hasColors)
-    {
-        for (int i = 0; CppUtils::cmpLess(i, m_vecColorComponent.size()); i += 3)
-        {
-            const auto &vec = m_vecColorComponent;
-            const Quantity_Color color{vec.at(i) / 255., vec.at(i + 1) / 255., vec.at(i + 2) / 255.,
-                                       TKernelUtils::preferredRgbColorType()};
-            gfxPoints->SetVertexColor((i / 3) + 1, color);
-        }
-    }
-
-#if 0
-    if (hasNormals) {
-        for (int i = 0; CppUtils::cmpLess(i, m_vecNormalCoord.size()); i += 3) {
-            const auto& vec = m_vecNormalCoord;
-            gfxPoints->SetVertexNormal((i / 3) + 1, vec.at(i), vec.at(i + 1), vec.at(i + 2));
-        }
-    }
-#endif
-
     // Insert point cloud as a document entity
     const TDF_Label entityLabel = doc->newEntityLabel();
-    PointCloudData::Set(entityLabel, gfxPoints);
+    if (m_pointCloudOctree)
+        PointCloudData::Set(entityLabel, m_pointCloudOctree);
+    else
+        PointCloudData::Set(entityLabel, m_pointCloud);
+
     return entityLabel;
 }
 
+std::unique_ptr<PropertyGroup> PlyReader::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void PlyReader::applyProperties(const PropertyGroup *params)
+{
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
+        m_params.octreeMinPointCount = ptr->octreeMinPointCount;
+}
+
 } // namespace Mayo::IO
@@ -8,8 +8,14 @@
 
 #include <vector>
 
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+
 #include "base/io_reader.h"
 #include "base/io_single_format_factory.h"
+#include "base/occ_handle.h"
+#include "base/point_cloud_octree.h"
 
 namespace Mayo::IO
 {
@@ -19,26 +25,45 @@ class PlyReader : public Reader
 {
 public:
     bool readFile(const FilePath &filepath, TaskProgress *progress) override;
+    bool readFile(const FileView &fileView, TaskProgress *progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) override;
-    void applyProperties(const PropertyGroup *) override
+    bool isConcurrentTransferSupported() const override
     {
+        return true;
     }
 
-    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *)
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
+    void applyProperties(const PropertyGroup *params) override;
+
+    // Parameters
+    struct Parameters
+    {
+        // Point clouds having at least this count of points are stored in a PointCloudOctree
+        // 0 means never
+        int octreeMinPointCount = 20 * 1000 * 1000;
+    };
+    Parameters &parameters()
     {
-        return {};
+        return m_params;
+    }
+    const Parameters &constParameters() const
+    {
+        return m_params;
     }
 
 private:
     TDF_Label transferMesh(DocumentPtr doc, TaskProgress *progress);
     TDF_Label transferPointCloud(DocumentPtr doc, TaskProgress *progress);
 
+    class Properties;
+    Parameters m_params;
+
+    // Elements are directly read into the target mesh or point cloud
     FilePath m_baseFilename;
-    uint32_t m_nodeCount = 0;
-    std::vector<float> m_vecNodeCoord;
-    std::vector<int> m_vecIndex;
-    std::vector<float> m_vecNormalCoord;
-    std::vector<uint8_t> m_vecColorComponent;
+    OccHandle<Poly_Triangulation> m_mesh;
+    OccHandle<Graphic3d_ArrayOfPoints> m_pointCloud;
+    PointCloudOctreePtr m_pointCloudOctree;
+    std::vector<Quantity_Color> m_vecNodeColor; // Colors of mesh nodes(optional)
 };
 
 // Provides factory to create PlyReader objects
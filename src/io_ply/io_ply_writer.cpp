@@ -7,21 +7,18 @@
 #include "io_ply_writer.h"
 
 #include <algorithm>
-#include <fstream>
-#include <gsl/util>
-#include <locale>
+#include <atomic>
+#include <iterator>
 #include <string>
+#include <vector>
 
+#include <Graphic3d_ArrayOfPoints.hxx>
 #include <Poly_Triangulation.hxx>
 #include <fmt/format.h>
 
-#include "base/caf_utils.h"
 #include "base/cpp_utils.h"
-#include "base/document.h"
-#include "base/io_system.h"
-#include "base/label_data.h"
+#include "base/io_output_file_buffer.h"
 #include "base/math_utils.h"
-#include "base/mesh_access.h"
 #include "base/messenger.h"
 #include "base/property_builtins.h"
 #include "base/property_enumeration.h"
@@ -91,81 +88,18 @@ public:
     PropertyString comment{this, PlyWriterI18N::textId("comment")};
 };
 
-bool PlyWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress *progress)
-{
-    progress = progress ? progress : &TaskProgress::null();
-    m_vecNode.clear();
-    m_vecNodeColor.clear();
-    m_vecFace.clear();
-
-    // TODO Investigate bad looking 3D mesh when defining vertex colors
-    // TODO Investigate task abort issue
-
-    // Count number of faces for progress report
-    int count = 0;
-    System::traverseUniqueItems(
-        appItems,
-        [&](const DocumentTreeNode &docTreeNode)
-        {
-            if (docTreeNode.isLeaf())
-            {
-                IMeshAccess_visitMeshes(docTreeNode, [&](const IMeshAccess &) { ++count; });
-                if (findLabelDataFlags(docTreeNode.label()) & LabelData_HasPointCloudData)
-                    ++count;
-            }
-        });
-
-    // Record face meshes
-    int iCount = 0;
-    System::traverseUniqueItems(appItems,
-                                [&](const DocumentTreeNode &docTreeNode)
-                                {
-                                    if (docTreeNode.isLeaf() && !progress->isAbortRequested())
-                                    {
-                                        IMeshAccess_visitMeshes(
-                                            docTreeNode,
-                                            [&](const IMeshAccess &mesh)
-                                            {
-                                                this->addMesh(mesh);
-                                                progress->setValue(
-                                                    MathUtils::toPercent(++iCount, 0, count));
-                                            });
-                                    }
-                                });
-
-    // Record point clouds
-    System::traverseUniqueItems(
-        appItems,
-        [&](const DocumentTreeNode &docTreeNode)
-        {
-            if (docTreeNode.isLeaf() &&
-                (findLabelDataFlags(docTreeNode.label()) & LabelData_HasPointCloudData) &&
-                !progress->isAbortRequested())
-            {
-                this->addPointCloud(CafUtils::findAttribute<PointCloudData>(docTreeNode.label()));
-                progress->setValue(MathUtils::toPercent(++iCount, 0, count));
-            }
-        });
-
-    return true;
-}
-
 bool PlyWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
 {
     progress = progress ? progress : &TaskProgress::null();
-    const bool isBinary = m_params.format == Format::Binary;
-    std::ios_base::openmode mode = std::ios_base::out;
-    if (isBinary)
-        mode |= std::ios_base::binary;
-
-    std::ofstream fstr(filepath, mode);
-    if (!fstr.is_open())
+    OutputFileBuffer out(filepath, OutputBufferSize);
+    if (!out.isOpen())
     {
         this->messenger()->emitError(PlyWriterI18N::textIdTr("Failed to open file"));
         return false;
     }
 
     // Define PLY format
+    const bool isBinary = m_params.format == Format::Binary;
     const char *strPlyFormat = nullptr;
     if (isBinary)
     {
@@ -185,167 +119,305 @@ bool PlyWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
     if (!strPlyFormat)
         return false;
 
-    // Write PLY header
-    fstr.imbue(std::locale::classic());
-    fstr << "ply\n"
-         << "format " << strPlyFormat << " 1.0\n";
+    // Element counts are known upfront, so the header can be written before mesh data
+    const MeshStreamWriter::Counts counts = this->counts();
+    const int64_t vertexCount = counts.meshNodeCount + counts.pointCount;
+
+    // Face vertex indices are written as PLY "int", mesh nodes being written first
+    if (!CppUtils::inRange<int32_t>(counts.meshNodeCount))
+    {
+        this->messenger()->emitError(
+            PlyWriterI18N::textIdTr("Too many mesh nodes, face indices can't be encoded"));
+        return false;
+    }
 
+    // Write PLY header
+    out.print("ply\nformat {} 1.0\n", strPlyFormat);
     if (!m_params.comment.empty())
     {
         std::string strComment = m_params.comment;
         std::replace(strComment.begin(), strComment.end(), '\n', ' ');
         std::replace(strComment.begin(), strComment.end(), '\r', ' ');
-        fstr << "comment " << m_params.comment << "\n";
+        out.print("comment {}\n", strComment);
     }
 
-    fstr << "element vertex " << m_vecNode.size() << "\n"
-         << "property float x\n"
-         << "property float y\n"
-         << "property float z\n";
-
+    out.print("element vertex {}\n", vertexCount);
+    out.write("property float x\n"
+              "property float y\n"
+              "property float z\n");
     if (m_params.writeColors)
     {
-        fstr << "property uchar red\n"
-             << "property uchar green\n"
-             << "property uchar blue\n";
+        out.write("property uchar red\n"
+                  "property uchar green\n"
+                  "property uchar blue\n");
     }
 
-    fstr << "element face " << m_vecFace.size() << "\n"
-         << "property list uchar int vertex_indices\n"
-         << "end_header\n";
+    out.print("element face {}\n", counts.meshTriangleCount);
+    out.write("property list uchar int vertex_indices\n"
+              "end_header\n");
 
-    // Helpers for progress report
-    const int elementCount = int(m_vecNode.size() + m_vecFace.size());
-    int iElement = 0;
-    auto fnUpdateProgress = [&]
+    // Capture meshes and point clouds, so they can be encoded concurrently
+    const std::vector<MeshItem> vecMeshItem = this->meshItems();
+    struct PointCloudItem
     {
-        ++iElement;
-        if (iElement % 50 == 0)
+        OccHandle<Graphic3d_ArrayOfPoints> points;
+        PointCloudOctreePtr octree;
+        std::vector<int64_t> vecLeafFirstPointIndex; // Octree only: index of first leaf points
+        int64_t firstPointIndex = 0;
+    };
+    std::vector<PointCloudItem> vecPointCloudItem;
+    int64_t pointCount = 0;
+    this->visitPointClouds(
+        [&](const PointCloudDataPtr &pntCloud)
         {
-            progress->setValue(MathUtils::toPercent(iElement, 0, elementCount));
-            if (progress->isAbortRequested())
-                return false;
-        }
+            PointCloudItem item{pntCloud->points(), pntCloud->octree(), {}, pointCount};
+            if (item.octree)
+            {
+                // Points of octree leaf nodes make the whole point cloud
+                int64_t leafFirstPointIndex = 0;
+                for (int leafIndex : item.octree->leafNodes())
+                {
+                    item.vecLeafFirstPointIndex.push_back(leafFirstPointIndex);
+                    leafFirstPointIndex += item.octree->nodes()[leafIndex].pointCount;
+                }
+            }
 
-        return true;
-    };
+            vecPointCloudItem.push_back(std::move(item));
+            pointCount += pntCloud->pointCount();
+        });
 
-    // Write vertices
-    for (const Vertex &node : m_vecNode)
+    // Helper to append a single encoded vertex to some buffer
+    const bool writeColors = m_params.writeColors;
+    auto fnAppendVertex = [=](fmt::memory_buffer *buffer, const Vertex &vertex, const Color &color)
     {
-        const auto inode = &node - &m_vecNode.front();
         if (isBinary)
         {
-            fstr.write(reinterpret_cast<const char *>(&node.x), 12);
-            if (m_params.writeColors)
-                fstr.write(reinterpret_cast<const char *>(&m_vecNodeColor.at(inode).red), 3);
+            const auto vertexBytes = reinterpret_cast<const char *>(&vertex.x);
+            buffer->append(vertexBytes, vertexBytes + 12);
+            if (writeColors)
+            {
+                const auto colorBytes = reinterpret_cast<const char *>(&color.red);
+                buffer->append(colorBytes, colorBytes + 3);
+            }
         }
         else
         {
-            fstr << node.x << " " << node.y << " " << node.z;
-            if (m_params.writeColors)
+            auto itOut = std::back_inserter(*buffer);
+            fmt::format_to(itOut, "{} {} {}", vertex.x, vertex.y, vertex.z);
+            if (writeColors)
             {
-                const Color &c = m_vecNodeColor.at(inode);
-                fstr << " " << int(c.red) << " " << int(c.green) << " " << int(c.blue);
+                fmt::format_to(itOut, " {} {} {}", int(color.red), int(color.green),
+                               int(color.blue));
             }
 
-            fstr << "\n";
+            buffer->push_back('\n');
         }
+    };
+    const size_t binaryVertexSize = 12 + (writeColors ? 3 : 0);
 
-        if (!fnUpdateProgress())
-            return true;
+    // Helpers for progress report
+    const int64_t elementCount = vertexCount + counts.meshTriangleCount;
+    auto fnPercent = [=](int64_t iElement)
+    { return int(MathUtils::toPercent(iElement, 0, elementCount)); };
+
+    // Write vertices of meshes
+    const Quantity_Color &defaultColor = m_params.defaultColor.GetRGB();
+    const Color defaultVertexColor = writeColors ? PlyWriter::toColor(defaultColor) : Color{};
+    auto fnEncodeMeshVertices = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
+    {
+        if (isBinary)
+            buffer->reserve(size_t(end - begin) * binaryVertexSize);
+
+        for (int64_t i = begin; i < end;)
+        {
+            const MeshItem &mesh = MeshStreamWriter::findMeshItemOfNode(vecMeshItem, i);
+            const int64_t meshEnd = mesh.firstNodeIndex + mesh.triangulation->NbNodes();
+            for (; i < std::min(end, meshEnd); ++i)
+            {
+                const int inode = int(i - mesh.firstNodeIndex);
+                const gp_Pnt pnt = mesh.triangulation->Node(inode + 1).Transformed(mesh.trsf);
+                Color color = defaultVertexColor;
+                if (writeColors)
+                {
+                    const std::optional<Quantity_Color> nodeColor = mesh.nodeColor(inode);
+                    if (nodeColor)
+                        color = PlyWriter::toColor(nodeColor.value());
+                }
+
+                fnAppendVertex(buffer, PlyWriter::toVertex(pnt), color);
+            }
+        }
+    };
+    const int64_t meshNodeCount = counts.meshNodeCount;
+    if (!MeshStreamWriter::writeChunks(&out, meshNodeCount, fnEncodeMeshVertices, progress, 0,
+                                       fnPercent(meshNodeCount)))
+    {
+        return false;
     }
 
-    fstr.flush();
-    // Write face indices
-    for (const Face &face : m_vecFace)
+    // Write vertices of point clouds
+    // A chunk doesn't straddle point clouds, and octree chunks are made of whole leaf nodes so
+    // each leaf is loaded once from cache file
+    std::vector<int64_t> vecPointChunkEnd;
+    for (size_t iItem = 0; iItem < vecPointCloudItem.size(); ++iItem)
     {
-        if (isBinary)
+        const PointCloudItem &item = vecPointCloudItem.at(iItem);
+        const int64_t itemEnd = iItem + 1 < vecPointCloudItem.size()
+                                    ? vecPointCloudItem.at(iItem + 1).firstPointIndex
+                                    : pointCount;
+        int64_t chunkBegin = item.firstPointIndex;
+        if (item.octree)
         {
-            const uint8_t indexCount = 3;
-            fstr.write(reinterpret_cast<const char *>(&indexCount), 1);
-            fstr.write(reinterpret_cast<const char *>(&face.v1), 12);
+            for (int64_t leafFirstPointIndex : item.vecLeafFirstPointIndex)
+            {
+                const int64_t leafBegin = item.firstPointIndex + leafFirstPointIndex;
+                if (leafBegin - chunkBegin >= ChunkElementCount)
+                {
+                    vecPointChunkEnd.push_back(leafBegin);
+                    chunkBegin = leafBegin;
+                }
+            }
         }
         else
         {
-            fstr << "3 " << face.v1 << " " << face.v2 << " " << face.v3 << "\n";
+            for (; itemEnd - chunkBegin > ChunkElementCount; chunkBegin += ChunkElementCount)
+                vecPointChunkEnd.push_back(chunkBegin + ChunkElementCount);
         }
 
-        if (!fnUpdateProgress())
-            return true;
+        if (chunkBegin < itemEnd)
+            vecPointChunkEnd.push_back(itemEnd);
     }
 
-    fstr.flush();
-    return true;
-}
+    std::atomic<bool> okLoadLeaves = true;
+    auto fnEncodePointCloudVertices = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
+    {
+        if (isBinary)
+            buffer->reserve(size_t(end - begin) * binaryVertexSize);
+
+        auto fnLess = [](int64_t index, const PointCloudItem &item)
+        { return index < item.firstPointIndex; };
+        const PointCloudItem &item = *std::prev(
+            std::upper_bound(vecPointCloudItem.cbegin(), vecPointCloudItem.cend(), begin, fnLess));
+        const PointCloudOctreePtr &octree = item.octree;
+        if (octree)
+        {
+            // Octree leaf nodes are loaded from cache file by the encoding tasks
+            const std::vector<int64_t> &vecLeafFirst = item.vecLeafFirstPointIndex;
+            const int64_t ibegin = begin - item.firstPointIndex;
+            const int64_t iend = end - item.firstPointIndex;
+            auto leafPos = size_t(
+                std::lower_bound(vecLeafFirst.cbegin(), vecLeafFirst.cend(), ibegin)
+                - vecLeafFirst.cbegin());
+            std::vector<PointCloudOctree::Point> vecLeafPoint;
+            for (; leafPos < vecLeafFirst.size() && vecLeafFirst.at(leafPos) < iend; ++leafPos)
+            {
+                const int leafIndex = octree->leafNodes()[leafPos];
+                if (!octree->loadNodePoints(leafIndex, &vecLeafPoint))
+                {
+                    // Keep vertex count consistent, error is reported after encoding
+                    okLoadLeaves = false;
+                    vecLeafPoint.assign(octree->nodes()[leafIndex].pointCount, {});
+                }
+
+                for (const PointCloudOctree::Point &point : vecLeafPoint)
+                {
+                    const Vertex vertex{point.coords[0], point.coords[1], point.coords[2]};
+                    Color color = defaultVertexColor;
+                    if (writeColors && octree->hasColors())
+                        color = {point.color[0], point.color[1], point.color[2]};
+
+                    fnAppendVertex(buffer, vertex, color);
+                }
+            }
 
-std::unique_ptr<PropertyGroup> PlyWriter::createProperties(PropertyGroup *parentGroup)
-{
-    return std::make_unique<Properties>(parentGroup);
-}
+            return;
+        }
 
-void PlyWriter::applyProperties(const PropertyGroup *params)
-{
-    auto ptr = dynamic_cast<const Properties *>(params);
-    if (ptr)
-    {
-        m_params.format = ptr->targetFormat;
-        m_params.writeColors = ptr->writeColors;
-        m_params.defaultColor = Quantity_ColorRGBA(ptr->defaultColor);
-        m_params.comment = ptr->comment;
-    }
-}
+        const OccHandle<Graphic3d_ArrayOfPoints> &points = item.points;
+        const bool hasColors = points->HasVertexColors();
+        for (int64_t i = begin; i < end; ++i)
+        {
+            const int ipnt = int(i - item.firstPointIndex) + 1;
+            Color color = defaultVertexColor;
+            if (writeColors && hasColors)
+                color = PlyWriter::toColor(points->VertexColor(ipnt));
 
-void PlyWriter::addMesh(const IMeshAccess &mesh)
-{
-    const OccHandle<Poly_Triangulation> &triangulation = mesh.triangulation();
-    for (int i = 1; i <= triangulation->NbTriangles(); ++i)
+            fnAppendVertex(buffer, PlyWriter::toVertex(points->Vertice(ipnt)), color);
+        }
+    };
+    if (!MeshStreamWriter::writeChunks(&out, vecPointChunkEnd, fnEncodePointCloudVertices,
+                                       progress, fnPercent(meshNodeCount),
+                                       fnPercent(vertexCount)))
     {
-        const Poly_Triangle &triangle = triangulation->Triangle(i);
-        const int32_t offset = CppUtils::safeStaticCast<int32_t>(m_vecNode.size());
-        const Face face{offset + triangle(1) - 1, offset + triangle(2) - 1,
-                        offset + triangle(3) - 1};
-        m_vecFace.push_back(std::move(face));
+        return false;
     }
 
-    for (int i = 1; i <= triangulation->NbNodes(); ++i)
+    if (!okLoadLeaves)
     {
-        const Vertex vertex =
-            PlyWriter::toVertex(triangulation->Node(i).Transformed(mesh.location()));
-        m_vecNode.push_back(std::move(vertex));
+        this->messenger()->emitError(PlyWriterI18N::textIdTr("Failed to read point cloud data"));
+        return false;
     }
 
-    if (m_params.writeColors)
+    // Write face indices
+    auto fnEncodeFaces = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
     {
-        for (int i = 0; i < triangulation->NbNodes(); ++i)
+        if (isBinary)
+            buffer->reserve(size_t(end - begin) * (1 + sizeof(Face)));
+
+        for (int64_t i = begin; i < end;)
         {
-            const std::optional<Quantity_Color> nodeColor = mesh.nodeColor(i);
-            const Quantity_Color &defaultNodeColor = m_params.defaultColor.GetRGB();
-            m_vecNodeColor.push_back(
-                PlyWriter::toColor(nodeColor ? nodeColor.value() : defaultNodeColor));
+            const MeshItem &mesh = MeshStreamWriter::findMeshItemOfTriangle(vecMeshItem, i);
+            const int64_t meshEnd = mesh.firstTriangleIndex + mesh.triangulation->NbTriangles();
+            const auto offset = CppUtils::safeStaticCast<int32_t>(mesh.firstNodeIndex);
+            for (; i < std::min(end, meshEnd); ++i)
+            {
+                const int itri = int(i - mesh.firstTriangleIndex);
+                const Poly_Triangle &triangle = mesh.triangulation->Triangle(itri + 1);
+                const Face face{offset + triangle(1) - 1, offset + triangle(2) - 1,
+                                offset + triangle(3) - 1};
+                if (isBinary)
+                {
+                    const auto faceBytes = reinterpret_cast<const char *>(&face.v1);
+                    buffer->push_back(char(3)); // Index count
+                    buffer->append(faceBytes, faceBytes + 12);
+                }
+                else
+                {
+                    fmt::format_to(std::back_inserter(*buffer), "3 {} {} {}\n", face.v1, face.v2,
+                                   face.v3);
+                }
+            }
         }
+    };
+    if (!MeshStreamWriter::writeChunks(&out, counts.meshTriangleCount, fnEncodeFaces, progress,
+                                       fnPercent(vertexCount), 100))
+    {
+        return false;
     }
-}
 
-void PlyWriter::addPointCloud(const PointCloudDataPtr &pntCloud)
-{
-    const OccHandle<Graphic3d_ArrayOfPoints> &points = pntCloud->points();
-    const int pntCount = points->VertexNumber();
-    for (int i = 1; i <= pntCount; ++i)
+    if (!out.flush())
     {
-        const Vertex vertex = PlyWriter::toVertex(points->Vertice(i));
-        m_vecNode.push_back(std::move(vertex));
+        this->messenger()->emitError(PlyWriterI18N::textIdTr("Failed to write file"));
+        return false;
     }
 
-    if (m_params.writeColors)
+    return true;
+}
+
+std::unique_ptr<PropertyGroup> PlyWriter::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void PlyWriter::applyProperties(const PropertyGroup *params)
+{
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
     {
-        const bool hasColors = points->HasVertexColors();
-        for (int i = 1; i <= pntCount; ++i)
-        {
-            const Quantity_Color pntColor =
-                hasColors ? points->VertexColor(i) : m_params.defaultColor.GetRGB();
-            m_vecNodeColor.push_back(PlyWriter::toColor(pntColor));
-        }
+        m_params.format = ptr->targetFormat;
+        m_params.writeColors = ptr->writeColors;
+        m_params.defaultColor = Quantity_ColorRGBA(ptr->defaultColor);
+        m_params.comment = ptr->comment;
     }
 }
 
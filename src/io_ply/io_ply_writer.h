@@ -6,28 +6,18 @@
 
 #pragma once
 
-#include <vector>
-
 #include <Quantity_ColorRGBA.hxx>
 
-#include "base/document_ptr.h"
+#include "base/io_mesh_stream_writer.h"
 #include "base/io_single_format_factory.h"
-#include "base/io_writer.h"
-#include "base/point_cloud_data.h"
-
-namespace Mayo
-{
-class IMeshAccess;
-}
 
 namespace Mayo::IO
 {
 
 // Writer for PLY file format
-class PlyWriter : public Writer
+class PlyWriter : public MeshStreamWriter
 {
 public:
-    bool transfer(Span<const ApplicationItem> appItems, TaskProgress *progress) override;
     bool writeFile(const FilePath &filepath, TaskProgress *progress) override;
 
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
@@ -81,14 +71,8 @@ private:
     static Vertex toVertex(const gp_Pnt &pnt);
     static Color toColor(const Quantity_Color &c);
 
-    void addMesh(const IMeshAccess &mesh);
-    void addPointCloud(const PointCloudDataPtr &pntCloud);
-
     class Properties;
     Parameters m_params;
-    std::vector<Vertex> m_vecNode;
-    std::vector<Color> m_vecNodeColor;
-    std::vector<Face> m_vecFace;
 };
 
 // Provides factory to create PlyWriter objects
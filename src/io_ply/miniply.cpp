@@ -20,6 +20,7 @@ SOFTWARE.
 
 #include "miniply.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cmath>
@@ -679,6 +680,45 @@ PLYReader::PLYReader(const char *filename)
         m_valid = false;
         return;
     }
+
+    parse_header();
+}
+
+PLYReader::PLYReader(const char *data, size_t size)
+{
+    m_buf = new char[kPLYReadBufferSize + 1];
+    m_buf[kPLYReadBufferSize] = '\0';
+
+    m_tmpBuf = new char[kPLYTempBufferSize + 1];
+    m_tmpBuf[kPLYTempBufferSize] = '\0';
+
+    m_bufEnd = m_buf + kPLYReadBufferSize;
+    m_pos = m_bufEnd;
+    m_end = m_bufEnd;
+
+    if (data == nullptr)
+    {
+        m_valid = false;
+        return;
+    }
+
+    m_memData = data;
+    m_memSize = size;
+    parse_header();
+}
+
+PLYReader::~PLYReader()
+{
+    if (m_f != nullptr)
+    {
+        fclose(m_f);
+    }
+    delete[] m_buf;
+    delete[] m_tmpBuf;
+}
+
+bool PLYReader::parse_header()
+{
     m_valid = true;
 
     refill_buffer();
@@ -690,7 +730,7 @@ PLYReader::PLYReader(const char *filename)
               keyword("end_header") && advance() && match("\n") && accept();
     if (!m_valid)
     {
-        return;
+        return false;
     }
     m_inDataSection = true;
     if (m_fileType == PLYFileType::ASCII)
@@ -702,16 +742,7 @@ PLYReader::PLYReader(const char *filename)
     {
         elem.calculate_offsets();
     }
-}
-
-PLYReader::~PLYReader()
-{
-    if (m_f != nullptr)
-    {
-        fclose(m_f);
-    }
-    delete[] m_buf;
-    delete[] m_tmpBuf;
+    return true;
 }
 
 bool PLYReader::valid() const
@@ -773,6 +804,7 @@ void PLYReader::next_element()
         // Clear temporary storage for the non-list properties in the current
         // element.
         m_elementData.clear();
+        m_mappedElementData = nullptr;
         m_elementLoaded = false;
         return;
     }
@@ -796,7 +828,7 @@ void PLYReader::next_element()
         if (elementEnd >= kPLYReadBufferSize)
         {
             m_bufOffset += elementEnd;
-            file_seek(m_f, m_bufOffset, SEEK_SET);
+            seek_input(m_bufOffset);
             m_bufEnd = m_buf + kPLYReadBufferSize;
             m_pos = m_bufEnd;
             m_end = m_bufEnd;
@@ -993,6 +1025,13 @@ bool PLYReader::find_properties(uint32_t propIdxs[], uint32_t numIdxs, ...) cons
 
 bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
                                    PLYPropertyType destType, void *dest) const
+{
+    return extract_properties(propIdxs, numProps, destType, dest, 0, num_rows());
+}
+
+bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
+                                   PLYPropertyType destType, void *dest, uint32_t firstRow,
+                                   uint32_t numRows) const
 {
     if (numProps == 0)
     {
@@ -1000,6 +1039,10 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
     }
 
     const PLYElement *elem = element();
+    if (firstRow > elem->count || numRows > elem->count - firstRow)
+    {
+        return false;
+    }
 
     // Make sure all property indexes are valid and that none of the properties
     // are lists (this function only extracts non-list data).
@@ -1011,6 +1054,10 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
         }
     }
 
+    // Data of the rows to be extracted.
+    const uint8_t *rowsBegin = element_data() + static_cast<size_t>(firstRow) * elem->rowStride;
+    const uint8_t *rowsEnd = rowsBegin + static_cast<size_t>(numRows) * elem->rowStride;
+
     // Find out whether we have contiguous columns. If so, we may be able to
     // use a more efficient data extraction technique.
     bool contiguousCols = true;
@@ -1058,14 +1105,14 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
             // Most efficient case is when the rows are contiguous. It means we're
             // simply copying the entire data block for this element, which we can
             // do with a single memcpy.
-            std::memcpy(to, m_elementData.data(), m_elementData.size());
+            std::memcpy(to, rowsBegin, static_cast<size_t>(rowsEnd - rowsBegin));
         }
         else if (contiguousCols)
         {
             // If the rows aren't contiguous, but the columns we're extracting
             // within each row are, then we can do a single memcpy per row.
-            const uint8_t *from = m_elementData.data() + elem->properties[propIdxs[0]].offset;
-            const uint8_t *end = m_elementData.data() + m_elementData.size();
+            const uint8_t *from = rowsBegin + elem->properties[propIdxs[0]].offset;
+            const uint8_t *end = rowsEnd;
             const size_t numBytes = expectedOffset - elem->properties[propIdxs[0]].offset;
             while (from < end)
             {
@@ -1077,8 +1124,8 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
         else
         {
             // If the columns aren't contiguous, we must memcpy each one separately.
-            const uint8_t *row = m_elementData.data();
-            const uint8_t *end = m_elementData.data() + m_elementData.size();
+            const uint8_t *row = rowsBegin;
+            const uint8_t *end = rowsEnd;
             uint8_t *to = reinterpret_cast<uint8_t *>(dest);
             size_t colBytes =
                 kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
@@ -1100,8 +1147,8 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
         // We will have to do data type conversions on the column values here. We
         // cannot simply use memcpy in this case, every column has to be
         // processed separately.
-        const uint8_t *row = m_elementData.data();
-        const uint8_t *end = m_elementData.data() + m_elementData.size();
+        const uint8_t *row = rowsBegin;
+        const uint8_t *end = rowsEnd;
         uint8_t *to = reinterpret_cast<uint8_t *>(dest);
         size_t colBytes =
             kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
@@ -1124,6 +1171,15 @@ bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps,
 bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32_t numProps,
                                                PLYPropertyType destType, void *dest,
                                                uint32_t destStride) const
+{
+    return extract_properties_with_stride(propIdxs, numProps, destType, dest, destStride, 0,
+                                          num_rows());
+}
+
+bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32_t numProps,
+                                               PLYPropertyType destType, void *dest,
+                                               uint32_t destStride, uint32_t firstRow,
+                                               uint32_t numRows) const
 {
     if (numProps == 0)
     {
@@ -1136,7 +1192,7 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
     const uint32_t minDestStride = numProps * kPLYPropertySize[uint32_t(destType)];
     if (destStride == 0 || destStride == minDestStride)
     {
-        return extract_properties(propIdxs, numProps, destType, dest);
+        return extract_properties(propIdxs, numProps, destType, dest, firstRow, numRows);
     }
     else if (destStride < minDestStride)
     {
@@ -1144,6 +1200,10 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
     }
 
     const PLYElement *elem = element();
+    if (firstRow > elem->count || numRows > elem->count - firstRow)
+    {
+        return false;
+    }
 
     // Make sure all property indexes are valid and that none of the properties
     // are lists (this function only extracts non-list data).
@@ -1155,6 +1215,10 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
         }
     }
 
+    // Data of the rows to be extracted.
+    const uint8_t *rowsBegin = element_data() + static_cast<size_t>(firstRow) * elem->rowStride;
+    const uint8_t *rowsEnd = rowsBegin + static_cast<size_t>(numRows) * elem->rowStride;
+
     // Find out whether we have contiguous columns. If so, we may be able to
     // use a more efficient data extraction technique.
     bool contiguousCols = true;
@@ -1196,8 +1260,8 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
         {
             // If the rows aren't contiguous, but the columns we're extracting
             // within each row are, then we can do a single memcpy per row.
-            const uint8_t *from = m_elementData.data() + elem->properties[propIdxs[0]].offset;
-            const uint8_t *end = m_elementData.data() + m_elementData.size();
+            const uint8_t *from = rowsBegin + elem->properties[propIdxs[0]].offset;
+            const uint8_t *end = rowsEnd;
             const size_t numBytes = expectedOffset - elem->properties[propIdxs[0]].offset;
             while (from < end)
             {
@@ -1209,8 +1273,8 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
         else
         {
             // If the columns aren't contiguous, we must memcpy each one separately.
-            const uint8_t *row = m_elementData.data();
-            const uint8_t *end = m_elementData.data() + m_elementData.size();
+            const uint8_t *row = rowsBegin;
+            const uint8_t *end = rowsEnd;
             uint8_t *to = reinterpret_cast<uint8_t *>(dest);
             const size_t colBytes =
                 kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
@@ -1234,8 +1298,8 @@ bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32
         // We will have to do data type conversions on the column values here. We
         // cannot simply use memcpy in this case, every column has to be
         // processed separately.
-        const uint8_t *row = m_elementData.data();
-        const uint8_t *end = m_elementData.data() + m_elementData.size();
+        const uint8_t *row = rowsBegin;
+        const uint8_t *end = rowsEnd;
         uint8_t *to = reinterpret_cast<uint8_t *>(dest);
         size_t colBytes =
             kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
@@ -1504,9 +1568,82 @@ bool PLYReader::find_indices(uint32_t propIdxs[1]) const
 // PLYReader private methods
 //
 
+size_t PLYReader::read_input(char *dest, size_t numBytes)
+{
+    if (m_f != nullptr)
+    {
+        return fread(dest, sizeof(char), numBytes, m_f);
+    }
+
+    size_t numBytesRead = std::min(numBytes, m_memSize - m_memPos);
+    std::memcpy(dest, m_memData + m_memPos, numBytesRead);
+    m_memPos += numBytesRead;
+    return numBytesRead;
+}
+
+void PLYReader::seek_input(int64_t offset)
+{
+    if (m_f != nullptr)
+    {
+        file_seek(m_f, offset, SEEK_SET);
+    }
+    else
+    {
+        m_memPos = std::min(static_cast<size_t>(offset), m_memSize);
+    }
+}
+
+bool PLYReader::has_input() const
+{
+    return m_f != nullptr || m_memData != nullptr;
+}
+
+bool PLYReader::map_fixed_size_element(PLYElement &elem)
+{
+    // Only data of binary little-endian files can be used as is, other data
+    // has to be parsed or converted.
+    if (m_memData == nullptr || m_fileType != PLYFileType::Binary)
+    {
+        return false;
+    }
+
+    int64_t elementStart = static_cast<int64_t>(m_pos - m_buf);
+    int64_t elementSize = static_cast<int64_t>(elem.rowStride) * elem.count;
+    int64_t elementEnd = elementStart + elementSize;
+    if (m_bufOffset + elementEnd > static_cast<int64_t>(m_memSize))
+    {
+        // Truncated data, let the regular loading report the error.
+        return false;
+    }
+
+    m_mappedElementData = reinterpret_cast<const uint8_t *>(m_memData + m_bufOffset + elementStart);
+
+    // Move the read buffer past the element data.
+    if (elementEnd > static_cast<int64_t>(m_bufEnd - m_buf))
+    {
+        m_bufOffset += elementEnd;
+        seek_input(m_bufOffset);
+        m_bufEnd = m_buf + kPLYReadBufferSize;
+        m_pos = m_bufEnd;
+        m_end = m_bufEnd;
+        refill_buffer();
+    }
+    else
+    {
+        m_pos = m_buf + elementEnd;
+        m_end = m_pos;
+    }
+    return true;
+}
+
+const uint8_t *PLYReader::element_data() const
+{
+    return m_mappedElementData != nullptr ? m_mappedElementData : m_elementData.data();
+}
+
 bool PLYReader::refill_buffer()
 {
-    if (m_f == nullptr || m_atEOF)
+    if (!has_input() || m_atEOF)
     {
         // Nothing left to read.
         return false;
@@ -1537,7 +1674,7 @@ bool PLYReader::refill_buffer()
     m_pos = m_buf;
 
     // Fill the remaining space in the buffer with data from the file.
-    size_t fetched = fread(m_buf + keep, sizeof(char), kPLYReadBufferSize - keep, m_f) + keep;
+    size_t fetched = read_input(m_buf + keep, kPLYReadBufferSize - keep) + keep;
     m_atEOF = fetched < kPLYReadBufferSize;
     m_bufEnd = m_buf + fetched;
 
@@ -1792,6 +1929,12 @@ bool PLYReader::parse_property(std::vector<PLYProperty> &properties)
 
 bool PLYReader::load_fixed_size_element(PLYElement &elem)
 {
+    if (map_fixed_size_element(elem))
+    {
+        m_elementLoaded = true;
+        return true;
+    }
+
     size_t numBytes = static_cast<size_t>(elem.count) * elem.rowStride;
 
     m_elementData.resize(numBytes);
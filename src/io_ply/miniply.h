@@ -152,6 +152,11 @@ class PLYReader
 {
 public:
     PLYReader(const char *filename);
+    /// Reads PLY contents from memory, e.g. a memory-mapped file. `data` must
+    /// stay valid for the lifetime of the reader. The data of binary
+    /// little-endian elements with only fixed-size properties is then used in
+    /// place rather than being copied.
+    PLYReader(const char *data, size_t size);
     ~PLYReader();
 
     bool valid() const;
@@ -203,6 +208,15 @@ public:
     bool extract_properties(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType,
                             void *dest) const;
 
+    /// The same as `extract_properties`, but only for rows `firstRow` to
+    /// `firstRow + numRows - 1` of the current element. Row `firstRow` is
+    /// written at the start of `dest`.
+    ///
+    /// This allows extracting a big element by chunks, e.g. to report
+    /// progress or to stop extraction early.
+    bool extract_properties(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType,
+                            void *dest, uint32_t firstRow, uint32_t numRows) const;
+
     /// The same as `extract_properties`, but does not require rows in the
     /// destination to be contiguous: `destStride` is the number of bytes
     /// between the start of one row and the start of the next row in the
@@ -220,6 +234,13 @@ public:
                                         PLYPropertyType destType, void *dest,
                                         uint32_t destStride) const;
 
+    /// The same as `extract_properties_with_stride`, but only for rows
+    /// `firstRow` to `firstRow + numRows - 1` of the current element.
+    bool extract_properties_with_stride(const uint32_t propIdxs[], uint32_t numProps,
+                                        PLYPropertyType destType, void *dest,
+                                        uint32_t destStride, uint32_t firstRow,
+                                        uint32_t numRows) const;
+
     /// Get the array of item counts for a list property. Entry `i` in this
     /// array is the number of items in the `i`th list.
     const uint32_t *get_list_counts(uint32_t propIdx) const;
@@ -245,6 +266,13 @@ public:
     bool find_indices(uint32_t propIdxs[1]) const;
 
 private:
+    bool parse_header();
+    size_t read_input(char *dest, size_t numBytes);
+    void seek_input(int64_t offset);
+    bool has_input() const;
+    bool map_fixed_size_element(PLYElement &elem);
+    const uint8_t *element_data() const;
+
     bool refill_buffer();
     bool rewind_to_safe_char();
     bool accept();
@@ -284,6 +312,9 @@ private:
 
 private:
     FILE *m_f = nullptr;
+    const char *m_memData = nullptr; //!< Input data when reading from memory
+    size_t m_memSize = 0;
+    size_t m_memPos = 0;
     char *m_buf = nullptr;
     const char *m_bufEnd = nullptr;
     const char *m_pos = nullptr;
@@ -303,6 +334,7 @@ private:
     size_t m_currentElement = 0;
     bool m_elementLoaded = false;
     std::vector<uint8_t> m_elementData;
+    const uint8_t *m_mappedElementData = nullptr; //!< Element data used in place, if any
 
     char *m_tmpBuf = nullptr;
 };
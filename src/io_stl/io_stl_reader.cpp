@@ -0,0 +1,817 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_stl_reader.h"
+
+#include <TDataStd_Name.hxx>
+#include <fast_float/fast_float.h>
+
+#include "base/brep_utils.h"
+#include "base/caf_utils.h"
+#include "base/document.h"
+#include "base/filepath_conv.h"
+#include "base/io_file_view.h"
+#include "base/math_utils.h"
+#include "base/mesh_utils.h"
+#include "base/messenger.h"
+#include "base/property_builtins.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
+#include "base/task_progress.h"
+#include "base/text_parse_utils.h"
+#include "base/triangulation_annex_data.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo::IO
+{
+
+struct StlReaderI18N
+{
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::StlReaderI18N)
+};
+
+namespace
+{
+
+constexpr size_t BinaryHeaderSize = 84; // 80 bytes header + 32bits count of facets
+constexpr size_t BinaryFacetSize = 50;  // Normal and 3 vertices(12 floats) + 16bits attribute
+constexpr uint32_t NullIndex = UINT32_MAX;
+static_assert(sizeof(float) == 4, "STL coordinates are 32bits floating point values");
+
+enum class StlFormat
+{
+    Unknown,
+    Ascii,
+    Binary
+};
+
+// Facets read from file, in file order
+// Coordinates are single precision values, as in binary STL
+struct StlFacets
+{
+    std::vector<float> vecVertexCoord; // 3 vertices per facet, 3 coordinates per vertex
+    std::vector<float> vecNormalCoord; // 3 coordinates per facet, empty if normals are ignored
+
+    size_t facetCount() const
+    {
+        return vecVertexCoord.size() / 9;
+    }
+};
+
+uint32_t readUInt32LE(const char *bytes)
+{
+    auto b = reinterpret_cast<const uint8_t *>(bytes);
+    return uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+}
+
+using namespace TextParseUtils;
+
+// Keywords of ASCII STL are case insensitive
+constexpr CaseSensitivity KeywordCase = CaseSensitivity::Insensitive;
+
+// Parses the 3 floating point numbers starting 'str'
+bool parseCoords(std::string_view str, float *coords)
+{
+    const char *pos = str.data();
+    const char *end = str.data() + str.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        while (pos < end && isSpace(*pos))
+            ++pos;
+
+        if (pos < end && *pos == '+')
+            ++pos;
+
+        const auto result = fast_float::from_chars(pos, end, coords[i]);
+        if (result.ec != std::errc())
+            return false;
+
+        pos = result.ptr;
+    }
+
+    return true;
+}
+
+StlFormat findStlFormat(std::string_view contents)
+{
+    std::string_view strStart = trimmedLeft(contents.substr(0, 512));
+    const bool startsWithSolid = consumeKeyword(&strStart, "solid", KeywordCase);
+    if (contents.size() >= BinaryHeaderSize)
+    {
+        const uint32_t facetCount = readUInt32LE(contents.data() + BinaryHeaderSize - 4);
+        const uint64_t binarySize = BinaryHeaderSize + BinaryFacetSize * uint64_t(facetCount);
+        // Some binary files start with "solid" though, but then the size is exactly the expected
+        // one. Some others have trailing bytes after the facets
+        if (binarySize == contents.size())
+            return StlFormat::Binary;
+
+        if (!startsWithSolid && binarySize < contents.size())
+            return StlFormat::Binary;
+    }
+
+    return startsWithSolid ? StlFormat::Ascii : StlFormat::Unknown;
+}
+
+// Facet records are copied in parallel straight from the file contents
+// Binary STL is little-endian, just like all the supported platforms
+bool readBinary(TaskManager &taskMgr, std::string_view contents, bool withNormals,
+                StlFacets *facets, TaskProgress *progress, int pctStart, int pctEnd)
+{
+    const size_t facetCount = readUInt32LE(contents.data() + BinaryHeaderSize - 4);
+    facets->vecVertexCoord.resize(9 * facetCount);
+    facets->vecNormalCoord.resize(withNormals ? 3 * facetCount : 0);
+    float *vertexCoords = facets->vecVertexCoord.data();
+    float *normalCoords = withNormals ? facets->vecNormalCoord.data() : nullptr;
+    const char *facetRecords = contents.data() + BinaryHeaderSize;
+    auto fnCopyFacets = [=](size_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const char *record = facetRecords + i * BinaryFacetSize;
+            if (normalCoords)
+                std::memcpy(normalCoords + 3 * i, record, 3 * sizeof(float));
+
+            std::memcpy(vertexCoords + 9 * i, record + 3 * sizeof(float), 9 * sizeof(float));
+        }
+    };
+    const auto range = ChunkedRange::fromGrainSize(taskMgr, facetCount, 64 * 1024);
+    return parallelForChunks(taskMgr, range, fnCopyFacets, progress, pctStart, pctEnd);
+}
+
+// Chunk of ASCII contents aligned on line boundaries, parsed by a single task
+struct AsciiChunk
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    size_t vertexCount = 0;
+    size_t facetCount = 0;
+    size_t firstVertexIndex = 0;
+    size_t firstFacetIndex = 0;
+    bool hasError = false;
+};
+
+// Contents are split into chunks, a first pass counts the "vertex" and "facet" lines of each
+// chunk so the second pass knows where to store the coordinates parsed
+// Returns false if abort was requested, error is reported in 'ptrError'
+bool readAscii(TaskManager &taskMgr, std::string_view contents, bool withNormals,
+               StlFacets *facets, std::string_view *ptrError, TaskProgress *progress, int pctStart,
+               int pctEnd)
+{
+    std::vector<AsciiChunk> vecChunk;
+    for (std::string_view chunkContents : splitIntoLineChunks(taskMgr, contents, 4 * 1024 * 1024))
+    {
+        AsciiChunk chunk;
+        chunk.begin = chunkContents.data();
+        chunk.end = chunkContents.data() + chunkContents.size();
+        vecChunk.push_back(chunk);
+    }
+
+    if (vecChunk.empty())
+        return true; // Empty contents, ChunkedRange would still provide one chunk
+
+    const ChunkedRange chunkRange(vecChunk.size(), vecChunk.size());
+    const int pctCountEnd = pctStart + (pctEnd - pctStart) / 5;
+
+    // First pass: count vertices and facets
+    auto fnCountLines = [&](size_t ichunk, size_t, size_t)
+    {
+        AsciiChunk &chunk = vecChunk.at(ichunk);
+        forEachLine(chunk.begin, chunk.end,
+                    [&](std::string_view line)
+                    {
+                        if (consumeKeyword(&line, "vertex", KeywordCase))
+                            ++chunk.vertexCount;
+                        else if (consumeKeyword(&line, "facet", KeywordCase))
+                            ++chunk.facetCount;
+
+                        return true;
+                    });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnCountLines, progress, pctStart, pctCountEnd))
+        return false;
+
+    size_t vertexCount = 0;
+    size_t facetCount = 0;
+    for (AsciiChunk &chunk : vecChunk)
+    {
+        chunk.firstVertexIndex = vertexCount;
+        chunk.firstFacetIndex = facetCount;
+        vertexCount += chunk.vertexCount;
+        facetCount += chunk.facetCount;
+    }
+
+    if (vertexCount % 3 != 0)
+    {
+        *ptrError = StlReaderI18N::textIdTr("Count of vertices isn't a multiple of 3");
+        return true;
+    }
+
+    // Normals are ignored if they can't be associated to facets
+    withNormals = withNormals && facetCount * 3 == vertexCount;
+    facets->vecVertexCoord.resize(3 * vertexCount);
+    facets->vecNormalCoord.resize(withNormals ? 3 * facetCount : 0);
+
+    // Second pass: parse coordinates
+    auto fnParseLines = [&](size_t ichunk, size_t, size_t)
+    {
+        AsciiChunk &chunk = vecChunk.at(ichunk);
+        float *vertexCoords = facets->vecVertexCoord.data() + 3 * chunk.firstVertexIndex;
+        float *normalCoords =
+            withNormals ? facets->vecNormalCoord.data() + 3 * chunk.firstFacetIndex : nullptr;
+        forEachLine(chunk.begin, chunk.end,
+                    [&](std::string_view line)
+                    {
+                        if (consumeKeyword(&line, "vertex", KeywordCase))
+                        {
+                            chunk.hasError = !parseCoords(line, vertexCoords);
+                            vertexCoords += 3;
+                        }
+                        else if (normalCoords && consumeKeyword(&line, "facet", KeywordCase))
+                        {
+                            line = trimmedLeft(line);
+                            consumeKeyword(&line, "normal", KeywordCase);
+                            if (!parseCoords(line, normalCoords))
+                                std::fill(normalCoords, normalCoords + 3, 0.f);
+
+                            normalCoords += 3;
+                        }
+
+                        return !chunk.hasError;
+                    });
+    };
+    if (!parallelForChunks(taskMgr, chunkRange, fnParseLines, progress, pctCountEnd, pctEnd))
+        return false;
+
+    auto fnHasError = [](const AsciiChunk &chunk) { return chunk.hasError; };
+    if (std::any_of(vecChunk.cbegin(), vecChunk.cend(), fnHasError))
+        *ptrError = StlReaderI18N::textIdTr("Invalid vertex coordinates");
+
+    return true;
+}
+
+// Key of a cell in the grid used for spatial hashing of vertices
+struct CellKey
+{
+    int64_t coords[3];
+
+    bool operator==(const CellKey &other) const
+    {
+        return std::equal(coords, coords + 3, other.coords);
+    }
+};
+
+uint64_t hashCellKey(const CellKey &key)
+{
+    uint64_t h = uint64_t(key.coords[0]) * 0x9E3779B97F4A7C15ull;
+    h ^= uint64_t(key.coords[1]) * 0xC2B2AE3D27D4EB4Full;
+    h ^= uint64_t(key.coords[2]) * 0x165667B19E3779F9ull;
+    return h ^ (h >> 31);
+}
+
+struct CellKeyHash
+{
+    size_t operator()(const CellKey &key) const
+    {
+        return size_t(hashCellKey(key));
+    }
+};
+
+// Vertex welding is split over shards of grid cells, each shard being processed by a single task
+// Shard of a cell is given by the high bits of its hash, hash tables use the low bits
+constexpr unsigned ShardCount = 64;
+
+unsigned shardOfCell(const CellKey &key)
+{
+    return unsigned(hashCellKey(key) >> 58);
+}
+
+struct WeldShard
+{
+    std::unordered_map<CellKey, uint32_t, CellKeyHash> mapCellFirstNode;
+    std::vector<uint32_t> vecNodeVertex; // Vertex providing the coordinates of each node
+    std::vector<uint32_t> vecNodeNext;   // Next node in the same cell, NullIndex if none
+    uint32_t firstNodeId = 0;            // Global index of the first node of the shard
+};
+
+// Result of vertex welding
+struct WeldResult
+{
+    std::vector<float> vecNodeCoord;     // 3 coordinates per node
+    std::vector<uint32_t> vecVertexNode; // Node index(0-based) of each vertex
+};
+
+// Merges vertices closer than 'tolerance' into mesh nodes, nodes being numbered in the order of
+// their first vertex in 'vecVertexCoord'
+// Vertices are spatially hashed on a grid whose cell size is 'tolerance'. If 'tolerance' is 0
+// then cells are the exact coordinates, so only identical vertices are merged
+// With a non-zero tolerance merging is transitive: a chain of vertices closer than tolerance
+// gives a single node
+bool weldVertices(TaskManager &taskMgr, const std::vector<float> &vecVertexCoord,
+                  double tolerance, WeldResult *result, TaskProgress *progress, int pctStart,
+                  int pctEnd)
+{
+    const size_t vertexCount = vecVertexCoord.size() / 3;
+    const float *vertexCoords = vecVertexCoord.data();
+    auto fnPct = [=](int pct) { return pctStart + ((pctEnd - pctStart) * pct) / 100; };
+
+    auto fnCellKey = [=](const float *coords)
+    {
+        constexpr double MaxCellCoord = double(INT64_C(1) << 62);
+        CellKey key;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (tolerance > 0)
+            {
+                const double cell = std::floor(coords[i] / tolerance);
+                const double clampedCell =
+                    cell >= -MaxCellCoord && cell <= MaxCellCoord
+                        ? cell
+                        : (cell > 0 ? MaxCellCoord : -MaxCellCoord); // Out of range or NaN
+                key.coords[i] = int64_t(clampedCell);
+            }
+            else
+            {
+                const float coord = coords[i] != 0.f ? coords[i] : 0.f; // Merge -0 and +0
+                uint32_t bits = 0;
+                std::memcpy(&bits, &coord, sizeof(float));
+                key.coords[i] = bits;
+            }
+        }
+
+        return key;
+    };
+
+    // Vertices in the same cell are identical if tolerance is 0
+    const double sqTolerance = tolerance * tolerance;
+    auto fnIsClose = [=](const float *coords1, const float *coords2)
+    {
+        if (tolerance <= 0)
+            return true;
+
+        double sqDistance = 0.;
+        for (int i = 0; i < 3; ++i)
+        {
+            const double delta = double(coords1[i]) - double(coords2[i]);
+            sqDistance += delta * delta;
+        }
+
+        return sqDistance <= sqTolerance;
+    };
+
+    // Sort vertices by shard(parallel counting sort)
+    const auto vertexRange = ChunkedRange::fromGrainSize(taskMgr, vertexCount, 64 * 1024);
+    std::vector<uint8_t> vecVertexShard(vertexCount);
+    std::vector<size_t> vecChunkShardOffset(vertexRange.chunkCount() * ShardCount, 0);
+    auto fnCountShardVertices = [&](size_t ichunk, size_t begin, size_t end)
+    {
+        size_t *shardCounts = vecChunkShardOffset.data() + ichunk * ShardCount;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const unsigned ishard = shardOfCell(fnCellKey(vertexCoords + 3 * i));
+            vecVertexShard[i] = uint8_t(ishard);
+            ++shardCounts[ishard];
+        }
+    };
+    if (!parallelForChunks(taskMgr, vertexRange, fnCountShardVertices, progress, fnPct(0),
+                           fnPct(20)))
+    {
+        return false;
+    }
+
+    std::vector<size_t> vecShardOffset(ShardCount + 1, 0);
+    {
+        size_t offset = 0;
+        for (unsigned ishard = 0; ishard < ShardCount; ++ishard)
+        {
+            vecShardOffset.at(ishard) = offset;
+            for (size_t ichunk = 0; ichunk < vertexRange.chunkCount(); ++ichunk)
+            {
+                size_t &chunkShardOffset = vecChunkShardOffset.at(ichunk * ShardCount + ishard);
+                const size_t count = chunkShardOffset;
+                chunkShardOffset = offset;
+                offset += count;
+            }
+        }
+
+        vecShardOffset.back() = offset;
+    }
+
+    std::vector<uint32_t> vecSortedVertex(vertexCount);
+    auto fnSortVertices = [&](size_t ichunk, size_t begin, size_t end)
+    {
+        size_t *shardOffsets = vecChunkShardOffset.data() + ichunk * ShardCount;
+        for (size_t i = begin; i < end; ++i)
+            vecSortedVertex[shardOffsets[vecVertexShard[i]]++] = uint32_t(i);
+    };
+    if (!parallelForChunks(taskMgr, vertexRange, fnSortVertices, progress, fnPct(20), fnPct(35)))
+        return false;
+
+    vecChunkShardOffset = {};
+
+    // Merge vertices of each shard, vertex node index is local to the shard
+    std::vector<WeldShard> vecShard(ShardCount);
+    std::vector<uint32_t> &vecVertexNode = result->vecVertexNode;
+    vecVertexNode.resize(vertexCount);
+    auto fnWeldShards = [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t ishard = begin; ishard < end; ++ishard)
+        {
+            WeldShard &shard = vecShard.at(ishard);
+            const uint32_t *itVertexBegin = vecSortedVertex.data() + vecShardOffset.at(ishard);
+            const uint32_t *itVertexEnd = vecSortedVertex.data() + vecShardOffset.at(ishard + 1);
+            shard.mapCellFirstNode.reserve((itVertexEnd - itVertexBegin) / 4);
+            for (auto it = itVertexBegin; it != itVertexEnd; ++it)
+            {
+                const uint32_t ivertex = *it;
+                const float *coords = vertexCoords + 3 * size_t(ivertex);
+                auto [itCell, isNewCell] = shard.mapCellFirstNode.try_emplace(fnCellKey(coords),
+                                                                              NullIndex);
+                uint32_t inode = itCell->second;
+                while (inode != NullIndex)
+                {
+                    const uint32_t inodeVertex = shard.vecNodeVertex[inode];
+                    if (fnIsClose(coords, vertexCoords + 3 * size_t(inodeVertex)))
+                        break;
+
+                    inode = shard.vecNodeNext[inode];
+                }
+
+                if (inode == NullIndex)
+                {
+                    inode = uint32_t(shard.vecNodeVertex.size());
+                    shard.vecNodeVertex.push_back(ivertex);
+                    shard.vecNodeNext.push_back(itCell->second);
+                    itCell->second = inode;
+                }
+
+                vecVertexNode[ivertex] = inode;
+            }
+        }
+    };
+    const ChunkedRange shardRange(ShardCount, ShardCount);
+    if (!parallelForChunks(taskMgr, shardRange, fnWeldShards, progress, fnPct(35), fnPct(75)))
+        return false;
+
+    vecSortedVertex = {};
+
+    // Global node indices
+    size_t nodeCount = 0;
+    for (WeldShard &shard : vecShard)
+    {
+        shard.firstNodeId = uint32_t(nodeCount);
+        nodeCount += shard.vecNodeVertex.size();
+    }
+
+    // With a non-zero tolerance, nodes of neighbour cells can be close: each node is attached to
+    // the close node of lowest index among the 27 cells around it
+    std::vector<uint32_t> vecNodeParent;
+    if (tolerance > 0)
+    {
+        vecNodeParent.resize(nodeCount);
+        auto fnFindParents = [&](size_t, size_t begin, size_t end)
+        {
+            for (size_t ishard = begin; ishard < end; ++ishard)
+            {
+                const WeldShard &shard = vecShard.at(ishard);
+                for (size_t inode = 0; inode < shard.vecNodeVertex.size(); ++inode)
+                {
+                    const float *coords = vertexCoords + 3 * size_t(shard.vecNodeVertex[inode]);
+                    const CellKey key = fnCellKey(coords);
+                    uint32_t parentId = shard.firstNodeId + uint32_t(inode);
+                    for (int i = 0; i < 27; ++i)
+                    {
+                        const CellKey nearKey = {{key.coords[0] + (i % 3) - 1,
+                                                  key.coords[1] + ((i / 3) % 3) - 1,
+                                                  key.coords[2] + (i / 9) - 1}};
+                        const WeldShard &nearShard = vecShard.at(shardOfCell(nearKey));
+                        auto itCell = nearShard.mapCellFirstNode.find(nearKey);
+                        if (itCell == nearShard.mapCellFirstNode.cend())
+                            continue;
+
+                        for (uint32_t inearNode = itCell->second; inearNode != NullIndex;
+                             inearNode = nearShard.vecNodeNext[inearNode])
+                        {
+                            const uint32_t nearNodeId = nearShard.firstNodeId + inearNode;
+                            const uint32_t inearVertex = nearShard.vecNodeVertex[inearNode];
+                            if (nearNodeId < parentId
+                                && fnIsClose(coords, vertexCoords + 3 * size_t(inearVertex)))
+                            {
+                                parentId = nearNodeId;
+                            }
+                        }
+                    }
+
+                    vecNodeParent[shard.firstNodeId + inode] = parentId;
+                }
+            }
+        };
+        if (!parallelForChunks(taskMgr, shardRange, fnFindParents, progress, fnPct(75),
+                               fnPct(85)))
+        {
+            return false;
+        }
+
+        // Parent of a node has a lower index, so it's already resolved to its root
+        for (uint32_t &parentId : vecNodeParent)
+            parentId = vecNodeParent[parentId];
+    }
+
+    // Vertex node indices made global
+    auto fnGlobalNodes = [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t nodeId = vecShard[vecVertexShard[i]].firstNodeId + vecVertexNode[i];
+            vecVertexNode[i] = !vecNodeParent.empty() ? vecNodeParent[nodeId] : nodeId;
+        }
+    };
+    if (!parallelForChunks(taskMgr, vertexRange, fnGlobalNodes, progress, fnPct(85), fnPct(90)))
+        return false;
+
+    vecShard = {};
+    vecVertexShard = {};
+    vecNodeParent = {};
+
+    // Final numbering of nodes, in order of first use
+    std::vector<uint32_t> vecNodeFinalId(nodeCount, NullIndex);
+    std::vector<float> &vecNodeCoord = result->vecNodeCoord;
+    vecNodeCoord.clear();
+    vecNodeCoord.reserve(3 * nodeCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        uint32_t &finalId = vecNodeFinalId[vecVertexNode[i]];
+        if (finalId == NullIndex)
+        {
+            finalId = uint32_t(vecNodeCoord.size() / 3);
+            vecNodeCoord.insert(vecNodeCoord.end(), vertexCoords + 3 * i, vertexCoords + 3 * i + 3);
+        }
+
+        vecVertexNode[i] = finalId;
+    }
+
+    progress->setValue(pctEnd);
+    return !TaskProgress::isAbortRequested(progress);
+}
+
+} // namespace
+
+class StlReader::Properties : public PropertyGroup
+{
+public:
+    Properties(PropertyGroup *parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->weldTolerance.setDescription(
+            StlReaderI18N::textIdTr("Facet vertices closer than this distance are merged into a "
+                                    "single mesh node.\n"
+                                    "0 means only vertices with identical coordinates are merged"));
+        this->weldTolerance.setConstraintsEnabled(true);
+        this->weldTolerance.setRange(0., DBL_MAX);
+        this->keepFacetNormals.setDescription(
+            StlReaderI18N::textIdTr("Compute mesh node normals from the facet normals stored in "
+                                    "the file"));
+    }
+
+    void restoreDefaults() override
+    {
+        const StlReader::Parameters defaultParams;
+        this->weldTolerance.setValue(defaultParams.weldTolerance);
+        this->keepFacetNormals.setValue(defaultParams.keepFacetNormals);
+    }
+
+    PropertyDouble weldTolerance{this, StlReaderI18N::textId("weldTolerance")};
+    PropertyBool keepFacetNormals{this, StlReaderI18N::textId("keepFacetNormals")};
+};
+
+bool StlReader::readFile(const FilePath &filepath, TaskProgress *progress)
+{
+    return this->readFile(FileView(filepath), progress);
+}
+
+bool StlReader::readFile(const FileView &fileView, TaskProgress *progress)
+{
+    progress = progress ? progress : &TaskProgress::null();
+    auto fnError = [=](std::string_view strMessage)
+    {
+        this->messenger()->emitError(strMessage);
+        return false;
+    };
+
+    // Reset internal data
+    m_baseFilename = fileView.filepath().stem();
+    m_mesh.Nullify();
+
+    if (!fileView.isOpen())
+        return fnError(StlReaderI18N::textIdTr("Can't open input file"));
+
+    // Read facets
+    TaskManager taskMgr;
+    StlFacets facets;
+    const StlFormat format = findStlFormat(fileView.contents());
+    if (format == StlFormat::Binary)
+    {
+        if (!readBinary(taskMgr, fileView.contents(), m_params.keepFacetNormals, &facets, progress,
+                        0, 40))
+        {
+            return false;
+        }
+    }
+    else if (format == StlFormat::Ascii)
+    {
+        std::string_view error;
+        if (!readAscii(taskMgr, fileView.contents(), m_params.keepFacetNormals, &facets, &error,
+                       progress, 0, 40))
+        {
+            return false;
+        }
+
+        if (!error.empty())
+            return fnError(error);
+    }
+    else
+    {
+        return fnError(StlReaderI18N::textIdTr("Unknown STL format"));
+    }
+
+    const size_t facetCount = facets.facetCount();
+    if (facetCount == 0)
+        return fnError(StlReaderI18N::textIdTr("No facet found"));
+
+    if (3 * facetCount > size_t(INT_MAX))
+        return fnError(StlReaderI18N::textIdTr("Too many facets"));
+
+    // Weld facet vertices
+    WeldResult weld;
+    if (!weldVertices(taskMgr, facets.vecVertexCoord, m_params.weldTolerance, &weld, progress, 40,
+                      90))
+    {
+        return false;
+    }
+
+    // Facets collapsed by welding are skipped
+    const uint32_t *vertexNodes = weld.vecVertexNode.data();
+    auto fnIsDegenerate = [=](size_t ifacet)
+    {
+        const uint32_t *nodes = vertexNodes + 3 * ifacet;
+        return nodes[0] == nodes[1] || nodes[1] == nodes[2] || nodes[0] == nodes[2];
+    };
+
+    const auto facetRange = ChunkedRange::fromGrainSize(taskMgr, facetCount, 64 * 1024);
+    std::vector<size_t> vecChunkFirstTriangle(facetRange.chunkCount() + 1, 0);
+    auto fnCountTriangles = [&](size_t ichunk, size_t begin, size_t end)
+    {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i)
+            count += fnIsDegenerate(i) ? 0 : 1;
+
+        vecChunkFirstTriangle.at(ichunk + 1) = count;
+    };
+    if (!parallelForChunks(taskMgr, facetRange, fnCountTriangles, progress, 90, 92))
+        return false;
+
+    for (size_t ichunk = 1; ichunk < vecChunkFirstTriangle.size(); ++ichunk)
+        vecChunkFirstTriangle.at(ichunk) += vecChunkFirstTriangle.at(ichunk - 1);
+
+    // Build mesh, data is written in place
+    const auto nodeCount = int(weld.vecNodeCoord.size() / 3);
+    const auto triangleCount = int(vecChunkFirstTriangle.back());
+    m_mesh = makeOccHandle<Poly_Triangulation>(nodeCount, triangleCount, false /*!hasUvNodes*/);
+    double *nodeCoords = MeshUtils::nodeCoordsData(m_mesh);
+    int *triangleIndices = MeshUtils::triangleIndicesData(m_mesh);
+    const float *weldNodeCoords = weld.vecNodeCoord.data();
+    auto fnSetNodes = [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const float *coords = weldNodeCoords + 3 * i;
+            if (nodeCoords)
+                std::copy(coords, coords + 3, nodeCoords + 3 * i);
+            else
+                MeshUtils::setNode(m_mesh, int(i) + 1, gp_Pnt(coords[0], coords[1], coords[2]));
+        }
+    };
+    const auto nodeRange = ChunkedRange::fromGrainSize(taskMgr, nodeCount, 64 * 1024);
+    if (!parallelForChunks(taskMgr, nodeRange, fnSetNodes, progress, 92, 95))
+        return false;
+
+    auto fnSetTriangles = [&](size_t ichunk, size_t begin, size_t end)
+    {
+        size_t itriangle = vecChunkFirstTriangle.at(ichunk);
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (fnIsDegenerate(i))
+                continue;
+
+            const uint32_t *nodes = vertexNodes + 3 * i;
+            if (triangleIndices)
+            {
+                for (int j = 0; j < 3; ++j)
+                    triangleIndices[3 * itriangle + j] = int(nodes[j]) + 1;
+            }
+            else
+            {
+                const Poly_Triangle triangle(nodes[0] + 1, nodes[1] + 1, nodes[2] + 1);
+                MeshUtils::setTriangle(m_mesh, int(itriangle) + 1, triangle);
+            }
+
+            ++itriangle;
+        }
+    };
+    if (!parallelForChunks(taskMgr, facetRange, fnSetTriangles, progress, 95, 98))
+        return false;
+
+    // Node normals are the average of the normals of the facets sharing the node
+    // Poly_Triangulation has no facet normals
+    if (!facets.vecNormalCoord.empty())
+    {
+        std::vector<float> vecNodeNormal(3 * size_t(nodeCount), 0.f);
+        for (size_t i = 0; i < facetCount; ++i)
+        {
+            if (fnIsDegenerate(i))
+                continue;
+
+            const float *fileNormal = facets.vecNormalCoord.data() + 3 * i;
+            gp_Vec3f normal(fileNormal[0], fileNormal[1], fileNormal[2]);
+            if (normal.SquareModulus() == 0.f)
+            {
+                // Null normal in file, use the geometric one instead
+                const float *v = facets.vecVertexCoord.data() + 9 * i;
+                const gp_Vec3f v1(v[3] - v[0], v[4] - v[1], v[5] - v[2]);
+                const gp_Vec3f v2(v[6] - v[0], v[7] - v[1], v[8] - v[2]);
+                normal = gp_Vec3f::Cross(v1, v2);
+            }
+
+            const float length = normal.Modulus();
+            if (length > 0.f)
+            {
+                normal /= length;
+                for (int j = 0; j < 3; ++j)
+                {
+                    float *nodeNormal = vecNodeNormal.data() + 3 * size_t(vertexNodes[3 * i + j]);
+                    for (int k = 0; k < 3; ++k)
+                        nodeNormal[k] += normal.GetData()[k];
+                }
+            }
+        }
+
+        MeshUtils::allocateNormals(m_mesh);
+        float *normalCoords = MeshUtils::normalCoordsData(m_mesh);
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            const float *n = vecNodeNormal.data() + 3 * size_t(i);
+            gp_Vec3f normal(n[0], n[1], n[2]);
+            const float length = normal.Modulus();
+            if (length > 0.f)
+                normal /= length;
+
+            if (normalCoords)
+                std::copy(normal.GetData(), normal.GetData() + 3, normalCoords + 3 * size_t(i));
+            else
+                MeshUtils::setNormal(m_mesh, i + 1, normal);
+        }
+    }
+
+    progress->setValue(100);
+    return true;
+}
+
+TDF_LabelSequence StlReader::transfer(DocumentPtr doc, TaskProgress * /*progress*/)
+{
+    if (m_mesh.IsNull())
+        return {};
+
+    const TDF_Label entityLabel = doc->newEntityShapeLabel();
+    doc->xcaf().setShape(entityLabel, BRepUtils::makeFace(m_mesh));
+    TriangulationAnnexData::Set(entityLabel); // IMPORTANT: pure mesh part marker!
+    TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+    return CafUtils::makeLabelSequence({entityLabel});
+}
+
+std::unique_ptr<PropertyGroup> StlReader::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void StlReader::applyProperties(const PropertyGroup *params)
+{
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
+    {
+        m_params.weldTolerance = ptr->weldTolerance;
+        m_params.keepFacetNormals = ptr->keepFacetNormals;
+    }
+}
+
+} // namespace Mayo::IO
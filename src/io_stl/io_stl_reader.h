@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Poly_Triangulation.hxx>
+
+#include "base/io_reader.h"
+#include "base/io_single_format_factory.h"
+#include "base/occ_handle.h"
+
+namespace Mayo::IO
+{
+
+// Reader for STL file format(binary and ASCII)
+// Facets are read in parallel, then their vertices are welded into a single indexed mesh
+class StlReader : public Reader
+{
+public:
+    bool readFile(const FilePath &filepath, TaskProgress *progress) override;
+    bool readFile(const FileView &fileView, TaskProgress *progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress *progress) override;
+    bool isConcurrentTransferSupported() const override
+    {
+        return true;
+    }
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
+    void applyProperties(const PropertyGroup *params) override;
+
+    // Parameters
+    struct Parameters
+    {
+        // Vertices closer than this distance are merged into a single mesh node
+        // 0 means only vertices having identical coordinates are merged
+        double weldTolerance = 0.;
+        // Mesh node normals are computed from the facet normals found in file
+        bool keepFacetNormals = false;
+    };
+    Parameters &parameters()
+    {
+        return m_params;
+    }
+    const Parameters &constParameters() const
+    {
+        return m_params;
+    }
+
+private:
+    class Properties;
+    Parameters m_params;
+    FilePath m_baseFilename;
+    OccHandle<Poly_Triangulation> m_mesh;
+};
+
+// Provides factory to create StlReader objects
+class StlFactoryReader : public SingleFormatFactoryReader<Format_STL, StlReader>
+{
+};
+
+} // namespace Mayo::IO
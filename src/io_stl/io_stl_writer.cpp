@@ -0,0 +1,473 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_stl_writer.h"
+
+#include <BRep_Tool.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Face.hxx>
+#include <fmt/format.h>
+
+#include "base/brep_utils.h"
+#include "base/document.h"
+#include "base/global.h"
+#include "base/io_output_file_buffer.h"
+#include "base/messenger.h"
+#include "base/property_enumeration.h"
+#include "base/task_manager.h"
+#include "base/task_parallel.h"
+#include "base/task_progress.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string_view>
+
+#if defined(MAYO_OS_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define MAYO_STL_WRITER_HAS_POSITIONAL_IO
+#elif defined(MAYO_OS_UNIX) && !defined(MAYO_OS_WASM)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define MAYO_STL_WRITER_HAS_POSITIONAL_IO
+#endif
+
+namespace Mayo::IO
+{
+
+struct StlWriterI18N
+{
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::StlWriterI18N)
+};
+
+namespace
+{
+
+constexpr size_t BinaryHeaderSize = 84; // 80 bytes header + 32bits count of facets
+constexpr size_t BinaryFacetSize = 50;  // Normal and 3 vertices(12 floats) + 16bits attribute
+
+// Count of facets encoded by a single task
+constexpr int64_t ChunkFacetCount = 32 * 1024;
+
+// Output file of fixed size, data can be written concurrently at any position
+class PreallocatedFile
+{
+public:
+    PreallocatedFile(const FilePath &filepath, uint64_t size)
+    {
+#if defined(MAYO_OS_WINDOWS)
+        m_hFile = CreateFileW(filepath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize = {};
+        fileSize.QuadPart = LONGLONG(size);
+        if (m_hFile != INVALID_HANDLE_VALUE
+            && (!SetFilePointerEx(m_hFile, fileSize, nullptr, FILE_BEGIN)
+                || !SetEndOfFile(m_hFile)))
+        {
+            CloseHandle(m_hFile);
+            m_hFile = INVALID_HANDLE_VALUE;
+        }
+#elif defined(MAYO_STL_WRITER_HAS_POSITIONAL_IO)
+        m_fd = ::open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_fd >= 0 && ::ftruncate(m_fd, off_t(size)) != 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+#else
+        m_fstr.open(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+        (void)size; // File grows as chunks are written
+#endif
+    }
+
+    ~PreallocatedFile()
+    {
+        this->close();
+    }
+
+    // Not copyable
+    PreallocatedFile(const PreallocatedFile &) = delete;
+    PreallocatedFile &operator=(const PreallocatedFile &) = delete;
+
+    bool isOpen() const
+    {
+#if defined(MAYO_OS_WINDOWS)
+        return m_hFile != INVALID_HANDLE_VALUE;
+#elif defined(MAYO_STL_WRITER_HAS_POSITIONAL_IO)
+        return m_fd >= 0;
+#else
+        return m_fstr.is_open();
+#endif
+    }
+
+    // Thread-safe
+    bool writeAt(uint64_t offset, const char *data, size_t size)
+    {
+#if defined(MAYO_OS_WINDOWS)
+        while (size > 0)
+        {
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = DWORD(offset & 0xFFFFFFFF);
+            overlapped.OffsetHigh = DWORD(offset >> 32);
+            const auto bytesToWrite = DWORD(std::min<size_t>(size, 1 << 30));
+            DWORD bytesWritten = 0;
+            if (!WriteFile(m_hFile, data, bytesToWrite, &bytesWritten, &overlapped)
+                || bytesWritten == 0)
+            {
+                return false;
+            }
+
+            offset += bytesWritten;
+            data += bytesWritten;
+            size -= bytesWritten;
+        }
+
+        return true;
+#elif defined(MAYO_STL_WRITER_HAS_POSITIONAL_IO)
+        while (size > 0)
+        {
+            const ssize_t bytesWritten = ::pwrite(m_fd, data, size, off_t(offset));
+            if (bytesWritten < 0 && errno == EINTR)
+                continue;
+
+            if (bytesWritten <= 0)
+                return false;
+
+            offset += uint64_t(bytesWritten);
+            data += bytesWritten;
+            size -= size_t(bytesWritten);
+        }
+
+        return true;
+#else
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fstr.seekp(std::streamoff(offset));
+        m_fstr.write(data, std::streamsize(size));
+        return m_fstr.good();
+#endif
+    }
+
+    // Returns false on error
+    bool close()
+    {
+        bool ok = true;
+#if defined(MAYO_OS_WINDOWS)
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            ok = CloseHandle(m_hFile) != FALSE;
+
+        m_hFile = INVALID_HANDLE_VALUE;
+#elif defined(MAYO_STL_WRITER_HAS_POSITIONAL_IO)
+        if (m_fd >= 0)
+            ok = ::close(m_fd) == 0;
+
+        m_fd = -1;
+#else
+        if (m_fstr.is_open())
+        {
+            m_fstr.close();
+            ok = !m_fstr.fail();
+        }
+#endif
+        return ok;
+    }
+
+private:
+#if defined(MAYO_OS_WINDOWS)
+    HANDLE m_hFile = INVALID_HANDLE_VALUE;
+#elif defined(MAYO_STL_WRITER_HAS_POSITIONAL_IO)
+    int m_fd = -1;
+#else
+    std::mutex m_mutex;
+    std::fstream m_fstr;
+#endif
+};
+
+// Facet of STL file: normal then 3 vertices, single precision values
+struct Facet
+{
+    float coords[12];
+};
+
+// Writes 'value' as 4 little-endian bytes, whatever the host endianness
+char *writeFloatLE(char *out, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(float));
+    out[0] = char(bits & 0xFF);
+    out[1] = char((bits >> 8) & 0xFF);
+    out[2] = char((bits >> 16) & 0xFF);
+    out[3] = char((bits >> 24) & 0xFF);
+    return out + 4;
+}
+
+void writeUInt32LE(char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out[i] = char((value >> (8 * i)) & 0xFF);
+}
+
+// Calls 'fn(facet)' for each facet of range [begin, end) in the triangles of all faces
+template <typename FaceMesh, typename Function>
+void forEachFacet(const std::vector<FaceMesh> &vecFaceMesh, int64_t begin, int64_t end,
+                  Function fn)
+{
+    auto fnLess = [](int64_t index, const FaceMesh &item)
+    { return index < item.firstTriangleIndex; };
+    auto itFaceMesh = std::upper_bound(vecFaceMesh.cbegin(), vecFaceMesh.cend(), begin, fnLess);
+    for (int64_t i = begin; i < end; ++itFaceMesh)
+    {
+        const FaceMesh &faceMesh = *std::prev(itFaceMesh);
+        const Poly_Triangulation &mesh = *faceMesh.triangulation;
+        const int64_t faceEnd = faceMesh.firstTriangleIndex + mesh.NbTriangles();
+        for (; i < std::min(end, faceEnd); ++i)
+        {
+            int n1, n2, n3;
+            mesh.Triangle(int(i - faceMesh.firstTriangleIndex) + 1).Get(n1, n2, n3);
+            if (faceMesh.isReversed)
+                std::swap(n2, n3);
+
+            const gp_Pnt pnt1 = mesh.Node(n1).Transformed(faceMesh.trsf);
+            const gp_Pnt pnt2 = mesh.Node(n2).Transformed(faceMesh.trsf);
+            const gp_Pnt pnt3 = mesh.Node(n3).Transformed(faceMesh.trsf);
+            gp_Vec normal = gp_Vec(pnt1, pnt2).Crossed(gp_Vec(pnt1, pnt3));
+            const double normalLength = normal.Magnitude();
+            normal = normalLength > 0. ? normal / normalLength : gp_Vec(0, 0, 0);
+
+            Facet facet;
+            float *coords = facet.coords;
+            for (const gp_XYZ &xyz : {normal.XYZ(), pnt1.XYZ(), pnt2.XYZ(), pnt3.XYZ()})
+            {
+                *coords++ = float(xyz.X());
+                *coords++ = float(xyz.Y());
+                *coords++ = float(xyz.Z());
+            }
+
+            fn(facet);
+        }
+    }
+}
+
+} // namespace
+
+class StlWriter::Properties : public PropertyGroup
+{
+public:
+    Properties(PropertyGroup *parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->targetFormat.mutableEnumeration().changeTrContext(StlWriterI18N::textIdContext());
+    }
+
+    void restoreDefaults() override
+    {
+        const StlWriter::Parameters defaultParams;
+        this->targetFormat.setValue(defaultParams.format);
+    }
+
+    PropertyEnum<StlWriter::Format> targetFormat{this, StlWriterI18N::textId("targetFormat")};
+};
+
+std::vector<StlWriter::FaceMesh> StlWriter::faceMeshes(int *ptrUnmeshedFaceCount) const
+{
+    std::vector<FaceMesh> vecFaceMesh;
+    int64_t triangleCount = 0;
+    int unmeshedFaceCount = 0;
+    for (const DocumentTreeNode &treeNode : this->treeNodes())
+    {
+        if (!treeNode.isValid() || !XCaf::isShape(treeNode.label()))
+            continue;
+
+        const DocumentPtr &doc = treeNode.document();
+        const TopLoc_Location locShape =
+            XCaf::shapeAbsoluteLocation(doc->modelTree(), treeNode.id());
+        BRepUtils::forEachSubFace(XCaf::shape(treeNode.label()),
+                                  [&](const TopoDS_Face &face)
+                                  {
+                                      TopLoc_Location locFace;
+                                      FaceMesh faceMesh;
+                                      faceMesh.triangulation =
+                                          BRep_Tool::Triangulation(face, locFace);
+                                      if (faceMesh.triangulation.IsNull())
+                                      {
+                                          ++unmeshedFaceCount;
+                                          return;
+                                      }
+
+                                      faceMesh.trsf = (locShape * locFace).Transformation();
+                                      faceMesh.isReversed = face.Orientation() == TopAbs_REVERSED;
+                                      faceMesh.firstTriangleIndex = triangleCount;
+                                      triangleCount += faceMesh.triangulation->NbTriangles();
+                                      vecFaceMesh.push_back(std::move(faceMesh));
+                                  });
+    }
+
+    if (ptrUnmeshedFaceCount)
+        *ptrUnmeshedFaceCount = unmeshedFaceCount;
+
+    return vecFaceMesh;
+}
+
+bool StlWriter::writeFile(const FilePath &filepath, TaskProgress *progress)
+{
+    progress = progress ? progress : &TaskProgress::null();
+
+    // Face triangulations are collected and checked in a single pass
+    int unmeshedFaceCount = 0;
+    const std::vector<FaceMesh> vecFaceMesh = this->faceMeshes(&unmeshedFaceCount);
+    if (unmeshedFaceCount > 0)
+        this->messenger()->emitWarning(StlWriterI18N::textIdTr("Not all BRep faces are meshed"));
+
+    int64_t triangleCount = 0;
+    if (!vecFaceMesh.empty())
+    {
+        const FaceMesh &lastFaceMesh = vecFaceMesh.back();
+        triangleCount = lastFaceMesh.firstTriangleIndex + lastFaceMesh.triangulation->NbTriangles();
+    }
+
+    progress->setValue(5);
+    if (m_params.format == Format::Binary)
+        return this->writeBinary(filepath, vecFaceMesh, triangleCount, progress);
+    else
+        return this->writeAscii(filepath, vecFaceMesh, triangleCount, progress);
+}
+
+std::unique_ptr<PropertyGroup> StlWriter::createProperties(PropertyGroup *parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void StlWriter::applyProperties(const PropertyGroup *params)
+{
+    auto ptr = dynamic_cast<const Properties *>(params);
+    if (ptr)
+        m_params.format = ptr->targetFormat;
+}
+
+bool StlWriter::writeBinary(const FilePath &filepath, const std::vector<FaceMesh> &vecFaceMesh,
+                            int64_t triangleCount, TaskProgress *progress)
+{
+    if (triangleCount > int64_t(UINT32_MAX))
+    {
+        this->messenger()->emitError(StlWriterI18N::textIdTr("Too many triangles"));
+        return false;
+    }
+
+    const uint64_t fileSize = BinaryHeaderSize + BinaryFacetSize * uint64_t(triangleCount);
+    PreallocatedFile file(filepath, fileSize);
+    // Preallocated file is left incomplete on abort or error, so it's removed
+    auto fnRemoveFile = [&]
+    {
+        file.close();
+        std::error_code ec;
+        std_filesystem::remove(filepath, ec);
+    };
+    if (!file.isOpen())
+    {
+        fnRemoveFile();
+        this->messenger()->emitError(StlWriterI18N::textIdTr("Failed to open file"));
+        return false;
+    }
+
+    // Header, must not start with "solid" to not be confused with ASCII STL
+    char header[BinaryHeaderSize] = {};
+    const std::string_view strHeader = "Binary STL exported by Mayo";
+    std::memcpy(header, strHeader.data(), strHeader.size());
+    writeUInt32LE(header + BinaryHeaderSize - 4, uint32_t(triangleCount));
+    std::atomic<bool> okWrite = file.writeAt(0, header, BinaryHeaderSize);
+
+    // Each chunk of facets is encoded and written at its final position by a single task
+    // Chunks have a bounded count of facets, so is the memory used by the encoding buffers
+    TaskManager taskMgr;
+    const auto chunkCount = size_t((triangleCount + ChunkFacetCount - 1) / ChunkFacetCount);
+    const ChunkedRange range(size_t(triangleCount), chunkCount);
+    auto fnEncodeFacets = [&](size_t, size_t begin, size_t end)
+    {
+        if (!okWrite)
+            return;
+
+        std::vector<char> buffer((end - begin) * BinaryFacetSize);
+        char *out = buffer.data();
+        forEachFacet(vecFaceMesh, int64_t(begin), int64_t(end),
+                     [&](const Facet &facet)
+                     {
+                         for (float coord : facet.coords)
+                             out = writeFloatLE(out, coord);
+
+                         *out++ = 0; // Attribute byte count
+                         *out++ = 0;
+                     });
+        const uint64_t offset = BinaryHeaderSize + BinaryFacetSize * uint64_t(begin);
+        if (!file.writeAt(offset, buffer.data(), buffer.size()))
+            okWrite = false;
+    };
+    if (!parallelForChunks(taskMgr, range, fnEncodeFacets, progress, 5, 100))
+    {
+        fnRemoveFile();
+        return false;
+    }
+
+    if (!file.close() || !okWrite)
+    {
+        fnRemoveFile();
+        this->messenger()->emitError(StlWriterI18N::textIdTr("Failed to write file"));
+        return false;
+    }
+
+    return true;
+}
+
+bool StlWriter::writeAscii(const FilePath &filepath, const std::vector<FaceMesh> &vecFaceMesh,
+                           int64_t triangleCount, TaskProgress *progress)
+{
+    OutputFileBuffer out(filepath, OutputBufferSize);
+    if (!out.isOpen())
+    {
+        this->messenger()->emitError(StlWriterI18N::textIdTr("Failed to open file"));
+        return false;
+    }
+
+    out.write("solid\n");
+    auto fnEncodeFacets = [&](int64_t begin, int64_t end, fmt::memory_buffer *buffer)
+    {
+        auto itOut = std::back_inserter(*buffer);
+        forEachFacet(vecFaceMesh, begin, end,
+                     [&](const Facet &facet)
+                     {
+                         const float *c = facet.coords;
+                         fmt::format_to(itOut,
+                                        "facet normal {} {} {}\n"
+                                        " outer loop\n"
+                                        "  vertex {} {} {}\n"
+                                        "  vertex {} {} {}\n"
+                                        "  vertex {} {} {}\n"
+                                        " endloop\n"
+                                        "endfacet\n",
+                                        c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8],
+                                        c[9], c[10], c[11]);
+                     });
+    };
+    if (!MeshStreamWriter::writeChunks(&out, triangleCount, fnEncodeFacets, progress, 5, 100))
+        return false;
+
+    out.write("endsolid\n");
+    if (!out.flush())
+    {
+        this->messenger()->emitError(StlWriterI18N::textIdTr("Failed to write file"));
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Mayo::IO
@@ -0,0 +1,82 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Poly_Triangulation.hxx>
+#include <gp_Trsf.hxx>
+
+#include "base/io_mesh_stream_writer.h"
+#include "base/io_single_format_factory.h"
+#include "base/occ_handle.h"
+
+namespace Mayo::IO
+{
+
+// Writer for STL file format
+// Facets are encoded in parallel straight from the triangulations of the faces. Binary file size
+// being known upfront, the file is preallocated and each encoded chunk is written at its final
+// position
+class StlWriter : public MeshStreamWriter
+{
+public:
+    bool writeFile(const FilePath &filepath, TaskProgress *progress) override;
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup *parentGroup);
+    void applyProperties(const PropertyGroup *params) override;
+
+    // Parameters
+    enum class Format
+    {
+        Ascii,
+        Binary
+    };
+
+    struct Parameters
+    {
+        Format format = Format::Binary;
+    };
+    Parameters &parameters()
+    {
+        return m_params;
+    }
+    const Parameters &constParameters() const
+    {
+        return m_params;
+    }
+
+private:
+    // Triangulation of a face placed in model space
+    struct FaceMesh
+    {
+        OccHandle<Poly_Triangulation> triangulation;
+        gp_Trsf trsf;
+        bool isReversed = false;
+        int64_t firstTriangleIndex = 0; // Index of first triangle in the triangles of all faces
+    };
+
+    // Faces found in treeNodes(), 'ptrUnmeshedFaceCount' receives the count of faces without
+    // triangulation
+    std::vector<FaceMesh> faceMeshes(int *ptrUnmeshedFaceCount) const;
+
+    bool writeBinary(const FilePath &filepath, const std::vector<FaceMesh> &vecFaceMesh,
+                     int64_t triangleCount, TaskProgress *progress);
+    bool writeAscii(const FilePath &filepath, const std::vector<FaceMesh> &vecFaceMesh,
+                    int64_t triangleCount, TaskProgress *progress);
+
+    class Properties;
+    Parameters m_params;
+};
+
+// Provides factory to create StlWriter objects
+class StlFactoryWriter : public SingleFormatFactoryWriter<Format_STL, StlWriter>
+{
+};
+
+} // namespace Mayo::IO
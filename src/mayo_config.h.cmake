@@ -10,6 +10,7 @@
 #cmakedefine MAYO_HAVE_ASSIMP
 #cmakedefine MAYO_HAVE_ASSIMP_aiGetVersionPatch
 #cmakedefine MAYO_HAVE_GMIO
+#cmakedefine MAYO_HAVE_ZLIB
 
 #ifdef HAVE_RAPIDJSON
 #  define OPENCASCADE_HAVE_RAPIDJSON
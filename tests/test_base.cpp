@@ -12,18 +12,28 @@
 #include "test_base.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <climits>
 #include <cmath>
 #include <common/mayo_config.h>
 #include <cstring>
+#include <fmt/format.h>
 #include <fstream>
 #include <gsl/util>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <random>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -39,7 +49,12 @@
 #include <Interface_ParamType.hxx>
 #include <Interface_Static.hxx>
 #include <NCollection_String.hxx>
+#include <Precision.hxx>
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
 
 #include "src/base/application.h"
 #include "src/base/brep_utils.h"
@@ -50,6 +65,8 @@
 #include "src/base/filepath.h"
 #include "src/base/filepath_conv.h"
 #include "src/base/geom_utils.h"
+#include "src/base/io_file_view.h"
+#include "src/base/io_import_cache.h"
 #include "src/base/io_system.h"
 #include "src/base/libtree.h"
 #include "src/base/mesh_utils.h"
@@ -57,21 +74,36 @@
 #include "src/base/meta_enum.h"
 #include "src/base/occ_handle.h"
 #include "src/base/occ_static_variables_rollback.h"
+#include "src/base/point_cloud_data.h"
+#include "src/base/point_cloud_octree.h"
 #include "src/base/property_builtins.h"
 #include "src/base/property_enumeration.h"
 #include "src/base/property_value_conversion.h"
 #include "src/base/settings.h"
 #include "src/base/string_conv.h"
 #include "src/base/task_manager.h"
+#include "src/base/task_thread_pool.h"
 #include "src/base/tkernel_utils.h"
 #include "src/base/unit.h"
 #include "src/base/unit_system.h"
+#include "src/io_dxf/dxf.h"
 #include "src/io_dxf/io_dxf.h"
+#include "src/io_obj/io_obj_reader.h"
 #include "src/io_occ/io_occ.h"
+#include "src/io_occ/io_occ_gltf_reader.h"
+#include "src/io_occ/io_occ_gltf_writer.h"
+#include "src/io_occ/io_occ_step.h"
 #include "src/io_off/io_off_reader.h"
 #include "src/io_off/io_off_writer.h"
 #include "src/io_ply/io_ply_reader.h"
 #include "src/io_ply/io_ply_writer.h"
+#include "src/io_stl/io_stl_reader.h"
+#include "src/io_stl/io_stl_writer.h"
+#include "src/cli/cli_batch.h"
+#ifdef MAYO_HAVE_ZLIB
+#include "src/io_gmio/zip_deflate_parallel.h"
+#include <zlib.h>
+#endif
 
 // Needed for Q_FECTH()
 Q_DECLARE_METATYPE(Mayo::UnitSystem::TranslateResult)
@@ -215,6 +247,15 @@ struct SignalEmitSpy
     SignalConnectionHandle sigConnection;
 };
 
+// Writes DXF file made of the group code/value pairs 'groups'
+void writeDxfFile(const FilePath &filepath,
+                  std::initializer_list<std::pair<int, std::string_view>> groups)
+{
+    std::ofstream ofs(filepath);
+    for (const auto &[code, value] : groups)
+        ofs << code << "\n" << value << "\n";
+}
+
 } // namespace
 
 void TestBase::Application_test()
@@ -731,6 +772,255 @@ void TestBase::IO_probeFormatDirect_test()
 
     fnSetProbeInput("tests/inputs/cube.off");
     QCOMPARE(IO::probeFormat_OFF(input), IO::Format_OFF);
+    QCOMPARE(IO::probeFormat_Predefined(input), IO::Format_OFF);
+
+    fnSetProbeInput("tests/inputs/cube.stlb");
+    QCOMPARE(IO::probeFormat_Predefined(input), IO::Format_STL);
+
+    fnSetProbeInput("tests/inputs/cube.iges");
+    QCOMPARE(IO::probeFormat_Predefined(input), IO::Format_IGES);
+}
+
+void TestBase::IO_probeFormats_test()
+{
+    const FilePath arrayFilepath[] = {
+        "tests/inputs/cube.step", "tests/inputs/cube.iges", "tests/inputs/cube.stlb",
+        "tests/inputs/cube.obj",  "tests/inputs/cube.ply",  "tests/inputs/cube.off"};
+    const IO::Format arrayExpectedFormat[] = {IO::Format_STEP, IO::Format_IGES, IO::Format_STL,
+                                              IO::Format_OBJ,  IO::Format_PLY,  IO::Format_OFF};
+    m_ioSystem->clearProbeFormatCache();
+    // Second pass is served from the probe cache and must give the same results
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const std::vector<IO::Format> vecFormat = m_ioSystem->probeFormats(arrayFilepath);
+        QCOMPARE(vecFormat.size(), std::size(arrayFilepath));
+        for (size_t i = 0; i < vecFormat.size(); ++i)
+        {
+            QCOMPARE(vecFormat.at(i), arrayExpectedFormat[i]);
+            QCOMPARE(m_ioSystem->probeFormat(arrayFilepath[i]), arrayExpectedFormat[i]);
+        }
+    }
+
+    QCOMPARE(m_ioSystem->probeFormatCacheSize(), std::size(arrayFilepath));
+
+    // Cache is bounded, least recently used entries are evicted first
+    const size_t cacheMaxSize = m_ioSystem->probeFormatCacheMaxSize();
+    auto _ = gsl::finally([=] { m_ioSystem->setProbeFormatCacheMaxSize(cacheMaxSize); });
+    m_ioSystem->setProbeFormatCacheMaxSize(3);
+    QCOMPARE(m_ioSystem->probeFormatCacheSize(), size_t(3));
+    for (size_t i = 0; i < std::size(arrayFilepath); ++i)
+    {
+        QCOMPARE(m_ioSystem->probeFormat(arrayFilepath[i]), arrayExpectedFormat[i]);
+        QCOMPARE(m_ioSystem->probeFormatCacheSize(), size_t(3));
+    }
+
+    m_ioSystem->clearProbeFormatCache();
+    QCOMPARE(m_ioSystem->probeFormatCacheSize(), size_t(0));
+}
+
+void TestBase::IO_FileView_test()
+{
+    const FilePath filepath = "tests/inputs/cube.off";
+    IO::FileView fileView(filepath);
+    QVERIFY(fileView.isOpen());
+    QCOMPARE(fileView.filepath(), filepath);
+    QCOMPARE(uintmax_t(fileView.size()), filepathFileSize(filepath));
+    QVERIFY(fileView.contents().substr(0, 3) == "OFF");
+    QCOMPARE(m_ioSystem->probeFormat(fileView), IO::Format_OFF);
+
+    // Move
+    IO::FileView fileViewMoved = std::move(fileView);
+    QVERIFY(!fileView.isOpen());
+    QVERIFY(fileViewMoved.isOpen());
+    QCOMPARE(fileViewMoved.filepath(), filepath);
+
+    // Read from view
+    auto reader = m_ioSystem->createReader(IO::Format_OFF);
+    QVERIFY(reader);
+    QVERIFY(reader->readFile(fileViewMoved, &TaskProgress::null()));
+
+    // Non existing file
+    IO::FileView fileViewNull("tests/inputs/non_existing.off");
+    QVERIFY(!fileViewNull.isOpen());
+    QCOMPARE(fileViewNull.size(), size_t(0));
+}
+
+void TestBase::IO_DxfTokenizer_test()
+{
+    using namespace DxfPrivate;
+    const std::string_view contents = "  0\r\nSECTION\r\n  2\nENTITIES\n 10\n+1.5\n 20\n-2e1\nx\ny";
+    DxfTokenizer tokenizer(contents);
+    int code = -1;
+    std::string_view value;
+    QVERIFY(tokenizer.nextGroup(&code, &value));
+    QCOMPARE(code, 0);
+    QVERIFY(value == "SECTION");
+    QVERIFY(tokenizer.nextGroup(&code, &value));
+    QCOMPARE(code, 2);
+    QVERIFY(value == "ENTITIES");
+    QVERIFY(tokenizer.nextGroup(&code, &value));
+    QCOMPARE(code, 10);
+    QCOMPARE(stringToDouble(value), 1.5);
+    QVERIFY(tokenizer.nextGroup(&code, &value));
+    QCOMPARE(code, 20);
+    QCOMPARE(stringToDouble(value), -20.);
+    QVERIFY(!tokenizer.atEnd());
+
+    // Group code isn't an integer
+    QVERIFY(!tokenizer.nextGroup(&code, &value));
+    QVERIFY(tokenizer.nextLine() == "y");
+    QVERIFY(tokenizer.atEnd());
+    QCOMPARE(tokenizer.position(), contents.size());
+
+    QCOMPARE(stringToInt("abc", StringToErrorMode::ReturnErrorValue), INT_MAX);
+    QVERIFY_EXCEPTION_THROWN(stringToDouble("abc"), std::runtime_error);
+}
+
+void TestBase::IO_DxfReaderParallelBuild_test()
+{
+    // Lines alternating between two layers, enough of them to be built by several chunks
+    const FilePath filepath = "tests/outputs/many_lines.dxf";
+    const int lineCount = 5000;
+    {
+        std::ofstream ofs(filepath);
+        ofs << "0\nSECTION\n2\nENTITIES\n";
+        for (int i = 0; i < lineCount; ++i)
+        {
+            ofs << "0\nLINE\n8\n" << (i % 2 == 0 ? "L1" : "L2") << "\n"
+                << "10\n" << i << "\n20\n0\n30\n0\n"
+                << "11\n" << i << "\n21\n1\n31\n0\n";
+        }
+
+        ofs << "0\nENDSEC\n0\nEOF\n";
+    }
+
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    IO::DxfReader reader;
+    QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+    const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+    QCOMPARE(seqLabel.Size(), 2);
+
+    // Each layer compound holds its edges in file order
+    for (const TDF_Label &label : seqLabel)
+    {
+        const int firstX = to_stdString(CafUtils::labelAttrStdName(label)) == "L1" ? 0 : 1;
+        int edgeCount = 0;
+        for (TopoDS_Iterator it(XCaf::shape(label)); it.More(); it.Next())
+        {
+            QCOMPARE(it.Value().ShapeType(), TopAbs_EDGE);
+            const TopoDS_Edge &edge = TopoDS::Edge(it.Value());
+            const gp_Pnt pnt = BRep_Tool::Pnt(TopExp::FirstVertex(edge));
+            QCOMPARE(pnt.X(), double(firstX + 2 * edgeCount));
+            ++edgeCount;
+        }
+
+        QCOMPARE(edgeCount, lineCount / 2);
+    }
+}
+
+void TestBase::IO_DxfReaderBlockInserts_test()
+{
+    // Block "B" is inserted before its definition, then three times after
+    const FilePath filepath = "tests/outputs/block_inserts.dxf";
+    writeDxfFile(filepath, {{0, "SECTION"}, {2, "ENTITIES"},
+                            {0, "INSERT"}, {8, "L1"}, {2, "B"}, {10, "-5"}, {20, "0"}, {30, "0"},
+                            {0, "ENDSEC"},
+                            {0, "SECTION"}, {2, "BLOCKS"},
+                            {0, "BLOCK"}, {2, "B"},
+                            {0, "LINE"}, {8, "L1"}, {10, "0"}, {20, "0"}, {30, "0"},
+                            {11, "1"}, {21, "0"}, {31, "0"},
+                            {0, "ENDBLK"},
+                            {0, "ENDSEC"},
+                            {0, "SECTION"}, {2, "ENTITIES"},
+                            {0, "INSERT"}, {8, "L1"}, {2, "B"}, {10, "0"}, {20, "0"}, {30, "0"},
+                            {0, "INSERT"}, {8, "L1"}, {2, "B"}, {10, "10"}, {20, "0"}, {30, "0"},
+                            {0, "INSERT"}, {8, "L1"}, {2, "B"}, {10, "20"}, {20, "0"}, {30, "0"},
+                            {41, "2"}, {42, "2"}, {43, "2"},
+                            {0, "ENDSEC"},
+                            {0, "EOF"}});
+
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    IO::DxfReader reader;
+    QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+    const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+    QCOMPARE(seqLabel.Size(), 1);
+
+    // Insert preceding the block definition is empty, other ones are components of layer "L1"
+    const TDF_Label layerLabel = seqLabel.First();
+    QVERIFY(XCaf::isShapeAssembly(layerLabel));
+    const TDF_LabelSequence seqComponent = XCaf::shapeComponents(layerLabel);
+    QCOMPARE(seqComponent.Size(), 3);
+
+    // Inserts with same scale share the block prototype
+    const TDF_Label block1 = XCaf::shapeReferred(seqComponent.Value(1));
+    const TDF_Label block2 = XCaf::shapeReferred(seqComponent.Value(2));
+    const TDF_Label block3 = XCaf::shapeReferred(seqComponent.Value(3));
+    QVERIFY(block1 == block2);
+    QVERIFY(block1 != block3);
+    QVERIFY(!XCaf::shape(block1).IsNull());
+    QVERIFY(!XCaf::shape(block3).IsNull());
+}
+
+void TestBase::IO_DxfReaderInsertPlacement_test()
+{
+    // Rotated insert of block "B", then insert with non-uniform scale along Z
+    const FilePath filepath = "tests/outputs/insert_placement.dxf";
+    writeDxfFile(filepath, {{0, "SECTION"}, {2, "BLOCKS"},
+                            {0, "BLOCK"}, {2, "B"},
+                            {0, "LINE"}, {8, "L1"}, {10, "0"}, {20, "0"}, {30, "0"},
+                            {11, "1"}, {21, "0"}, {31, "0"},
+                            {0, "ENDBLK"},
+                            {0, "ENDSEC"},
+                            {0, "SECTION"}, {2, "ENTITIES"},
+                            {0, "INSERT"}, {8, "L1"}, {2, "B"}, {10, "10"}, {20, "0"}, {30, "0"},
+                            {50, "1.5"},
+                            {0, "INSERT"}, {8, "L2"}, {2, "B"}, {10, "0"}, {20, "0"}, {30, "0"},
+                            {41, "1"}, {42, "1"}, {43, "2"},
+                            {0, "ENDSEC"},
+                            {0, "EOF"}});
+
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    MessageCollecter messages;
+    messages.only(MessageType::Warning);
+    IO::DxfReader reader;
+    reader.setMessenger(&messages);
+    QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+    const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+    QCOMPARE(seqLabel.Size(), 2);
+
+    // Base point of the block is at insertion point whatever the rotation
+    TDF_Label layerLabel;
+    for (const TDF_Label &label : seqLabel)
+    {
+        if (to_stdString(CafUtils::labelAttrStdName(label)) == "L1")
+            layerLabel = label;
+    }
+
+    QVERIFY(!layerLabel.IsNull());
+    const TDF_LabelSequence seqComponent = XCaf::shapeComponents(layerLabel);
+    QCOMPARE(seqComponent.Size(), 1);
+    std::vector<gp_Pnt> vecPnt;
+    for (TopExp_Explorer expl(XCaf::shape(seqComponent.First()), TopAbs_VERTEX); expl.More();
+         expl.Next())
+    {
+        vecPnt.push_back(BRep_Tool::Pnt(TopoDS::Vertex(expl.Current())));
+    }
+
+    QCOMPARE(vecPnt.size(), size_t(2));
+    const gp_Pnt pntInsert(10, 0, 0);
+    QVERIFY(vecPnt.at(0).IsEqual(pntInsert, Precision::Confusion()) ||
+            vecPnt.at(1).IsEqual(pntInsert, Precision::Confusion()));
+    QVERIFY(std::abs(vecPnt.at(0).Distance(vecPnt.at(1)) - 1.) < Precision::Confusion());
+
+    // Scale along Z differs from X
+    QCOMPARE(messages.messages().size(), size_t(1));
+    QVERIFY(messages.messages().front().text.find("non-uniform") != std::string::npos);
 }
 
 void TestBase::IO_OccStaticVariablesRollback_test()
@@ -799,6 +1089,179 @@ void TestBase::IO_OccStaticVariablesRollback_test_data()
     QTest::newRow("var_str2") << "mayo.test.variable_str2" << QVariant("foo") << QVariant("blah");
 }
 
+void TestBase::IO_OccStepReaderStructurePreview_test()
+{
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    IO::OccStepReader reader;
+    reader.parameters().structurePreview = true;
+
+    // Assembly of 3 parts
+    {
+        QVERIFY(reader.readFile("tests/inputs/#332_file.stp", &TaskProgress::null()));
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        const TDF_Label rootLabel = seqLabel.First();
+        QCOMPARE(to_stdString(CafUtils::labelAttrStdName(rootLabel)), std::string{"Root"});
+        QVERIFY(XCaf::isShapeAssembly(rootLabel));
+        const TDF_LabelSequence seqComponent = XCaf::shapeComponents(rootLabel);
+        QCOMPARE(seqComponent.Size(), 3);
+        for (int i = 1; i <= seqComponent.Size(); ++i)
+        {
+            const TDF_Label &componentLabel = seqComponent.Value(i);
+            const TDF_Label partLabel = XCaf::shapeReferred(componentLabel);
+            QVERIFY(XCaf::isShapeReference(componentLabel));
+            QVERIFY(!XCaf::isShapeAssembly(partLabel));
+            QCOMPARE(to_stdString(CafUtils::labelAttrStdName(componentLabel)),
+                     fmt::format("Ref {}", i));
+            QCOMPARE(to_stdString(CafUtils::labelAttrStdName(partLabel)),
+                     fmt::format("Part {}", i));
+        }
+    }
+
+    // Single part
+    {
+        QVERIFY(reader.readFile("tests/inputs/cube.step", &TaskProgress::null()));
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        QCOMPARE(to_stdString(CafUtils::labelAttrStdName(seqLabel.First())), std::string{"Cube"});
+        QVERIFY(!XCaf::isShapeAssembly(seqLabel.First()));
+    }
+
+    // Not a STEP file
+    QVERIFY(!reader.readFile("tests/inputs/cube.obj", &TaskProgress::null()));
+}
+
+void TestBase::IO_OccGltfReaderLateDataLoading_test()
+{
+#if OCC_VERSION_HEX >= 0x070600
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    IO::OccGltfReader reader;
+    reader.parameters().lateDataLoading = true;
+    QVERIFY(reader.readFile("tests/inputs/cube.gltf", &TaskProgress::null()));
+    const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+    QVERIFY(!seqLabel.IsEmpty());
+
+    auto fnCountMeshData = [&](int *ptrNodeCount, int *ptrTriangleCount)
+    {
+        *ptrNodeCount = 0;
+        *ptrTriangleCount = 0;
+        for (const TDF_Label &label : seqLabel)
+        {
+            BRepUtils::forEachSubFace(
+                XCaf::shape(label),
+                [&](const TopoDS_Face &face)
+                {
+                    TopLoc_Location loc;
+                    const OccHandle<Poly_Triangulation> &mesh = BRep_Tool::Triangulation(face, loc);
+                    if (mesh)
+                    {
+                        *ptrNodeCount += mesh->NbNodes();
+                        *ptrTriangleCount += mesh->NbTriangles();
+                    }
+                });
+        }
+    };
+
+    // Mesh data isn't loaded yet
+    int nodeCount = 0;
+    int triangleCount = 0;
+    fnCountMeshData(&nodeCount, &triangleCount);
+    QCOMPARE(nodeCount, 0);
+
+    // Concurrent loadings, each triangulation has to be loaded once
+    TaskManager taskMgr;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 4; ++i)
+    {
+        vecTaskId.push_back(taskMgr.newTask(
+            [&](TaskProgress *)
+            {
+                for (const TDF_Label &label : seqLabel)
+                    BRepUtils::loadDeferredTriangulations(XCaf::shape(label));
+            }));
+    }
+
+    for (TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    for (TaskId taskId : vecTaskId)
+        QVERIFY(taskMgr.waitForDone(taskId));
+
+    // Cube made of 6 quads
+    fnCountMeshData(&nodeCount, &triangleCount);
+    QCOMPARE(nodeCount, 24);
+    QCOMPARE(triangleCount, 12);
+#endif
+}
+
+void TestBase::IO_OccGltfWriterOptimizeMeshes_test()
+{
+#if OCC_VERSION_HEX >= 0x070600
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    IO::OccGltfReader reader;
+    QVERIFY(reader.readFile("tests/inputs/cube.gltf", &TaskProgress::null()));
+    const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+    QVERIFY(!seqLabel.IsEmpty());
+
+    auto fnFaceTriangulations = [](const TDF_LabelSequence &seqLabel)
+    {
+        std::vector<OccHandle<Poly_Triangulation>> vecMesh;
+        for (const TDF_Label &label : seqLabel)
+        {
+            BRepUtils::forEachSubFace(XCaf::shape(label),
+                                      [&](const TopoDS_Face &face)
+                                      {
+                                          TopLoc_Location loc;
+                                          vecMesh.push_back(BRep_Tool::Triangulation(face, loc));
+                                      });
+        }
+
+        return vecMesh;
+    };
+
+    const std::vector<OccHandle<Poly_Triangulation>> vecMeshBefore = fnFaceTriangulations(seqLabel);
+    QVERIFY(!vecMeshBefore.empty());
+
+    const FilePath filepath = "tests/outputs/cube_optimized.glb";
+    IO::OccGltfWriter writer;
+    writer.parameters().optimizeMeshes = true;
+    const ApplicationItem appItems[] = {ApplicationItem(doc)};
+    QVERIFY(writer.transfer(appItems, &TaskProgress::null()));
+    QVERIFY(writer.writeFile(filepath, &TaskProgress::null()));
+
+    // Faces of the source document keep their triangulations
+    const std::vector<OccHandle<Poly_Triangulation>> vecMeshAfter = fnFaceTriangulations(seqLabel);
+    QCOMPARE(vecMeshAfter.size(), vecMeshBefore.size());
+    for (size_t i = 0; i < vecMeshBefore.size(); ++i)
+        QVERIFY(vecMeshAfter.at(i) == vecMeshBefore.at(i));
+
+    // Read back, optimized meshes have same count of nodes and triangles
+    DocumentPtr docOutput = app->newDocument();
+    auto _2 = gsl::finally([=] { app->closeDocument(docOutput); });
+    IO::OccGltfReader readerOutput;
+    QVERIFY(readerOutput.readFile(filepath, &TaskProgress::null()));
+    const TDF_LabelSequence seqLabelOutput =
+        readerOutput.transfer(docOutput, &TaskProgress::null());
+    int nodeCount = 0;
+    int triangleCount = 0;
+    for (const OccHandle<Poly_Triangulation> &mesh : fnFaceTriangulations(seqLabelOutput))
+    {
+        QVERIFY(!mesh.IsNull());
+        nodeCount += mesh->NbNodes();
+        triangleCount += mesh->NbTriangles();
+    }
+
+    QCOMPARE(nodeCount, 24);
+    QCOMPARE(triangleCount, 12);
+#endif
+}
+
 void TestBase::IO_bugGitHub166_test()
 {
     QFETCH(QString, strInputFilePath);
@@ -841,6 +1304,10 @@ void TestBase::IO_bugGitHub166_test_data()
                               << IO::Format_STL;
     QTest::newRow("STL->PLY") << "tests/inputs/cube.stla" << "tests/outputs/cube.ply"
                               << IO::Format_PLY;
+    QTest::newRow("PLY->OFF") << "tests/inputs/cube.ply" << "tests/outputs/cube.off"
+                              << IO::Format_OFF;
+    QTest::newRow("STL->OFF") << "tests/inputs/cube.stla" << "tests/outputs/cube.off"
+                              << IO::Format_OFF;
 
 #if OCC_VERSION_HEX >= 0x070400
     QTest::newRow("OBJ->PLY") << "tests/inputs/cube.obj" << "tests/outputs/cube.ply"
@@ -889,6 +1356,538 @@ void TestBase::IO_bugGitHub258_test()
     QCOMPARE(triangulation->NbTriangles(), 12);
 }
 
+void TestBase::IO_importInDocumentParallelTransfer_test()
+{
+    const FilePath arrayFilepath[] = {"tests/inputs/cube.step", "tests/inputs/cube.stla",
+                                      "tests/inputs/cube.ply", "tests/inputs/cube.off"};
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    const int docCount = app->documentCount();
+    const bool okImport = m_ioSystem->importInDocument()
+                              .targetDocument(doc)
+                              .withFilepaths(arrayFilepath)
+                              .withParallelTransfer(true)
+                              .execute();
+    QVERIFY(okImport);
+    QCOMPARE(app->documentCount(), docCount);
+    QCOMPARE(doc->entityCount(), int(std::size(arrayFilepath)));
+    for (int i = 0; i < doc->entityCount(); ++i)
+    {
+        const TDF_Label entityLabel = doc->entityLabel(i);
+        QVERIFY(Document::findFrom(entityLabel) == doc);
+        QVERIFY(XCaf::isShape(entityLabel));
+        QVERIFY(!XCaf::shape(entityLabel).IsNull());
+    }
+
+    // Error on some file is reported, other files are still imported
+    const FilePath arrayFilepathWithError[] = {"tests/inputs/cube.stla",
+                                               "tests/inputs/file_not_found.step",
+                                               "tests/inputs/cube.off"};
+    DocumentPtr docWithError = app->newDocument();
+    const bool okImportWithError = m_ioSystem->importInDocument()
+                                       .targetDocument(docWithError)
+                                       .withFilepaths(arrayFilepathWithError)
+                                       .withParallelTransfer(true)
+                                       .execute();
+    QVERIFY(!okImportWithError);
+    QCOMPARE(docWithError->entityCount(), 2);
+}
+
+void TestBase::IO_importCache_test()
+{
+    const FilePath cacheDir = std_filesystem::temp_directory_path() / "mayo_test_import_cache";
+    IO::ImportCache cache(cacheDir);
+    cache.clear();
+    auto _ = gsl::finally([&] { cache.clear(); });
+
+    auto app = makeOccHandle<Application>();
+    Application::defineMayoFormat(app);
+    auto fnImport = [&](const DocumentPtr &doc)
+    {
+        return m_ioSystem->importInDocument()
+            .targetDocument(doc)
+            .withFilepath("tests/inputs/cube.step")
+            .withImportCache(&cache)
+            .execute();
+    };
+
+    // First import: entities are stored in cache
+    QVERIFY(fnImport(app->newDocument()));
+    QCOMPARE(cache.statistics().missCount, int64_t(1));
+    QCOMPARE(cache.statistics().storeCount, int64_t(1));
+    QVERIFY(cache.size() > 0);
+
+    // Second import: entities are restored from cache
+    DocumentPtr doc = app->newDocument();
+    QVERIFY(fnImport(doc));
+    QCOMPARE(cache.statistics().hitCount, int64_t(1));
+    QCOMPARE(doc->entityCount(), 1);
+    QVERIFY(XCaf::isShape(doc->entityLabel(0)));
+    QVERIFY(!XCaf::shape(doc->entityLabel(0)).IsNull());
+
+    // Many files with parallel transfer: first import stores the IGES and BRep files, second
+    // import restores all files from cache
+    const FilePath filepaths[] = {"tests/inputs/cube.step", "tests/inputs/cube.iges",
+                                  "tests/inputs/cube.brep"};
+    for (int i = 0; i < 2; ++i)
+    {
+        DocumentPtr docMany = app->newDocument();
+        const bool ok = m_ioSystem->importInDocument()
+                            .targetDocument(docMany)
+                            .withFilepaths(filepaths)
+                            .withParallelTransfer(true)
+                            .withImportCache(&cache)
+                            .execute();
+        QVERIFY(ok);
+        QCOMPARE(docMany->entityCount(), 3);
+    }
+
+    QCOMPARE(cache.statistics().hitCount, int64_t(5));
+    QCOMPARE(cache.statistics().storeCount, int64_t(3));
+
+    // Key depends on file contents and format
+    const std::string key = IO::ImportCache::computeKey("tests/inputs/cube.step",
+                                                        IO::Format_STEP, nullptr);
+    QVERIFY(!key.empty());
+    QVERIFY(cache.contains(key));
+    QCOMPARE(IO::ImportCache::computeKey("tests/inputs/cube.step", IO::Format_STEP, nullptr), key);
+    QVERIFY(IO::ImportCache::computeKey("tests/inputs/cube.step", IO::Format_IGES, nullptr) != key);
+    QVERIFY(IO::ImportCache::computeKey("tests/inputs/cube.iges", IO::Format_STEP, nullptr) != key);
+
+    // Eviction
+    cache.setMaxSize(0);
+    QCOMPARE(cache.statistics().evictionCount, int64_t(3));
+    QVERIFY(!cache.contains(key));
+    QCOMPARE(cache.size(), uint64_t(0));
+}
+
+void TestBase::IO_importMemoryBudget_test()
+{
+    const FilePath cubeStepFilepath = "tests/inputs/cube.step";
+    const uint64_t cubeStepFileSize = filepathFileSize(cubeStepFilepath);
+    QVERIFY(m_ioSystem->memoryExpansionFactor(IO::Format_STEP) >= 1.);
+    QVERIFY(m_ioSystem->estimateReadMemory(cubeStepFilepath, IO::Format_STEP) >= cubeStepFileSize);
+
+    // Only factors set or learned are reported, factors are at least 1
+    {
+        IO::System ioSystem;
+        QVERIFY(ioSystem.memoryExpansionFactors().empty());
+        ioSystem.setMemoryExpansionFactor(IO::Format_STL, 2.5);
+        ioSystem.setMemoryExpansionFactor(IO::Format_STEP, 0.5);
+        const auto vecFactor = ioSystem.memoryExpansionFactors();
+        QCOMPARE(vecFactor.size(), size_t(2));
+        QCOMPARE(vecFactor.at(0).first, IO::Format_STEP);
+        QCOMPARE(vecFactor.at(0).second, 1.);
+        QCOMPARE(vecFactor.at(1).first, IO::Format_STL);
+        QCOMPARE(vecFactor.at(1).second, 2.5);
+    }
+
+    // Budget smaller than any file: files are read one after the other, but all imported
+    const FilePath filepaths[] = {cubeStepFilepath, "tests/inputs/cube.iges",
+                                  "tests/inputs/cube.brep"};
+    for (bool parallelTransfer : {false, true})
+    {
+        auto app = makeOccHandle<Application>();
+        DocumentPtr doc = app->newDocument();
+        const bool ok = m_ioSystem->importInDocument()
+                            .targetDocument(doc)
+                            .withFilepaths(filepaths)
+                            .withParallelTransfer(parallelTransfer)
+                            .withMemoryBudget(1)
+                            .execute();
+        QVERIFY(ok);
+        QCOMPARE(doc->entityCount(), 3);
+    }
+}
+
+void TestBase::IO_OffReader_test()
+{
+    auto fnWriteFile = [](const FilePath &filepath, std::string_view contents)
+    {
+        std::ofstream ofs(filepath);
+        ofs << contents;
+        return filepath;
+    };
+
+    // Comments, blank lines and polygons having more than 3 vertices
+    {
+        const FilePath filepath = fnWriteFile("tests/outputs/polygons.off",
+                                              "# Header comment\nOFF\n# Counts\n5 3 0\n\n"
+                                              "0 0 0\n1 0 0 # Trailing comment\n1 1 0\n0 1 0\n"
+                                              "  0.5 0.5 1\n# Faces\n"
+                                              "4 0 1 2 3\n3 0 1 4\n2 0 1\n");
+        auto app = makeOccHandle<Application>();
+        DocumentPtr doc = app->newDocument();
+        auto _ = gsl::finally([=] { app->closeDocument(doc); });
+        IO::OffReader reader;
+        QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        const TopoDS_Shape shape = doc->xcaf().shape(seqLabel.First());
+        TopLoc_Location locFace;
+        const auto mesh = BRep_Tool::Triangulation(TopoDS::Face(shape), locFace);
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbNodes(), 5);
+        // Quad is split into 2 triangles, face having 2 vertices is ignored
+        QCOMPARE(mesh->NbTriangles(), 3);
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - (1. + std::sqrt(1.25) / 2.)) < 1e-6);
+    }
+
+    // Invalid files are rejected with an error message
+    const std::string_view invalidContents[] = {
+        "OFF\nabc\n",                                    // No counts
+        "OFF\n-1 1 0\n0 0 0\n",                           // Negative count
+        "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n4 0 1 2\n",  // Missing face vertex
+        "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n3 0 1 3\n",  // Face vertex out of range
+        "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n3 0 -1 2\n", // Negative face vertex
+    };
+    for (std::string_view contents : invalidContents)
+    {
+        const FilePath filepath = fnWriteFile("tests/outputs/invalid.off", contents);
+        MessageCollecter messages;
+        messages.only(MessageType::Error);
+        IO::OffReader reader;
+        reader.setMessenger(&messages);
+        QVERIFY(!reader.readFile(filepath, &TaskProgress::null()));
+        QCOMPARE(messages.messages().size(), size_t(1));
+    }
+}
+
+void TestBase::IO_ObjReader_test()
+{
+    auto app = makeOccHandle<Application>();
+    auto fnFaceMesh = [](const DocumentPtr &doc, const TDF_Label &label)
+    {
+        const TopoDS_Shape shape = doc->xcaf().shape(label);
+        TopLoc_Location locFace;
+        return BRep_Tool::Triangulation(TopoDS::Face(shape), locFace);
+    };
+
+    // Single group: one mesh entity, color taken from MTL file
+    {
+        IO::ObjReader reader;
+        QVERIFY(reader.readFile("tests/inputs/cube.obj", &TaskProgress::null()));
+        DocumentPtr doc = app->newDocument();
+        auto _ = gsl::finally([=] { app->closeDocument(doc); });
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        const OccHandle<Poly_Triangulation> mesh = fnFaceMesh(doc, seqLabel.First());
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbNodes(), 8);
+        QCOMPARE(mesh->NbTriangles(), 12);
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - 600.) < 1e-6);
+        Quantity_Color color;
+        QVERIFY(doc->xcaf().colorTool()->GetColor(seqLabel.First(), XCAFDoc_ColorGen, color));
+        QVERIFY(std::abs(color.Red() - 0.8) < 1e-6);
+    }
+
+    // Groups and materials: one mesh per group/material pair, polygons are triangulated and
+    // relative indices are resolved
+    {
+        const FilePath filepath = "tests/outputs/groups.obj";
+        {
+            std::ofstream ofs(filepath);
+            ofs << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\n"
+                << "g quad\nusemtl red\nf 1//1 2//1 3//1 4//1\n"
+                << "g tri\nf -4 -3 -2\n"
+                << "g quad\nf 1 2 4\n";
+        }
+
+        IO::ObjReader reader;
+        QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+        DocumentPtr doc = app->newDocument();
+        auto _ = gsl::finally([=] { app->closeDocument(doc); });
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        QVERIFY(XCaf::isShapeAssembly(seqLabel.First()));
+        TDF_LabelSequence seqComponent;
+        XCAFDoc_ShapeTool::GetComponents(seqLabel.First(), seqComponent);
+        QCOMPARE(seqComponent.Size(), 2);
+        std::vector<int> vecTriangleCount;
+        for (const TDF_Label &component : seqComponent)
+        {
+            const TDF_Label labelMesh = XCaf::shapeReferred(component);
+            vecTriangleCount.push_back(fnFaceMesh(doc, labelMesh)->NbTriangles());
+        }
+
+        // Faces of the second "quad" group are merged with the ones of the first
+        std::sort(vecTriangleCount.begin(), vecTriangleCount.end());
+        QCOMPARE(vecTriangleCount.front(), 1);
+        QCOMPARE(vecTriangleCount.back(), 3);
+    }
+
+    // Empty file: read error but no exception
+    {
+        const FilePath filepath = "tests/outputs/empty.obj";
+        std::ofstream(filepath).close();
+        IO::ObjReader reader;
+        QVERIFY(!reader.readFile(filepath, &TaskProgress::null()));
+    }
+}
+
+void TestBase::IO_StlReader_test()
+{
+    auto app = makeOccHandle<Application>();
+    auto fnReadMesh = [&](const IO::StlReader::Parameters &params, const FilePath &filepath)
+    {
+        OccHandle<Poly_Triangulation> mesh;
+        IO::StlReader reader;
+        reader.parameters() = params;
+        if (!reader.readFile(filepath, &TaskProgress::null()))
+            return mesh;
+
+        DocumentPtr doc = app->newDocument();
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        if (seqLabel.Size() == 1)
+        {
+            const TopoDS_Shape shape = doc->xcaf().shape(seqLabel.First());
+            TopLoc_Location locFace;
+            mesh = BRep_Tool::Triangulation(TopoDS::Face(shape), locFace);
+        }
+
+        app->closeDocument(doc);
+        return mesh;
+    };
+
+    // Facet vertices are welded, both for ASCII and binary files
+    IO::StlReader::Parameters params;
+    for (const FilePath filepath : {"tests/inputs/cube.stla", "tests/inputs/cube.stlb"})
+    {
+        const OccHandle<Poly_Triangulation> mesh = fnReadMesh(params, filepath);
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbNodes(), 8);
+        QCOMPARE(mesh->NbTriangles(), 12);
+        QVERIFY(!mesh->HasNormals());
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - 600.) < 1e-6);
+    }
+
+    // Facet normals
+    params.keepFacetNormals = true;
+    {
+        const OccHandle<Poly_Triangulation> mesh = fnReadMesh(params, "tests/inputs/cube.stla");
+        QVERIFY(!mesh.IsNull());
+        QVERIFY(mesh->HasNormals());
+        for (int i = 1; i <= mesh->NbNodes(); ++i)
+            QVERIFY(std::abs(MeshUtils::normal(mesh, i).Modulus() - 1.f) < 1e-5f);
+    }
+
+    // Weld tolerance greater than cube size: all facets collapse
+    params.weldTolerance = 20.;
+    {
+        const OccHandle<Poly_Triangulation> mesh = fnReadMesh(params, "tests/inputs/cube.stlb");
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbNodes(), 1);
+        QCOMPARE(mesh->NbTriangles(), 0);
+    }
+}
+
+void TestBase::IO_StlWriter_test()
+{
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    const bool okImport = m_ioSystem->importInDocument()
+                              .targetDocument(doc)
+                              .withFilepath("tests/inputs/cube.stla")
+                              .execute();
+    QVERIFY(okImport);
+
+    for (IO::StlWriter::Format format : {IO::StlWriter::Format::Binary,
+                                         IO::StlWriter::Format::Ascii})
+    {
+        const FilePath filepath = "tests/outputs/cube_writer.stl";
+        IO::StlWriter writer;
+        writer.parameters().format = format;
+        const ApplicationItem appItems[] = {ApplicationItem(doc)};
+        QVERIFY(writer.transfer(appItems, &TaskProgress::null()));
+        QVERIFY(writer.writeFile(filepath, &TaskProgress::null()));
+        if (format == IO::StlWriter::Format::Binary)
+            QCOMPARE(filepathFileSize(filepath), uintmax_t(84 + 50 * 12));
+
+        // Read back
+        IO::StlReader reader;
+        QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+        DocumentPtr docOutput = app->newDocument();
+        const TDF_LabelSequence seqLabel = reader.transfer(docOutput, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        const TopoDS_Shape shape = docOutput->xcaf().shape(seqLabel.First());
+        TopLoc_Location locFace;
+        auto mesh = BRep_Tool::Triangulation(TopoDS::Face(shape), locFace);
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbNodes(), 8);
+        QCOMPARE(mesh->NbTriangles(), 12);
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - 600.) < 1e-6);
+        QVERIFY(std::abs(MeshUtils::triangulationVolume(mesh) - 1000.) < 1e-6);
+        app->closeDocument(docOutput);
+    }
+}
+
+void TestBase::IO_OffWriter_test()
+{
+    const FilePath inputFilepath = "tests/outputs/precision.off";
+    {
+        std::ofstream ofs(inputFilepath);
+        ofs << "OFF\n3 1 0\n0.123456789 1.5 -2\n1 0 0\n0 1 0.333333333333\n3 0 1 2\n";
+    }
+
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=] { app->closeDocument(doc); });
+    const bool okImport =
+        m_ioSystem->importInDocument().targetDocument(doc).withFilepath(inputFilepath).execute();
+    QVERIFY(okImport);
+
+    // Returns the vertex lines of OFF file written with 'coordinatePrecision'
+    auto fnWriteVertexLines = [&](int coordinatePrecision)
+    {
+        const FilePath filepath = "tests/outputs/precision_writer.off";
+        IO::OffWriter writer;
+        writer.parameters().coordinatePrecision = coordinatePrecision;
+        const ApplicationItem appItems[] = {ApplicationItem(doc)};
+        std::vector<std::string> vecLine;
+        if (!writer.transfer(appItems, &TaskProgress::null()))
+            return vecLine;
+
+        if (!writer.writeFile(filepath, &TaskProgress::null()))
+            return vecLine;
+
+        std::ifstream ifs(filepath);
+        std::string line;
+        for (int i = 0; i < 5 && std::getline(ifs, line); ++i)
+        {
+            if (i >= 2) // Skip "OFF" and counts lines
+                vecLine.push_back(line);
+        }
+
+        return vecLine;
+    };
+    // Vertex lines also contain node colors, only coordinates are checked
+    auto fnStartsWithCoords = [](const std::string &line, std::string_view coords)
+    {
+        return line.size() > coords.size() && line.compare(0, coords.size(), coords) == 0 &&
+               line.at(coords.size()) == ' ';
+    };
+
+    // Exact values
+    {
+        const std::vector<std::string> vecLine = fnWriteVertexLines(0);
+        QCOMPARE(vecLine.size(), size_t(3));
+        QVERIFY(fnStartsWithCoords(vecLine.at(0), "0.123456789 1.5 -2"));
+        QVERIFY(fnStartsWithCoords(vecLine.at(1), "1 0 0"));
+        QVERIFY(fnStartsWithCoords(vecLine.at(2), "0 1 0.333333333333"));
+    }
+
+    // Limited count of significant digits
+    {
+        const std::vector<std::string> vecLine = fnWriteVertexLines(3);
+        QCOMPARE(vecLine.size(), size_t(3));
+        QVERIFY(fnStartsWithCoords(vecLine.at(0), "0.123 1.5 -2"));
+        QVERIFY(fnStartsWithCoords(vecLine.at(1), "1 0 0"));
+        QVERIFY(fnStartsWithCoords(vecLine.at(2), "0 1 0.333"));
+    }
+}
+
+void TestBase::IO_ZipDeflateParallel_test()
+{
+#ifdef MAYO_HAVE_ZLIB
+    QFETCH(int, dataSize);
+    QFETCH(int, level);
+    QFETCH(bool, useZip64);
+
+    // Compressible data with some noise, so blocks depend on the dictionary of previous ones
+    std::string data;
+    data.reserve(dataSize);
+    std::minstd_rand randEngine(42);
+    const std::string_view pattern = "solid vertex facet normal outer loop endloop endfacet ";
+    for (int i = 0; i < dataSize; ++i)
+        data += (randEngine() % 16) != 0 ? pattern.at(i % pattern.size()) : char(randEngine());
+
+    const FilePath filepath = "tests/outputs/deflate_parallel.zip";
+    IO::ZipDeflateOptions options;
+    options.level = level;
+    options.useZip64 = useZip64;
+    QVERIFY(IO::writeZipArchiveParallel(filepath, "entry.bin", data, options, nullptr, 0, 100));
+
+    std::string zip;
+    {
+        std::ifstream ifs(filepath, std::ios::binary);
+        zip.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    auto fnReadUInt = [&](size_t pos, int byteCount)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < byteCount; ++i)
+            value |= uint64_t(uint8_t(zip.at(pos + i))) << (8 * i);
+
+        return value;
+    };
+
+    // Local file header
+    QCOMPARE(fnReadUInt(0, 4), uint64_t(0x04034b50));
+    QCOMPARE(fnReadUInt(4, 2), uint64_t(useZip64 ? 45 : 20));
+    QCOMPARE(fnReadUInt(8, 2), uint64_t(8)); // Deflate method
+    const auto crc = uint32_t(fnReadUInt(14, 4));
+    uint64_t compressedSize = fnReadUInt(18, 4);
+    uint64_t uncompressedSize = fnReadUInt(22, 4);
+    const size_t filenameLength = fnReadUInt(26, 2);
+    const size_t extraLength = fnReadUInt(28, 2);
+    QVERIFY(zip.compare(30, filenameLength, "entry.bin") == 0);
+    if (useZip64)
+    {
+        QCOMPARE(compressedSize, uint64_t(0xFFFFFFFF));
+        QCOMPARE(uncompressedSize, uint64_t(0xFFFFFFFF));
+        const size_t extraPos = 30 + filenameLength;
+        QCOMPARE(extraLength, size_t(20));
+        QCOMPARE(fnReadUInt(extraPos, 2), uint64_t(0x0001));
+        uncompressedSize = fnReadUInt(extraPos + 4, 8);
+        compressedSize = fnReadUInt(extraPos + 12, 8);
+    }
+
+    QCOMPARE(uncompressedSize, uint64_t(data.size()));
+    const size_t dataPos = 30 + filenameLength + extraLength;
+    QVERIFY(dataPos + compressedSize <= zip.size());
+
+    // End of central directory record
+    QCOMPARE(fnReadUInt(zip.size() - 22, 4), uint64_t(0x06054b50));
+
+    // Inflate entry data, one byte more than expected to detect overflow
+    std::string inflated(data.size() + 1, '\0');
+    z_stream zs = {};
+    QCOMPARE(inflateInit2(&zs, -MAX_WBITS), Z_OK);
+    zs.next_in = reinterpret_cast<Bytef *>(zip.data() + dataPos);
+    zs.avail_in = uInt(compressedSize);
+    zs.next_out = reinterpret_cast<Bytef *>(inflated.data());
+    zs.avail_out = uInt(inflated.size());
+    const int ret = inflate(&zs, Z_FINISH);
+    inflated.resize(zs.total_out);
+    inflateEnd(&zs);
+    QCOMPARE(ret, Z_STREAM_END);
+    QCOMPARE(zs.avail_in, uInt(0));
+    QVERIFY(inflated == data);
+    const auto dataCrc = crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef *>(data.data()),
+                               uInt(data.size()));
+    QCOMPARE(crc, uint32_t(dataCrc));
+#endif
+}
+
+void TestBase::IO_ZipDeflateParallel_test_data()
+{
+    QTest::addColumn<int>("dataSize");
+    QTest::addColumn<int>("level");
+    QTest::addColumn<bool>("useZip64");
+
+    // 1MB is split into several deflated blocks whatever the count of threads
+    constexpr int DataSize = 1024 * 1024;
+    QTest::newRow("empty") << 0 << 6 << false;
+    QTest::newRow("single_block") << 1000 << 6 << false;
+    QTest::newRow("multiple_blocks") << DataSize << 6 << false;
+    QTest::newRow("multiple_blocks_level9") << DataSize << 9 << false;
+    QTest::newRow("multiple_blocks_level0") << DataSize << 0 << false;
+    QTest::newRow("multiple_blocks_zip64") << DataSize << 6 << true;
+    QTest::newRow("multiple_blocks_level0_zip64") << DataSize << 0 << true;
+}
+
 void TestBase::DoubleToString_test()
 {
     const std::locale frLocale = getFrLocale();
@@ -1031,6 +2030,161 @@ void TestBase::MeshUtils_orientation_test_data()
     }
 }
 
+void TestBase::MeshUtils_optimizeVertexCache_test()
+{
+    // Grid of 50x50 quads, triangles being shuffled
+    const int quadCount = 50;
+    const int nodeCount = (quadCount + 1) * (quadCount + 1);
+    std::vector<std::array<int, 3>> vecTriangle;
+    for (int y = 0; y < quadCount; ++y)
+    {
+        for (int x = 0; x < quadCount; ++x)
+        {
+            const int n0 = y * (quadCount + 1) + x;
+            const int n1 = n0 + quadCount + 1;
+            vecTriangle.push_back({n0, n0 + 1, n1 + 1});
+            vecTriangle.push_back({n0, n1 + 1, n1});
+        }
+    }
+
+    std::shuffle(vecTriangle.begin(), vecTriangle.end(), std::mt19937(42));
+    std::vector<int> vecIndex;
+    for (const auto &tri : vecTriangle)
+        vecIndex.insert(vecIndex.end(), tri.cbegin(), tri.cend());
+
+    const double acmrShuffled = MeshUtils::averageCacheMissRatio(vecIndex, nodeCount);
+    MeshUtils::optimizeVertexCache(vecIndex, nodeCount);
+    const double acmrOptimized = MeshUtils::averageCacheMissRatio(vecIndex, nodeCount);
+    QVERIFY(acmrShuffled > 2.);
+    QVERIFY(acmrOptimized < 1.);
+
+    // Same set of triangles
+    std::vector<std::array<int, 3>> vecTriangleOptimized;
+    for (size_t i = 0; i < vecIndex.size(); i += 3)
+        vecTriangleOptimized.push_back({vecIndex.at(i), vecIndex.at(i + 1), vecIndex.at(i + 2)});
+
+    std::sort(vecTriangle.begin(), vecTriangle.end());
+    std::sort(vecTriangleOptimized.begin(), vecTriangleOptimized.end());
+    QCOMPARE(vecTriangleOptimized, vecTriangle);
+
+    // Nodes renumbered in order of first use, unreferenced node moved at the end
+    std::vector<int> vecIndexFetch = {5, 2, 0, 0, 2, 3};
+    const std::vector<int> vecNewIndex = MeshUtils::optimizeVertexFetch(vecIndexFetch, 6);
+    QCOMPARE(vecIndexFetch, std::vector<int>({0, 1, 2, 2, 1, 3}));
+    QCOMPARE(vecNewIndex, std::vector<int>({2, 4, 1, 3, 5, 0}));
+}
+
+void TestBase::PointCloudOctree_test()
+{
+    // Random points with colors
+    constexpr int pointCount = 100 * 1000;
+    std::mt19937 randomEngine(42);
+    std::uniform_real_distribution<float> randomCoord(-100.f, 100.f);
+    std::vector<float> vecCoord;
+    std::vector<uint8_t> vecColor;
+    for (int i = 0; i < pointCount; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            vecCoord.push_back(randomCoord(randomEngine));
+
+        vecColor.insert(vecColor.end(), {uint8_t(i % 256), uint8_t((i / 256) % 256), 0});
+    }
+
+    PointCloudOctree::Builder builder(true /*hasColors*/);
+    builder.setMaxNodePointCount(1000);
+    builder.setBucketPointCount(10 * 1000); // Forces partition of points into buckets
+    constexpr int halfPointCount = pointCount / 2;
+    QVERIFY(builder.addPoints(vecCoord.data(), vecColor.data(), halfPointCount));
+    QVERIFY(builder.addPoints(&vecCoord.at(3 * halfPointCount), &vecColor.at(3 * halfPointCount),
+                              pointCount - halfPointCount));
+    const PointCloudOctreePtr octree = builder.build(&TaskProgress::null());
+    QVERIFY(octree);
+    QCOMPARE(octree->pointCount(), int64_t(pointCount));
+    QVERIFY(octree->hasColors());
+    QVERIFY(octree->depth() > 0);
+    QCOMPARE(octree->nodes().front().level, 0);
+
+    // Points of leaf nodes must be the whole point cloud, each one inside the cell of its node
+    using PointCoords = std::array<float, 3>;
+    std::vector<PointCoords> vecLeafCoords;
+    for (int leafIndex : octree->leafNodes())
+    {
+        std::vector<PointCloudOctree::Point> vecPoint;
+        QVERIFY(octree->loadNodePoints(leafIndex, &vecPoint));
+        const Bnd_Box &cellBox = octree->nodes()[leafIndex].box;
+        for (const PointCloudOctree::Point &point : vecPoint)
+        {
+            const float *coords = point.coords;
+            QVERIFY(!cellBox.IsOut(gp_Pnt(coords[0], coords[1], coords[2])));
+            vecLeafCoords.push_back({coords[0], coords[1], coords[2]});
+        }
+    }
+
+    std::vector<PointCoords> vecInputCoords;
+    for (int i = 0; i < pointCount; ++i)
+    {
+        const float *coords = &vecCoord.at(3 * i);
+        vecInputCoords.push_back({coords[0], coords[1], coords[2]});
+    }
+
+    std::sort(vecInputCoords.begin(), vecInputCoords.end());
+    std::sort(vecLeafCoords.begin(), vecLeafCoords.end());
+    QVERIFY(vecLeafCoords == vecInputCoords);
+
+    // Levels of detail
+    QCOMPARE(octree->findNodes(0).size(), size_t(1));
+    auto fnTotalPointCount = [&](Span<const int> spanNode)
+    {
+        int64_t count = 0;
+        for (int nodeIndex : spanNode)
+            count += octree->nodes()[nodeIndex].pointCount;
+
+        return count;
+    };
+    QCOMPARE(fnTotalPointCount(octree->leafNodes()), int64_t(pointCount));
+    QCOMPARE(fnTotalPointCount(octree->findNodes(octree->depth())), int64_t(pointCount));
+    const int level = octree->findLevel(10 * 1000);
+    QVERIFY(level < octree->depth());
+    const OccHandle<Graphic3d_ArrayOfPoints> gfxPoints =
+        octree->loadPoints(octree->findNodes(level));
+    QVERIFY(gfxPoints);
+    QVERIFY(gfxPoints->VertexNumber() > 0);
+    QVERIFY(gfxPoints->VertexNumber() <= 10 * 1000);
+
+    // Query of a region
+    Bnd_Box region;
+    region.Update(0, 0, 0, 50, 50, 50);
+    const std::vector<int> vecRegionNode = octree->findNodes(octree->depth(), region);
+    QVERIFY(!vecRegionNode.empty());
+    QVERIFY(vecRegionNode.size() < octree->leafNodes().size());
+
+    // PLY point cloud read into an octree
+    {
+        const FilePath filepath = "tests/outputs/point_cloud.ply";
+        {
+            std::ofstream ofs(filepath);
+            ofs << "ply\nformat ascii 1.0\nelement vertex 1000\n"
+                << "property float x\nproperty float y\nproperty float z\nend_header\n";
+            for (int i = 0; i < 1000; ++i)
+                ofs << i << " " << (i % 10) << " " << (i % 100) << "\n";
+        }
+
+        IO::PlyReader reader;
+        reader.parameters().octreeMinPointCount = 1;
+        QVERIFY(reader.readFile(filepath, &TaskProgress::null()));
+        auto app = makeOccHandle<Application>();
+        DocumentPtr doc = app->newDocument();
+        const TDF_LabelSequence seqLabel = reader.transfer(doc, &TaskProgress::null());
+        QCOMPARE(seqLabel.Size(), 1);
+        auto pntCloud = CafUtils::findAttribute<PointCloudData>(seqLabel.First());
+        QVERIFY(pntCloud);
+        QVERIFY(pntCloud->octree());
+        QVERIFY(!pntCloud->points());
+        QCOMPARE(pntCloud->pointCount(), int64_t(1000));
+        app->closeDocument(doc);
+    }
+}
+
 void TestBase::Enumeration_test()
 {
     enum class TestBase_Enum1
@@ -1395,6 +2549,103 @@ void TestBase::LibTask_test()
     QCOMPARE(vecProgressRec.back().value, 100);
 }
 
+void TestBase::LibTaskThreadPool_test()
+{
+    TaskThreadPool pool(2);
+    QCOMPARE(pool.workerCount(), 2);
+
+    TaskManager taskMgr(&pool);
+    // QtTest macros can't be used in worker threads, results are recorded then checked here
+    const std::thread::id testThreadId = std::this_thread::get_id();
+    std::atomic<int> nestedJobCount = 0;
+    std::atomic<int> childPoolMismatchCount = 0;
+    std::atomic<int> testThreadJobCount = 0;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 8; ++i)
+    {
+        const TaskId taskId = taskMgr.newTask(
+            [&](TaskProgress *)
+            {
+                if (std::this_thread::get_id() == testThreadId)
+                    ++testThreadJobCount;
+
+                // Nested tasks have to run in the same pool
+                TaskManager childTaskMgr;
+                if (childTaskMgr.threadPool() != &pool)
+                    ++childPoolMismatchCount;
+
+                std::vector<TaskId> vecChildTaskId;
+                for (int j = 0; j < 10; ++j)
+                    vecChildTaskId.push_back(childTaskMgr.newTask([&](TaskProgress *)
+                                                                  { ++nestedJobCount; }));
+
+                for (TaskId childTaskId : vecChildTaskId)
+                    childTaskMgr.run(childTaskId, TaskAutoDestroy::Off, TaskPriority::High);
+
+                for (TaskId childTaskId : vecChildTaskId)
+                    childTaskMgr.waitForDone(childTaskId);
+            });
+        vecTaskId.push_back(taskId);
+    }
+
+    for (TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    for (TaskId taskId : vecTaskId)
+        QVERIFY(taskMgr.waitForDone(taskId));
+
+    QCOMPARE(nestedJobCount.load(), 80);
+    QCOMPARE(childPoolMismatchCount.load(), 0);
+    // Non-worker threads must not execute pending jobs while waiting
+    QCOMPARE(testThreadJobCount.load(), 0);
+    QCOMPARE(taskMgr.globalProgress(), 100);
+
+    // Task not run yet is considered as done
+    const TaskId idleTaskId = taskMgr.newTask([](TaskProgress *) {});
+    QVERIFY(taskMgr.waitForDone(idleTaskId, 0));
+}
+
+void TestBase::LibTaskManager_waitForNextDone_test()
+{
+    TaskThreadPool pool(4);
+    TaskManager taskMgr(&pool);
+    QCOMPARE(taskMgr.waitForNextDone(), TaskId_null);
+
+    // Tasks are expected to be returned in completion order
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto sleepTime = std::chrono::milliseconds(200 - i * 50);
+        vecTaskId.push_back(
+            taskMgr.newTask([=](TaskProgress *) { std::this_thread::sleep_for(sleepTime); }));
+    }
+
+    // Auto-destroyed tasks aren't queued
+    const TaskId autoDestroyTaskId = taskMgr.newTask([](TaskProgress *) {});
+    taskMgr.run(autoDestroyTaskId, TaskAutoDestroy::On);
+
+    for (TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    std::vector<TaskId> vecDoneTaskId;
+    for (TaskId taskId = taskMgr.waitForNextDone(); taskId != TaskId_null;
+         taskId = taskMgr.waitForNextDone())
+    {
+        QVERIFY(taskMgr.waitForDone(taskId, 0));
+        vecDoneTaskId.push_back(taskId);
+    }
+
+    QCOMPARE(vecDoneTaskId.size(), vecTaskId.size());
+    QCOMPARE(vecDoneTaskId.back(), vecTaskId.front()); // Longest task
+
+    // Timeout
+    const TaskId longTaskId = taskMgr.newTask(
+        [](TaskProgress *) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
+    taskMgr.run(longTaskId, TaskAutoDestroy::Off);
+    QCOMPARE(taskMgr.waitForNextDone(0), TaskId_null);
+    QCOMPARE(taskMgr.waitForNextDone(), longTaskId);
+}
+
 void TestBase::LibTree_test()
 {
     const TreeNodeId nullptrId = 0;
@@ -1481,15 +2732,122 @@ void TestBase::Span_test()
     QCOMPARE(Span_itemIndex(vecString, item4), 4);
 }
 
+void TestBase::CliBatch_outputFilepath_test()
+{
+    auto fnOutput = [](std::string_view outputTemplate, const FilePath &inputFilepath)
+    { return cli_batchOutputFilepath(outputTemplate, inputFilepath).generic_u8string(); };
+
+    QCOMPARE(fnOutput("{dir}/out/{stem}.stl", "models/part.step"), "models/out/part.stl");
+    QCOMPARE(fnOutput("{filename}.zip", "models/part.step"), "part.step.zip");
+    QCOMPARE(fnOutput("{stem}{ext}.obj", "models/part.ply"), "part.ply.obj");
+    // Input without parent directory
+    QCOMPARE(fnOutput("{dir}/{stem}.stl", "part.step"), "./part.stl");
+    QCOMPARE(fnOutput("out.stl", "part.step"), "out.stl");
+    QVERIFY_EXCEPTION_THROWN(fnOutput("{unknown}.stl", "part.step"), fmt::format_error);
+    QVERIFY_EXCEPTION_THROWN(fnOutput("{stem.stl", "part.step"), fmt::format_error);
+}
+
+void TestBase::CliBatch_outputConflicts_test()
+{
+    std::vector<BatchFileReport> vecReport(6);
+    const char *outputs[] = {"out/a.stl", "out/b.stl", "out/../out/a.stl",
+                             "out/./b.stl", "out/c.stl", "out/a.stl"};
+    for (BatchFileReport &report : vecReport)
+        report.outputFilepath = outputs[&report - &vecReport.front()];
+
+    // Output paths are compared once normalized
+    const std::vector<std::pair<size_t, size_t>> vecExpectedConflict = {{0, 2}, {1, 3}, {0, 5}};
+    QVERIFY(cli_batchOutputConflicts(vecReport) == vecExpectedConflict);
+
+    vecReport.resize(2);
+    QVERIFY(cli_batchOutputConflicts(vecReport).empty());
+    QVERIFY(cli_batchOutputConflicts(Span<const BatchFileReport>{}).empty());
+}
+
+void TestBase::CliBatch_summary_test()
+{
+    std::vector<BatchFileReport> vecReport(3);
+    for (BatchFileReport &report : vecReport)
+    {
+        report.inputSize = 1024 * 1024;
+        report.outputSize = 100;
+        report.triangleCount = 12;
+        report.success = true;
+    }
+
+    vecReport.back().outputSize = 0;
+    vecReport.back().triangleCount = 0;
+    vecReport.back().success = false;
+
+    const BatchSummary summary = cli_batchSummary(vecReport, 2.);
+    QCOMPARE(summary.fileCount, 3);
+    QCOMPARE(summary.successCount, 2);
+    QCOMPARE(summary.inputSize, uintmax_t(3 * 1024 * 1024));
+    QCOMPARE(summary.outputSize, uintmax_t(200));
+    QCOMPARE(summary.triangleCount, int64_t(24));
+    QCOMPARE(summary.duration, 2.);
+    QCOMPARE(summary.filesPerSecond, 1.5);
+    QCOMPARE(summary.megaBytesPerSecond, 1.5);
+
+    // Null duration: no rates
+    const BatchSummary summaryNoDuration = cli_batchSummary(vecReport, 0.);
+    QCOMPARE(summaryNoDuration.fileCount, 3);
+    QCOMPARE(summaryNoDuration.filesPerSecond, 0.);
+    QCOMPARE(summaryNoDuration.megaBytesPerSecond, 0.);
+
+    const BatchSummary summaryEmpty = cli_batchSummary({}, 1.);
+    QCOMPARE(summaryEmpty.fileCount, 0);
+    QCOMPARE(summaryEmpty.filesPerSecond, 0.);
+}
+
+void TestBase::CliBatch_reportToJson_test()
+{
+    std::vector<BatchFileReport> vecReport(2);
+    vecReport.front().inputFilepath = "in/a.step";
+    vecReport.front().outputFilepath = "out/a.stl";
+    vecReport.front().inputSize = 2048;
+    vecReport.front().success = true;
+    vecReport.back().inputFilepath = "in/b \"quoted\".step";
+    vecReport.back().outputFilepath = "out/b.stl";
+    vecReport.back().errorMessage = "Import failed\n\tpath\\to\x01";
+
+    const BatchSummary summary = cli_batchSummary(vecReport, 0.5);
+    const std::string json = cli_batchReportToJson(summary, vecReport, 4);
+    auto fnContains = [&](std::string_view str) { return json.find(str) != std::string::npos; };
+    QVERIFY(fnContains("\"workerCount\": 4,"));
+    QVERIFY(fnContains("\"fileCount\": 2,"));
+    QVERIFY(fnContains("\"successCount\": 1,"));
+    QVERIFY(fnContains("\"failureCount\": 1,"));
+    QVERIFY(fnContains("\"duration\": 0.500,"));
+    QVERIFY(fnContains("\"inputBytes\": 2048,"));
+    QVERIFY(fnContains("\"input\": \"in/a.step\""));
+    QVERIFY(fnContains("\"success\": true"));
+    // Special characters are escaped, error is reported only for failed files
+    QVERIFY(fnContains(R"("input": "in/b \"quoted\".step")"));
+    QVERIFY(fnContains(R"("error": "Import failed\n\tpath\\to\u0001")"));
+    QCOMPARE(std::count(json.cbegin(), json.cend(), '{'), std::ptrdiff_t(3));
+    QVERIFY(json.find("\"error\"") == json.rfind("\"error\""));
+
+    // No files
+    const std::string jsonEmpty = cli_batchReportToJson({}, {}, 1);
+    QVERIFY(jsonEmpty.find("\"files\": [\n  ]") != std::string::npos);
+}
+
 void TestBase::initTestCase()
 {
     m_ioSystem = new IO::System;
 
+    // Same order as the application, native OBJ and STL readers take precedence over the
+    // OpenCascade ones
     m_ioSystem->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
+    m_ioSystem->addFactoryReader(std::make_unique<IO::ObjFactoryReader>());
+    m_ioSystem->addFactoryReader(std::make_unique<IO::StlFactoryReader>());
     m_ioSystem->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
     m_ioSystem->addFactoryReader(std::make_unique<IO::OffFactoryReader>());
     m_ioSystem->addFactoryReader(std::make_unique<IO::PlyFactoryReader>());
 
+    // Native STL writer takes precedence over the OpenCascade one
+    m_ioSystem->addFactoryWriter(std::make_unique<IO::StlFactoryWriter>());
     m_ioSystem->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
     m_ioSystem->addFactoryWriter(std::make_unique<IO::OffFactoryWriter>());
     m_ioSystem->addFactoryWriter(std::make_unique<IO::PlyFactoryWriter>());
@@ -50,11 +50,30 @@ private slots:
     void IO_probeFormat_test();
     void IO_probeFormat_test_data();
     void IO_probeFormatDirect_test();
+    void IO_probeFormats_test();
+    void IO_FileView_test();
+    void IO_DxfTokenizer_test();
+    void IO_DxfReaderParallelBuild_test();
+    void IO_DxfReaderBlockInserts_test();
+    void IO_DxfReaderInsertPlacement_test();
     void IO_OccStaticVariablesRollback_test();
     void IO_OccStaticVariablesRollback_test_data();
+    void IO_OccStepReaderStructurePreview_test();
+    void IO_OccGltfReaderLateDataLoading_test();
+    void IO_OccGltfWriterOptimizeMeshes_test();
     void IO_bugGitHub166_test();
     void IO_bugGitHub166_test_data();
     void IO_bugGitHub258_test();
+    void IO_importInDocumentParallelTransfer_test();
+    void IO_importCache_test();
+    void IO_importMemoryBudget_test();
+    void IO_OffReader_test();
+    void IO_ObjReader_test();
+    void IO_StlReader_test();
+    void IO_StlWriter_test();
+    void IO_OffWriter_test();
+    void IO_ZipDeflateParallel_test();
+    void IO_ZipDeflateParallel_test_data();
 
     void DoubleToString_test();
     void StringConv_test();
@@ -67,6 +86,9 @@ private slots:
     void MeshUtils_test_data();
     void MeshUtils_orientation_test();
     void MeshUtils_orientation_test_data();
+    void MeshUtils_optimizeVertexCache_test();
+
+    void PointCloudOctree_test();
 
     void Enumeration_test();
     void MetaEnum_test();
@@ -84,11 +106,18 @@ private slots:
     void UnitSystem_test_data();
 
     void LibTask_test();
+    void LibTaskThreadPool_test();
+    void LibTaskManager_waitForNextDone_test();
     void LibTree_test();
     void LibTree_removeRoot_test();
 
     void Span_test();
 
+    void CliBatch_outputFilepath_test();
+    void CliBatch_outputConflicts_test();
+    void CliBatch_summary_test();
+    void CliBatch_reportToJson_test();
+
     void initTestCase();
     void cleanupTestCase();
 